@@ -0,0 +1,77 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_API_ATTRIBUTE_TABLE_H
+#define SA_API_ATTRIBUTE_TABLE_H
+
+#include "shellanything/sa_types.h"
+#include "shellanything/sa_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#if 0
+}  // do not indent code inside extern C
+#endif
+#endif
+
+/// <summary>
+/// Get the number of attributes in the table.
+/// </summary>
+/// <param name="table">The attribute table structure object.</param>
+/// <returns>Returns the number of attributes in the table.</returns>
+size_t sa_attribute_table_get_count(sa_attribute_table_immutable_t* table);
+
+/// <summary>
+/// Get the name of an attribute.
+/// </summary>
+/// <param name="table">The attribute table structure object.</param>
+/// <param name="id">The id of the attribute. This is the index of the attribute in the definition array used to create the table.</param>
+/// <returns>Returns the name of the attribute. Returns NULL if the id is out of bounds.</returns>
+const char* sa_attribute_table_get_name(sa_attribute_table_immutable_t* table, size_t id);
+
+/// <summary>
+/// Check if an attribute is defined.
+/// An empty attribute value is defined as 'set'.
+/// </summary>
+/// <param name="table">The attribute table structure object.</param>
+/// <param name="id">The id of the attribute.</param>
+/// <returns>Returns 1 if the attribute is defined. Returns 0 otherwise.</returns>
+sa_boolean sa_attribute_table_has_value(sa_attribute_table_immutable_t* table, size_t id);
+
+/// <summary>
+/// Get the value of an attribute.
+/// </summary>
+/// <param name="table">The attribute table structure object.</param>
+/// <param name="id">The id of the attribute.</param>
+/// <returns>Returns the value of the attribute. The value is valid for the lifetime of the action. Returns NULL if the attribute is not defined.</returns>
+const char* sa_attribute_table_get_value_cstr(sa_attribute_table_immutable_t* table, size_t id);
+
+#ifdef __cplusplus
+#if 0
+{  // do not indent code inside extern C
+#endif
+}  // extern "C"
+#endif
+
+#endif //SA_API_ATTRIBUTE_TABLE_H
@@ -37,6 +37,22 @@ extern "C" {
 #endif
 #endif
 
+/// <summary>
+/// Performance counters of a configuration, a menu or a validator.
+/// Times are measured in nanoseconds.
+/// </summary>
+typedef struct
+{
+  uint64_t updates;             // number of updates or validations.
+  uint64_t total_ns;            // cumulative time of all updates.
+  uint64_t max_ns;              // time of the slowest update.
+  uint64_t expansions;          // number of property expansions.
+  uint64_t filesystem_probes;   // number of file system probes.
+  uint64_t exprtk_evaluations;  // number of exprtk expression evaluations.
+  uint64_t plugin_calls;        // number of plugin callbacks.
+  uint64_t plugin_ns;           // cumulative time spent in plugin callbacks.
+} sa_performance_counters_t;
+
 /// <summary>
 /// Get how many configurations are loaded in the configuration manager.
 /// </summary>
@@ -88,6 +104,54 @@ void sa_cfgmgr_clear_search_path();
 /// <param name="path">The path to add to the search list.</param>
 void sa_cfgmgr_add_search_path(const char* path);
 
+/// <summary>
+/// Enable or disable the performance counters of configurations, menus, validators and plugins.
+/// Performance counters are disabled by default.
+/// </summary>
+/// <param name="enabled">Set to 1 to enable the performance counters. Set to 0 to disable them.</param>
+void sa_cfgmgr_set_performance_counters_enabled(sa_boolean enabled);
+
+/// <summary>
+/// Returns 1 if the performance counters are enabled.
+/// </summary>
+/// <returns>Returns 1 if the performance counters are enabled. Returns 0 otherwise.</returns>
+sa_boolean sa_cfgmgr_is_performance_counters_enabled();
+
+/// <summary>
+/// Reset the performance counters of all loaded configurations, menus, validators and plugins.
+/// </summary>
+void sa_cfgmgr_reset_performance_counters();
+
+/// <summary>
+/// Get the performance counters of a loaded configuration in the configuration manager.
+/// </summary>
+/// <param name="index">The configuration index</param>
+/// <param name="counters">The output performance counters</param>
+/// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
+sa_error_t sa_cfgmgr_get_configuration_performance_counters(size_t index, sa_performance_counters_t* counters);
+
+/// <summary>
+/// Get the performance counters of a menu.
+/// </summary>
+/// <param name="menu">The menu structure object.</param>
+/// <param name="counters">The output performance counters</param>
+/// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
+sa_error_t sa_cfgmgr_get_menu_performance_counters(sa_menu_immutable_t* menu, sa_performance_counters_t* counters);
+
+/// <summary>
+/// Get the performance counters of a validator.
+/// </summary>
+/// <param name="validator">The validator structure object.</param>
+/// <param name="counters">The output performance counters</param>
+/// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
+sa_error_t sa_cfgmgr_get_validator_performance_counters(sa_validator_immutable_t* validator, sa_performance_counters_t* counters);
+
+/// <summary>
+/// Write the menus with the highest cumulative update time to the log.
+/// </summary>
+/// <param name="count">The maximum number of menus to log.</param>
+void sa_cfgmgr_log_slowest_menus(size_t count);
+
 #ifdef __cplusplus
 #if 0
 {  // do not indent code inside extern C
@@ -32,6 +32,8 @@
 #include "shellanything/sa_error.h"
 #include "shellanything/sa_selection_context.h"
 #include "shellanything/sa_property_store.h"
+#include "shellanything/sa_attribute_table.h"
+#include "shellanything/sa_xml.h"
 #include "shellanything/sa_plugin_definitions.h"
 
 #ifdef __cplusplus
@@ -92,6 +94,18 @@ const char* sa_plugin_action_get_name();
 /// <returns>Returns the xml definition of an action. Returns NULL if no xml is defined.</returns>
 const char* sa_plugin_action_get_xml();
 
+/// <summary>
+/// Get the attributes of an action, parsed once by the application.
+/// On the first call while the action is created, the application reads the given attributes from the action's xml element
+/// and saves them in an immutable table that lives as long as the action. Later calls return the same table without parsing.
+/// The id of an attribute in the table is its index in the attrs array.
+/// </summary>
+/// <param name="attrs">The array of XML_ATTR that defines the attributes of the action.</param>
+/// <param name="count">The number of elements in the attrs array.</param>
+/// <param name="table">The output attribute table.</param>
+/// <returns>Returns 0 on success. Returns SA_ERROR_NOT_FOUND if a mandatory attribute is missing. Returns non-zero otherwise.</returns>
+sa_error_t sa_plugin_action_get_attributes(XML_ATTR* attrs, size_t count, sa_attribute_table_immutable_t* table);
+
 /// <summary>
 /// Get a custom data pointer from the action. This same pointer is used while creating, executing and destroying the action.
 /// </summary>
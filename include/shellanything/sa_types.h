@@ -44,6 +44,11 @@ typedef struct sa_action_immutable_t
   void* opaque;
 } sa_action_immutable_t;
 
+typedef struct sa_attribute_table_immutable_t
+{
+  void* opaque;
+} sa_attribute_table_immutable_t;
+
 typedef struct sa_configuration_t
 {
   void* opaque;
@@ -29,6 +29,7 @@
 #include "shellanything/sa_error.h"
 #include "shellanything/sa_string.h"
 #include "shellanything/sa_property_store.h"
+#include "shellanything/sa_attribute_table.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -119,6 +120,15 @@ void sa_xml_attr_list_cleanup(XML_ATTR* attrs, size_t count);
 /// <param name="store">The property store to save the value of the arribute.</param>
 void sa_xml_attr_list_update(XML_ATTR* attrs, size_t count, sa_property_store_immutable_t* store);
 
+/// <summary>
+/// Update and assign temporary values to an XML_ATTR array from an attribute table.
+/// The id of each attribute in the table must match its index in the XML_ATTR array.
+/// </summary>
+/// <param name="attrs">The an array of XML_ATTR to parse.</param>
+/// <param name="count">The number of elements in the attrs array.</param>
+/// <param name="table">The attribute table that contains the value of the arributes.</param>
+void sa_xml_attr_list_update_table(XML_ATTR* attrs, size_t count, sa_attribute_table_immutable_t* table);
+
 /// <summary>
 /// Check that a single value is specified for a given group.
 /// </summary>
@@ -129,6 +139,17 @@ void sa_xml_attr_list_update(XML_ATTR* attrs, size_t count, sa_property_store_im
 /// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
 sa_error_t sa_xml_attr_group_is_mutually_exclusive(XML_ATTR* attrs, size_t count, int group, sa_property_store_immutable_t* store);
 
+/// <summary>
+/// Check that a single value is specified for a given group.
+/// The id of each attribute in the table must match its index in the XML_ATTR array.
+/// </summary>
+/// <param name="attrs">The an array of XML_ATTR to parse.</param>
+/// <param name="count">The number of elements in the attrs array.</param>
+/// <param name="group">The group identifier.</param>
+/// <param name="table">The attribute table to get attribute values.</param>
+/// <returns>Returns 0 on success. Returns SA_ERROR_INVALID_ARGUMENTS if attrs or table is NULL. Returns non-zero otherwise.</returns>
+sa_error_t sa_xml_attr_group_is_mutually_exclusive_table(XML_ATTR* attrs, size_t count, int group, sa_attribute_table_immutable_t* table);
+
 #ifdef __cplusplus
 #if 0
 {  // do not indent code inside extern C
@@ -0,0 +1,68 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "shellanything/sa_attribute_table.h"
+#include "AttributeTable.h"
+#include "sa_private_casting.h"
+
+using namespace shellanything;
+
+size_t sa_attribute_table_get_count(sa_attribute_table_immutable_t* table)
+{
+  if (table == NULL || table->opaque == NULL)
+    return 0;
+  size_t count = AS_CLASS_ATTRIBUTE_TABLE(table)->GetCount();
+  return count;
+}
+
+const char* sa_attribute_table_get_name(sa_attribute_table_immutable_t* table, size_t id)
+{
+  if (table == NULL || table->opaque == NULL)
+    return NULL;
+  const AttributeTable* table_class = AS_CLASS_ATTRIBUTE_TABLE(table);
+  if (id >= table_class->GetCount())
+    return NULL;
+  return table_class->GetName(id).c_str();
+}
+
+sa_boolean sa_attribute_table_has_value(sa_attribute_table_immutable_t* table, size_t id)
+{
+  if (table == NULL || table->opaque == NULL)
+    return 0;
+  bool found = AS_CLASS_ATTRIBUTE_TABLE(table)->HasValue(id);
+  if (found)
+    return 1;
+  return 0;
+}
+
+const char* sa_attribute_table_get_value_cstr(sa_attribute_table_immutable_t* table, size_t id)
+{
+  if (table == NULL || table->opaque == NULL)
+    return NULL;
+  const std::string* value = NULL;
+  bool found = AS_CLASS_ATTRIBUTE_TABLE(table)->TryGetValue(id, value);
+  if (!found)
+    return NULL;
+  return value->c_str();
+}
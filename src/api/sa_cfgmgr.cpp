@@ -24,6 +24,7 @@
 
 #include "shellanything/sa_cfgmgr.h"
 #include "ConfigManager.h"
+#include "PerformanceCounters.h"
 #include "sa_private_casting.h"
 #include "sa_string_private.h"
 
@@ -81,3 +82,68 @@ void sa_cfgmgr_add_search_path(const char* path)
 {
   ConfigManager::GetInstance().AddSearchPath(path);
 }
+
+static void sa_cfgmgr_copy_performance_counters(const PERFORMANCE_COUNTERS& source, sa_performance_counters_t* counters)
+{
+  counters->updates = source.updates;
+  counters->total_ns = source.total_ns;
+  counters->max_ns = source.max_ns;
+  counters->expansions = source.expansions;
+  counters->filesystem_probes = source.filesystem_probes;
+  counters->exprtk_evaluations = source.exprtk_evaluations;
+  counters->plugin_calls = source.plugin_calls;
+  counters->plugin_ns = source.plugin_ns;
+}
+
+void sa_cfgmgr_set_performance_counters_enabled(sa_boolean enabled)
+{
+  PerformanceCounters::SetEnabled(enabled != 0);
+}
+
+sa_boolean sa_cfgmgr_is_performance_counters_enabled()
+{
+  bool enabled = PerformanceCounters::IsEnabled();
+  if (enabled)
+    return 1;
+  return 0;
+}
+
+void sa_cfgmgr_reset_performance_counters()
+{
+  ConfigManager::GetInstance().ResetPerformanceCounters();
+}
+
+sa_error_t sa_cfgmgr_get_configuration_performance_counters(size_t index, sa_performance_counters_t* counters)
+{
+  if (counters == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+  ConfigFile::ConfigFilePtrList configs = ConfigManager::GetInstance().GetConfigFiles();
+  if (configs.empty() || index > (configs.size() - 1))
+    return SA_ERROR_VALUE_OUT_OF_BOUNDS;
+  const shellanything::ConfigFile* config_element = configs[index];
+  sa_cfgmgr_copy_performance_counters(config_element->GetPerformanceCounters(), counters);
+  return SA_ERROR_SUCCESS;
+}
+
+sa_error_t sa_cfgmgr_get_menu_performance_counters(sa_menu_immutable_t* menu, sa_performance_counters_t* counters)
+{
+  if (menu == NULL || counters == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+  const Menu* m = AS_CLASS_MENU(menu);
+  sa_cfgmgr_copy_performance_counters(m->GetPerformanceCounters(), counters);
+  return SA_ERROR_SUCCESS;
+}
+
+sa_error_t sa_cfgmgr_get_validator_performance_counters(sa_validator_immutable_t* validator, sa_performance_counters_t* counters)
+{
+  if (validator == NULL || counters == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+  const Validator* v = AS_CLASS_VALIDATOR(validator);
+  sa_cfgmgr_copy_performance_counters(v->GetPerformanceCounters(), counters);
+  return SA_ERROR_SUCCESS;
+}
+
+void sa_cfgmgr_log_slowest_menus(size_t count)
+{
+  ConfigManager::GetInstance().LogSlowestMenus(count);
+}
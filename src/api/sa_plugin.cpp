@@ -29,6 +29,8 @@
 #include "IAttributeValidator.h"
 #include "IUpdateCallback.h"
 #include "Plugin.h"
+#include "AttributeView.h"
+#include "AttributeTable.h"
 
 #include "rapidassist/strings.h"
 
@@ -39,11 +41,52 @@ using namespace shellanything;
 sa_selection_context_immutable_t g_update_selection_context;
 sa_selection_context_immutable_t g_validation_selection_context;
 sa_property_store_immutable_t g_validation_property_store;
-sa_property_store_t g_action_property_store;
 sa_selection_context_immutable_t g_action_selection_context;
-const char* g_action_name;
-const char* g_action_xml;
-void* g_action_data;
+
+/// <summary>
+/// State of a call to the action event function of a plugin.
+/// The state lives on the stack of the caller. A nested call saves the state of its parent and restores it when the call ends.
+/// </summary>
+struct PLUGIN_ACTION_CALL
+{
+  sa_property_store_t property_store;
+  const char* name;
+  const char* xml;
+  std::string xml_buffer;     // the serialized element, on demand.
+  const AttributeView* element; // the element of the action, only while creating the action.
+  AttributeTable* attributes;
+  void* data;
+  PLUGIN_ACTION_CALL* parent;
+
+  PLUGIN_ACTION_CALL(const std::string& action_name, PropertyStore* store, AttributeTable* table, void* action_data);
+  ~PLUGIN_ACTION_CALL();
+
+private:
+  // Disable copy constructor and copy operator
+  PLUGIN_ACTION_CALL(const PLUGIN_ACTION_CALL&);
+  PLUGIN_ACTION_CALL& operator=(const PLUGIN_ACTION_CALL&);
+};
+
+static thread_local PLUGIN_ACTION_CALL* t_action_call = NULL;
+
+PLUGIN_ACTION_CALL::PLUGIN_ACTION_CALL(const std::string& action_name, PropertyStore* store, AttributeTable* table, void* action_data) :
+  name(action_name.c_str()),
+  xml(NULL),
+  element(NULL),
+  attributes(table),
+  data(action_data),
+  parent(t_action_call)
+{
+  memset(&property_store, 0, sizeof(property_store));
+  if (store)
+    property_store = AS_TYPE_PROPERTY_STORE(store);
+  t_action_call = this;
+}
+
+PLUGIN_ACTION_CALL::~PLUGIN_ACTION_CALL()
+{
+  t_action_call = parent;
+}
 
 void ToCStringArray(std::vector<const char*>& destination, const std::vector<std::string>& values)
 {
@@ -236,6 +279,7 @@ public:
   PluginAction() :
     mMenu(NULL),
     mStore(NULL),
+    mAttributes(NULL),
     mData(NULL),
     mActionEventFunc(NULL)
   {
@@ -246,24 +290,17 @@ public:
     if (mActionEventFunc == NULL)
       sa_logging_print_format(SA_LOG_LEVEL_ERROR, SA_API_LOG_IDDENTIFIER, "Missing action event function.");
 
-    // initialize the global objects for the DESTROY event
-    memset(&g_action_property_store, 0, sizeof(g_action_property_store));
-    if (mStore)
-      g_action_property_store = AS_TYPE_PROPERTY_STORE(mStore);
-    g_action_name = mName.c_str();
-    g_action_xml = NULL;
-    g_action_data = mData;
-
-    // call the action event function of the plugin
-    sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Destroying action '%s'", mName.c_str());
-    sa_action_event_t evnt = SA_ACTION_EVENT_DESTROY;
-    sa_error_t result = mActionEventFunc(evnt);
+    sa_error_t result = SA_ERROR_SUCCESS;
+    if (mActionEventFunc)
+    {
+      // initialize the objects of the DESTROY event
+      PLUGIN_ACTION_CALL call(mName, mStore, mAttributes, mData);
 
-    // invalidate global update objects
-    memset(&g_action_property_store, 0, sizeof(g_action_property_store));
-    g_action_name = NULL;
-    g_action_xml = NULL;
-    g_action_data = NULL;
+      // call the action event function of the plugin
+      sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Destroying action '%s'", mName.c_str());
+      sa_action_event_t evnt = SA_ACTION_EVENT_DESTROY;
+      result = mActionEventFunc(evnt);
+    }
 
     // if a destruction has failed
     if (result != SA_ERROR_SUCCESS)
@@ -274,6 +311,8 @@ public:
 
     if (mStore)
       delete mStore;
+    if (mAttributes)
+      delete mAttributes;
   }
 
   virtual void SetName(const char* name)
@@ -291,6 +330,11 @@ public:
     mStore = store;
   }
 
+  virtual void SetAttributeTable(AttributeTable* attributes)
+  {
+    mAttributes = attributes;
+  }
+
   void SetActionEventFunction(sa_plugin_action_event_func func)
   {
     mActionEventFunc = func;
@@ -320,26 +364,15 @@ public:
       return false;
     }
 
-    // initialize the global objects for the EXECUTE event
-    memset(&g_action_property_store, 0, sizeof(g_action_property_store));
-    if (mStore)
-      g_action_property_store = AS_TYPE_PROPERTY_STORE(mStore);
-    g_action_name = mName.c_str();
-    g_action_xml = NULL;
-    g_action_data = mData;
+    // initialize the objects of the EXECUTE event
+    PLUGIN_ACTION_CALL call(mName, mStore, mAttributes, mData);
 
     // call the action event function of the plugin
     sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Executing action '%s'", mName.c_str());
     sa_action_event_t evnt = SA_ACTION_EVENT_EXECUTE;
     sa_error_t result = mActionEventFunc(evnt);
 
-    mData = g_action_data;
-
-    // invalidate global update objects
-    memset(&g_action_property_store, 0, sizeof(g_action_property_store));
-    g_action_name = NULL;
-    g_action_xml = NULL;
-    g_action_data = NULL;
+    mData = call.data;
 
     // if a execute failed
     if (result != SA_ERROR_SUCCESS)
@@ -355,6 +388,7 @@ public:
 private:
   Menu* mMenu;
   PropertyStore* mStore;
+  AttributeTable* mAttributes;
   std::string mName;
   mutable void* mData;
   sa_plugin_action_event_func mActionEventFunc;
@@ -387,6 +421,11 @@ public:
   }
 
   virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
+  {
+    return ParseFromXmlString(xml, error);
+  }
+
+  virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
   {
     // check callback
     if (mActionEventFunc == NULL)
@@ -396,26 +435,22 @@ public:
     }
 
     void* data = NULL;
+    AttributeTable* table = NULL;
     PropertyStore* store = new PropertyStore();
+    sa_error_t result = SA_ERROR_SUCCESS;
+    {
+      // initialize the objects of the CREATE event. The xml is serialized on demand.
+      PLUGIN_ACTION_CALL call(mName, store, NULL, NULL);
+      call.element = &attributes;
 
-    // initialize the global objects for the CREATE event
-    g_action_property_store = AS_TYPE_PROPERTY_STORE(store);
-    g_action_name = mName.c_str();
-    g_action_xml = xml.c_str();
-    g_action_data = data;
-
-    // call the action event function of the plugin
-    sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Parsing action '%s'", mName.c_str());
-    sa_action_event_t evnt = SA_ACTION_EVENT_CREATE;
-    sa_error_t result = mActionEventFunc(evnt);
-
-    data = g_action_data;
+      // call the action event function of the plugin
+      sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Parsing action '%s'", mName.c_str());
+      sa_action_event_t evnt = SA_ACTION_EVENT_CREATE;
+      result = mActionEventFunc(evnt);
 
-    // invalidate global update objects
-    memset(&g_action_property_store, 0, sizeof(g_action_property_store));
-    g_action_name = NULL;
-    g_action_xml = NULL;
-    g_action_data = NULL;
+      data = call.data;
+      table = call.attributes;
+    }
 
     // if a parsing is succesful
     if (result == SA_ERROR_SUCCESS)
@@ -424,6 +459,7 @@ public:
       action->SetName(mName.c_str());
       action->SetData(data);
       action->SetPropertyStore(store);
+      action->SetAttributeTable(table);
       action->SetActionEventFunction(mActionEventFunc);
       return action;
     }
@@ -431,6 +467,8 @@ public:
     {
       // a parsing error occured
       delete store;
+      if (table)
+        delete table;
       error = sa_error_get_error_description(result);
       return NULL;
     }
@@ -459,27 +497,103 @@ sa_selection_context_immutable_t* sa_plugin_config_update_get_selection_context(
 
 const char* sa_plugin_action_get_name()
 {
-  return g_action_name;
+  if (t_action_call == NULL)
+    return NULL;
+  return t_action_call->name;
 }
 
 const char* sa_plugin_action_get_xml()
 {
-  return g_action_xml;
+  PLUGIN_ACTION_CALL* call = t_action_call;
+  if (call == NULL)
+    return NULL;
+
+  // serialize the action's element on the first request
+  if (call->xml == NULL && call->element != NULL)
+  {
+    call->xml_buffer = call->element->ToXml();
+    call->xml = call->xml_buffer.c_str();
+  }
+  return call->xml;
+}
+
+sa_error_t sa_plugin_action_get_attributes(XML_ATTR* attrs, size_t count, sa_attribute_table_immutable_t* table)
+{
+  if (attrs == NULL || count == 0 || table == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+
+  PLUGIN_ACTION_CALL* call = t_action_call;
+  if (call == NULL)
+  {
+    sa_logging_print_format(SA_LOG_LEVEL_ERROR, SA_API_LOG_IDDENTIFIER, "Failed to get attributes of action. Attributes are only available while processing an action event.");
+    return SA_ERROR_NOT_FOUND;
+  }
+
+  // read the attributes from the element once, while the action is created
+  if (call->attributes == NULL)
+  {
+    if (call->element == NULL)
+    {
+      sa_logging_print_format(SA_LOG_LEVEL_ERROR, SA_API_LOG_IDDENTIFIER, "Failed to get attributes of action '%s'. Attributes are only parsed while creating the action.", call->name);
+      return SA_ERROR_NOT_FOUND;
+    }
+
+    StringList names;
+    for (size_t i = 0; i < count; i++)
+    {
+      names.push_back(attrs[i].name);
+    }
+    AttributeTable* attributes = new AttributeTable(*call->element, names);
+
+    // check mandatory attributes
+    for (size_t i = 0; i < count; i++)
+    {
+      const XML_ATTR& attr = attrs[i];
+      if (attr.mandatory == SA_XML_ATTR_MANDATORY && !attributes->HasValue(i))
+      {
+        sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Unable to find mandatory attribute '%s'.", attr.name);
+        delete attributes;
+        return SA_ERROR_NOT_FOUND;
+      }
+    }
+
+    call->attributes = attributes;
+  }
+
+  // the table is indexed from the plugin's definition array
+  if (call->attributes->GetCount() != count)
+  {
+    sa_logging_print_format(SA_LOG_LEVEL_ERROR, SA_API_LOG_IDDENTIFIER, "Failed to get attributes of action '%s'. Expected %d attributes but the action defines %d attributes.", call->name, (int)count, (int)call->attributes->GetCount());
+    return SA_ERROR_VALUE_OUT_OF_BOUNDS;
+  }
+
+  *table = AS_TYPE_ATTRIBUTE_TABLE(call->attributes);
+  return SA_ERROR_SUCCESS;
 }
 
 void* sa_plugin_action_get_data()
 {
-  return g_action_data;
+  if (t_action_call == NULL)
+    return NULL;
+  return t_action_call->data;
 }
 
 void sa_plugin_action_set_data(void* data)
 {
-  g_action_data = data;
+  if (t_action_call == NULL)
+    return;
+  t_action_call->data = data;
 }
 
 sa_property_store_t* sa_plugin_action_get_property_store()
 {
-  return &g_action_property_store;
+  static sa_property_store_t EMPTY_PROPERTY_STORE;
+  if (t_action_call == NULL)
+  {
+    memset(&EMPTY_PROPERTY_STORE, 0, sizeof(EMPTY_PROPERTY_STORE));
+    return &EMPTY_PROPERTY_STORE;
+  }
+  return &t_action_call->property_store;
 }
 
 sa_error_t sa_plugin_register_validation_attributes(const char* names[], size_t count, sa_plugin_validation_attributes_func func)
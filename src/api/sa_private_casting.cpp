@@ -143,6 +143,15 @@ sa_property_store_t                   AS_TYPE_PROPERTY_STORE(shellanything::Prop
   sa_property_store_t            my_type; my_type.opaque = (void*)(object); return my_type;
 }
 
+const shellanything::AttributeTable* AS_CLASS_ATTRIBUTE_TABLE(sa_attribute_table_immutable_t* object)
+{
+  return (const shellanything::AttributeTable*)(object->opaque);
+}
+sa_attribute_table_immutable_t        AS_TYPE_ATTRIBUTE_TABLE(const shellanything::AttributeTable* object)
+{
+  sa_attribute_table_immutable_t my_type; my_type.opaque = (void*)(object); return my_type;
+}
+
 //const std::string* AS_CLASS_STRING(sa_string_immutable_t*      object) { return (const std::string*)(object->opaque); }
 std::string* AS_CLASS_STRING(sa_string_t* object)
 {
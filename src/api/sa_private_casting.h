@@ -35,6 +35,7 @@
 #include "ConfigFile.h"
 #include "Validator.h"
 #include "PropertyStore.h"
+#include "AttributeTable.h"
 
 #include "shellanything/sa_types.h"
 
@@ -73,6 +74,9 @@ shellanything::PropertyStore* AS_CLASS_PROPERTY_STORE(sa_property_store_t* objec
 sa_property_store_immutable_t        AS_TYPE_PROPERTY_STORE(const shellanything::PropertyStore* object);
 sa_property_store_t                  AS_TYPE_PROPERTY_STORE(shellanything::PropertyStore* object);
 
+const shellanything::AttributeTable* AS_CLASS_ATTRIBUTE_TABLE(sa_attribute_table_immutable_t* object);
+sa_attribute_table_immutable_t        AS_TYPE_ATTRIBUTE_TABLE(const shellanything::AttributeTable* object);
+
 //const std::string* AS_CLASS_STRING(sa_string_immutable_t*      object);
 std::string* AS_CLASS_STRING(sa_string_t* object);
 //sa_string_immutable_t        AS_TYPE_STRING(const std::string* object);
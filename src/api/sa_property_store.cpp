@@ -77,21 +77,21 @@ void sa_property_store_set_property(sa_property_store_t* store, const char* name
 const char* sa_property_store_get_property_cstr(sa_property_store_immutable_t* store, const char* name)
 {
   const shellanything::PropertyStore* store_class = AS_CLASS_PROPERTY_STORE(store);
-  bool found = store_class->HasProperty(name);
+  const std::string* value = NULL;
+  bool found = store_class->TryGetProperty(name, value);
   if (!found)
     return NULL;
-  const std::string& value = store_class->GetProperty(name);
-  return value.c_str();
+  return value->c_str();
 }
 
 const char* sa_property_store_get_property_alloc(sa_property_store_immutable_t* store, const char* name)
 {
   const shellanything::PropertyStore* store_class = AS_CLASS_PROPERTY_STORE(store);
-  bool found = store_class->HasProperty(name);
+  const std::string* value = NULL;
+  bool found = store_class->TryGetProperty(name, value);
   if (!found)
     return NULL;
-  const std::string& value = store_class->GetProperty(name);
-  const char* output = value.c_str();
+  const char* output = value->c_str();
   return _strdup(output);
 }
 
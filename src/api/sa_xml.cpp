@@ -29,9 +29,11 @@
 #include "sa_private_casting.h"
 
 #include "PropertyStore.h"
+#include "AttributeTable.h"
 
 #include "tinyxml2.h"
 #include <string>
+#include <vector>
 
 using namespace shellanything;
 using namespace tinyxml2;
@@ -210,6 +212,32 @@ void sa_xml_attr_list_cleanup(XML_ATTR* attrs, size_t count)
   }
 }
 
+void sa_xml_attr_list_update_table(XML_ATTR* attrs, size_t count, sa_attribute_table_immutable_t* table)
+{
+  if (attrs == NULL)
+    return;
+  sa_xml_attr_list_cleanup(attrs, count);
+  if (table == NULL || table->opaque == NULL)
+    return;
+
+  const AttributeTable* table_class = AS_CLASS_ATTRIBUTE_TABLE(table);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    XML_ATTR& attr = attrs[i];
+
+    // Get the original value of this attribute from the table
+    const std::string* attribute_value = NULL;
+    if (table_class->TryGetValue(i, attribute_value))
+    {
+      attr.tmp_value = _strdup(attribute_value->c_str());
+
+      // And expand the value
+      attr.tmp_expanded = sa_properties_expand_alloc(attr.tmp_value);
+    }
+  }
+}
+
 void sa_xml_attr_list_update(XML_ATTR* attrs, size_t count, sa_property_store_immutable_t* store)
 {
   sa_xml_attr_list_cleanup(attrs, count);
@@ -232,7 +260,7 @@ void sa_xml_attr_list_update(XML_ATTR* attrs, size_t count, sa_property_store_im
   }
 }
 
-sa_error_t sa_xml_attr_group_is_mutually_exclusive(XML_ATTR* attrs, size_t count, int group, sa_property_store_immutable_t* store)
+static sa_error_t sa_xml_attr_group_is_mutually_exclusive_internal(XML_ATTR* attrs, size_t count, int group, const std::vector<bool>& specified)
 {
   // Build attribute names in group
   std::string all_names_in_group;
@@ -262,8 +290,8 @@ sa_error_t sa_xml_attr_group_is_mutually_exclusive(XML_ATTR* attrs, size_t count
     XML_ATTR& attr = attrs[i];
     if (attr.group == group)
     {
-      // Check if this attribute was specified (is available in the store)
-      if (sa_property_store_has_property(store, attr.name))
+      // Check if this attribute was specified
+      if (specified[i])
       {
         num_specified++;
         if (!specified_names_in_group.empty())
@@ -287,3 +315,28 @@ sa_error_t sa_xml_attr_group_is_mutually_exclusive(XML_ATTR* attrs, size_t count
 
   return SA_ERROR_SUCCESS;
 }
+
+sa_error_t sa_xml_attr_group_is_mutually_exclusive(XML_ATTR* attrs, size_t count, int group, sa_property_store_immutable_t* store)
+{
+  // An attribute is specified if it is available in the store
+  std::vector<bool> specified(count, false);
+  for (size_t i = 0; i < count; i++)
+  {
+    specified[i] = (sa_property_store_has_property(store, attrs[i].name) != 0);
+  }
+  return sa_xml_attr_group_is_mutually_exclusive_internal(attrs, count, group, specified);
+}
+
+sa_error_t sa_xml_attr_group_is_mutually_exclusive_table(XML_ATTR* attrs, size_t count, int group, sa_attribute_table_immutable_t* table)
+{
+  if (attrs == NULL || table == NULL || table->opaque == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+
+  // An attribute is specified if it is defined in the table
+  std::vector<bool> specified(count, false);
+  for (size_t i = 0; i < count; i++)
+  {
+    specified[i] = (sa_attribute_table_has_value(table, i) != 0);
+  }
+  return sa_xml_attr_group_is_mutually_exclusive_internal(attrs, count, group, specified);
+}
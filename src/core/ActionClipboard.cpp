@@ -53,29 +53,17 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionClipboard* action = new ActionClipboard();
       std::string tmp_str;
 
       //parse value
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "value", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "value", false, true, tmp_str, error))
       {
         action->SetValue(tmp_str);
       }
@@ -57,78 +57,66 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionExecute* action = new ActionExecute();
       std::string tmp_str;
 
       //parse path
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "path", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "path", false, true, tmp_str, error))
       {
         action->SetPath(tmp_str);
       }
 
       //parse arguments
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "arguments", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "arguments", true, true, tmp_str, error))
       {
         action->SetArguments(tmp_str);
       }
 
       //parse basedir
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "basedir", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "basedir", true, true, tmp_str, error))
       {
         action->SetBaseDir(tmp_str);
       }
 
       //parse verb
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "verb", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "verb", true, true, tmp_str, error))
       {
         action->SetVerb(tmp_str);
       }
 
       //parse wait
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "wait", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "wait", true, true, tmp_str, error))
       {
         action->SetWait(tmp_str);
       }
 
       //parse timeout
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "timeout", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "timeout", true, true, tmp_str, error))
       {
         action->SetTimeout(tmp_str);
       }
 
       //parse console
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "console", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "console", true, true, tmp_str, error))
       {
         action->SetConsole(tmp_str);
       }
 
       //parse pid
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "pid", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "pid", true, true, tmp_str, error))
       {
         action->SetPid(tmp_str);
       }
@@ -53,35 +53,23 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionFile* action = new ActionFile();
       std::string tmp_str;
 
       //parse path
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "path", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "path", false, true, tmp_str, error))
       {
         action->SetPath(tmp_str);
       }
 
       //parse text
-      const char* text = element->GetText();
+      const char* text = attributes.GetText();
       if (text)
       {
         action->SetText(text);
@@ -89,7 +77,7 @@ namespace shellanything
 
       //parse encoding
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "encoding", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "encoding", true, true, tmp_str, error))
       {
         action->SetEncoding(tmp_str);
       }
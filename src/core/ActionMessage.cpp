@@ -55,43 +55,31 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionMessage* action = new ActionMessage();
       std::string tmp_str;
 
       //parse title
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "title", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "title", false, true, tmp_str, error))
       {
         action->SetTitle(tmp_str);
       }
 
       //parse caption
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "caption", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "caption", false, true, tmp_str, error))
       {
         action->SetCaption(tmp_str);
       }
 
       //parse icon
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "icon", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "icon", true, true, tmp_str, error))
       {
         action->SetIcon(tmp_str);
       }
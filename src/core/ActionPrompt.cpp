@@ -54,64 +54,52 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionPrompt* action = new ActionPrompt();
       std::string tmp_str;
 
       //parse name
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "name", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "name", false, true, tmp_str, error))
       {
         action->SetName(tmp_str);
       }
 
       //parse title
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "title", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "title", false, true, tmp_str, error))
       {
         action->SetTitle(tmp_str);
       }
 
       //parse default
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "default", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "default", true, true, tmp_str, error))
       {
         action->SetDefault(tmp_str);
       }
 
       //parse type
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "type", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "type", true, true, tmp_str, error))
       {
         action->SetType(tmp_str);
       }
 
       //parse valueyes
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "valueyes", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "valueyes", true, true, tmp_str, error))
       {
         action->SetValueYes(tmp_str);
       }
 
       //parse valueno
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "valueno", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "valueno", true, true, tmp_str, error))
       {
         action->SetValueNo(tmp_str);
       }
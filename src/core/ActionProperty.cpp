@@ -24,7 +24,7 @@
 
 #include "ActionProperty.h"
 #include "PropertyManager.h"
-#include "libexprtk.h"
+#include "ExprtkHelper.h"
 #include "ObjectFactory.h"
 #include "LoggerHelper.h"
 #include "RandomHelper.h"
@@ -59,99 +59,87 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionProperty* action = new ActionProperty();
       std::string tmp_str;
 
       //parse name
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "name", false, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "name", false, true, tmp_str, error))
       {
         action->SetName(tmp_str);
       }
 
       //parse value
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "value", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "value", true, true, tmp_str, error))
       {
         action->SetValue(tmp_str);
       }
 
       //parse exprtk
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "exprtk", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "exprtk", true, true, tmp_str, error))
       {
         action->SetExprtk(tmp_str);
       }
 
       //parse file
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "file", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "file", true, true, tmp_str, error))
       {
         action->SetFile(tmp_str);
       }
 
       //parse filesize
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "filesize", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "filesize", true, true, tmp_str, error))
       {
         action->SetFileSize(tmp_str);
       }
 
       //parse registrykey
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "registrykey", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "registrykey", true, true, tmp_str, error))
       {
         action->SetRegistryKey(tmp_str);
       }
 
       //parse searchpath
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "searchpath", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "searchpath", true, true, tmp_str, error))
       {
         action->SetSearchPath(tmp_str);
       }
 
       //parse random
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "random", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "random", true, true, tmp_str, error))
       {
         action->SetRandom(tmp_str);
       }
 
       //parse randommin
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "randommin", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "randommin", true, true, tmp_str, error))
       {
         action->SetRandomMin(tmp_str);
       }
 
       //parse randommax
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "randommax", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "randommax", true, true, tmp_str, error))
       {
         action->SetRandomMax(tmp_str);
       }
 
       //parse fail
       tmp_str = "";
-      if (ObjectFactory::ParseAttribute(element, "fail", true, true, tmp_str, error))
+      if (ObjectFactory::ParseAttribute(attributes, "fail", true, true, tmp_str, error))
       {
         action->SetFail(tmp_str);
       }
@@ -434,12 +422,10 @@ namespace shellanything
 
   bool ActionProperty::GetValueFromExprtk(const std::string& exprtk, std::string& value) const
   {
-    static const size_t ERROR_SIZE = 10480;
-    char error[ERROR_SIZE];
-    error[0] = '\0';
-
+    // Evaluate numeric properties as variables of the unexpanded expression to reuse the compiled expression.
+    std::string error;
     double result = 0.0;
-    int evaluated = EvaluateDouble(exprtk.c_str(), &result, error, ERROR_SIZE);
+    bool evaluated = ExprtkHelper::EvaluateDouble(mExprtk, exprtk, result, error);
     if (!evaluated)
     {
       // report a warning.
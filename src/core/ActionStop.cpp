@@ -53,28 +53,16 @@ namespace shellanything
 
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
+      return ParseFromXmlString(xml, error);
+    }
 
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+    {
       ActionStop* action = new ActionStop();
       std::string tmp_str;
 
       //parse like a Validator
-      Validator* validator = ObjectFactory::GetInstance().ParseValidator(element, error);
+      Validator* validator = ObjectFactory::GetInstance().ParseValidator(attributes, error);
       if (validator == NULL)
       {
         delete action;
@@ -25,6 +25,7 @@
 #include "App.h"
 #include "LoggerHelper.h"
 #include "ConfigManager.h"
+#include "ConfigSnapshot.h"
 #include "PropertyManager.h"
 #include "Environment.h"
 
@@ -50,7 +51,8 @@ namespace shellanything
     mLogger(NULL),
     mRegistry(NULL),
     mClipboard(NULL),
-    mKeyboard(NULL)
+    mKeyboard(NULL),
+    mFileWatcherService(NULL)
   {
   }
 
@@ -80,10 +82,15 @@ namespace shellanything
 
   void App::ClearServices()
   {
+    // Write pending log messages before the logger is released
+    if (mLogger)
+      mLogger->Flush();
+
     mLogger = NULL;
     mRegistry = NULL;
     mClipboard = NULL;
     mKeyboard = NULL;
+    mFileWatcherService = NULL;
   }
 
   void App::SetLoggerService(ILoggerService* logger)
@@ -156,6 +163,16 @@ namespace shellanything
     return mProcessLauncherService;
   }
 
+  void App::SetFileWatcherService(IFileWatcherService* instance)
+  {
+    mFileWatcherService = instance;
+  }
+
+  IFileWatcherService* App::GetFileWatcherService()
+  {
+    return mFileWatcherService;
+  }
+
   bool App::IsTestingEnvironment()
   {
     std::string process_path = ra::process::GetCurrentProcessPathUtf8();
@@ -239,6 +256,13 @@ namespace shellanything
     return temp_dir;
   }
 
+  std::string App::GetSnapshotDirectory()
+  {
+    std::string log_dir = GetLogDirectory();
+    std::string snapshot_dir = log_dir + "\\snapshots";
+    return snapshot_dir;
+  }
+
   std::string App::GetLegacyConfigurationsDirectory()
   {
     //get home directory of the user
@@ -287,6 +311,9 @@ namespace shellanything
   {
     SetupGlobalProperties();
 
+    //Configuration Files are loaded from their snapshot when they are up to date
+    ConfigSnapshot::SetDirectory(GetSnapshotDirectory());
+
     InitConfigManager();
 
     return true;
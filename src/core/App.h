@@ -32,6 +32,7 @@
 #include "IRandomService.h"
 #include "IIconResolutionService.h"
 #include "IProcessLauncherService.h"
+#include "IFileWatcherService.h"
 
 #include <string>
 
@@ -68,6 +69,7 @@ namespace shellanything
 
     /// <summary>
     /// Clear all services. Note that existing service instances are not destroyed.
+    /// Pending messages of the logger service are flushed before the service is cleared.
     /// </summary>
     void ClearServices();
 
@@ -176,6 +178,21 @@ namespace shellanything
     /// <returns>Returns a pointer of the instance that is currently set. Returns NULL if no service is set.</returns>
     IProcessLauncherService* GetProcessLauncherService();
 
+    /// <summary>
+    /// Set the current application file watcher service.
+    /// </summary>
+    /// <remarks>
+    /// If a service instance is already set, the caller must properly destroy the old instance.
+    /// </remarks>
+    /// <param name="instance">A valid instance of a the service.</param>
+    void SetFileWatcherService(IFileWatcherService* instance);
+
+    /// <summary>
+    /// Get the current application file watcher service.
+    /// </summary>
+    /// <returns>Returns a pointer of the instance that is currently set. Returns NULL if no service is set.</returns>
+    IFileWatcherService* GetFileWatcherService();
+
     /// <summary>
     /// Test if application is loaded in a test environment (main's tests executable).
     /// </summary>
@@ -194,6 +211,12 @@ namespace shellanything
     /// <returns>Returns the path of the directory that should be used by the logging framework.</returns>
     std::string GetLogDirectory();
 
+    /// <summary>
+    /// Get the application's snapshot directory. Snapshots of the Configuration Files are stored in a subdirectory of the log directory.
+    /// </summary>
+    /// <returns>Returns the path of the directory that should be used for storing snapshots of Configuration Files.</returns>
+    std::string GetSnapshotDirectory();
+
     /// <summary>
     /// Test if the given directory is valid for logging.
     /// </summary>
@@ -279,6 +302,7 @@ namespace shellanything
     IRandomService* mRandom;
     IIconResolutionService* mIconResolutionService;
     IProcessLauncherService* mProcessLauncherService;
+    IFileWatcherService* mFileWatcherService;
   };
 
 
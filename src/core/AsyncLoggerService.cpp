@@ -0,0 +1,328 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "AsyncLoggerService.h"
+
+#include "rapidassist/timing.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+namespace shellanything
+{
+  const size_t AsyncLoggerService::DEFAULT_MEMORY_BUDGET = 2 * 1024 * 1024;
+
+  // Maximum time in milliseconds that a flush waits for messages being written by other threads.
+  static const uint64_t FLUSH_TIMEOUT_MS = 1000;
+
+  // Maximum time in milliseconds that the background thread sleeps without checking for new messages.
+  static const uint64_t DRAIN_INTERVAL_MS = 20;
+
+  inline size_t CopyText(char* destination, size_t size, const char* source)
+  {
+    size_t length = strlen(source);
+    if (length >= size)
+      length = size - 1; // truncate
+    memcpy(destination, source, length);
+    destination[length] = '\0';
+    return length;
+  }
+
+  AsyncLoggerService::AsyncLoggerService(ILoggerService* logger, size_t memory_budget, OVERFLOW_POLICY policy) :
+    mLogger(logger),
+    mSlots(NULL),
+    mMask(0),
+    mEnqueuePos(0),
+    mDequeuePos(0),
+    mPolicy(policy),
+    mDropped(0),
+    mReportedDrops(0),
+    mRunning(false),
+    mStopping(false),
+    mSleeping(false)
+  {
+    // The number of slots must be a power of 2
+    size_t capacity = 2;
+    while (capacity * 2 * sizeof(SLOT) <= memory_budget)
+    {
+      capacity *= 2;
+    }
+
+    mSlots = new SLOT[capacity];
+    mMask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++)
+    {
+      mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  AsyncLoggerService::~AsyncLoggerService()
+  {
+    Stop();
+    Flush();
+    delete[] mSlots;
+    mSlots = NULL;
+  }
+
+  void AsyncLoggerService::LogMessage(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    Enqueue(filename, line, level, message);
+  }
+
+  void AsyncLoggerService::LogMessage(const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    Enqueue(NULL, 0, level, message);
+  }
+
+  void AsyncLoggerService::Flush()
+  {
+    // Drain on the calling thread. The timeout prevents a deadlock if the background thread was
+    // terminated while draining, which happens when the process exits.
+    std::unique_lock<std::timed_mutex> lock(mDrainMutex, std::defer_lock);
+    if (lock.try_lock_for(std::chrono::milliseconds(FLUSH_TIMEOUT_MS)))
+      DrainPending(true);
+
+    if (mLogger)
+      mLogger->Flush();
+  }
+
+  bool AsyncLoggerService::Start()
+  {
+    std::lock_guard<std::mutex> lock(mThreadMutex);
+    if (mThread.joinable())
+      return true; // already running
+
+    mStopping = false;
+    mRunning = true;
+    mThread = std::thread(&AsyncLoggerService::Run, this);
+    return true;
+  }
+
+  void AsyncLoggerService::Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mThreadMutex);
+      if (!mThread.joinable())
+        return; // not running
+
+      // New messages are forwarded synchronously from now on
+      mRunning = false;
+      mStopping = true;
+      {
+        std::lock_guard<std::mutex> wake_lock(mWakeMutex);
+        mWakeCondition.notify_one();
+      }
+      mThread.join();
+    }
+
+    // Forward the messages that were queued while the thread was stopping
+    Flush();
+  }
+
+  bool AsyncLoggerService::IsRunning() const
+  {
+    return mRunning.load();
+  }
+
+  ILoggerService* AsyncLoggerService::GetLogger() const
+  {
+    return mLogger;
+  }
+
+  AsyncLoggerService::OVERFLOW_POLICY AsyncLoggerService::GetOverflowPolicy() const
+  {
+    return (OVERFLOW_POLICY)mPolicy.load(std::memory_order_relaxed);
+  }
+
+  void AsyncLoggerService::SetOverflowPolicy(OVERFLOW_POLICY policy)
+  {
+    mPolicy.store(policy, std::memory_order_relaxed);
+  }
+
+  size_t AsyncLoggerService::GetCapacity() const
+  {
+    return mMask + 1;
+  }
+
+  uint64_t AsyncLoggerService::GetDroppedCount() const
+  {
+    return mDropped.load(std::memory_order_relaxed);
+  }
+
+  void AsyncLoggerService::Enqueue(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    if (mLogger == NULL)
+      return;
+
+    for (;;)
+    {
+      if (!mRunning.load())
+      {
+        // No background thread. Forward synchronously.
+        if (filename)
+          mLogger->LogMessage(filename, line, level, message);
+        else
+          mLogger->LogMessage(level, message);
+        return;
+      }
+
+      if (TryEnqueue(filename, line, level, message))
+      {
+        if (mSleeping.load())
+          mWakeCondition.notify_one();
+        return;
+      }
+
+      // The ring buffer is full
+      if (GetOverflowPolicy() == OVERFLOW_POLICY_DROP)
+      {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      // Wait for the background thread to free a slot
+      mWakeCondition.notify_one();
+      std::this_thread::yield();
+    }
+  }
+
+  bool AsyncLoggerService::TryEnqueue(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    // Claim a slot. Multiple producers compete for the same position.
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    SLOT* slot = NULL;
+    for (;;)
+    {
+      slot = &mSlots[pos & mMask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+      if (diff == 0)
+      {
+        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      {
+        return false; // full
+      }
+      else
+      {
+        pos = mEnqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    // Copy the message in the slot
+    slot->level = level;
+    slot->line = line;
+    slot->has_filename = (filename != NULL);
+    size_t offset = 0;
+    if (filename)
+      offset = CopyText(slot->text, SLOT_TEXT_SIZE / 4, filename) + 1;
+    CopyText(slot->text + offset, SLOT_TEXT_SIZE - offset, (message ? message : ""));
+
+    // Publish the slot to the consumer
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool AsyncLoggerService::DequeueOne()
+  {
+    size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+    SLOT& slot = mSlots[pos & mMask];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != pos + 1)
+      return false; // empty or the slot is still being written
+
+    if (slot.has_filename)
+    {
+      const char* filename = slot.text;
+      const char* message = slot.text + strlen(filename) + 1;
+      mLogger->LogMessage(filename, slot.line, slot.level, message);
+    }
+    else
+    {
+      mLogger->LogMessage(slot.level, slot.text);
+    }
+
+    // Release the slot to the producers
+    slot.sequence.store(pos + mMask + 1, std::memory_order_release);
+    mDequeuePos.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  void AsyncLoggerService::DrainPending(bool wait_for_writers)
+  {
+    // Forward every message that was queued before this call
+    const size_t target = mEnqueuePos.load(std::memory_order_acquire);
+    const uint64_t deadline = ra::timing::GetMillisecondsCounterU64() + FLUSH_TIMEOUT_MS;
+    while ((intptr_t)(target - mDequeuePos.load(std::memory_order_relaxed)) > 0)
+    {
+      if (DequeueOne())
+        continue;
+
+      // The next slot is claimed but not written yet
+      if (!wait_for_writers || ra::timing::GetMillisecondsCounterU64() > deadline)
+        break;
+      std::this_thread::yield();
+    }
+
+    ReportDroppedMessages();
+  }
+
+  void AsyncLoggerService::ReportDroppedMessages()
+  {
+    uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+    if (dropped == mReportedDrops)
+      return;
+
+    char message[128];
+    snprintf(message, sizeof(message), "%llu log messages were dropped because the log buffer was full.", (unsigned long long)(dropped - mReportedDrops));
+    mReportedDrops = dropped;
+    mLogger->LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_WARNING, message);
+  }
+
+  void AsyncLoggerService::Run()
+  {
+    while (!mStopping.load())
+    {
+      {
+        std::lock_guard<std::timed_mutex> lock(mDrainMutex);
+        DrainPending(false);
+      }
+
+      // Sleep until a producer wakes us up.
+      // A missed notification only delays the messages by DRAIN_INTERVAL_MS.
+      std::unique_lock<std::mutex> lock(mWakeMutex);
+      mSleeping = true;
+      if (!mStopping.load() && mDequeuePos.load() == mEnqueuePos.load())
+        mWakeCondition.wait_for(lock, std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+      mSleeping = false;
+    }
+
+    std::lock_guard<std::timed_mutex> lock(mDrainMutex);
+    DrainPending(true);
+  }
+
+} //namespace shellanything
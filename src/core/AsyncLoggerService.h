@@ -0,0 +1,196 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_ASYNC_LOGGER_SERVICE_H
+#define SA_ASYNC_LOGGER_SERVICE_H
+
+#include "ILoggerService.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Logger decorator that forwards messages to another logger from a background thread.
+  /// Messages are copied into a bounded lock-free ring buffer. The calling thread never waits for the wrapped logger.
+  /// Messages longer than a slot are truncated.
+  /// </summary>
+  class SHELLANYTHING_EXPORT AsyncLoggerService : public virtual ILoggerService
+  {
+  public:
+    /// <summary>
+    /// Defines what happens to a message when the ring buffer is full.
+    /// </summary>
+    enum OVERFLOW_POLICY
+    {
+      ///<summary>The message is discarded and the dropped message counter is incremented.</summary>
+      OVERFLOW_POLICY_DROP,
+      ///<summary>The calling thread waits until the background thread frees a slot.</summary>
+      OVERFLOW_POLICY_BLOCK,
+    };
+
+    /// <summary>
+    /// Default memory budget of the ring buffer, in bytes.
+    /// </summary>
+    static const size_t DEFAULT_MEMORY_BUDGET;
+
+    /// <summary>
+    /// Maximum size in bytes of the filename and message stored in a single slot of the ring buffer.
+    /// </summary>
+    static const size_t SLOT_TEXT_SIZE = 2048;
+
+    /// <summary>
+    /// Create a new asynchronous logger.
+    /// The background thread is not started. Messages are forwarded synchronously until Start() is called.
+    /// </summary>
+    /// <param name="logger">The wrapped logger. The instance is not owned by this logger and must outlive it.</param>
+    /// <param name="memory_budget">The maximum memory in bytes used by the ring buffer.</param>
+    /// <param name="policy">The overflow policy of the ring buffer.</param>
+    AsyncLoggerService(ILoggerService* logger, size_t memory_budget = DEFAULT_MEMORY_BUDGET, OVERFLOW_POLICY policy = OVERFLOW_POLICY_DROP);
+    virtual ~AsyncLoggerService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    AsyncLoggerService(const AsyncLoggerService&);
+    AsyncLoggerService& operator=(const AsyncLoggerService&);
+  public:
+
+    /// <summary>
+    /// Send a message to this logger.
+    /// </summary>
+    /// <param name="filename">The originating source code file name.</param>
+    /// <param name="line">The line number that producing this message.</param>
+    /// <param name="level">The log level of the message.</param>
+    /// <param name="message">The actual message.</param>
+    virtual void LogMessage(const char* filename, int line, const ILoggerService::LOG_LEVEL & level, const char* message);
+
+    /// <summary>
+    /// Send a message to this logger.
+    /// </summary>
+    /// <param name="level">The log level of the message.</param>
+    /// <param name="message">The actual message.</param>
+    virtual void LogMessage(const ILoggerService::LOG_LEVEL & level, const char* message);
+
+    /// <summary>
+    /// Forward all pending messages to the wrapped logger and flush the wrapped logger.
+    /// The pending messages are forwarded on the calling thread.
+    /// </summary>
+    virtual void Flush();
+
+    /// <summary>
+    /// Start the background thread that forwards messages to the wrapped logger.
+    /// Must not be called while the loader lock is held (within DllMain).
+    /// </summary>
+    /// <returns>Returns true if the background thread is running. Returns false otherwise.</returns>
+    bool Start();
+
+    /// <summary>
+    /// Stop the background thread and forward all pending messages to the wrapped logger.
+    /// Messages are then forwarded synchronously until Start() is called again.
+    /// Must not be called while the loader lock is held (within DllMain).
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// Check if the background thread is running.
+    /// </summary>
+    /// <returns>Returns true if the background thread is running. Returns false otherwise.</returns>
+    bool IsRunning() const;
+
+    /// <summary>
+    /// Get the wrapped logger.
+    /// </summary>
+    /// <returns>Returns the wrapped logger.</returns>
+    ILoggerService* GetLogger() const;
+
+    /// <summary>
+    /// Get the overflow policy of the ring buffer.
+    /// </summary>
+    /// <returns>Returns the overflow policy of the ring buffer.</returns>
+    OVERFLOW_POLICY GetOverflowPolicy() const;
+
+    /// <summary>
+    /// Set the overflow policy of the ring buffer.
+    /// </summary>
+    /// <param name="policy">The new overflow policy.</param>
+    void SetOverflowPolicy(OVERFLOW_POLICY policy);
+
+    /// <summary>
+    /// Get the number of messages that the ring buffer can hold.
+    /// </summary>
+    /// <returns>Returns the number of slots of the ring buffer.</returns>
+    size_t GetCapacity() const;
+
+    /// <summary>
+    /// Get the number of messages dropped because the ring buffer was full.
+    /// </summary>
+    /// <returns>Returns the number of dropped messages.</returns>
+    uint64_t GetDroppedCount() const;
+
+  private:
+    struct SLOT
+    {
+      std::atomic<size_t> sequence;
+      ILoggerService::LOG_LEVEL level;
+      int line;
+      bool has_filename;
+      char text[SLOT_TEXT_SIZE]; // filename and message, both NULL terminated
+    };
+
+    void Enqueue(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message);
+    bool TryEnqueue(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message);
+    bool DequeueOne();
+    void DrainPending(bool wait_for_writers);
+    void ReportDroppedMessages();
+    void Run();
+
+  private:
+    ILoggerService* mLogger;
+    SLOT* mSlots;
+    size_t mMask;
+    std::atomic<size_t> mEnqueuePos;
+    std::atomic<size_t> mDequeuePos;
+    std::atomic<int> mPolicy;
+    std::atomic<uint64_t> mDropped;
+    uint64_t mReportedDrops;
+
+    // Only a single thread can dequeue at a time
+    std::timed_mutex mDrainMutex;
+
+    std::mutex mThreadMutex;
+    std::thread mThread;
+    std::atomic<bool> mRunning;
+    std::atomic<bool> mStopping;
+    std::atomic<bool> mSleeping;
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+  };
+
+} //namespace shellanything
+
+#endif //SA_ASYNC_LOGGER_SERVICE_H
@@ -0,0 +1,85 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "AttributeTable.h"
+
+namespace shellanything
+{
+  static const std::string EMPTY_VALUE;
+
+  AttributeTable::AttributeTable(const AttributeView& attributes, const StringList& names) :
+    mAttributes(names.size())
+  {
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      ATTRIBUTE& attribute = mAttributes[i];
+      attribute.name = names[i];
+
+      const char* value = attributes.GetAttribute(attribute.name.c_str());
+      attribute.defined = (value != NULL);
+      if (value)
+        attribute.value = value;
+    }
+  }
+
+  AttributeTable::~AttributeTable()
+  {
+  }
+
+  size_t AttributeTable::GetCount() const
+  {
+    return mAttributes.size();
+  }
+
+  const std::string& AttributeTable::GetName(size_t id) const
+  {
+    if (id >= mAttributes.size())
+      return EMPTY_VALUE;
+    return mAttributes[id].name;
+  }
+
+  bool AttributeTable::HasValue(size_t id) const
+  {
+    if (id >= mAttributes.size())
+      return false;
+    return mAttributes[id].defined;
+  }
+
+  const std::string& AttributeTable::GetValue(size_t id) const
+  {
+    if (id >= mAttributes.size())
+      return EMPTY_VALUE;
+    return mAttributes[id].value;
+  }
+
+  bool AttributeTable::TryGetValue(size_t id, const std::string*& value) const
+  {
+    value = NULL;
+    if (!HasValue(id))
+      return false;
+    value = &mAttributes[id].value;
+    return true;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,106 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_ATTRIBUTE_TABLE_H
+#define SA_ATTRIBUTE_TABLE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "AttributeView.h"
+#include "StringList.h"
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// An immutable table of attribute values read from a xml element.
+  /// The table is sized from a list of expected attribute names. The id of an attribute is its index in that list.
+  /// </summary>
+  class SHELLANYTHING_EXPORT AttributeTable
+  {
+  public:
+    /// <summary>
+    /// Read the given attributes from an xml element.
+    /// </summary>
+    /// <param name="attributes">A view of the xml element to read from.</param>
+    /// <param name="names">The names of the expected attributes.</param>
+    AttributeTable(const AttributeView& attributes, const StringList& names);
+    virtual ~AttributeTable();
+
+  private:
+    // Disable copy constructor and copy operator
+    AttributeTable(const AttributeTable&);
+    AttributeTable& operator=(const AttributeTable&);
+  public:
+
+    /// <summary>
+    /// Get the number of attributes in the table.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Get the name of an attribute.
+    /// </summary>
+    /// <param name="id">The id of the attribute.</param>
+    /// <returns>Returns the name of the attribute. Returns an empty string if the id is out of bounds.</returns>
+    const std::string& GetName(size_t id) const;
+
+    /// <summary>
+    /// Check if an attribute is defined in the xml element.
+    /// </summary>
+    /// <param name="id">The id of the attribute.</param>
+    /// <returns>Returns true if the attribute is defined. Returns false otherwise.</returns>
+    bool HasValue(size_t id) const;
+
+    /// <summary>
+    /// Get the value of an attribute.
+    /// </summary>
+    /// <param name="id">The id of the attribute.</param>
+    /// <returns>Returns the value of the attribute. Returns an empty string if the attribute is not defined.</returns>
+    const std::string& GetValue(size_t id) const;
+
+    /// <summary>
+    /// Gets the value of an attribute if it is defined.
+    /// </summary>
+    /// <param name="id">The id of the attribute.</param>
+    /// <param name="value">The output pointer to the value of the attribute. The pointer is valid for the lifetime of the table.</param>
+    /// <returns>Returns true if the attribute is defined. Returns false otherwise.</returns>
+    bool TryGetValue(size_t id, const std::string*& value) const;
+
+  private:
+    struct ATTRIBUTE
+    {
+      std::string name;
+      std::string value;
+      bool defined;
+    };
+    typedef std::vector<ATTRIBUTE> AttributeList;
+    AttributeList mAttributes;
+  };
+
+} //namespace shellanything
+
+#endif //SA_ATTRIBUTE_TABLE_H
@@ -0,0 +1,91 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "AttributeView.h"
+
+#include "tinyxml2.h"
+using namespace tinyxml2;
+
+namespace shellanything
+{
+
+  AttributeView::AttributeView(const XMLElement* element) :
+    mElement(element)
+  {
+  }
+
+  AttributeView::~AttributeView()
+  {
+  }
+
+  const XMLElement* AttributeView::GetElement() const
+  {
+    return mElement;
+  }
+
+  const char* AttributeView::GetName() const
+  {
+    if (mElement == NULL)
+      return "";
+    return mElement->Name();
+  }
+
+  int AttributeView::GetLineNum() const
+  {
+    if (mElement == NULL)
+      return 0;
+    return mElement->GetLineNum();
+  }
+
+  bool AttributeView::HasAttribute(const char* name) const
+  {
+    return (GetAttribute(name) != NULL);
+  }
+
+  const char* AttributeView::GetAttribute(const char* name) const
+  {
+    if (mElement == NULL)
+      return NULL;
+    return mElement->Attribute(name);
+  }
+
+  const char* AttributeView::GetText() const
+  {
+    if (mElement == NULL)
+      return NULL;
+    return mElement->GetText();
+  }
+
+  std::string AttributeView::ToXml() const
+  {
+    if (mElement == NULL)
+      return std::string();
+
+    XMLPrinter printer;
+    mElement->Accept(&printer);
+    std::string xml = printer.CStr();
+    return xml;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,107 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_ATTRIBUTE_VIEW_H
+#define SA_ATTRIBUTE_VIEW_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <string>
+
+namespace tinyxml2
+{
+  class XMLElement;
+}
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// A lightweight read-only view over the attributes and text of an already parsed xml element.
+  /// The view does not own the element. The element must outlive the view.
+  /// </summary>
+  class SHELLANYTHING_EXPORT AttributeView
+  {
+  public:
+    AttributeView(const tinyxml2::XMLElement* element);
+    virtual ~AttributeView();
+
+  private:
+    // Disable copy constructor and copy operator
+    AttributeView(const AttributeView&);
+    AttributeView& operator=(const AttributeView&);
+  public:
+
+    /// <summary>
+    /// Get the viewed xml element.
+    /// </summary>
+    /// <returns>Returns the viewed xml element. May be NULL.</returns>
+    const tinyxml2::XMLElement* GetElement() const;
+
+    /// <summary>
+    /// Get the name of the viewed element.
+    /// </summary>
+    /// <returns>Returns the name of the element. Returns an empty string if the view is empty.</returns>
+    const char* GetName() const;
+
+    /// <summary>
+    /// Get the line number of the viewed element in its source document.
+    /// </summary>
+    /// <returns>Returns the line number of the element. Returns 0 if the view is empty.</returns>
+    int GetLineNum() const;
+
+    /// <summary>
+    /// Check if the viewed element has the given attribute.
+    /// </summary>
+    /// <param name="name">The name of the attribute.</param>
+    /// <returns>Returns true if the attribute is defined. Returns false otherwise.</returns>
+    bool HasAttribute(const char* name) const;
+
+    /// <summary>
+    /// Get the value of an attribute of the viewed element.
+    /// </summary>
+    /// <param name="name">The name of the attribute.</param>
+    /// <returns>Returns the value of the attribute. Returns NULL if the attribute is not defined.</returns>
+    const char* GetAttribute(const char* name) const;
+
+    /// <summary>
+    /// Get the text of the viewed element.
+    /// </summary>
+    /// <returns>Returns the text of the element. Returns NULL if the element has no text.</returns>
+    const char* GetText() const;
+
+    /// <summary>
+    /// Serialize the viewed element and its child nodes to a xml string.
+    /// </summary>
+    /// <returns>Returns the xml string of the element. Returns an empty string if the view is empty.</returns>
+    std::string ToXml() const;
+
+  private:
+    const tinyxml2::XMLElement* mElement;
+  };
+
+} //namespace shellanything
+
+#endif //SA_ATTRIBUTE_VIEW_H
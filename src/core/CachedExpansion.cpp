@@ -0,0 +1,80 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "CachedExpansion.h"
+#include "PropertyManager.h"
+
+namespace shellanything
+{
+  CachedExpansion::CachedExpansion() :
+    mGeneration(0),
+    mVolatile(true),
+    mValid(false)
+  {
+  }
+
+  CachedExpansion::CachedExpansion(const CachedExpansion& expansion)
+  {
+    (*this) = expansion;
+  }
+
+  CachedExpansion::~CachedExpansion()
+  {
+  }
+
+  const CachedExpansion& CachedExpansion::operator =(const CachedExpansion& expansion)
+  {
+    if (this != &expansion)
+    {
+      mSource = expansion.mSource;
+      mExpanded = expansion.mExpanded;
+      mGeneration = expansion.mGeneration;
+      mVolatile = expansion.mVolatile;
+      mValid = expansion.mValid;
+    }
+    return (*this);
+  }
+
+  const std::string& CachedExpansion::Expand(const std::string& value)
+  {
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    uint64_t generation = pmgr.GetGeneration();
+
+    if (mValid && !mVolatile && mGeneration == generation && mSource == value)
+      return mExpanded;
+
+    mSource = value;
+    mExpanded = pmgr.Expand(value, mVolatile);
+    mGeneration = generation;
+    mValid = true;
+
+    return mExpanded;
+  }
+
+  void CachedExpansion::Invalidate()
+  {
+    mValid = false;
+  }
+
+} //namespace shellanything
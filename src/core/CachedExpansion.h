@@ -0,0 +1,77 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_CACHED_EXPANSION_H
+#define SA_CACHED_EXPANSION_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include <string>
+#include <stdint.h>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A CachedExpansion keeps the expanded value of a string.
+  /// The string is expanded again only when one of the properties it depends on is modified.
+  /// </summary>
+  class SHELLANYTHING_EXPORT CachedExpansion
+  {
+  public:
+    CachedExpansion();
+    CachedExpansion(const CachedExpansion& expansion);
+    virtual ~CachedExpansion();
+
+    /// <summary>
+    /// Copy operator
+    /// </summary>
+    const CachedExpansion& operator =(const CachedExpansion& expansion);
+
+    /// <summary>
+    /// Expands the given string. See PropertyManager::Expand() for details.
+    /// </summary>
+    /// <remarks>
+    /// The previous expanded value is returned if the given value is identical to the previous call
+    /// and if no property was modified since the previous call.
+    /// </remarks>
+    /// <param name="value">The given value to expand.</param>
+    /// <returns>Returns the given value with the property references expanded.</returns>
+    const std::string& Expand(const std::string& value);
+
+    /// <summary>
+    /// Invalidate the cached value. The next call to Expand() will expand the value again.
+    /// </summary>
+    void Invalidate();
+
+  private:
+    std::string mSource;
+    std::string mExpanded;
+    uint64_t mGeneration;
+    bool mVolatile;
+    bool mValid;
+  };
+
+} //namespace shellanything
+
+#endif //SA_CACHED_EXPANSION_H
@@ -26,15 +26,19 @@
 #include "SelectionContext.h"
 #include "ActionProperty.h"
 #include "ObjectFactory.h"
+#include "ConfigSnapshot.h"
 #include "LoggerHelper.h"
 
 #include "rapidassist/filesystem_utf8.h"
-#include "rapidassist/random.h"
 #include "rapidassist/environment.h"
 
 #include "tinyxml2.h"
 #include "SaUtils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN 1
 #endif
@@ -98,86 +102,23 @@ namespace shellanything
     return encoding;
   }
 
-  ConfigFile::ConfigFile() :
-    mFileModifiedDate(0),
-    mDefaults(NULL)
-  {
-  }
-
-  ConfigFile::~ConfigFile()
-  {
-    DeleteChildren();
-  }
-
-  ConfigFile* ConfigFile::GetUpdatingConfigFile()
-  {
-    return gUpdatingConfigFile;
-  }
-
-  void ConfigFile::SetUpdatingConfigFile(ConfigFile* config_file)
-  {
-    gUpdatingConfigFile = config_file;
-  }
-
-  ConfigFile* ConfigFile::LoadFile(const std::string& path, std::string& error)
+  static bool ParseXmlContent(const std::string& content, XMLDocument& doc, std::string& error)
   {
-    SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
-    sli.verbose = true;
-    ScopeLogger logger(&sli);
-
-    SA_VERBOSE_LOG(INFO) << "Loading configuration file '" << path << "'.";
-
-    error = "";
-
-    if (!ra::filesystem::FileExistsUtf8(path.c_str()))
-    {
-      error = "File '" + path + "' not found.";
-      return NULL;
-    }
-
-    uint64_t file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(path.c_str());
-
-    //Parse the xml file
+    //Parse the xml content
     //http://leethomason.github.io/tinyxml2/
 
-    XMLDocument doc;
-    XMLError result = doc.LoadFile(path.c_str());
-    if (result == XML_ERROR_FILE_NOT_FOUND)
-    {
-      //We already validated that file exists. This is probably because the file path is utf-8 encoded.
-      //This is not supported by TinyXML.
-
-      //As a workaround, copy the file to a temp directory with a non utf-8 path
-      std::string temp_filename;
-      ra::random::GetRandomString(temp_filename, 10);
-      temp_filename.append(".xml");
-      std::string temp_path = ra::filesystem::GetTemporaryDirectory() + ra::filesystem::GetPathSeparatorStr() + temp_filename;
-      bool copied = ra::filesystem::CopyFileUtf8(path, temp_path);
-      if (!copied)
-      {
-        error.clear();
-        error << "Failed to copy file '" << path << "' to '" << temp_path << "'.";
-        return NULL;
-      }
-
-      //and load the new temp file
-      result = doc.LoadFile(temp_path.c_str());
-
-      //cleanup
-      ra::filesystem::DeleteFile(temp_path.c_str());
-    }
-
+    XMLError result = doc.Parse(content.data(), content.size());
     if (result != XML_SUCCESS)
     {
       if (doc.ErrorStr())
       {
         error = doc.ErrorStr();
-        return NULL;
+        return false;
       }
       else
       {
         error = "Unknown error reported by XML library.";
-        return NULL;
+        return false;
       }
     }
 
@@ -188,7 +129,7 @@ namespace shellanything
       //Not an utf-8 encoded file.
       error.clear();
       error << "File is not encoded in UTF-8.";
-      return NULL;
+      return false;
     }
 
     //validate utf-8 encoding
@@ -199,23 +140,111 @@ namespace shellanything
       //Not an utf-8 encoded file.
       error.clear();
       error << "File is not encoded in UTF-8. Encoding found is '" << encoding << "'.";
-      return NULL;
+      return false;
+    }
+
+    return true;
+  }
+
+  ConfigFile::ConfigFile() :
+    mFileModifiedDate(0),
+    mDefaults(NULL),
+    mMenuTreeValid(false),
+    mPerformanceCounters()
+  {
+  }
+
+  ConfigFile::~ConfigFile()
+  {
+    DeleteChildren();
+  }
+
+  ConfigFile* ConfigFile::GetUpdatingConfigFile()
+  {
+    return gUpdatingConfigFile;
+  }
+
+  void ConfigFile::SetUpdatingConfigFile(ConfigFile* config_file)
+  {
+    gUpdatingConfigFile = config_file;
+  }
+
+  static bool LoadDocument(const std::string& path, XMLDocument& doc, uint64_t& file_modified_date, uint64_t& file_size, bool& snapshot_loaded, std::string& error)
+  {
+    if (!ra::filesystem::FileExistsUtf8(path.c_str()))
+    {
+      error = "File '" + path + "' not found.";
+      return false;
+    }
+
+    file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(path.c_str());
+    file_size = ra::filesystem::GetFileSizeUtf8(path.c_str());
+
+    //Load the snapshot of the file, if available
+    std::string snapshot_error;
+    snapshot_loaded = ConfigSnapshot::IsEnabled() && ConfigSnapshot::Load(path, file_modified_date, file_size, doc, snapshot_error);
+    if (snapshot_loaded)
+    {
+      SA_VERBOSE_LOG(INFO) << "Loaded snapshot of configuration file '" << path << "'.";
+    }
+    else
+    {
+      //Parse the xml file
+      std::string content;
+      if (!ra::filesystem::ReadFileUtf8(path, content))
+      {
+        error = "Failed reading file '" + path + "'.";
+        return false;
+      }
+      file_size = content.size();
+      if (!ParseXmlContent(content, doc, error))
+        return false;
     }
 
     const XMLElement* xml_root = XMLHandle(&doc).FirstChildElement("root").ToElement();
     if (!xml_root)
     {
       error = "Node <root> not found";
-      return NULL;
+      return false;
     }
 
     const XMLElement* xml_shell = XMLHandle(&doc).FirstChildElement("root").FirstChildElement("shell").ToElement();
     if (!xml_shell)
     {
       error = "Node <shell> not found";
-      return NULL;
+      return false;
     }
 
+    return true;
+  }
+
+  static void SaveDocumentSnapshot(const std::string& path, uint64_t file_modified_date, uint64_t file_size, const XMLDocument& doc)
+  {
+    //Only documents of valid configurations are saved. Errors are always reported from the xml file, with line numbers.
+    std::string snapshot_error;
+    if (ConfigSnapshot::IsEnabled() && !ConfigSnapshot::Save(path, file_modified_date, file_size, doc, snapshot_error))
+    {
+      SA_VERBOSE_LOG(WARNING) << "Failed saving snapshot of configuration file '" << path << "'. Error=" << snapshot_error;
+    }
+  }
+
+  static bool HasPlugins(const XMLDocument& doc)
+  {
+    const XMLElement* xml_plugins = XMLConstHandle(&doc).FirstChildElement("root").FirstChildElement("plugins").ToElement();
+    while (xml_plugins)
+    {
+      if (xml_plugins->FirstChildElement("plugin"))
+        return true;
+      xml_plugins = xml_plugins->NextSiblingElement("plugins");
+    }
+    return false;
+  }
+
+  static ConfigFile* ParseDocument(const std::string& path, uint64_t file_modified_date, const XMLDocument& doc, std::string& error)
+  {
+    const XMLElement* xml_root = XMLConstHandle(&doc).FirstChildElement("root").ToElement();
+    const XMLElement* xml_shell = XMLConstHandle(&doc).FirstChildElement("root").FirstChildElement("shell").ToElement();
+
     ConfigFile* config = new ConfigFile();
     config->SetFilePath(path);
     config->SetFileModifiedDate(file_modified_date);
@@ -269,8 +298,11 @@ namespace shellanything
 
     //set active plugins for parsing child elements
     //notify the ObjectParser about this configuration's plugins.
+    //the active plugins are set for the calling thread only. Other configurations can be parsed concurrently.
     const Plugin::PluginPtrList& active_plugins = config->GetPlugins();
-    ObjectFactory::GetInstance().SetActivePlugins(active_plugins);
+    const bool have_active_plugins = !active_plugins.empty();
+    if (have_active_plugins)
+      ObjectFactory::GetInstance().SetActivePlugins(active_plugins);
 
     //find <menu> nodes under <shell>
     const XMLElement* xml_menu = xml_shell->FirstChildElement("menu");
@@ -281,7 +313,8 @@ namespace shellanything
       if (menu == NULL)
       {
         delete config;
-        ObjectFactory::GetInstance().ClearActivePlugins();
+        if (have_active_plugins)
+          ObjectFactory::GetInstance().ClearActivePlugins();
         return NULL;
       }
 
@@ -293,11 +326,130 @@ namespace shellanything
     }
 
     //cleanup ObjectFactory plugins.
-    ObjectFactory::GetInstance().ClearActivePlugins();
+    if (have_active_plugins)
+      ObjectFactory::GetInstance().ClearActivePlugins();
 
     return config;
   }
 
+  struct LOADING_TASK
+  {
+    std::string path;
+    XMLDocument doc;
+    uint64_t file_modified_date;
+    uint64_t file_size;
+    bool snapshot_loaded;
+    bool document_loaded;
+    bool have_plugins;
+    ConfigFile* config;
+    std::string error;
+  };
+
+  static void ParseDocumentTask(LOADING_TASK* task)
+  {
+    task->config = ParseDocument(task->path, task->file_modified_date, task->doc, task->error);
+    if (task->config != NULL && !task->snapshot_loaded)
+      SaveDocumentSnapshot(task->path, task->file_modified_date, task->file_size, task->doc);
+  }
+
+  static void LoadDocumentTask(LOADING_TASK* task)
+  {
+    SA_VERBOSE_LOG(INFO) << "Loading configuration file '" << task->path << "'.";
+
+    task->document_loaded = LoadDocument(task->path, task->doc, task->file_modified_date, task->file_size, task->snapshot_loaded, task->error);
+    if (!task->document_loaded)
+      return;
+
+    //plugins are loaded serially. Their configuration is parsed later.
+    task->have_plugins = HasPlugins(task->doc);
+    if (!task->have_plugins)
+      ParseDocumentTask(task);
+  }
+
+  ConfigFile* ConfigFile::LoadFile(const std::string& path, std::string& error)
+  {
+    SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
+    sli.verbose = true;
+    ScopeLogger logger(&sli);
+
+    SA_VERBOSE_LOG(INFO) << "Loading configuration file '" << path << "'.";
+
+    error = "";
+
+    XMLDocument doc;
+    uint64_t file_modified_date = 0;
+    uint64_t file_size = 0;
+    bool snapshot_loaded = false;
+    if (!LoadDocument(path, doc, file_modified_date, file_size, snapshot_loaded, error))
+      return NULL;
+
+    ConfigFile* config = ParseDocument(path, file_modified_date, doc, error);
+    if (config != NULL && !snapshot_loaded)
+      SaveDocumentSnapshot(path, file_modified_date, file_size, doc);
+    return config;
+  }
+
+  void ConfigFile::LoadFiles(const StringList& paths, size_t max_threads, ConfigFilePtrList& configs, StringList& errors)
+  {
+    SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
+    sli.verbose = true;
+    ScopeLogger logger(&sli);
+
+    configs.assign(paths.size(), NULL);
+    errors.assign(paths.size(), std::string());
+    if (paths.empty())
+      return;
+
+    std::vector<LOADING_TASK*> tasks(paths.size(), NULL);
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+      LOADING_TASK* task = new LOADING_TASK();
+      task->path = paths[i];
+      task->file_modified_date = 0;
+      task->file_size = 0;
+      task->snapshot_loaded = false;
+      task->document_loaded = false;
+      task->have_plugins = false;
+      task->config = NULL;
+      tasks[i] = task;
+    }
+
+    //read and parse the files concurrently
+    if (max_threads == 0)
+      max_threads = std::thread::hardware_concurrency();
+    size_t num_threads = (std::min)(max_threads, tasks.size());
+    std::atomic<size_t> next_task(0);
+    auto worker = [&tasks, &next_task]()
+    {
+      for (size_t i = next_task++; i < tasks.size(); i = next_task++)
+      {
+        LoadDocumentTask(tasks[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; i++)
+    {
+      threads.push_back(std::thread(worker));
+    }
+    worker(); //the calling thread also processes tasks
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+      threads[i].join();
+    }
+
+    //load plugins and parse their configurations in the same order as the given paths
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+      LOADING_TASK* task = tasks[i];
+      if (task->document_loaded && task->have_plugins)
+        ParseDocumentTask(task);
+
+      configs[i] = task->config;
+      errors[i] = task->error;
+      delete task;
+    }
+  }
+
   bool ConfigFile::IsValidConfigFile(const std::string& path)
   {
     std::string file_extension = ra::filesystem::GetFileExtention(path);
@@ -351,6 +503,7 @@ namespace shellanything
     sli.verbose = true;
     sli.instance = this;
     ScopeLogger logger(&sli);
+    PerformanceCounters::Scope performance_scope(mPerformanceCounters);
 
     SetUpdatingConfigFile(this);
 
@@ -367,22 +520,30 @@ namespace shellanything
         SA_VERBOSE_LOG(INFO) << "Executing update callback " << (j + 1) << " of " << count << ".";
         IUpdateCallback* callback = registry.GetUpdateCallbackFromIndex(j);
         callback->SetSelectionContext(&context);
-        callback->OnNewSelection();
+        {
+          PerformanceCounters::Scope plugin_scope(p->GetPerformanceCounters(), true);
+          callback->OnNewSelection();
+        }
         callback->SetSelectionContext(NULL);
       }
     }
 
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
-    {
-      Menu* child = children[i];
-      child->Update(context);
-    }
+    //update all menus
+    GetMenuTree().Update(context);
 
     SetUpdatingConfigFile(NULL);
   }
 
+  const PERFORMANCE_COUNTERS& ConfigFile::GetPerformanceCounters() const
+  {
+    return mPerformanceCounters;
+  }
+
+  void ConfigFile::ResetPerformanceCounters()
+  {
+    PerformanceCounters::Reset(mPerformanceCounters);
+  }
+
   void ConfigFile::ApplyDefaultSettings()
   {
     if (mDefaults && mDefaults->GetActions().size() > 0)
@@ -430,47 +591,17 @@ namespace shellanything
 
   Menu* ConfigFile::FindMenuByCommandId(const uint32_t& command_id)
   {
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
-    {
-      Menu* child = children[i];
-      Menu* match = child->FindMenuByCommandId(command_id);
-      if (match)
-        return match;
-    }
-
-    return NULL;
+    return GetMenuTree().FindMenuByCommandId(command_id);
   }
 
   Menu* ConfigFile::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
   {
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
-    {
-      Menu* child = children[i];
-      Menu* match = child->FindMenuByName(name, flags);
-      if (match)
-        return match;
-    }
-
-    return NULL;
+    return GetMenuTree().FindMenuByName(name, flags);
   }
 
   uint32_t ConfigFile::AssignCommandIds(const uint32_t& first_command_id)
   {
-    uint32_t nextCommandId = first_command_id;
-
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
-    {
-      Menu* child = children[i];
-      nextCommandId = child->AssignCommandIds(nextCommandId);
-    }
-
-    return nextCommandId;
+    return GetMenuTree().AssignCommandIds(first_command_id);
   }
 
   void ConfigFile::AddPlugin(Plugin* plugin)
@@ -506,6 +637,23 @@ namespace shellanything
   {
     mMenus.push_back(menu);
     menu->SetParentConfigFile(this);
+    InvalidateMenuTree();
+  }
+
+  MenuTree& ConfigFile::GetMenuTree()
+  {
+    if (!mMenuTreeValid)
+    {
+      mMenuTree.Build(mMenus);
+      mMenuTreeValid = true;
+    }
+    return mMenuTree;
+  }
+
+  void ConfigFile::InvalidateMenuTree()
+  {
+    mMenuTree.Clear();
+    mMenuTreeValid = false;
   }
 
   std::string ConfigFile::ToShortString() const
@@ -556,6 +704,7 @@ namespace shellanything
       delete sub;
     }
     mMenus.clear();
+    InvalidateMenuTree();
 
     // Delete plugins
     // Note that plugins must be deleted after everything else.
@@ -29,9 +29,11 @@
 #include "shellanything/config.h"
 #include "IObject.h"
 #include "Menu.h"
+#include "MenuTree.h"
 #include "DefaultSettings.h"
 #include "Plugin.h"
 #include "Enums.h"
+#include "StringList.h"
 
 #include <stdint.h>
 
@@ -78,6 +80,16 @@ namespace shellanything
     /// <returns>Returns a valid Configuration pointer if the file can be loaded. Returns NULL otherwise.</returns>
     static ConfigFile* LoadFile(const std::string& path, std::string& error);
 
+    /// <summary>
+    /// Load multiple Configuration Files.
+    /// The files are read and parsed concurrently. Plugins are loaded serially, in the order of the given paths.
+    /// </summary>
+    /// <param name="paths">The file paths to load</param>
+    /// <param name="max_threads">The maximum number of threads used for loading the files. Set to 0 to use one thread per processor.</param>
+    /// <param name="configs">The output list of loaded configurations, in the same order as the given paths. An element is NULL if the matching file cannot be loaded.</param>
+    /// <param name="errors">The output list of error descriptions, in the same order as the given paths.</param>
+    static void LoadFiles(const StringList& paths, size_t max_threads, ConfigFilePtrList& configs, StringList& errors);
+
     /// <summary>
     /// Detect if a given file is a valid Configuration File.
     /// </summary>
@@ -116,6 +128,18 @@ namespace shellanything
     /// </summary>
     void ApplyDefaultSettings();
 
+    /// <summary>
+    /// Get the performance counters of this configuration. See PerformanceCounters.
+    /// The counters measure Update() which includes the plugin update callbacks and all menus.
+    /// </summary>
+    /// <returns>Returns the performance counters of this configuration.</returns>
+    const PERFORMANCE_COUNTERS& GetPerformanceCounters() const;
+
+    /// <summary>
+    /// Reset the performance counters of this configuration.
+    /// </summary>
+    void ResetPerformanceCounters();
+
     /// <summary>
     /// Finds a loaded Menu that have the given command_id assigned.
     /// </summary>
@@ -172,6 +196,20 @@ namespace shellanything
     /// <param name="menu">The Menu to add.</param>
     void AddMenu(Menu* menu);
 
+    /// <summary>
+    /// Get the flattened tree of all menus of this ConfigFile.
+    /// </summary>
+    /// <remarks>
+    /// The tree is built again on the first call following a call to InvalidateMenuTree().
+    /// </remarks>
+    /// <returns>Returns the menu tree of this ConfigFile.</returns>
+    MenuTree& GetMenuTree();
+
+    /// <summary>
+    /// Invalidate the flattened tree of menus. Must be called when a menu of this ConfigFile is added or deleted.
+    /// </summary>
+    void InvalidateMenuTree();
+
     // IObject methods
     virtual std::string ToShortString() const;
     virtual void ToLongString(std::string& str, int indent) const;
@@ -186,6 +224,9 @@ namespace shellanything
     std::string mFilePath;
     Plugin::PluginPtrList mPlugins;
     Menu::MenuPtrList mMenus;
+    MenuTree mMenuTree;
+    bool mMenuTreeValid;
+    PERFORMANCE_COUNTERS mPerformanceCounters;
   };
 
 } //namespace shellanything
@@ -26,23 +26,72 @@
 #include "Menu.h"
 #include "LoggerHelper.h"
 #include "SaUtils.h"
+#include "App.h"
+#include "PropertyManager.h"
+#include "PerformanceCounters.h"
 
 #include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/strings.h"
 #include "rapidassist/environment.h"
+#include "rapidassist/timing.h"
+
+#include <algorithm>
+#include <chrono>
 
 namespace shellanything
 {
+  const uint64_t ConfigManager::DEFAULT_UPDATE_CACHE_TIMEOUT = 1000;
+  const uint64_t ConfigManager::DEFAULT_BACKGROUND_REFRESH_INTERVAL = 1000;
 
-  ConfigManager::ConfigManager()
+  ConfigManager::ConfigManager() :
+    mConfigSet(new ConfigFileRefList()),
+    mConfigVersion(0),
+    mMaxLoadingThreads(0),
+    mDirty(true),
+    mWatcher(NULL),
+    mFirstCommandId(Menu::INVALID_COMMAND_ID),
+    mUpdateCacheTimeout(DEFAULT_UPDATE_CACHE_TIMEOUT),
+    mPathsChanged(true),
+    mRefreshStop(false),
+    mRefreshInterval(DEFAULT_BACKGROUND_REFRESH_INTERVAL),
+    mRefreshWatcher(NULL),
+    mRefreshPolling(true),
+    mRefreshForced(true)
   {
+    ClearNameIndex();
+    InvalidateUpdateCache();
+    mPendingRefresh.version = 0;
+    mPendingRefresh.ready = false;
   }
 
   ConfigManager::~ConfigManager()
   {
+    StopBackgroundRefresh();
     DeleteChildren();
   }
 
+  static bool IsConfigFileInList(const ConfigManager::ConfigFileRefList& configs, const std::string& path)
+  {
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+      if (configs[i]->GetFilePath() == path)
+        return true;
+    }
+    return false;
+  }
+
+  static void SetFailedFile(StringList& failed_paths, std::vector<uint64_t>& failed_dates, const std::string& path, const uint64_t& date)
+  {
+    StringList::iterator failed = std::find(failed_paths.begin(), failed_paths.end(), path);
+    if (failed == failed_paths.end())
+    {
+      failed_paths.push_back(path);
+      failed_dates.push_back(date);
+    }
+    else
+      failed_dates[failed - failed_paths.begin()] = date;
+  }
+
   ConfigManager& ConfigManager::GetInstance()
   {
     static ConfigManager _instance;
@@ -62,11 +111,30 @@ namespace shellanything
     SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
     ScopeLogger logger(&sli);
 
+    //the background thread searches the paths for us
+    if (IsBackgroundRefreshRunning() && !mPathsChanged && App::GetInstance().GetFileWatcherService() == mWatcher)
+    {
+      PublishBackgroundRefresh();
+      return;
+    }
+
+    if (!IsRefreshRequired())
+    {
+      SA_VERBOSE_LOG(INFO) << "Search paths are unchanged. Configurations are up to date.";
+      return;
+    }
+
+    //start watching the search paths before searching them.
+    //a change detected while searching will trigger the next refresh.
+    UpdateWatches();
+
     //validate existing configurations
-    ConfigFile::ConfigFilePtrList existing = GetConfigFiles();
+    ConfigFileRefList next;
+    bool changed = false;
+    const ConfigFileRefList& existing = *mConfigSet;
     for (size_t i = 0; i < existing.size(); i++)
     {
-      ConfigFile* config = existing[i];
+      const std::shared_ptr<ConfigFile>& config = existing[i];
 
       //compare the file's date at the load time and the current date
       const std::string& file_path = config->GetFilePath();
@@ -76,17 +144,19 @@ namespace shellanything
       {
         //current configuration is up to date
         SA_LOG(INFO) << "Configuration file '" << file_path << "' is up to date.";
+        next.push_back(config);
       }
       else
       {
         //file is missing or current configuration is out of date
         //forget about existing config
         SA_LOG(INFO) << "Configuration file '" << file_path << "' is missing or is not up to date. Deleting configuration.";
-        DeleteChild(config);
+        changed = true;
       }
     }
 
     //search every known path
+    StringList new_files;
     for (size_t i = 0; i < mPaths.size(); i++)
     {
       const std::string& path = mPaths[i];
@@ -105,26 +175,10 @@ namespace shellanything
           if (ConfigFile::IsValidConfigFile(file_path))
           {
             //is this file already loaded ?
-            if (!IsConfigFileLoaded(file_path))
+            if (!IsConfigFileInList(next, file_path) && std::find(new_files.begin(), new_files.end(), file_path) == new_files.end())
             {
               SA_LOG(INFO) << "Found new configuration file '" << file_path << "'";
-
-              //parse the file
-              std::string error;
-              ConfigFile* config = ConfigFile::LoadFile(file_path, error);
-              if (config == NULL)
-              {
-                //log an error message
-                SA_LOG(ERROR) << "Failed loading configuration file '" << file_path << "'. Error=" << error << ".";
-              }
-              else
-              {
-                //add to current list of configurations
-                mConfigurations.push_back(config);
-
-                //apply default properties of the configuration
-                config->ApplyDefaultSettings();
-              }
+              new_files.push_back(file_path);
             }
             else
             {
@@ -139,6 +193,393 @@ namespace shellanything
         SA_LOG(ERROR) << "Failed searching for configuration files in directory '" << path << "'.";
       }
     }
+
+    //parse the new files
+    ConfigFile::ConfigFilePtrList configs;
+    StringList errors;
+    ConfigFile::LoadFiles(new_files, mMaxLoadingThreads, configs, errors);
+
+    //add the configurations in the order they were found
+    ConfigFile::ConfigFilePtrList added;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+      const std::string& file_path = new_files[i];
+      ConfigFile* config = configs[i];
+      if (config == NULL)
+      {
+        //log an error message
+        SA_LOG(ERROR) << "Failed loading configuration file '" << file_path << "'. Error=" << errors[i] << ".";
+      }
+      else
+      {
+        //add to current list of configurations
+        next.push_back(std::shared_ptr<ConfigFile>(config));
+        added.push_back(config);
+        changed = true;
+      }
+    }
+
+    //publish the new list of configurations
+    if (changed)
+      PublishConfigFiles(next);
+    mPathsChanged = false;
+
+    //apply default properties of the new configurations
+    for (size_t i = 0; i < added.size(); i++)
+    {
+      added[i]->ApplyDefaultSettings();
+    }
+  }
+
+  void ConfigManager::PublishConfigFiles(const ConfigFileRefList& configs)
+  {
+    mConfigSet = ConfigFileSetPtr(new ConfigFileRefList(configs));
+    mConfigurations.clear();
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+      mConfigurations.push_back(configs[i].get());
+    }
+
+    //command ids must be assigned again for the new configurations
+    ClearCommandIdIndex();
+    ClearNameIndex();
+    InvalidateUpdateCache();
+
+    //let the background thread know about the published configurations
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    mConfigVersion++;
+    mLoadedPaths.clear();
+    mLoadedDates.clear();
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+      mLoadedPaths.push_back(configs[i]->GetFilePath());
+      mLoadedDates.push_back(configs[i]->GetFileModifiedDate());
+    }
+  }
+
+  ConfigManager::ConfigFileSetPtr ConfigManager::GetConfigFileSet() const
+  {
+    return mConfigSet;
+  }
+
+  bool ConfigManager::StartBackgroundRefresh(const uint64_t& interval)
+  {
+    if (IsBackgroundRefreshRunning())
+      return true;
+
+    {
+      std::unique_lock<std::mutex> lock(mRefreshMutex);
+      mRefreshStop = false;
+      mRefreshInterval = interval;
+      mRefreshPaths = mPaths;
+      mRefreshWatcher = mWatcher;
+      mRefreshPolling = (mWatcher == NULL || mWatchedPaths.size() != mPaths.size());
+      mRefreshForced = true;
+      ClearBackgroundRefresh(mPendingRefresh);
+    }
+
+    SA_LOG(INFO) << "Starting background refresh of configurations. Changes are checked every " << interval << " ms.";
+    mRefreshThread = std::thread(&ConfigManager::RunBackgroundRefresh, this);
+    return mRefreshThread.joinable();
+  }
+
+  void ConfigManager::StopBackgroundRefresh()
+  {
+    if (!IsBackgroundRefreshRunning())
+      return;
+
+    {
+      std::unique_lock<std::mutex> lock(mRefreshMutex);
+      mRefreshStop = true;
+    }
+    mRefreshCondition.notify_all();
+    mRefreshThread.join();
+
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    ClearBackgroundRefresh(mPendingRefresh);
+
+    //the changes notified to the thread are lost. The next refresh must search the paths.
+    mDirty = true;
+  }
+
+  bool ConfigManager::IsBackgroundRefreshRunning() const
+  {
+    return mRefreshThread.joinable();
+  }
+
+  void ConfigManager::ClearBackgroundRefresh(BACKGROUND_REFRESH& refresh)
+  {
+    for (size_t i = 0; i < refresh.configs.size(); i++)
+    {
+      delete refresh.configs[i];
+    }
+    refresh.configs.clear();
+    refresh.stale_paths.clear();
+    refresh.version = 0;
+    refresh.ready = false;
+  }
+
+  void ConfigManager::RunBackgroundRefresh()
+  {
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    while (!mRefreshStop)
+    {
+      mRefreshCondition.wait_for(lock, std::chrono::milliseconds(mRefreshInterval));
+      if (mRefreshStop)
+        break;
+
+      //wait for the previous changes to be published
+      if (mPendingRefresh.ready)
+        continue;
+
+      const StringList paths = mRefreshPaths;
+      const StringList loaded_paths = mLoadedPaths;
+      const std::vector<uint64_t> loaded_dates = mLoadedDates;
+      const StringList failed_paths = mFailedPaths;
+      const std::vector<uint64_t> failed_dates = mFailedDates;
+      const uint64_t version = mConfigVersion;
+      const size_t max_threads = mMaxLoadingThreads;
+      IFileWatcherService* watcher = mRefreshWatcher;
+      const bool search = (mRefreshPolling || mRefreshForced || watcher == NULL);
+      mRefreshForced = false;
+      lock.unlock();
+
+      //search the paths only after a change is notified
+      if (!search)
+      {
+        StringList changes;
+        if (!watcher->GetChanges(changes))
+        {
+          lock.lock();
+          continue;
+        }
+
+        for (size_t i = 0; i < changes.size(); i++)
+        {
+          SA_LOG(INFO) << "Detected changes in directory '" << changes[i] << "'.";
+        }
+      }
+
+      //find the configurations which are missing or not up to date
+      BACKGROUND_REFRESH refresh;
+      refresh.version = version;
+      refresh.ready = false;
+      for (size_t i = 0; i < loaded_paths.size(); i++)
+      {
+        const std::string& file_path = loaded_paths[i];
+        if (!ra::filesystem::FileExistsUtf8(file_path.c_str()) || ra::filesystem::GetFileModifiedDateUtf8(file_path) != loaded_dates[i])
+          refresh.stale_paths.push_back(file_path);
+      }
+
+      //search for new or modified files
+      StringList new_files;
+      std::vector<uint64_t> new_dates;
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        ra::strings::StringVector files;
+        if (!ra::filesystem::FindFilesUtf8(files, paths[i].c_str()))
+          continue;
+        for (size_t j = 0; j < files.size(); j++)
+        {
+          const std::string& file_path = files[j];
+          if (!ConfigFile::IsValidConfigFile(file_path) || std::find(new_files.begin(), new_files.end(), file_path) != new_files.end())
+            continue;
+
+          bool loaded = (std::find(loaded_paths.begin(), loaded_paths.end(), file_path) != loaded_paths.end());
+          bool stale = (std::find(refresh.stale_paths.begin(), refresh.stale_paths.end(), file_path) != refresh.stale_paths.end());
+          if (loaded && !stale)
+            continue;
+
+          const uint64_t file_date = ra::filesystem::GetFileModifiedDateUtf8(file_path);
+          StringList::const_iterator failed = std::find(failed_paths.begin(), failed_paths.end(), file_path);
+          if (failed != failed_paths.end() && failed_dates[failed - failed_paths.begin()] == file_date)
+            continue;
+
+          new_files.push_back(file_path);
+          new_dates.push_back(file_date);
+        }
+      }
+
+      //parse the new files, including the ones which declare plugins
+      StringList errors;
+      ConfigFile::ConfigFilePtrList configs;
+      ConfigFile::LoadFiles(new_files, max_threads, configs, errors);
+
+      //keep the configurations in the order they were found
+      lock.lock();
+      for (size_t i = 0; i < configs.size(); i++)
+      {
+        if (configs[i] != NULL)
+        {
+          refresh.configs.push_back(configs[i]);
+          continue;
+        }
+
+        const std::string& file_path = new_files[i];
+        SA_LOG(ERROR) << "Failed loading configuration file '" << file_path << "'. Error=" << errors[i] << ".";
+        SetFailedFile(mFailedPaths, mFailedDates, file_path, new_dates[i]);
+      }
+
+      if (!refresh.stale_paths.empty() || !refresh.configs.empty())
+      {
+        ClearBackgroundRefresh(mPendingRefresh);
+        mPendingRefresh = refresh;
+        mPendingRefresh.ready = true;
+      }
+    }
+  }
+
+  void ConfigManager::PublishBackgroundRefresh()
+  {
+    //take the configurations loaded by the background thread
+    BACKGROUND_REFRESH refresh;
+    {
+      std::unique_lock<std::mutex> lock(mRefreshMutex);
+      if (!mPendingRefresh.ready)
+        return;
+      refresh = mPendingRefresh;
+      mPendingRefresh.configs.clear();
+      ClearBackgroundRefresh(mPendingRefresh);
+    }
+
+    //the configurations were modified since the thread searched the paths
+    if (refresh.version != mConfigVersion)
+    {
+      SA_LOG(INFO) << "Discarding configurations loaded in the background. Configurations were modified while loading.";
+      ClearBackgroundRefresh(refresh);
+
+      //the changes notified to the thread are lost. The thread must search the paths again.
+      std::unique_lock<std::mutex> lock(mRefreshMutex);
+      mRefreshForced = true;
+      return;
+    }
+
+    //keep the configurations that are up to date
+    ConfigFileRefList next;
+    const ConfigFileRefList& existing = *mConfigSet;
+    for (size_t i = 0; i < existing.size(); i++)
+    {
+      const std::string& file_path = existing[i]->GetFilePath();
+      if (std::find(refresh.stale_paths.begin(), refresh.stale_paths.end(), file_path) == refresh.stale_paths.end())
+        next.push_back(existing[i]);
+      else
+        SA_LOG(INFO) << "Configuration file '" << file_path << "' is missing or is not up to date. Deleting configuration.";
+    }
+
+    //add the configurations in the order they were found
+    for (size_t i = 0; i < refresh.configs.size(); i++)
+    {
+      SA_LOG(INFO) << "Found new configuration file '" << refresh.configs[i]->GetFilePath() << "'";
+      next.push_back(std::shared_ptr<ConfigFile>(refresh.configs[i]));
+    }
+    PublishConfigFiles(next);
+
+    //apply default properties of the new configurations
+    for (size_t i = 0; i < refresh.configs.size(); i++)
+    {
+      refresh.configs[i]->ApplyDefaultSettings();
+    }
+  }
+
+  bool ConfigManager::IsRefreshRequired()
+  {
+    IFileWatcherService* watcher = App::GetInstance().GetFileWatcherService();
+    if (watcher == NULL || watcher != mWatcher || mDirty)
+      return true;
+
+    StringList changes;
+    if (!watcher->GetChanges(changes))
+      return false;
+
+    for (size_t i = 0; i < changes.size(); i++)
+    {
+      SA_LOG(INFO) << "Detected changes in directory '" << changes[i] << "'.";
+    }
+
+    //remember the changes until the next refresh
+    mDirty = true;
+    return true;
+  }
+
+  void ConfigManager::UpdateWatches()
+  {
+    IFileWatcherService* watcher = App::GetInstance().GetFileWatcherService();
+    if (watcher != mWatcher)
+    {
+      //the previous service may already be destroyed. Forget about its watches.
+      mWatcher = watcher;
+      mWatchedPaths.clear();
+    }
+    if (watcher == NULL)
+    {
+      mDirty = true;
+      std::unique_lock<std::mutex> lock(mRefreshMutex);
+      mRefreshWatcher = NULL;
+      mRefreshPolling = true;
+      return;
+    }
+
+    //stop watching paths that were removed
+    //a path that was deleted is no longer watched by the service and must be watched again
+    StringList watched;
+    for (size_t i = 0; i < mWatchedPaths.size(); i++)
+    {
+      const std::string& path = mWatchedPaths[i];
+      if (std::find(mPaths.begin(), mPaths.end(), path) == mPaths.end())
+        watcher->Unwatch(path);
+      else if (watcher->IsWatching(path))
+        watched.push_back(path);
+    }
+
+    //watch new paths
+    bool all_watched = true;
+    for (size_t i = 0; i < mPaths.size(); i++)
+    {
+      const std::string& path = mPaths[i];
+      if (std::find(watched.begin(), watched.end(), path) != watched.end())
+        continue;
+      if (watcher->Watch(path))
+        watched.push_back(path);
+      else
+        all_watched = false;
+    }
+    mWatchedPaths = watched;
+
+    //pending changes are handled by the upcoming search
+    StringList changes;
+    watcher->GetChanges(changes);
+
+    //a path that cannot be watched must be searched on every refresh
+    mDirty = !all_watched;
+
+    //let the background thread know about the watched paths
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    mRefreshWatcher = watcher;
+    mRefreshPolling = !all_watched;
+  }
+
+  static uint32_t GetKeyboardState()
+  {
+    IKeyboardService* keyboard = App::GetInstance().GetKeyboardService();
+    if (keyboard == NULL)
+      return 0;
+
+    static const KEYB_MODIFIER_ID MODIFIERS[] = { KMID_CTRL, KMID_ALT, KMID_SHIFT };
+    static const KEYB_TOGGLE_ID TOGGLES[] = { KTID_CAPS_LOCK, KTID_SCROLL_LOCK, KTID_NUM_LOCK };
+
+    uint32_t state = 0;
+    uint32_t bit = 1;
+    for (size_t i = 0; i < sizeof(MODIFIERS) / sizeof(MODIFIERS[0]); i++, bit <<= 1)
+    {
+      if (keyboard->IsModifierKeyDown(MODIFIERS[i]))
+        state |= bit;
+    }
+    for (size_t i = 0; i < sizeof(TOGGLES) / sizeof(TOGGLES[0]); i++, bit <<= 1)
+    {
+      if (keyboard->IsToggleStateOn(TOGGLES[i]))
+        state |= bit;
+    }
+    return state;
   }
 
   void ConfigManager::Update(const SelectionContext& context)
@@ -147,6 +588,17 @@ namespace shellanything
     sli.verbose = true;
     ScopeLogger logger(&sli);
 
+    //reuse the states of the previous update if nothing has changed
+    const uint32_t keyboard_state = GetKeyboardState();
+    if (RestoreUpdateMemo(context, keyboard_state))
+    {
+      SA_VERBOSE_LOG(INFO) << "Reusing the menu states of the previous update.";
+      return;
+    }
+
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    const uint64_t live_read_count = pmgr.GetLiveReadCount();
+
     //for each child
     ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
     for (size_t i = 0; i < configurations.size(); i++)
@@ -154,10 +606,131 @@ namespace shellanything
       ConfigFile* config = configurations[i];
       config->Update(context);
     }
+
+    //the states of menus which depends on live properties cannot be reused
+    if (pmgr.GetLiveReadCount() == live_read_count)
+      SaveUpdateMemo(context, keyboard_state);
+    else
+      InvalidateUpdateCache();
+  }
+
+  void ConfigManager::SetUpdateCacheTimeout(const uint64_t& timeout)
+  {
+    mUpdateCacheTimeout = timeout;
+    InvalidateUpdateCache();
+  }
+
+  const uint64_t& ConfigManager::GetUpdateCacheTimeout() const
+  {
+    return mUpdateCacheTimeout;
+  }
+
+  void ConfigManager::InvalidateUpdateCache()
+  {
+    mUpdateMemo.elements.clear();
+    mUpdateMemo.sizes.clear();
+    mUpdateMemo.modified_dates.clear();
+    mUpdateMemo.keyboard_state = 0;
+    mUpdateMemo.generation = 0;
+    mUpdateMemo.timestamp = 0;
+    mUpdateMemo.visible.clear();
+    mUpdateMemo.enabled.clear();
+    mUpdateMemo.valid = false;
+  }
+
+  bool ConfigManager::RestoreUpdateMemo(const SelectionContext& context, uint32_t keyboard_state)
+  {
+    if (!mUpdateMemo.valid || mUpdateCacheTimeout == 0)
+      return false;
+
+    //is the memo expired?
+    uint64_t elapsed = ra::timing::GetMillisecondsCounterU64() - mUpdateMemo.timestamp;
+    if (elapsed > mUpdateCacheTimeout)
+      return false;
+
+    //is it the same selection?
+    const StringList& elements = context.GetElements();
+    if (mUpdateMemo.keyboard_state != keyboard_state ||
+        mUpdateMemo.generation != PropertyManager::GetInstance().GetGeneration() ||
+        mUpdateMemo.elements != elements)
+      return false;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      if (mUpdateMemo.sizes[i] != context.GetElementSize(i) ||
+          mUpdateMemo.modified_dates[i] != context.GetElementModifiedDate(i))
+        return false;
+    }
+
+    //are the menus the same?
+    size_t count = 0;
+    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      count += configurations[i]->GetMenuTree().GetCount();
+    }
+    if (count != mUpdateMemo.visible.size())
+      return false;
+
+    //restore the states
+    size_t offset = 0;
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      const MenuTree& tree = configurations[i]->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++, offset++)
+      {
+        Menu* menu = tree.GetNode(j).menu;
+        menu->SetVisible(mUpdateMemo.visible[offset]);
+        menu->SetEnabled(mUpdateMemo.enabled[offset]);
+      }
+    }
+
+    return true;
+  }
+
+  void ConfigManager::SaveUpdateMemo(const SelectionContext& context, uint32_t keyboard_state)
+  {
+    InvalidateUpdateCache();
+    if (mUpdateCacheTimeout == 0)
+      return;
+
+    const StringList& elements = context.GetElements();
+    mUpdateMemo.elements = elements;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      mUpdateMemo.sizes.push_back(context.GetElementSize(i));
+      mUpdateMemo.modified_dates.push_back(context.GetElementModifiedDate(i));
+    }
+    mUpdateMemo.keyboard_state = keyboard_state;
+    mUpdateMemo.generation = PropertyManager::GetInstance().GetGeneration();
+
+    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      const MenuTree& tree = configurations[i]->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++)
+      {
+        const Menu* menu = tree.GetNode(j).menu;
+        mUpdateMemo.visible.push_back(menu->IsVisible());
+        mUpdateMemo.enabled.push_back(menu->IsEnabled());
+      }
+    }
+
+    mUpdateMemo.timestamp = ra::timing::GetMillisecondsCounterU64();
+    mUpdateMemo.valid = true;
   }
 
   Menu* ConfigManager::FindMenuByCommandId(const uint32_t& command_id)
   {
+    //look in the index built by AssignCommandIds()
+    if (mFirstCommandId != Menu::INVALID_COMMAND_ID)
+    {
+      if (command_id < mFirstCommandId || command_id - mFirstCommandId >= mCommandIdIndex.size())
+        return NULL;
+      Menu* menu = mCommandIdIndex[command_id - mFirstCommandId];
+      if (menu != NULL && menu->GetCommandId() == command_id)
+        return menu;
+    }
+
     //for each child
     ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
     for (size_t i = 0; i < configurations.size(); i++)
@@ -173,6 +746,29 @@ namespace shellanything
 
   Menu* ConfigManager::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
   {
+    //look in the index of raw or expanded names
+    const bool expands = ((flags & FIND_BY_NAME_EXPANDS) != 0);
+    NAME_INDEX& index = (expands ? mExpandedNameIndex : mNameIndex);
+    if (!IsNameIndexValid(index, expands))
+      BuildNameIndex(index, expands);
+    if (!index.is_volatile)
+    {
+      MenuNameMap::const_iterator it;
+      if (flags & FIND_BY_NAME_CASE_INSENSITIVE)
+      {
+        it = index.uppercase.find(ra::strings::Uppercase(name));
+        if (it != index.uppercase.end())
+          return it->second;
+      }
+      else
+      {
+        it = index.exact.find(name);
+        if (it != index.exact.end())
+          return it->second;
+      }
+      return NULL;
+    }
+
     //for each child
     ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
     for (size_t i = 0; i < configurations.size(); i++)
@@ -186,6 +782,89 @@ namespace shellanything
     return NULL;
   }
 
+  bool ConfigManager::IsNameIndexValid(NAME_INDEX& index, bool expands)
+  {
+    if (!index.built || index.name_generation != Menu::GetNameGeneration())
+      return false;
+    if (!expands)
+      return true;
+
+    //the expanded names are still valid if none of the properties they have read was modified
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    const uint64_t generation = pmgr.GetGeneration();
+    if (index.generation == generation)
+      return true;
+    for (PropertyGenerationMap::const_iterator it = index.dependencies.begin(); it != index.dependencies.end(); ++it)
+    {
+      if (pmgr.GetPropertyGeneration(it->first) != it->second)
+        return false;
+    }
+    index.generation = generation;
+    return true;
+  }
+
+  void ConfigManager::BuildNameIndex(NAME_INDEX& index, bool expands)
+  {
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+
+    index.exact.clear();
+    index.uppercase.clear();
+    index.dependencies.clear();
+    index.generation = pmgr.GetGeneration();
+    index.name_generation = Menu::GetNameGeneration();
+    index.built = true;
+    index.is_volatile = false;
+
+    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      const MenuTree& tree = configurations[i]->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++)
+      {
+        Menu* menu = tree.GetNode(j).menu;
+        std::string name = menu->GetName();
+        if (expands)
+        {
+          bool name_volatile = false;
+          StringList dependencies;
+          name = pmgr.Expand(name, name_volatile, dependencies);
+          index.is_volatile |= name_volatile;
+          for (size_t k = 0; k < dependencies.size(); k++)
+          {
+            const std::string& dependency = dependencies[k];
+            index.dependencies[dependency] = pmgr.GetPropertyGeneration(dependency);
+          }
+        }
+
+        //keep the first menu in search order for each name
+        index.exact.insert(std::pair<std::string, Menu*>(name, menu));
+        index.uppercase.insert(std::pair<std::string, Menu*>(ra::strings::Uppercase(name), menu));
+      }
+    }
+
+    //a volatile name cannot be indexed
+    if (index.is_volatile)
+    {
+      index.exact.clear();
+      index.uppercase.clear();
+    }
+  }
+
+  void ConfigManager::ClearNameIndex()
+  {
+    NAME_INDEX* indexes[] = { &mNameIndex, &mExpandedNameIndex };
+    for (size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++)
+    {
+      NAME_INDEX& index = *indexes[i];
+      index.exact.clear();
+      index.uppercase.clear();
+      index.dependencies.clear();
+      index.generation = 0;
+      index.name_generation = 0;
+      index.built = false;
+      index.is_volatile = false;
+    }
+  }
 
   uint32_t ConfigManager::AssignCommandIds(const uint32_t& first_command_id)
   {
@@ -199,22 +878,72 @@ namespace shellanything
       nextCommandId = config->AssignCommandIds(nextCommandId);
     }
 
+    //index the menus by command id
+    ClearCommandIdIndex();
+    if (first_command_id != Menu::INVALID_COMMAND_ID && nextCommandId > first_command_id)
+    {
+      mFirstCommandId = first_command_id;
+      mCommandIdIndex.resize(nextCommandId - first_command_id, NULL);
+      for (size_t i = 0; i < configurations.size(); i++)
+      {
+        const MenuTree& tree = configurations[i]->GetMenuTree();
+        for (size_t j = 0; j < tree.GetCount(); j++)
+        {
+          Menu* menu = tree.GetNode(j).menu;
+          const uint32_t& command_id = menu->GetCommandId();
+          if (command_id == Menu::INVALID_COMMAND_ID || command_id < mFirstCommandId)
+            continue;
+
+          size_t offset = command_id - mFirstCommandId;
+          if (offset < mCommandIdIndex.size())
+            mCommandIdIndex[offset] = menu;
+        }
+      }
+    }
+
     return nextCommandId;
   }
 
+  void ConfigManager::ClearCommandIdIndex()
+  {
+    mCommandIdIndex.clear();
+    mFirstCommandId = Menu::INVALID_COMMAND_ID;
+  }
+
   ConfigFile::ConfigFilePtrList ConfigManager::GetConfigFiles()
   {
     return mConfigurations;
   }
 
+  void ConfigManager::SetMaxLoadingThreads(size_t max_threads)
+  {
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    mMaxLoadingThreads = max_threads;
+  }
+
+  size_t ConfigManager::GetMaxLoadingThreads() const
+  {
+    return mMaxLoadingThreads;
+  }
+
   void ConfigManager::ClearSearchPath()
   {
     mPaths.clear();
+    mDirty = true;
+    mPathsChanged = true;
+
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    mRefreshPaths = mPaths;
   }
 
   void ConfigManager::AddSearchPath(const std::string& path)
   {
     mPaths.push_back(path);
+    mDirty = true;
+    mPathsChanged = true;
+
+    std::unique_lock<std::mutex> lock(mRefreshMutex);
+    mRefreshPaths = mPaths;
   }
 
   std::string ConfigManager::ToShortString() const
@@ -257,34 +986,158 @@ namespace shellanything
 
       str += indent_str + "}";
     }
+
+    if (PerformanceCounters::IsEnabled())
+    {
+      str += "\n";
+      ToPerformanceString(str, indent);
+    }
   }
 
-  bool ConfigManager::IsConfigFileLoaded(const std::string& path) const
+  void ConfigManager::ResetPerformanceCounters()
   {
+    //for each config
     for (size_t i = 0; i < mConfigurations.size(); i++)
     {
-      const ConfigFile* config = mConfigurations[i];
-      if (config != NULL && config->GetFilePath() == path)
-        return true;
+      ConfigFile* config = mConfigurations[i];
+      config->ResetPerformanceCounters();
+
+      const Plugin::PluginPtrList& plugins = config->GetPlugins();
+      for (size_t j = 0; j < plugins.size(); j++)
+      {
+        plugins[j]->ResetPerformanceCounters();
+      }
+
+      //for each menu
+      const MenuTree& tree = config->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++)
+      {
+        Menu* menu = tree.GetNode(j).menu;
+        menu->ResetPerformanceCounters();
+      }
     }
-    return false;
   }
 
-  void ConfigManager::DeleteChildren()
+  void ConfigManager::ToPerformanceString(std::string& str, int indent) const
   {
-    // delete configurations
+    const std::string indent_str = std::string(indent, ' ');
+
+    str += indent_str + "Performance counters {\n";
+
+    //for each config
     for (size_t i = 0; i < mConfigurations.size(); i++)
     {
       ConfigFile* config = mConfigurations[i];
-      delete config;
+      str += indent_str + "  ConfigFile '" + config->GetFilePath() + "': ";
+      PerformanceCounters::ToString(config->GetPerformanceCounters(), str);
+      str += "\n";
+
+      const Plugin::PluginPtrList& plugins = config->GetPlugins();
+      for (size_t j = 0; j < plugins.size(); j++)
+      {
+        const Plugin* plugin = plugins[j];
+        str += indent_str + "    Plugin '" + plugin->GetPath() + "': ";
+        PerformanceCounters::ToString(plugin->GetPerformanceCounters(), str);
+        str += "\n";
+      }
+
+      //for each menu
+      const MenuTree& tree = config->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++)
+      {
+        const Menu* menu = tree.GetNode(j).menu;
+        str += indent_str + "    Menu '" + menu->GetName() + "': ";
+        PerformanceCounters::ToString(menu->GetPerformanceCounters(), str);
+        str += "\n";
+
+        for (size_t k = 0; k < menu->GetVisibilityCount(); k++)
+        {
+          const Validator* validator = menu->GetVisibility(k);
+          str += indent_str + "      Visibility " + ToHexString(validator) + ": ";
+          PerformanceCounters::ToString(validator->GetPerformanceCounters(), str);
+          str += "\n";
+        }
+        for (size_t k = 0; k < menu->GetValidityCount(); k++)
+        {
+          const Validator* validator = menu->GetValidity(k);
+          str += indent_str + "      Validity " + ToHexString(validator) + ": ";
+          PerformanceCounters::ToString(validator->GetPerformanceCounters(), str);
+          str += "\n";
+        }
+      }
+    }
+
+    str += indent_str + "}";
+  }
+
+  static bool IsSlowerMenu(const Menu* a, const Menu* b)
+  {
+    return a->GetPerformanceCounters().total_ns > b->GetPerformanceCounters().total_ns;
+  }
+
+  void ConfigManager::GetSlowestMenus(size_t count, Menu::MenuPtrList& menus) const
+  {
+    menus.clear();
+
+    //for each config
+    for (size_t i = 0; i < mConfigurations.size(); i++)
+    {
+      ConfigFile* config = mConfigurations[i];
+      const MenuTree& tree = config->GetMenuTree();
+      for (size_t j = 0; j < tree.GetCount(); j++)
+      {
+        Menu* menu = tree.GetNode(j).menu;
+        if (menu->GetPerformanceCounters().updates > 0)
+          menus.push_back(menu);
+      }
+    }
+
+    std::stable_sort(menus.begin(), menus.end(), IsSlowerMenu);
+    if (menus.size() > count)
+      menus.resize(count);
+  }
+
+  void ConfigManager::LogSlowestMenus(size_t count) const
+  {
+    Menu::MenuPtrList menus;
+    GetSlowestMenus(count, menus);
+
+    if (menus.empty())
+    {
+      SA_LOG(INFO) << "Slowest menus: no menu updates were measured. Performance counters enabled: " << (PerformanceCounters::IsEnabled() ? "true" : "false") << ".";
+      return;
+    }
+
+    SA_LOG(INFO) << "Slowest menus (" << menus.size() << "):";
+    for (size_t i = 0; i < menus.size(); i++)
+    {
+      const Menu* menu = menus[i];
+      const ConfigFile* config = menu->GetParentConfigFile();
+
+      std::string counters;
+      PerformanceCounters::ToString(menu->GetPerformanceCounters(), counters);
+
+      SA_LOG(INFO) << "  #" << (i + 1) << " menu '" << menu->GetName() << "' of configuration '" << (config ? config->GetFilePath() : "") << "': " << counters;
     }
-    mConfigurations.clear();
   }
 
-  void ConfigManager::DeleteChild(ConfigFile* config)
+  bool ConfigManager::IsConfigFileLoaded(const std::string& path) const
+  {
+    for (size_t i = 0; i < mConfigurations.size(); i++)
+    {
+      const ConfigFile* config = mConfigurations[i];
+      if (config != NULL && config->GetFilePath() == path)
+        return true;
+    }
+    return false;
+  }
+
+  void ConfigManager::DeleteChildren()
   {
-    mConfigurations.erase(std::find(mConfigurations.begin(), mConfigurations.end(), config));
-    delete config;
+    // the configurations are deleted when they are not used anymore
+    PublishConfigFiles(ConfigFileRefList());
+    mDirty = true; //configurations must be discovered again
+    mPathsChanged = true;
   }
 
 } //namespace shellanything
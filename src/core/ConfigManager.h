@@ -32,6 +32,14 @@
 #include "ConfigFile.h"
 #include "SelectionContext.h"
 #include "Enums.h"
+#include "IFileWatcherService.h"
+
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace shellanything
 {
@@ -53,11 +61,41 @@ namespace shellanything
   public:
     static ConfigManager& GetInstance();
 
+    /// <summary>
+    /// A list of reference counted ConfigFile instances.
+    /// </summary>
+    typedef std::vector<std::shared_ptr<ConfigFile> > ConfigFileRefList;
+
+    /// <summary>
+    /// A shared pointer to an immutable list of loaded configurations.
+    /// </summary>
+    typedef std::shared_ptr<const ConfigFileRefList> ConfigFileSetPtr;
+
+    /// <summary>
+    /// Default initialization value for the 'GetUpdateCacheTimeout()' method.
+    /// </summary>
+    static const uint64_t DEFAULT_UPDATE_CACHE_TIMEOUT;
+
+    /// <summary>
+    /// Default interval in milliseconds between two searches of the background refresh thread.
+    /// </summary>
+    static const uint64_t DEFAULT_BACKGROUND_REFRESH_INTERVAL;
+
     /// <summary>
     /// Get the list of ConfigFile pointers handled by the manager
     /// </summary>
     ConfigFile::ConfigFilePtrList GetConfigFiles();
 
+    /// <summary>
+    /// Get the list of configurations currently loaded by the manager.
+    /// </summary>
+    /// <remarks>
+    /// The list is never modified. Refresh() and Clear() publish a new list instead.
+    /// The ConfigFile instances of the list are not deleted while the returned pointer is in use, even if they are unloaded by the manager.
+    /// </remarks>
+    /// <returns>Returns a shared pointer to the current list of configurations.</returns>
+    ConfigFileSetPtr GetConfigFileSet() const;
+
     /// <summary>
     /// Returns true if the given path is a ConfigFile loaded by the manager.
     /// </summary>
@@ -76,17 +114,78 @@ namespace shellanything
     /// * Deleted loaded configurations whose file are missing.
     /// * Discover new unloaded configuration files.
     /// </summary>
+    /// <remarks>
+    /// If a file watcher service is set, the search paths are watched for changes
+    /// and the refresh is skipped until a change is notified by the service.
+    /// </remarks>
     void Refresh();
 
+    /// <summary>
+    /// Start a thread which searches the search paths and loads the new or modified configuration files in the background.
+    /// </summary>
+    /// <remarks>
+    /// While the thread is running, Refresh() only publishes the configurations that are already loaded by the thread.
+    /// The search paths are still searched by Refresh() after they are modified.
+    /// The thread only searches the search paths after the file watcher service notifies a change.
+    /// If no file watcher service is set or if a search path cannot be watched, the search paths are searched at every interval.
+    /// Configurations which declare plugins are also loaded by the thread. Refresh() never waits for the thread.
+    /// The file watcher service must not be replaced while the thread is running.
+    /// The thread must not be started or stopped while the loader lock is held (within DllMain).
+    /// </remarks>
+    /// <param name="interval">The interval in milliseconds between two checks for changes.</param>
+    /// <returns>Returns true if the thread is running. Returns false otherwise.</returns>
+    bool StartBackgroundRefresh(const uint64_t& interval = DEFAULT_BACKGROUND_REFRESH_INTERVAL);
+
+    /// <summary>
+    /// Stop the background refresh thread. Configurations loaded by the thread but not published yet are deleted.
+    /// </summary>
+    void StopBackgroundRefresh();
+
+    /// <summary>
+    /// Check if the background refresh thread is running.
+    /// </summary>
+    /// <returns>Returns true if the thread is running. Returns false otherwise.</returns>
+    bool IsBackgroundRefreshRunning() const;
+
+    /// <summary>
+    /// Check if the content of the configuration manager must be refreshed.
+    /// </summary>
+    /// <returns>Returns true if a search path was changed or if changes cannot be detected. Returns false otherwise.</returns>
+    bool IsRefreshRequired();
+
     /// <summary>
     /// Recursively update all loaded configurations.
     /// </summary>
+    /// <remarks>
+    /// The visible and enabled states of the menus are remembered after an update.
+    /// The next update reuses the same states if the selected elements, their size and modified date, the keyboard state and the properties are identical.
+    /// The states are not remembered if a live property was read during the update.
+    /// </remarks>
     /// <param name="context">The selection context</param>
     void Update(const SelectionContext& context);
 
+    /// <summary>
+    /// Set the maximum duration in milliseconds where the states of a previous update can be reused by Update().
+    /// </summary>
+    /// <param name="timeout">The timeout in milliseconds. Set to 0 to always update the menus.</param>
+    void SetUpdateCacheTimeout(const uint64_t& timeout);
+
+    /// <summary>
+    /// Get the maximum duration in milliseconds where the states of a previous update can be reused by Update().
+    /// </summary>
+    const uint64_t& GetUpdateCacheTimeout() const;
+
+    /// <summary>
+    /// Forget the states of the previous update. The next call to Update() will update all menus.
+    /// </summary>
+    void InvalidateUpdateCache();
+
     /// <summary>
     /// Finds a loaded Menu pointer that is assigned the command id command_id.
     /// </summary>
+    /// <remarks>
+    /// The command ids assigned by AssignCommandIds() are indexed. The lookup is a direct access until the configurations are refreshed.
+    /// </remarks>
     /// <param name="command_id">The search command id value.</param>
     /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
     Menu* FindMenuByCommandId(const uint32_t& command_id);
@@ -94,6 +193,11 @@ namespace shellanything
     /// <summary>
     /// Finds a loaded Menu pointer by a given name. The first menu that matches the given name is returned.
     /// </summary>
+    /// <remarks>
+    /// The menus are indexed by name on the first search. The index is rebuilt when a menu is renamed.
+    /// The index of expanded names is also rebuilt when a property read while expanding the names is modified.
+    /// The menus are searched one by one if one of the expanded names depends on a live property.
+    /// </remarks>
     /// <param name="name">The name of the menu.</param>
     /// <param name="flags">The flags for searching by name.</param>
     /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
@@ -104,8 +208,24 @@ namespace shellanything
     /// </summary>
     /// <param name="first_command_id">The first command id available.</param>
     /// <returns>Returns the next available command id. Returns first_command_id if it failed assining command id.</returns>
+    /// <remarks>The menus are indexed by command id for FindMenuByCommandId().</remarks>
     uint32_t AssignCommandIds(const uint32_t& first_command_id);
 
+    /// <summary>
+    /// Set the maximum number of threads used for loading new configuration files.
+    /// </summary>
+    /// <remarks>
+    /// Threads must not be used while the loader lock is held (within DllMain).
+    /// </remarks>
+    /// <param name="max_threads">The maximum number of threads. Set to 0 to use one thread per processor. Set to 1 to load files on the calling thread.</param>
+    void SetMaxLoadingThreads(size_t max_threads);
+
+    /// <summary>
+    /// Get the maximum number of threads used for loading new configuration files.
+    /// </summary>
+    /// <returns>Returns the maximum number of threads. Returns 0 if one thread per processor is used.</returns>
+    size_t GetMaxLoadingThreads() const;
+
     /// <summary>
     /// Clears all the registered search paths
     /// </summary>
@@ -117,6 +237,32 @@ namespace shellanything
     /// <param name="path">The path to add to the search list.</param>
     void AddSearchPath(const std::string& path);
 
+    /// <summary>
+    /// Reset the performance counters of all configurations, plugins, menus and validators.
+    /// </summary>
+    void ResetPerformanceCounters();
+
+    /// <summary>
+    /// Get a description of the performance counters of all configurations, plugins, menus and validators.
+    /// The description is also appended to ToLongString() when performance counters are enabled.
+    /// </summary>
+    /// <param name="str">The output string.</param>
+    /// <param name="indent">The indentation of the output string.</param>
+    void ToPerformanceString(std::string& str, int indent) const;
+
+    /// <summary>
+    /// Get the menus with the highest cumulative update time.
+    /// </summary>
+    /// <param name="count">The maximum number of menus to get.</param>
+    /// <param name="menus">The output list of menus, sorted from the slowest to the fastest.</param>
+    void GetSlowestMenus(size_t count, Menu::MenuPtrList& menus) const;
+
+    /// <summary>
+    /// Write the menus with the highest cumulative update time to the log.
+    /// </summary>
+    /// <param name="count">The maximum number of menus to log.</param>
+    void LogSlowestMenus(size_t count) const;
+
     // IObject methods
     virtual std::string ToShortString() const;
     virtual void ToLongString(std::string& str, int indent) const;
@@ -124,11 +270,86 @@ namespace shellanything
   private:
     //methods
     void DeleteChildren();
-    void DeleteChild(ConfigFile* config);
+    void PublishConfigFiles(const ConfigFileRefList& configs);
+    void UpdateWatches();
+    void ClearCommandIdIndex();
+    void ClearNameIndex();
+
+    typedef std::unordered_map<std::string /*name*/, Menu* /*menu*/> MenuNameMap;
+    typedef std::unordered_map<std::string /*name*/, uint64_t /*generation*/> PropertyGenerationMap;
+    struct NAME_INDEX
+    {
+      MenuNameMap exact;
+      MenuNameMap uppercase;
+      PropertyGenerationMap dependencies; // generation of each property read while expanding the names
+      uint64_t generation;                // generation of the PropertyManager when the dependencies were last validated
+      uint64_t name_generation;           // generation of the menu names when the index was built
+      bool built;
+      bool is_volatile;
+    };
+    bool IsNameIndexValid(NAME_INDEX& index, bool expands);
+    void BuildNameIndex(NAME_INDEX& index, bool expands);
+
+    struct UPDATE_MEMO
+    {
+      StringList elements;
+      std::vector<uint64_t> sizes;
+      std::vector<uint64_t> modified_dates;
+      uint32_t keyboard_state;
+      uint64_t generation;
+      uint64_t timestamp;
+      std::vector<bool> visible;
+      std::vector<bool> enabled;
+      bool valid;
+    };
+    bool RestoreUpdateMemo(const SelectionContext& context, uint32_t keyboard_state);
+    void SaveUpdateMemo(const SelectionContext& context, uint32_t keyboard_state);
+
+    struct BACKGROUND_REFRESH
+    {
+      StringList stale_paths; // configurations to unload
+      ConfigFile::ConfigFilePtrList configs; // configurations to load
+      uint64_t version; // version of the configurations that were searched
+      bool ready;
+    };
+    void RunBackgroundRefresh();
+    void PublishBackgroundRefresh();
+    void ClearBackgroundRefresh(BACKGROUND_REFRESH& refresh);
 
     //attributes
     StringList mPaths;
-    ConfigFile::ConfigFilePtrList mConfigurations;
+    ConfigFileSetPtr mConfigSet;
+    ConfigFile::ConfigFilePtrList mConfigurations; // raw pointers of mConfigSet
+    uint64_t mConfigVersion; // increased each time a new list of configurations is published
+    size_t mMaxLoadingThreads;
+    bool mDirty;
+    IFileWatcherService* mWatcher;
+    StringList mWatchedPaths;
+    Menu::MenuPtrList mCommandIdIndex; // menus by (command id - mFirstCommandId)
+    uint32_t mFirstCommandId;
+    NAME_INDEX mNameIndex;          // menus by raw name
+    NAME_INDEX mExpandedNameIndex;  // menus by expanded name
+    UPDATE_MEMO mUpdateMemo;
+    uint64_t mUpdateCacheTimeout;
+
+    // background refresh
+    bool mPathsChanged; // search paths must be searched by Refresh()
+
+    // The members below are protected by mRefreshMutex.
+    std::thread mRefreshThread;
+    mutable std::mutex mRefreshMutex;
+    std::condition_variable mRefreshCondition;
+    bool mRefreshStop;
+    uint64_t mRefreshInterval;
+    StringList mRefreshPaths;       // copy of mPaths
+    IFileWatcherService* mRefreshWatcher; // copy of mWatcher
+    bool mRefreshPolling;           // the search paths must be searched at every interval
+    bool mRefreshForced;            // the search paths must be searched at the next interval
+    StringList mFailedPaths;        // files that failed to load. They are not loaded again until they are modified.
+    std::vector<uint64_t> mFailedDates; // file modified date of each failed file
+    StringList mLoadedPaths;        // file path of each published configuration
+    std::vector<uint64_t> mLoadedDates; // file modified date of each published configuration
+    BACKGROUND_REFRESH mPendingRefresh;
   };
 
 } //namespace shellanything
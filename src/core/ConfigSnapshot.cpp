@@ -0,0 +1,530 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "ConfigSnapshot.h"
+#include "shellanything/version.h"
+#include "SaUtils.h"
+
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/unicode.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/process.h"
+
+#include "tinyxml2.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <Windows.h>
+#undef GetEnvironmentVariable
+#undef DeleteFile
+#undef CreateDirectory
+#undef CopyFile
+#undef CreateFile
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <string.h>
+#include <atomic>
+
+using namespace tinyxml2;
+
+namespace shellanything
+{
+  const uint32_t ConfigSnapshot::FORMAT_VERSION = 3;
+
+  static const char SNAPSHOT_MAGIC[8] = { 'S', 'A', 'S', 'N', 'A', 'P', 'S', 'H' };
+  static const char* SNAPSHOT_FILE_EXTENSION = ".snapshot";
+  static const size_t MAX_ELEMENT_DEPTH = 256;
+  static std::string gSnapshotDirectory;
+  static std::atomic<uint32_t> gTemporaryFileCount(0);
+
+  enum SNAPSHOT_NODE_TYPE
+  {
+    SNAPSHOT_NODE_END = 0,
+    SNAPSHOT_NODE_ELEMENT,
+    SNAPSHOT_NODE_TEXT,
+    SNAPSHOT_NODE_CDATA,
+  };
+
+  static uint32_t GetSnapshotChecksum(const char* data, size_t size)
+  {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+      hash ^= (unsigned char)data[i];
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  /// <summary>
+  /// Serializes values into a binary buffer.
+  /// Strings are prefixed by their length and followed by a null character
+  /// which allows the reader to use them directly from the mapped memory.
+  /// </summary>
+  struct SNAPSHOT_WRITER
+  {
+    std::string buffer;
+
+    void WriteU8(uint8_t value)
+    {
+      buffer.append(1, (char)value);
+    }
+    void WriteU32(uint32_t value)
+    {
+      buffer.append((const char*)&value, sizeof(value));
+    }
+    void WriteU64(uint64_t value)
+    {
+      buffer.append((const char*)&value, sizeof(value));
+    }
+    void WriteString(const char* value)
+    {
+      if (value == NULL)
+        value = "";
+      uint32_t length = (uint32_t)strlen(value);
+      WriteU32(length);
+      buffer.append(value, length + 1);
+    }
+  };
+
+  /// <summary>
+  /// Reads values from a binary buffer. Every read is bounds checked.
+  /// </summary>
+  struct SNAPSHOT_READER
+  {
+    const char* data;
+    size_t size;
+    size_t offset;
+
+    bool Read(void* value, size_t length)
+    {
+      if (length > size - offset)
+        return false;
+      memcpy(value, data + offset, length);
+      offset += length;
+      return true;
+    }
+    bool ReadU8(uint8_t& value)
+    {
+      return Read(&value, sizeof(value));
+    }
+    bool ReadU32(uint32_t& value)
+    {
+      return Read(&value, sizeof(value));
+    }
+    bool ReadU64(uint64_t& value)
+    {
+      return Read(&value, sizeof(value));
+    }
+    bool ReadString(const char*& value)
+    {
+      uint32_t length = 0;
+      if (!ReadU32(length))
+        return false;
+      if ((size_t)length >= size - offset || data[offset + length] != '\0')
+        return false;
+      value = data + offset;
+      offset += (size_t)length + 1;
+      return true;
+    }
+  };
+
+  /// <summary>
+  /// A read-only file mapped in memory.
+  /// </summary>
+  struct MAPPED_FILE
+  {
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+
+    MAPPED_FILE() :
+      data(NULL),
+      size(0),
+#ifdef _WIN32
+      file(INVALID_HANDLE_VALUE),
+      mapping(NULL)
+#else
+      fd(-1)
+#endif
+    {
+    }
+
+    ~MAPPED_FILE()
+    {
+      Close();
+    }
+
+    bool Open(const std::string& path)
+    {
+#ifdef _WIN32
+      std::wstring path_unicode = ra::unicode::Utf8ToUnicode(path);
+      file = CreateFileW(path_unicode.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (file == INVALID_HANDLE_VALUE)
+        return false;
+      LARGE_INTEGER file_size;
+      if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        return false;
+      size = (size_t)file_size.QuadPart;
+      mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping == NULL)
+        return false;
+      data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      return (data != NULL);
+#else
+      fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        return false;
+      struct stat file_stat;
+      if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+        return false;
+      size = (size_t)file_stat.st_size;
+      void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (view == MAP_FAILED)
+        return false;
+      data = (const char*)view;
+      return true;
+#endif
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+      if (data)
+        UnmapViewOfFile(data);
+      if (mapping)
+        CloseHandle(mapping);
+      if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+      mapping = NULL;
+      file = INVALID_HANDLE_VALUE;
+#else
+      if (data)
+        munmap((void*)data, size);
+      if (fd >= 0)
+        close(fd);
+      fd = -1;
+#endif
+      data = NULL;
+      size = 0;
+    }
+  };
+
+  static void WriteSnapshotNodes(SNAPSHOT_WRITER& writer, const XMLNode* parent)
+  {
+    for (const XMLNode* node = parent->FirstChild(); node != NULL; node = node->NextSibling())
+    {
+      const XMLElement* element = node->ToElement();
+      const XMLText* text = node->ToText();
+      if (element)
+      {
+        writer.WriteU8(SNAPSHOT_NODE_ELEMENT);
+        writer.WriteString(element->Name());
+
+        uint32_t count = 0;
+        for (const XMLAttribute* attr = element->FirstAttribute(); attr != NULL; attr = attr->Next())
+          count++;
+        writer.WriteU32(count);
+        for (const XMLAttribute* attr = element->FirstAttribute(); attr != NULL; attr = attr->Next())
+        {
+          writer.WriteString(attr->Name());
+          writer.WriteString(attr->Value());
+        }
+
+        WriteSnapshotNodes(writer, element);
+      }
+      else if (text)
+      {
+        writer.WriteU8(text->CData() ? SNAPSHOT_NODE_CDATA : SNAPSHOT_NODE_TEXT);
+        writer.WriteString(text->Value());
+      }
+
+      // Declarations, comments and unknown nodes are not used by the ObjectFactory.
+    }
+    writer.WriteU8(SNAPSHOT_NODE_END);
+  }
+
+  static bool ReadSnapshotNodes(SNAPSHOT_READER& reader, XMLDocument& doc, XMLNode* parent, size_t depth)
+  {
+    if (depth > MAX_ELEMENT_DEPTH)
+      return false;
+
+    uint8_t type = SNAPSHOT_NODE_END;
+    while (reader.ReadU8(type))
+    {
+      switch (type)
+      {
+      case SNAPSHOT_NODE_END:
+        return true;
+      case SNAPSHOT_NODE_ELEMENT:
+        {
+          const char* name = NULL;
+          uint32_t count = 0;
+          if (!reader.ReadString(name) || !reader.ReadU32(count))
+            return false;
+
+          XMLElement* element = doc.NewElement(name);
+          parent->InsertEndChild(element);
+          for (uint32_t i = 0; i < count; i++)
+          {
+            const char* attr_name = NULL;
+            const char* attr_value = NULL;
+            if (!reader.ReadString(attr_name) || !reader.ReadString(attr_value))
+              return false;
+            element->SetAttribute(attr_name, attr_value);
+          }
+
+          if (!ReadSnapshotNodes(reader, doc, element, depth + 1))
+            return false;
+        }
+        break;
+      case SNAPSHOT_NODE_TEXT:
+      case SNAPSHOT_NODE_CDATA:
+        {
+          const char* value = NULL;
+          if (!reader.ReadString(value))
+            return false;
+
+          XMLText* text = doc.NewText(value);
+          text->SetCData(type == SNAPSHOT_NODE_CDATA);
+          parent->InsertEndChild(text);
+        }
+        break;
+      default:
+        return false;
+      };
+    }
+
+    // End of buffer reached before the end of the children
+    return false;
+  }
+
+  static bool ReadSnapshotHeader(SNAPSHOT_READER& reader, const std::string& path, uint64_t file_modified_date, uint64_t file_size, const std::string& snapshot_path, std::string& error)
+  {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t format_version = 0;
+    uint64_t snapshot_file_modified_date = 0;
+    uint64_t snapshot_file_size = 0;
+    const char* snapshot_app_version = NULL;
+    const char* snapshot_path_value = NULL;
+    uint64_t payload_size = 0;
+    uint32_t payload_checksum = 0;
+    if (!reader.Read(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+        !reader.ReadU32(format_version) || format_version != ConfigSnapshot::FORMAT_VERSION)
+    {
+      error = "Snapshot file '" + snapshot_path + "' has an unknown format.";
+      return false;
+    }
+    if (!reader.ReadU64(snapshot_file_modified_date) ||
+        !reader.ReadU64(snapshot_file_size) ||
+        !reader.ReadString(snapshot_app_version) ||
+        !reader.ReadString(snapshot_path_value) ||
+        !reader.ReadU64(payload_size) ||
+        !reader.ReadU32(payload_checksum))
+    {
+      error = "Snapshot file '" + snapshot_path + "' is truncated.";
+      return false;
+    }
+    if (snapshot_file_modified_date != file_modified_date ||
+        snapshot_file_size != file_size ||
+        strcmp(snapshot_app_version, SHELLANYTHING_VERSION) != 0 ||
+        path != snapshot_path_value)
+    {
+      error = "Snapshot file '" + snapshot_path + "' is out of date.";
+      return false;
+    }
+    if (payload_size != (uint64_t)(reader.size - reader.offset) ||
+        GetSnapshotChecksum(reader.data + reader.offset, (size_t)payload_size) != payload_checksum)
+    {
+      error = "Snapshot file '" + snapshot_path + "' is corrupted.";
+      return false;
+    }
+
+    return true;
+  }
+
+  static bool ReplaceSnapshotFile(const std::string& temp_path, const std::string& snapshot_path)
+  {
+#ifdef _WIN32
+    std::wstring temp_path_unicode = ra::unicode::Utf8ToUnicode(temp_path);
+    std::wstring snapshot_path_unicode = ra::unicode::Utf8ToUnicode(snapshot_path);
+    return (MoveFileExW(temp_path_unicode.c_str(), snapshot_path_unicode.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+    return RenameFileUtf8(temp_path, snapshot_path);
+#endif
+  }
+
+  void ConfigSnapshot::SetDirectory(const std::string& path)
+  {
+    gSnapshotDirectory = path;
+  }
+
+  const std::string& ConfigSnapshot::GetDirectory()
+  {
+    return gSnapshotDirectory;
+  }
+
+  bool ConfigSnapshot::IsEnabled()
+  {
+    return !gSnapshotDirectory.empty();
+  }
+
+  std::string ConfigSnapshot::GetSnapshotPath(const std::string& path)
+  {
+    if (!IsEnabled())
+      return "";
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < path.size(); i++)
+    {
+      hash ^= (unsigned char)path[i];
+      hash *= 1099511628211ull;
+    }
+
+    std::string filename = ra::strings::Format("%016llx", (unsigned long long)hash);
+
+    std::string snapshot_path = gSnapshotDirectory + ra::filesystem::GetPathSeparatorStr() + filename + SNAPSHOT_FILE_EXTENSION;
+    return snapshot_path;
+  }
+
+  bool ConfigSnapshot::IsUpToDate(const std::string& path)
+  {
+    if (!IsEnabled())
+      return false;
+
+    std::string snapshot_path = GetSnapshotPath(path);
+    MAPPED_FILE file;
+    if (!file.Open(snapshot_path))
+      return false;
+
+    if (!ra::filesystem::FileExistsUtf8(path.c_str()))
+      return false;
+    uint64_t file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(path.c_str());
+    uint64_t file_size = ra::filesystem::GetFileSizeUtf8(path.c_str());
+
+    SNAPSHOT_READER reader;
+    reader.data = file.data;
+    reader.size = file.size;
+    reader.offset = 0;
+    std::string error;
+    return ReadSnapshotHeader(reader, path, file_modified_date, file_size, snapshot_path, error);
+  }
+
+  bool ConfigSnapshot::Save(const std::string& path, uint64_t file_modified_date, uint64_t file_size, const XMLDocument& doc, std::string& error)
+  {
+    if (!IsEnabled())
+    {
+      error = "Snapshots are disabled.";
+      return false;
+    }
+
+    SNAPSHOT_WRITER payload;
+    WriteSnapshotNodes(payload, &doc);
+
+    SNAPSHOT_WRITER writer;
+    writer.buffer.reserve(payload.buffer.size() + 256 + path.size());
+    writer.buffer.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.WriteU32(FORMAT_VERSION);
+    writer.WriteU64(file_modified_date);
+    writer.WriteU64(file_size);
+    writer.WriteString(SHELLANYTHING_VERSION);
+    writer.WriteString(path.c_str());
+    writer.WriteU64(payload.buffer.size());
+    writer.WriteU32(GetSnapshotChecksum(payload.buffer.data(), payload.buffer.size()));
+    writer.buffer.append(payload.buffer);
+
+    if (!ra::filesystem::DirectoryExistsUtf8(gSnapshotDirectory.c_str()) && !ra::filesystem::CreateDirectoryUtf8(gSnapshotDirectory.c_str()))
+    {
+      error = "Failed creating snapshot directory '" + gSnapshotDirectory + "'.";
+      return false;
+    }
+
+    //write a temporary file and replace the snapshot. Other processes never read a partial snapshot.
+    std::string snapshot_path = GetSnapshotPath(path);
+    std::string temp_path = snapshot_path + ra::strings::Format(".%u.%u.tmp", (unsigned int)ra::process::GetCurrentProcessId(), (unsigned int)gTemporaryFileCount++);
+    if (!ra::filesystem::WriteFileUtf8(temp_path, writer.buffer))
+    {
+      ra::filesystem::DeleteFileUtf8(temp_path.c_str());
+      error = "Failed writing snapshot file '" + temp_path + "'.";
+      return false;
+    }
+    if (!ReplaceSnapshotFile(temp_path, snapshot_path))
+    {
+      ra::filesystem::DeleteFileUtf8(temp_path.c_str());
+      error = "Failed replacing snapshot file '" + snapshot_path + "'.";
+      return false;
+    }
+
+    return true;
+  }
+
+  bool ConfigSnapshot::Load(const std::string& path, uint64_t file_modified_date, uint64_t file_size, XMLDocument& doc, std::string& error)
+  {
+    if (!IsEnabled())
+    {
+      error = "Snapshots are disabled.";
+      return false;
+    }
+
+    std::string snapshot_path = GetSnapshotPath(path);
+    MAPPED_FILE file;
+    if (!file.Open(snapshot_path))
+    {
+      error = "Snapshot file '" + snapshot_path + "' not found.";
+      return false;
+    }
+
+    SNAPSHOT_READER reader;
+    reader.data = file.data;
+    reader.size = file.size;
+    reader.offset = 0;
+    if (!ReadSnapshotHeader(reader, path, file_modified_date, file_size, snapshot_path, error))
+      return false;
+
+    doc.Clear();
+    if (!ReadSnapshotNodes(reader, doc, &doc, 0) || reader.offset != reader.size)
+    {
+      doc.Clear();
+      error = "Snapshot file '" + snapshot_path + "' is corrupted.";
+      return false;
+    }
+
+    return true;
+  }
+
+} //namespace shellanything
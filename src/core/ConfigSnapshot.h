@@ -0,0 +1,118 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_CONFIG_SNAPSHOT_H
+#define SA_CONFIG_SNAPSHOT_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace tinyxml2
+{
+  class XMLDocument;
+}
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// Binary snapshots of parsed Configuration Files.
+  /// A snapshot stores the element tree of a Configuration File that was successfully parsed and validated.
+  /// It is keyed by the path, the modified date and the size of the file and by the version of the application.
+  /// The xml file is only read when its snapshot is missing or out of date.
+  /// Line numbers are not stored in the snapshot. Elements of a document loaded from a snapshot report line 0.
+  /// Loading a snapshot maps the file in memory and rebuilds the document without parsing xml text.
+  /// </summary>
+  class SHELLANYTHING_EXPORT ConfigSnapshot
+  {
+  public:
+    /// <summary>
+    /// Version of the binary format. Snapshots of another format version are ignored.
+    /// </summary>
+    static const uint32_t FORMAT_VERSION;
+
+    /// <summary>
+    /// Set the directory where snapshots are stored. An empty directory disables snapshots.
+    /// </summary>
+    /// <param name="path">The path of the snapshot directory.</param>
+    static void SetDirectory(const std::string& path);
+
+    /// <summary>
+    /// Get the directory where snapshots are stored.
+    /// </summary>
+    /// <returns>Returns the path of the snapshot directory. Returns an empty string if snapshots are disabled.</returns>
+    static const std::string& GetDirectory();
+
+    /// <summary>
+    /// Check if snapshots are enabled.
+    /// </summary>
+    /// <returns>Returns true if a snapshot directory is set. Returns false otherwise.</returns>
+    static bool IsEnabled();
+
+    /// <summary>
+    /// Get the path of the snapshot file of a Configuration File.
+    /// </summary>
+    /// <param name="path">The path of a Configuration File.</param>
+    /// <returns>Returns the path of the snapshot file. Returns an empty string if snapshots are disabled.</returns>
+    static std::string GetSnapshotPath(const std::string& path);
+
+    /// <summary>
+    /// Check if an up to date snapshot of a Configuration File exists.
+    /// </summary>
+    /// <param name="path">The path of a Configuration File.</param>
+    /// <returns>Returns true if the snapshot matches the current modified date and size of the file. Returns false otherwise.</returns>
+    static bool IsUpToDate(const std::string& path);
+
+    /// <summary>
+    /// Save the snapshot of a parsed Configuration File.
+    /// The snapshot is written to a temporary file which then replaces the previous snapshot.
+    /// </summary>
+    /// <param name="path">The path of the Configuration File.</param>
+    /// <param name="file_modified_date">The modified date of the Configuration File.</param>
+    /// <param name="file_size">The size of the Configuration File in bytes.</param>
+    /// <param name="doc">The parsed document of the Configuration File.</param>
+    /// <param name="error">The output error description, if the function fails.</param>
+    /// <returns>Returns true if the snapshot is saved. Returns false otherwise.</returns>
+    static bool Save(const std::string& path, uint64_t file_modified_date, uint64_t file_size, const tinyxml2::XMLDocument& doc, std::string& error);
+
+    /// <summary>
+    /// Load the snapshot of a Configuration File.
+    /// The snapshot is rejected if it does not match the given modified date and size, or the version of the application.
+    /// </summary>
+    /// <param name="path">The path of the Configuration File.</param>
+    /// <param name="file_modified_date">The current modified date of the Configuration File.</param>
+    /// <param name="file_size">The current size of the Configuration File in bytes.</param>
+    /// <param name="doc">The output document. Must be empty.</param>
+    /// <param name="error">The output error description, if the function fails.</param>
+    /// <returns>Returns true if an up to date snapshot is loaded. Returns false otherwise.</returns>
+    static bool Load(const std::string& path, uint64_t file_modified_date, uint64_t file_size, tinyxml2::XMLDocument& doc, std::string& error);
+
+  };
+
+} //namespace shellanything
+
+#endif //SA_CONFIG_SNAPSHOT_H
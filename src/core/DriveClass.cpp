@@ -24,6 +24,7 @@
 
 #include "DriveClass.h"
 #include "Validator.h"
+#include "PerformanceCounters.h"
 
 #include <Windows.h>
 
@@ -78,6 +79,8 @@ namespace shellanything
 
   DRIVE_CLASS GetDriveClassFromPath(const std::string& path)
   {
+    PerformanceCounters::AddFilesystemProbe();
+
     // Patch for DRIVE_CLASS_NETWORK.
     // The function GetDriveTypeA() will return DRIVE_UNKNOWN when the given path is a network path.
     // For example \\localhost\shared\public will be reported as DRIVE_UNKNOWN.
@@ -24,6 +24,8 @@
 
 #include "Environment.h"
 #include "Validator.h"
+#include "LoggerHelper.h"
+#include "ScopeTracer.h"
 
 #include "rapidassist/unicode.h"
 #include "rapidassist/environment_utf8.h"
@@ -33,6 +35,7 @@ namespace shellanything
   static const std::string EMPTY_VALUE;
 
   const std::string Environment::SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME = "SA_OPTION_LOGGING_VERBOSE";
+  const std::string Environment::SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME = "SA_OPTION_LOGGING_TRACE";
   const std::string Environment::SYSTEM_CONFIGURATIONS_DIR_OVERRIDE_ENVIRONMENT_VARIABLE_NAME = "SA_OPTION_CONFIGURATIONS_DIR";
   const std::string Environment::SYSTEM_LOGS_DIR_OVERRIDE_ENVIRONMENT_VARIABLE_NAME = "SA_OPTION_LOGS_DIR";
 
@@ -85,5 +88,26 @@ namespace shellanything
     return is_false;
   }
 
+  bool Environment::SetOption(const std::string& name, const std::string& value)
+  {
+    bool success = ra::environment::SetEnvironmentVariableUtf8(name.c_str(), value.c_str());
+    OnOptionChanged(name);
+    return success;
+  }
+
+  bool Environment::ClearOption(const std::string& name)
+  {
+    bool success = ra::environment::SetEnvironmentVariableUtf8(name.c_str(), NULL);
+    OnOptionChanged(name);
+    return success;
+  }
+
+  void Environment::OnOptionChanged(const std::string& name)
+  {
+    if (name == SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME)
+      LoggerHelper::InvalidateVerboseLoggingCache();
+    else if (name == SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME)
+      ScopeTracer::InvalidateEnabledCache();
+  }
 
 } //namespace shellanything
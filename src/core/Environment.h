@@ -54,6 +54,11 @@ namespace shellanything
     /// </summary>
     static const std::string SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME;
 
+    /// <summary>
+    /// Name of the environment variable that defines the scope tracing.
+    /// </summary>
+    static const std::string SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME;
+
     /// <summary>
     /// Name of the environment variable that defines the configurations directory path override.
     /// </summary>
@@ -97,6 +102,24 @@ namespace shellanything
     /// <returns>Returns true if the environment variable evaluates to true. Returns false otherwise.</returns>
     bool IsOptionFalse(const std::string& name) const;
 
+    /// <summary>
+    /// Set the value of an option.
+    /// </summary>
+    /// <param name="name">The name of the environment variable to set.</param>
+    /// <param name="value">The new value of the environment variable.</param>
+    /// <returns>Returns true if the environment variable was set. Returns false otherwise.</returns>
+    bool SetOption(const std::string& name, const std::string& value);
+
+    /// <summary>
+    /// Delete an option.
+    /// </summary>
+    /// <param name="name">The name of the environment variable to delete.</param>
+    /// <returns>Returns true if the environment variable was deleted. Returns false otherwise.</returns>
+    bool ClearOption(const std::string& name);
+
+  private:
+    void OnOptionChanged(const std::string& name);
+
   };
 
 } //namespace shellanything
@@ -0,0 +1,208 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "ExprtkHelper.h"
+#include "PropertyManager.h"
+#include "PropertyTemplate.h"
+#include "PerformanceCounters.h"
+#include "libexprtk.h"
+
+#include "rapidassist/strings.h"
+
+#include <string.h>
+#include <vector>
+#include <map>
+
+namespace shellanything
+{
+  static const size_t ERROR_SIZE = 10480;
+  static const size_t MAX_VARIABLE_DIGITS = 15; // all integers of 15 digits are exactly representable as a double.
+
+  /// <summary>
+  /// An exprtk expression where numeric property references are replaced by variables.
+  /// </summary>
+  struct EXPRTK_BINDING
+  {
+    std::string expression;
+    std::vector<std::string> names;
+    std::vector<double> values;
+  };
+
+  inline bool IsOperatorBefore(char c)
+  {
+    return (strchr(" \t\r\n+-*/%^<>=!&|,(?:;[{", c) != NULL);
+  }
+
+  inline bool IsOperatorAfter(char c)
+  {
+    return (strchr(" \t\r\n+-*/%^<>=!&|,)?:;]}", c) != NULL);
+  }
+
+  /// <summary>
+  /// Parse a property value as a non-negative integer.
+  /// The value is parsed independently of the current locale.
+  /// </summary>
+  static bool ParseVariableValue(const std::string& value, double& result)
+  {
+    if (value.empty() || value.size() > MAX_VARIABLE_DIGITS)
+      return false;
+
+    result = 0.0;
+    for (size_t i = 0; i < value.size(); i++)
+    {
+      char c = value[i];
+      if (c < '0' || c > '9')
+        return false;
+      result = result * 10.0 + (double)(c - '0');
+    }
+    return true;
+  }
+
+  /// <summary>
+  /// Replace the property references of an exprtk expression by variables.
+  /// </summary>
+  /// <param name="exprtk">The unexpanded exprtk expression.</param>
+  /// <param name="expanded">The expanded value of the exprtk expression.</param>
+  /// <param name="binding">The output expression and variables.</param>
+  /// <returns>Returns true if all references were replaced by variables. Returns false otherwise.</returns>
+  static bool BindVariables(const std::string& exprtk, const std::string& expanded, EXPRTK_BINDING& binding)
+  {
+    PropertyTemplate tmpl;
+    tmpl.Parse(exprtk);
+    if (!tmpl.IsSimple() || tmpl.GetReferenceCount() == 0)
+      return false;
+
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    const PropertyTemplate::SegmentList& segments = tmpl.GetSegments();
+
+    // The expression with the values of the properties. Must match the expanded value.
+    std::string substituted;
+    std::map<std::string, size_t> variable_indices;
+    bool in_string = false;
+    bool previous_is_reference = false;
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+      const PropertyTemplate::SEGMENT& segment = segments[i];
+
+      if (!segment.reference)
+      {
+        const char* text = exprtk.c_str() + segment.offset;
+        if (previous_is_reference && !IsOperatorAfter(text[0]))
+          return false;
+
+        // Track string literals. Properties inside strings cannot be variables.
+        for (size_t j = 0; j < segment.length; j++)
+        {
+          char c = text[j];
+          if (in_string && c == '\\')
+            j++;
+          else if (c == '\'')
+            in_string = !in_string;
+          else if (!in_string && (c == '#' || (c == '/' && j + 1 < segment.length && (text[j + 1] == '/' || text[j + 1] == '*'))))
+            return false; // comments
+        }
+
+        binding.expression.append(text, segment.length);
+        substituted.append(text, segment.length);
+        previous_is_reference = false;
+        continue;
+      }
+
+      // Property reference
+      if (in_string || previous_is_reference)
+        return false;
+      if (segment.offset > 0 && !IsOperatorBefore(exprtk[segment.offset - 1]))
+        return false;
+
+      std::string value;
+      if (!pmgr.TryGetProperty(segment.name, value))
+        return false;
+      double number = 0.0;
+      if (!ParseVariableValue(value, number))
+        return false;
+
+      std::map<std::string, size_t>::const_iterator it = variable_indices.find(segment.name);
+      size_t index = 0;
+      if (it != variable_indices.end())
+      {
+        index = it->second;
+      }
+      else
+      {
+        index = binding.names.size();
+        variable_indices[segment.name] = index;
+        binding.names.push_back("sa_var" + ra::strings::ToString(index));
+        binding.values.push_back(number);
+      }
+
+      binding.expression.append(binding.names[index]);
+      substituted.append(value);
+      previous_is_reference = true;
+    }
+
+    // Make sure the variables are evaluated exactly as the expanded expression.
+    return (!in_string && substituted == expanded);
+  }
+
+  bool ExprtkHelper::EvaluateDouble(const std::string& exprtk, const std::string& expanded, double& result, std::string& error)
+  {
+    PerformanceCounters::AddExprtkEvaluation();
+
+    char error_buffer[ERROR_SIZE];
+    error_buffer[0] = '\0';
+    int evaluated = 0;
+
+    EXPRTK_BINDING binding;
+    if (BindVariables(exprtk, expanded, binding))
+    {
+      std::vector<const char*> names;
+      for (size_t i = 0; i < binding.names.size(); i++)
+        names.push_back(binding.names[i].c_str());
+
+      evaluated = EvaluateDoubleWithVariables(binding.expression.c_str(), &names[0], &binding.values[0], (int)names.size(), &result, error_buffer, ERROR_SIZE);
+    }
+
+    // Fallback to the expanded expression
+    if (!evaluated)
+      evaluated = ::EvaluateDouble(expanded.c_str(), &result, error_buffer, ERROR_SIZE);
+
+    if (!evaluated)
+    {
+      error = error_buffer;
+      return false;
+    }
+    return true;
+  }
+
+  bool ExprtkHelper::EvaluateBoolean(const std::string& exprtk, const std::string& expanded, bool& result, std::string& error)
+  {
+    double tmp = 0.0;
+    if (!EvaluateDouble(exprtk, expanded, tmp, error))
+      return false;
+    result = (tmp != 0.0);
+    return true;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,71 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_EXPRTK_HELPER_H
+#define SA_EXPRTK_HELPER_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <string>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// Helper class for evaluating exprtk expressions.
+  /// </summary>
+  class SHELLANYTHING_EXPORT ExprtkHelper
+  {
+  public:
+
+    /// <summary>
+    /// Evaluates an exprtk expression and calculates the result.
+    /// Numeric property references of the unexpanded expression are evaluated as variables.
+    /// This allows the compiled expression to be reused from the cache of libexprtk when the values of the properties changes.
+    /// If the references cannot be bound as variables, the expanded expression is evaluated instead.
+    /// </summary>
+    /// <param name="exprtk">The unexpanded exprtk expression.</param>
+    /// <param name="expanded">The expanded value of the exprtk expression.</param>
+    /// <param name="result">The output result of the expression.</param>
+    /// <param name="error">The output error description, if the evaluation fails.</param>
+    /// <returns>Returns true if the evaluation is successfull. Returns false otherwise.</returns>
+    static bool EvaluateDouble(const std::string& exprtk, const std::string& expanded, double& result, std::string& error);
+
+    /// <summary>
+    /// Evaluates a boolean exprtk expression as a true or false value.
+    /// See EvaluateDouble() for details.
+    /// </summary>
+    /// <param name="exprtk">The unexpanded exprtk expression.</param>
+    /// <param name="expanded">The expanded value of the exprtk expression.</param>
+    /// <param name="result">The output result of the expression.</param>
+    /// <param name="error">The output error description, if the evaluation fails.</param>
+    /// <returns>Returns true if the evaluation is successfull. Returns false otherwise.</returns>
+    static bool EvaluateBoolean(const std::string& exprtk, const std::string& expanded, bool& result, std::string& error);
+
+  };
+
+} //namespace shellanything
+
+#endif //SA_EXPRTK_HELPER_H
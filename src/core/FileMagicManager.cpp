@@ -73,32 +73,36 @@ std::string GetMGCPath()
 
 namespace shellanything
 {
-  FileMagicManager::FileMagicManager()
+  static std::string GetMagicFileResult(magic_t cookie, int flags, const std::string& path, const char* result_name)
   {
-    magic_cookie = magic_open(MAGIC_NONE);
-    if (magic_cookie == NULL)
-    {
-      std::string message = "Failed to open magic library";
-      SA_LOG(ERROR) << "File magic error: " << message << ".";
-      return;
-    }
+    if (cookie == NULL)
+      return std::string();
 
-    std::string path = GetMGCPath();
-    if (magic_load(magic_cookie, path.c_str()) == -1)
+    magic_setflags(cookie, flags);
+    const char* result = magic_file(cookie, path.c_str());
+    if (result == NULL)
     {
-      magic_cookie = NULL;
-
-      std::string message = "Failed to load magic file '" + path + "'. ";
-      message += magic_error(magic_cookie);
+      std::string message = std::string("Failed to get ") + result_name + " of file '" + path + "'. ";
+      message += magic_error(cookie);
       SA_LOG(ERROR) << "File magic error: " << message << ".";
 
-      return;
+      return std::string();
+    }
+    else
+    {
+      return std::string(result);
     }
   }
 
+  FileMagicManager::FileMagicManager()
+  {
+    mgc_path = GetMGCPath();
+    magic_cookie = OpenCookie();
+  }
+
   FileMagicManager::~FileMagicManager()
   {
-    magic_close(magic_cookie);
+    CloseCookie(magic_cookie);
     magic_cookie = NULL;
   }
 
@@ -108,76 +112,73 @@ namespace shellanything
     return _instance;
   }
 
-  std::string FileMagicManager::GetMIMEType(const std::string& path) const
+  magic_t FileMagicManager::OpenCookie() const
   {
-    magic_setflags(magic_cookie, MAGIC_MIME_TYPE);
-    const char* result = magic_file(magic_cookie, path.c_str());
-    if (result == NULL)
+    magic_t cookie = magic_open(MAGIC_NONE);
+    if (cookie == NULL)
     {
-      std::string message = "Failed to get mime type of file '" + path + "'. ";
-      message += magic_error(magic_cookie);
+      std::string message = "Failed to open magic library";
       SA_LOG(ERROR) << "File magic error: " << message << ".";
-
-      return std::string();
+      return NULL;
     }
-    else
+
+    if (magic_load(cookie, mgc_path.c_str()) == -1)
     {
-      return std::string(result);
+      std::string message = "Failed to load magic file '" + mgc_path + "'. ";
+      message += magic_error(cookie);
+      SA_LOG(ERROR) << "File magic error: " << message << ".";
+
+      magic_close(cookie);
+      return NULL;
     }
+
+    return cookie;
   }
 
-  std::string FileMagicManager::GetDescription(const std::string& path) const
+  void FileMagicManager::CloseCookie(magic_t cookie)
   {
-    magic_setflags(magic_cookie, MAGIC_NONE);
-    const char* result = magic_file(magic_cookie, path.c_str());
-    if (result == NULL)
-    {
-      std::string message = "Failed to get description of file '" + path + "'. ";
-      message += magic_error(magic_cookie);
-      SA_LOG(ERROR) << "File magic error: " << message << ".";
+    if (cookie != NULL)
+      magic_close(cookie);
+  }
 
-      return std::string();
-    }
-    else
-    {
-      return std::string(result);
-    }
+  std::string FileMagicManager::GetMIMEType(const std::string& path) const
+  {
+    return GetMIMEType(magic_cookie, path);
   }
 
-  std::string FileMagicManager::GetExtension(const std::string& path) const
+  std::string FileMagicManager::GetDescription(const std::string& path) const
   {
-    magic_setflags(magic_cookie, MAGIC_EXTENSION);
-    const char* result = magic_file(magic_cookie, path.c_str());
-    if (result == NULL)
-    {
-      std::string message = "Failed to get extension of file '" + path + "'. ";
-      message += magic_error(magic_cookie);
-      SA_LOG(ERROR) << "File magic error: " << message << ".";
+    return GetDescription(magic_cookie, path);
+  }
 
-      return std::string();
-    }
-    else
-    {
-      return std::string(result);
-    }
+  std::string FileMagicManager::GetExtension(const std::string& path) const
+  {
+    return GetExtension(magic_cookie, path);
   }
 
   std::string FileMagicManager::GetCharset(const std::string& path) const
   {
-    magic_setflags(magic_cookie, MAGIC_MIME_ENCODING);
-    const char* result = magic_file(magic_cookie, path.c_str());
-    if (result == NULL)
-    {
-      std::string message = "Failed to get character set of file '" + path + "'. ";
-      message += magic_error(magic_cookie);
-      SA_LOG(ERROR) << "File magic error: " << message << ".";
+    return GetCharset(magic_cookie, path);
+  }
 
-      return std::string();
-    }
-    else
-    {
-      return std::string(result);
-    }
+  std::string FileMagicManager::GetMIMEType(magic_t cookie, const std::string& path)
+  {
+    return GetMagicFileResult(cookie, MAGIC_MIME_TYPE, path, "mime type");
+  }
+
+  std::string FileMagicManager::GetDescription(magic_t cookie, const std::string& path)
+  {
+    return GetMagicFileResult(cookie, MAGIC_NONE, path, "description");
+  }
+
+  std::string FileMagicManager::GetExtension(magic_t cookie, const std::string& path)
+  {
+    return GetMagicFileResult(cookie, MAGIC_EXTENSION, path, "extension");
+  }
+
+  std::string FileMagicManager::GetCharset(magic_t cookie, const std::string& path)
+  {
+    return GetMagicFileResult(cookie, MAGIC_MIME_ENCODING, path, "character set");
   }
 
 } //shellanything
\ No newline at end of file
@@ -51,8 +51,27 @@ namespace shellanything
     std::string GetExtension(const std::string& path) const;
     std::string GetCharset(const std::string& path) const;
 
+    /// <summary>
+    /// Open a new magic cookie loaded with the same magic file as the manager.
+    /// Magic cookies are not thread-safe. Each thread must use its own cookie.
+    /// </summary>
+    /// <returns>Returns a new magic cookie. Returns NULL on failure.</returns>
+    magic_t OpenCookie() const;
+
+    /// <summary>
+    /// Close a magic cookie opened with OpenCookie().
+    /// </summary>
+    /// <param name="cookie">The cookie to close.</param>
+    static void CloseCookie(magic_t cookie);
+
+    static std::string GetMIMEType(magic_t cookie, const std::string& path);
+    static std::string GetDescription(magic_t cookie, const std::string& path);
+    static std::string GetExtension(magic_t cookie, const std::string& path);
+    static std::string GetCharset(magic_t cookie, const std::string& path);
+
   private:
     magic_t magic_cookie;
+    std::string mgc_path;
   };
 
 
@@ -24,6 +24,9 @@
 
 #include "IActionFactory.h"
 
+#include "tinyxml2.h"
+using namespace tinyxml2;
+
 namespace shellanything
 {
 
@@ -35,4 +38,40 @@ namespace shellanything
   {
   }
 
+  IAction* IActionFactory::ParseFromAttributes(const AttributeView& attributes, std::string& error) const
+  {
+    //convert the xml element back to a string
+    std::string xml = attributes.ToXml();
+    return ParseFromXml(xml, error);
+  }
+
+  IAction* IActionFactory::ParseFromXmlString(const std::string& xml, std::string& error) const
+  {
+    tinyxml2::XMLDocument doc;
+    XMLError result = doc.Parse(xml.c_str());
+    if (result != XML_SUCCESS)
+    {
+      if (doc.ErrorStr())
+      {
+        error = doc.ErrorStr();
+        return NULL;
+      }
+      else
+      {
+        error = "Unknown error reported by XML library.";
+        return NULL;
+      }
+    }
+
+    const XMLElement* element = doc.FirstChildElement(GetName().c_str());
+    if (element == NULL)
+    {
+      error = "Node '" + GetName() + "' not found.";
+      return NULL;
+    }
+
+    AttributeView attributes(element);
+    return ParseFromAttributes(attributes, error);
+  }
+
 } //namespace shellanything
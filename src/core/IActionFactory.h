@@ -28,6 +28,7 @@
 #include "shellanything/export.h"
 #include "shellanything/config.h"
 #include "IAction.h"
+#include "AttributeView.h"
 #include <vector>
 
 namespace shellanything
@@ -67,6 +68,27 @@ namespace shellanything
     /// <returns>Returns a pointer to a valid IAction if the parsing is successful. Returns NULL otherwise.</returns>
     virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const = 0;
 
+    /// <summary>
+    /// Parse an Action from an already parsed xml element.
+    /// The default implementation serializes the element and calls ParseFromXml().
+    /// Factories should override this function to read the attributes directly from the view
+    /// with ObjectFactory::ParseAttribute().
+    /// </summary>
+    /// <param name="attributes">A view of the xml element to parse. The view is never empty.</param>
+    /// <param name="error">Provides an error description in case the parsing fails.</param>
+    /// <returns>Returns a pointer to a valid IAction if the parsing is successful. Returns NULL otherwise.</returns>
+    virtual IAction* ParseFromAttributes(const AttributeView& attributes, std::string& error) const;
+
+  protected:
+    /// <summary>
+    /// Parse a xml string and calls ParseFromAttributes() with the element matching the factory's name.
+    /// Factories that override ParseFromAttributes() can implement ParseFromXml() with this function.
+    /// </summary>
+    /// <param name="xml">A string that contains the xml element (including child nodes) to parse.</param>
+    /// <param name="error">Provides an error description in case the parsing fails.</param>
+    /// <returns>Returns a pointer to a valid IAction if the parsing is successful. Returns NULL otherwise.</returns>
+    IAction* ParseFromXmlString(const std::string& xml, std::string& error) const;
+
   };
 
 
@@ -0,0 +1,91 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_IFILE_WATCHER_SERVICE_H
+#define SA_IFILE_WATCHER_SERVICE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+
+#include <string>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Abstract file watcher service class.
+  /// Used to decouple the core from the change notification api of the operating system.
+  /// </summary>
+  class SHELLANYTHING_EXPORT IFileWatcherService
+  {
+  public:
+    IFileWatcherService();
+    virtual ~IFileWatcherService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    IFileWatcherService(const IFileWatcherService&);
+    IFileWatcherService& operator=(const IFileWatcherService&);
+  public:
+
+    /// <summary>
+    /// Start watching a directory and its subdirectories for changes.
+    /// A change is any file or directory that is created, deleted, renamed or modified.
+    /// </summary>
+    /// <param name="path">The path of the directory to watch.</param>
+    /// <returns>Returns true if the directory is watched. Returns false otherwise.</returns>
+    virtual bool Watch(const std::string& path) = 0;
+
+    /// <summary>
+    /// Stop watching a directory.
+    /// </summary>
+    /// <param name="path">The path of a watched directory.</param>
+    /// <returns>Returns true if the directory is not watched anymore. Returns false otherwise.</returns>
+    virtual bool Unwatch(const std::string& path) = 0;
+
+    /// <summary>
+    /// Stop watching all directories.
+    /// </summary>
+    virtual void UnwatchAll() = 0;
+
+    /// <summary>
+    /// Check if a directory is watched.
+    /// </summary>
+    /// <param name="path">The path of a directory.</param>
+    /// <returns>Returns true if the directory is watched. Returns false otherwise.</returns>
+    virtual bool IsWatching(const std::string& path) = 0;
+
+    /// <summary>
+    /// Get the watched directories that have changed since the last call.
+    /// The pending changes are cleared.
+    /// </summary>
+    /// <param name="directories">The output list of watched directories that have changed.</param>
+    /// <returns>Returns true if at least one watched directory has changed. Returns false otherwise.</returns>
+    virtual bool GetChanges(StringList& directories) = 0;
+
+  };
+
+} //namespace shellanything
+
+#endif //SA_IFILE_WATCHER_SERVICE_H
@@ -35,4 +35,8 @@ namespace shellanything
   {
   }
 
+  void ILoggerService::Flush()
+  {
+  }
+
 } //namespace shellanything
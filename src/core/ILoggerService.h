@@ -71,6 +71,12 @@ namespace shellanything
     /// <param name="message">The actual message.</param>
     virtual void LogMessage(const LOG_LEVEL & level, const char* message) = 0;
 
+    /// <summary>
+    /// Write all pending messages of this logger.
+    /// The default implementation does nothing.
+    /// </summary>
+    virtual void Flush();
+
   };
 
 } //namespace shellanything
@@ -0,0 +1,290 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "InotifyFileWatcherService.h"
+#include "LoggerHelper.h"
+
+#include <map>
+#include <set>
+#include <mutex>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+namespace shellanything
+{
+  typedef std::map<int, std::string> WatchDescriptorMap;
+
+  struct InotifyFileWatcherService::STATE
+  {
+    int fd;
+    std::mutex mutex;
+    WatchDescriptorMap watches; // path of each watched directory, by watch descriptor.
+    std::set<std::string> roots;
+    std::set<std::string> changes;
+
+    STATE() : fd(-1) {}
+  };
+
+  static std::string NormalizeDirectoryPath(const std::string& path)
+  {
+    std::string output = path;
+    while (output.size() > 1 && output[output.size() - 1] == '/')
+      output.erase(output.size() - 1);
+    return output;
+  }
+
+#ifdef __linux__
+  static bool IsSubdirectory(const std::string& path, const std::string& root)
+  {
+    if (path == root)
+      return true;
+    if (root == "/")
+      return (!path.empty() && path[0] == '/');
+    return (path.size() > root.size() && path.compare(0, root.size(), root) == 0 && path[root.size()] == '/');
+  }
+
+  static const uint32_t INOTIFY_WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+  static bool AddWatchRecursive(int fd, WatchDescriptorMap& watches, const std::string& directory)
+  {
+    int wd = inotify_add_watch(fd, directory.c_str(), INOTIFY_WATCH_MASK);
+    if (wd < 0)
+      return false;
+    watches[wd] = directory;
+
+    // Watch all subdirectories. Symbolic links are not followed.
+    DIR* dir = opendir(directory.c_str());
+    if (dir == NULL)
+      return true;
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir)) != NULL)
+    {
+      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        continue;
+
+      std::string subdirectory = (directory == "/" ? "" : directory) + "/" + entry->d_name;
+      bool is_directory = (entry->d_type == DT_DIR);
+      if (entry->d_type == DT_UNKNOWN)
+      {
+        struct stat info;
+        is_directory = (lstat(subdirectory.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+      }
+      if (is_directory)
+        AddWatchRecursive(fd, watches, subdirectory);
+    }
+    closedir(dir);
+
+    return true;
+  }
+
+  static void MarkChanged(std::set<std::string>& changes, const std::set<std::string>& roots, const std::string& directory)
+  {
+    for (std::set<std::string>::const_iterator it = roots.begin(); it != roots.end(); it++)
+    {
+      const std::string& root = (*it);
+      if (IsSubdirectory(directory, root))
+        changes.insert(root);
+    }
+  }
+#endif
+
+  InotifyFileWatcherService::InotifyFileWatcherService() :
+    mState(new STATE())
+  {
+  }
+
+  InotifyFileWatcherService::~InotifyFileWatcherService()
+  {
+    UnwatchAll();
+    delete mState;
+    mState = NULL;
+  }
+
+  bool InotifyFileWatcherService::IsSupported()
+  {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  bool InotifyFileWatcherService::Watch(const std::string& path)
+  {
+#ifdef __linux__
+    std::string root = NormalizeDirectoryPath(path);
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    if (mState->roots.find(root) != mState->roots.end())
+      return true; // already watching
+
+    if (mState->fd < 0)
+    {
+      mState->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (mState->fd < 0)
+      {
+        SA_LOG(WARNING) << "Failed initializing inotify. Error: " << strerror(errno) << ".";
+        return false;
+      }
+    }
+
+    if (!AddWatchRecursive(mState->fd, mState->watches, root))
+    {
+      SA_LOG(WARNING) << "Failed watching directory '" << root << "'. Error: " << strerror(errno) << ".";
+      return false;
+    }
+
+    mState->roots.insert(root);
+    return true;
+#else
+    SA_LOG(WARNING) << "Failed watching directory '" << path << "'. inotify is not supported.";
+    return false;
+#endif
+  }
+
+  bool InotifyFileWatcherService::Unwatch(const std::string& path)
+  {
+    std::string root = NormalizeDirectoryPath(path);
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    if (mState->roots.erase(root) == 0)
+      return false;
+    mState->changes.erase(root);
+
+#ifdef __linux__
+    // Remove the watches that are not required by another watched directory.
+    WatchDescriptorMap::iterator it = mState->watches.begin();
+    while (it != mState->watches.end())
+    {
+      const std::string& directory = it->second;
+      bool required = false;
+      if (IsSubdirectory(directory, root))
+      {
+        for (std::set<std::string>::const_iterator root_it = mState->roots.begin(); root_it != mState->roots.end() && !required; root_it++)
+          required = IsSubdirectory(directory, *root_it);
+      }
+      else
+        required = true;
+
+      if (!required)
+      {
+        inotify_rm_watch(mState->fd, it->first);
+        it = mState->watches.erase(it);
+      }
+      else
+        it++;
+    }
+#endif
+
+    return true;
+  }
+
+  void InotifyFileWatcherService::UnwatchAll()
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+#ifdef __linux__
+    if (mState->fd >= 0)
+      close(mState->fd);
+#endif
+    mState->fd = -1;
+    mState->watches.clear();
+    mState->roots.clear();
+    mState->changes.clear();
+  }
+
+  bool InotifyFileWatcherService::IsWatching(const std::string& path)
+  {
+    std::string root = NormalizeDirectoryPath(path);
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return (mState->roots.find(root) != mState->roots.end());
+  }
+
+  bool InotifyFileWatcherService::GetChanges(StringList& directories)
+  {
+    directories.clear();
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+
+#ifdef __linux__
+    // Read all pending events without blocking.
+    static const size_t BUFFER_SIZE = 16 * 1024;
+    char buffer[BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (mState->fd >= 0)
+    {
+      ssize_t length = read(mState->fd, buffer, BUFFER_SIZE);
+      if (length <= 0)
+        break; // no more events
+
+      for (char* ptr = buffer; ptr < buffer + length; )
+      {
+        const struct inotify_event* e = (const struct inotify_event*)ptr;
+        ptr += sizeof(struct inotify_event) + e->len;
+
+        if (e->mask & IN_Q_OVERFLOW)
+        {
+          // Events were lost. Assume all directories have changed.
+          mState->changes.insert(mState->roots.begin(), mState->roots.end());
+          continue;
+        }
+
+        WatchDescriptorMap::iterator it = mState->watches.find(e->wd);
+        if (it == mState->watches.end())
+          continue;
+        const std::string directory = it->second;
+
+        MarkChanged(mState->changes, mState->roots, directory);
+
+        if (e->mask & IN_IGNORED)
+        {
+          // The directory was deleted or moved.
+          // A watched root directory is forgotten so that it is watched again if it is recreated.
+          mState->watches.erase(it);
+          mState->roots.erase(directory);
+          continue;
+        }
+
+        // Watch new subdirectories
+        if ((e->mask & IN_ISDIR) && (e->mask & (IN_CREATE | IN_MOVED_TO)) && e->len > 0)
+        {
+          std::string subdirectory = (directory == "/" ? "" : directory) + "/" + e->name;
+          AddWatchRecursive(mState->fd, mState->watches, subdirectory);
+        }
+      }
+    }
+#endif
+
+    directories.assign(mState->changes.begin(), mState->changes.end());
+    mState->changes.clear();
+    return !directories.empty();
+  }
+
+} //namespace shellanything
@@ -0,0 +1,70 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_INOTIFY_FILE_WATCHER_SERVICE_H
+#define SA_INOTIFY_FILE_WATCHER_SERVICE_H
+
+#include "IFileWatcherService.h"
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// inotify implementation class of IFileWatcherService.
+  /// Each watched directory and all its subdirectories are registered to the inotify instance.
+  /// Pending events are read without blocking when GetChanges() is called.
+  /// Only available on Linux. On other platforms, directories cannot be watched.
+  /// </summary>
+  class SHELLANYTHING_EXPORT InotifyFileWatcherService : public IFileWatcherService
+  {
+  public:
+    InotifyFileWatcherService();
+    virtual ~InotifyFileWatcherService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    InotifyFileWatcherService(const InotifyFileWatcherService&);
+    InotifyFileWatcherService& operator=(const InotifyFileWatcherService&);
+  public:
+
+    /// <summary>
+    /// Check if inotify is supported on the current platform.
+    /// </summary>
+    /// <returns>Returns true if inotify is supported. Returns false otherwise.</returns>
+    static bool IsSupported();
+
+    virtual bool Watch(const std::string& path);
+    virtual bool Unwatch(const std::string& path);
+    virtual void UnwatchAll();
+    virtual bool IsWatching(const std::string& path);
+    virtual bool GetChanges(StringList& directories);
+
+  private:
+    struct STATE;
+    STATE* mState;
+  };
+
+} //namespace shellanything
+
+#endif //SA_INOTIFY_FILE_WATCHER_SERVICE_H
@@ -23,11 +23,13 @@
  *********************************************************************************/
 
 #include "LoggerHelper.h"
+#include "ScopeTracer.h"
 #include "PropertyManager.h"
 #include "Environment.h"
 #include "Validator.h"
 #include "SaUtils.h"
 #include <string>
+#include <atomic>
 
 #include "rapidassist/strings.h"
 #include "rapidassist/filesystem_utf8.h"
@@ -35,6 +37,45 @@
 
 namespace shellanything
 {
+  enum VERBOSE_LOGGING_STATE
+  {
+    VERBOSE_LOGGING_UNKNOWN = 0,
+    VERBOSE_LOGGING_DISABLED = 1,
+    VERBOSE_LOGGING_ENABLED = 2,
+  };
+  static const uint64_t VERBOSE_LOGGING_STATE_MASK = 0x3;
+  static const uint64_t VERBOSE_LOGGING_GENERATION_INCREMENT = 0x4;
+
+  // The low bits store the cached state. The high bits count the invalidations of the cache.
+  // A state evaluated before an invalidation can never be published after it.
+  static std::atomic<uint64_t> gVerboseLoggingState(VERBOSE_LOGGING_UNKNOWN);
+
+  static bool EvaluateVerboseLogging()
+  {
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    Environment& env = Environment::GetInstance();
+
+    // Check environment variable options first.
+    static const std::string& VERBOSE_ENV_VAR_NAME = Environment::SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME;
+    if (env.IsOptionSet(VERBOSE_ENV_VAR_NAME))
+    {
+      if (env.IsOptionTrue(VERBOSE_ENV_VAR_NAME))
+        return true;
+      return false;
+    }
+
+    // Check internal property system.
+    static const std::string& VERBOSE_PROPERTY_NAME = PropertyManager::SYSTEM_LOGGING_VERBOSE_PROPERTY_NAME;
+    if (!pmgr.HasProperty(VERBOSE_PROPERTY_NAME))
+      return false; // no verbose logging
+
+    const std::string& value = pmgr.GetProperty(VERBOSE_PROPERTY_NAME);
+    if (value.empty())
+      return false; // no verbose logging
+
+    bool has_vebose_logging = Validator::IsTrue(value);
+    return has_vebose_logging;
+  }
 
   LoggerHelper::LoggerHelper(ILoggerService::LOG_LEVEL level) :
     mFilename(NULL),
@@ -104,29 +145,27 @@ namespace shellanything
 
   bool LoggerHelper::IsVerboseLoggingEnabled()
   {
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-    Environment& env = Environment::GetInstance();
+    uint64_t cache = gVerboseLoggingState.load();
+    uint64_t state = (cache & VERBOSE_LOGGING_STATE_MASK);
+    if (state != VERBOSE_LOGGING_UNKNOWN)
+      return (state == VERBOSE_LOGGING_ENABLED);
 
-    // Check environment variable options first.
-    static const std::string& VERBOSE_ENV_VAR_NAME = Environment::SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME;
-    if (env.IsOptionSet(VERBOSE_ENV_VAR_NAME))
-    {
-      if (env.IsOptionTrue(VERBOSE_ENV_VAR_NAME))
-        return true;
-      return false;
-    }
+    bool enabled = EvaluateVerboseLogging();
 
-    // Check internal property system.
-    static const std::string& VERBOSE_PROPERTY_NAME = PropertyManager::SYSTEM_LOGGING_VERBOSE_PROPERTY_NAME;
-    if (!pmgr.HasProperty(VERBOSE_PROPERTY_NAME))
-      return false; // no verbose logging
-
-    const std::string& value = pmgr.GetProperty(VERBOSE_PROPERTY_NAME);
-    if (value.empty())
-      return false; // no verbose logging
+    // Publish the state only if the cache was not invalidated or published by another thread while evaluating.
+    uint64_t evaluated = (cache & ~VERBOSE_LOGGING_STATE_MASK) | (enabled ? VERBOSE_LOGGING_ENABLED : VERBOSE_LOGGING_DISABLED);
+    gVerboseLoggingState.compare_exchange_strong(cache, evaluated);
+    return enabled;
+  }
 
-    bool has_vebose_logging = Validator::IsTrue(value);
-    return has_vebose_logging;
+  void LoggerHelper::InvalidateVerboseLoggingCache()
+  {
+    uint64_t cache = gVerboseLoggingState.load();
+    uint64_t invalidated;
+    do
+    {
+      invalidated = (cache & ~VERBOSE_LOGGING_STATE_MASK) + VERBOSE_LOGGING_GENERATION_INCREMENT;
+    } while (!gVerboseLoggingState.compare_exchange_weak(cache, invalidated));
   }
 
   bool LoggerHelper::IsValidLogFile(const std::string& path)
@@ -154,8 +193,16 @@ namespace shellanything
   // ------------------------------------------------------------------------------------------------------------------------------------------------------------
 
   ScopeLogger::ScopeLogger(const ScopeLogger::ARGS* args_) :
-    args(args_)
+    args(args_),
+    mTraced(ScopeTracer::IsEnabled()),
+    mTraceBegin(0)
   {
+    if (mTraced)
+      mTraceBegin = ScopeTracer::GetTimestamp();
+
+    if (args->verbose && !LoggerHelper::IsVerboseLoggingEnabled())
+      return; // nothing to log
+
     // Prepare output text
     std::string text;
     text += args->name;
@@ -177,6 +224,12 @@ namespace shellanything
 
   ScopeLogger::~ScopeLogger()
   {
+    if (mTraced)
+      ScopeTracer::Record(args->name, args->filename, args->line, args->instance, mTraceBegin, ScopeTracer::GetTimestamp());
+
+    if (args->verbose && !LoggerHelper::IsVerboseLoggingEnabled())
+      return; // nothing to log
+
     // Prepare output text
     std::string text;
     text += args->name;
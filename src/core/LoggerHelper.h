@@ -27,6 +27,7 @@
 
 #include "ILoggerService.h"
 #include "App.h"
+#include <stdint.h>
 #include <ostream>
 #include <sstream>
 
@@ -66,6 +67,13 @@ namespace shellanything
     /// <returns>Returns true when verbose logging is enabled. Returns false otherwise.</returns>
     static bool IsVerboseLoggingEnabled();
 
+    /// <summary>
+    /// Invalidate the cached verbose logging state.
+    /// The state is evaluated again on the next call to IsVerboseLoggingEnabled().
+    /// Must be called when the verbose logging property or environment option changes.
+    /// </summary>
+    static void InvalidateVerboseLoggingCache();
+
     /// <summary>
     /// Detect if a given file is a valid log file.
     /// </summary>
@@ -81,8 +89,20 @@ namespace shellanything
     std::stringstream mSS;
   };
 
+  /// <summary>
+  /// Helper class that turns a streamed LoggerHelper expression into a void expression.
+  /// Used by the logging macros to skip the whole expression when the stream is disabled.
+  /// </summary>
+  class LoggerHelperVoidify
+  {
+  public:
+    // The & operator has a lower precedence than << but higher than ?:
+    inline void operator&(const LoggerHelper&) {}
+  };
+
   /// <summary>
   /// Helper class for logging the scope of a function or block of code.
+  /// The duration of the scope is also recorded when scope tracing is enabled. See ScopeTracer.
   /// </summary>
   /// <example>
   /// <code>
@@ -125,6 +145,10 @@ namespace shellanything
 
   public:
     const ARGS* args;
+
+  private:
+    bool mTraced;
+    uint64_t mTraceBegin;
   };
 
   #ifndef SA_DECLARE_SCOPE_LOGGER_ARGS
@@ -141,7 +165,7 @@ namespace shellanything
   #endif
 
   #ifndef SA_VERBOSE_LOG
-  #define SA_VERBOSE_LOG(expr)  (::shellanything::LoggerHelper(__FILE__, __LINE__, ::shellanything::ILoggerService::LOG_LEVEL_##expr, true ))
+  #define SA_VERBOSE_LOG(expr)  !::shellanything::LoggerHelper::IsVerboseLoggingEnabled() ? (void)0 : ::shellanything::LoggerHelperVoidify() & (::shellanything::LoggerHelper(__FILE__, __LINE__, ::shellanything::ILoggerService::LOG_LEVEL_##expr, true ))
   #endif
 
 } //namespace shellanything
@@ -23,6 +23,7 @@
  *********************************************************************************/
 
 #include "Menu.h"
+#include "ConfigFile.h"
 #include "Unicode.h"
 #include "PropertyManager.h"
 #include "LoggerHelper.h"
@@ -31,11 +32,15 @@
 #include "rapidassist/strings.h"
 #include "rapidassist/environment.h"
 
+#include <atomic>
+
 namespace shellanything
 {
   const uint32_t Menu::INVALID_COMMAND_ID = 0;
   const int Menu::DEFAULT_NAME_MAX_LENGTH = 250;
 
+  static std::atomic<uint64_t> g_name_generation(0);
+
   Menu::Menu() :
     mParentMenu(NULL),
     mParentConfigFile(NULL),
@@ -44,7 +49,8 @@ namespace shellanything
     mColumnSeparator(false),
     mCommandId(INVALID_COMMAND_ID),
     mVisible(true),
-    mEnabled(true)
+    mEnabled(true),
+    mPerformanceCounters()
   {
   }
 
@@ -146,7 +152,15 @@ namespace shellanything
 
   void Menu::SetName(const std::string& name)
   {
+    if (mName == name)
+      return;
     mName = name;
+    g_name_generation++;
+  }
+
+  uint64_t Menu::GetNameGeneration()
+  {
+    return g_name_generation.load();
   }
 
   const int& Menu::GetNameMaxLength() const
@@ -213,6 +227,40 @@ namespace shellanything
     ScopeLogger logger(&sli);
 
     //update current menu
+    UpdateState(context);
+
+    //for each child
+    for (size_t i = 0; i < mSubMenus.size(); i++)
+    {
+      Menu* child = mSubMenus[i];
+      child->Update(context);
+    }
+
+    UpdateParentVisibility();
+  }
+
+  void Menu::UpdateParentVisibility()
+  {
+    //Issue #4 - Parent menu with no children.
+    if (!IsParentMenu() || !mVisible)
+      return;
+
+    //for each child
+    for (size_t i = 0; i < mSubMenus.size(); i++)
+    {
+      if (mSubMenus[i]->IsVisible())
+        return;
+    }
+
+    //all the direct children of this menu are invisible, force this node as invisible.
+    SetVisible(false);
+    SA_VERBOSE_LOG(INFO) << "Menu '" << mName << "' is forced invisible because all its children (" << mSubMenus.size() << ") are invisibles.";
+  }
+
+  void Menu::UpdateState(const SelectionContext& context)
+  {
+    PerformanceCounters::Scope performance_scope(mPerformanceCounters);
+
     bool visible = true;
     if (!mVisibilities.empty())
     {
@@ -255,28 +303,25 @@ namespace shellanything
     {
       SA_VERBOSE_LOG(INFO) << "Menu '" << mName << "' is set disabled from validation.";
     }
+  }
 
-    //update children
-    bool all_invisible_children = true;
+  const PERFORMANCE_COUNTERS& Menu::GetPerformanceCounters() const
+  {
+    return mPerformanceCounters;
+  }
 
-    //for each child
-    Menu::MenuPtrList children = GetSubMenus();
-    for (size_t i = 0; i < children.size(); i++)
-    {
-      Menu* child = children[i];
-      child->Update(context);
+  void Menu::ResetPerformanceCounters()
+  {
+    PerformanceCounters::Reset(mPerformanceCounters);
 
-      //refresh the flag
-      all_invisible_children = all_invisible_children && !child->IsVisible();
+    //for each validators
+    for (size_t i = 0; i < mVisibilities.size(); i++)
+    {
+      mVisibilities[i]->ResetPerformanceCounters();
     }
-
-    //Issue #4 - Parent menu with no children.
-    //if all the direct children of this menu are invisible
-    if (IsParentMenu() && visible && all_invisible_children)
+    for (size_t i = 0; i < mValidities.size(); i++)
     {
-      //force this node as invisible.
-      SetVisible(false);
-      SA_VERBOSE_LOG(INFO) << "Menu '" << mName << "' is forced invisible because all its children (" << children.size() << ") are invisibles.";
+      mValidities[i]->ResetPerformanceCounters();
     }
   }
 
@@ -286,10 +331,9 @@ namespace shellanything
       return this;
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    for (size_t i = 0; i < mSubMenus.size(); i++)
     {
-      Menu* child = children[i];
+      Menu* child = mSubMenus[i];
       Menu* match = child->FindMenuByCommandId(command_id);
       if (match)
         return match;
@@ -300,31 +344,14 @@ namespace shellanything
 
   Menu* Menu::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
   {
-    // Get the menu name and expand it if requested.
-    std::string menu_name = mName;
-    if (flags & FIND_BY_NAME_EXPANDS)
-    {
-      PropertyManager& pmgr = PropertyManager::GetInstance();
-      std::string expanded = pmgr.Expand(mName);
-      menu_name = expanded;
-    }
-
     // Is it this menu?
-    if (menu_name == name)
+    if (IsMatchingName(name, flags))
       return this;
-    else if (flags & FIND_BY_NAME_CASE_INSENSITIVE)
-    {
-      std::string u_menu_name = ra::strings::Uppercase(menu_name);
-      std::string u_name = ra::strings::Uppercase(name);
-      if (u_menu_name == u_name)
-        return this;
-    }
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    for (size_t i = 0; i < mSubMenus.size(); i++)
     {
-      Menu* child = children[i];
+      Menu* child = mSubMenus[i];
       Menu* match = child->FindMenuByName(name, flags);
       if (match)
         return match;
@@ -333,6 +360,26 @@ namespace shellanything
     return NULL;
   }
 
+  bool Menu::IsMatchingName(const std::string& name, FIND_BY_NAME_FLAGS flags)
+  {
+    // Get the menu name and expand it if requested.
+    const std::string* menu_name = &mName;
+    if (flags & FIND_BY_NAME_EXPANDS)
+      menu_name = &mExpandedName.Expand(mName);
+
+    if (*menu_name == name)
+      return true;
+    else if (flags & FIND_BY_NAME_CASE_INSENSITIVE)
+    {
+      std::string u_menu_name = ra::strings::Uppercase(*menu_name);
+      std::string u_name = ra::strings::Uppercase(name);
+      if (u_menu_name == u_name)
+        return true;
+    }
+
+    return false;
+  }
+
   uint32_t Menu::AssignCommandIds(const uint32_t& first_command_id)
   {
     uint32_t next_command_id = first_command_id;
@@ -350,10 +397,9 @@ namespace shellanything
     }
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    for (size_t i = 0; i < mSubMenus.size(); i++)
     {
-      Menu* child = children[i];
+      Menu* child = mSubMenus[i];
 
       if (mCommandId == INVALID_COMMAND_ID)
         child->AssignCommandIds(INVALID_COMMAND_ID); //also assign invalid ids to sub menus
@@ -443,6 +489,13 @@ namespace shellanything
   {
     mSubMenus.push_back(menu);
     menu->SetParentMenu(this);
+
+    //the flattened menus of the parent configuration must be built again
+    Menu* root = this;
+    while (root->mParentMenu)
+      root = root->mParentMenu;
+    if (root->mParentConfigFile)
+      root->mParentConfigFile->InvalidateMenuTree();
   }
 
   void Menu::AddAction(IAction* action)
@@ -32,6 +32,8 @@
 #include "Validator.h"
 #include "IAction.h"
 #include "Enums.h"
+#include "CachedExpansion.h"
+#include "PerformanceCounters.h"
 
 #include <string>
 #include <vector>
@@ -138,6 +140,12 @@ namespace shellanything
     /// </summary>
     void SetName(const std::string& name);
 
+    /// <summary>
+    /// Get the generation of the names of all menus.
+    /// The generation is increased each time the name of any menu is modified.
+    /// </summary>
+    static uint64_t GetNameGeneration();
+
     /// <summary>
     /// Getter for the 'max_length' parameter.
     /// </summary>
@@ -187,6 +195,18 @@ namespace shellanything
     /// <param name="context">The selection context</param>
     void Update(const SelectionContext& context);
 
+    /// <summary>
+    /// Update the visible and enabled state of this menu from its validators. The submenus are not updated.
+    /// </summary>
+    /// <param name="context">The selection context</param>
+    void UpdateState(const SelectionContext& context);
+
+    /// <summary>
+    /// Force this menu as invisible if it is a visible parent menu and all its submenus are invisible (issue #4).
+    /// The submenus must be updated before calling this method.
+    /// </summary>
+    void UpdateParentVisibility();
+
     /// <summary>
     /// Searches this menu and submenus for a menu whose command id is command_id.
     /// </summary>
@@ -202,6 +222,14 @@ namespace shellanything
     /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
     Menu* FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_NONE);
 
+    /// <summary>
+    /// Check if the name of this menu matches the given name. The submenus are not searched.
+    /// </summary>
+    /// <param name="name">The name of the menu.</param>
+    /// <param name="flags">The flags for searching by name.</param>
+    /// <returns>Returns true if the name of this menu matches the given name. Returns false otherwise.</returns>
+    bool IsMatchingName(const std::string& name, FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_NONE);
+
     /// <summary>
     /// Assign unique command id to this menus and submenus.
     /// </summary>
@@ -209,6 +237,18 @@ namespace shellanything
     /// <returns>Returns the next available command id. Returns first_command_id if no command id was assigned.</returns>
     uint32_t AssignCommandIds(const uint32_t& first_command_id);
 
+    /// <summary>
+    /// Get the performance counters of this menu. See PerformanceCounters.
+    /// The counters measure UpdateState() which includes the validators of the menu but not the submenus.
+    /// </summary>
+    /// <returns>Returns the performance counters of this menu.</returns>
+    const PERFORMANCE_COUNTERS& GetPerformanceCounters() const;
+
+    /// <summary>
+    /// Reset the performance counters of this menu and of its validators.
+    /// </summary>
+    void ResetPerformanceCounters();
+
     /// <summary>
     /// Getter for the 'command-id' parameter.
     /// </summary>
@@ -313,10 +353,12 @@ namespace shellanything
     bool mColumnSeparator;
     uint32_t mCommandId;
     std::string mName;
+    CachedExpansion mExpandedName;
     int mNameMaxLength;
     std::string mDescription;
     IAction::ActionPtrList mActions;
     MenuPtrList mSubMenus;
+    PERFORMANCE_COUNTERS mPerformanceCounters;
   };
 
 } //namespace shellanything
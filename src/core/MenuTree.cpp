@@ -0,0 +1,149 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "MenuTree.h"
+
+namespace shellanything
+{
+  const size_t MenuTree::INVALID_INDEX = (size_t)-1;
+
+  MenuTree::MenuTree()
+  {
+  }
+
+  MenuTree::~MenuTree()
+  {
+  }
+
+  void MenuTree::Build(const Menu::MenuPtrList& menus)
+  {
+    mNodes.clear();
+    for (size_t i = 0; i < menus.size(); i++)
+    {
+      AddNode(menus[i], INVALID_INDEX);
+    }
+  }
+
+  void MenuTree::AddNode(Menu* menu, size_t parent)
+  {
+    const size_t index = mNodes.size();
+    NODE node;
+    node.menu = menu;
+    node.parent = parent;
+    node.end = INVALID_INDEX;
+    mNodes.push_back(node);
+
+    //for each child
+    Menu::MenuPtrList children = menu->GetSubMenus();
+    for (size_t i = 0; i < children.size(); i++)
+    {
+      AddNode(children[i], index);
+    }
+
+    mNodes[index].end = mNodes.size();
+  }
+
+  void MenuTree::Clear()
+  {
+    mNodes.clear();
+  }
+
+  size_t MenuTree::GetCount() const
+  {
+    return mNodes.size();
+  }
+
+  const MenuTree::NODE& MenuTree::GetNode(size_t index) const
+  {
+    return mNodes[index];
+  }
+
+  void MenuTree::Update(const SelectionContext& context)
+  {
+    //update each menu
+    for (size_t i = 0; i < mNodes.size(); i++)
+    {
+      mNodes[i].menu->UpdateState(context);
+    }
+
+    //Issue #4 - Parent menu with no children.
+    //Walk backward to process the children before their parent.
+    for (size_t i = mNodes.size(); i > 0; i--)
+    {
+      mNodes[i - 1].menu->UpdateParentVisibility();
+    }
+  }
+
+  uint32_t MenuTree::AssignCommandIds(const uint32_t& first_command_id)
+  {
+    uint32_t next_command_id = first_command_id;
+
+    //parents are assigned before their children
+    for (size_t i = 0; i < mNodes.size(); i++)
+    {
+      const NODE& node = mNodes[i];
+      Menu* menu = node.menu;
+
+      //Issue #5 - ConfigManager::AssignCommandIds() should skip invisible menus
+      //sub menus of a menu without a command id also have no command id
+      bool invalid_parent = (node.parent != INVALID_INDEX && mNodes[node.parent].menu->GetCommandId() == Menu::INVALID_COMMAND_ID);
+      if (first_command_id == Menu::INVALID_COMMAND_ID || invalid_parent || !menu->IsVisible())
+      {
+        menu->SetCommandId(Menu::INVALID_COMMAND_ID);
+      }
+      else
+      {
+        menu->SetCommandId(next_command_id);
+        next_command_id++;
+      }
+    }
+
+    return next_command_id;
+  }
+
+  Menu* MenuTree::FindMenuByCommandId(const uint32_t& command_id) const
+  {
+    for (size_t i = 0; i < mNodes.size(); i++)
+    {
+      Menu* menu = mNodes[i].menu;
+      if (menu->GetCommandId() == command_id)
+        return menu;
+    }
+
+    return NULL;
+  }
+
+  Menu* MenuTree::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags) const
+  {
+    for (size_t i = 0; i < mNodes.size(); i++)
+    {
+      Menu* menu = mNodes[i].menu;
+      if (menu->IsMatchingName(name, flags))
+        return menu;
+    }
+
+    return NULL;
+  }
+
+} //namespace shellanything
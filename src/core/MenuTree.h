@@ -0,0 +1,135 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_MENU_TREE_H
+#define SA_MENU_TREE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "Menu.h"
+#include "SelectionContext.h"
+#include "Enums.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// A MenuTree is a flattened view of a forest of menus.
+  /// The nodes are stored in an array in pre-order (depth-first) which allows walking the whole forest with a loop
+  /// instead of recursive calls that copy the list of submenus at each level.
+  /// The tree does not own the menus. Each node points to its menu which is still allocated individually.
+  /// The tree must be built again when a menu is added or deleted.
+  /// </summary>
+  class SHELLANYTHING_EXPORT MenuTree
+  {
+  public:
+    /// <summary>
+    /// An invalid node index.
+    /// </summary>
+    static const size_t INVALID_INDEX;
+
+    /// <summary>
+    /// A node of the tree.
+    /// </summary>
+    struct NODE
+    {
+      Menu* menu;
+      size_t parent;  // index of the parent node. INVALID_INDEX for root menus.
+      size_t end;     // index following the last descendant of the node.
+    };
+    typedef std::vector<NODE> NodeList;
+
+    MenuTree();
+    virtual ~MenuTree();
+
+  private:
+    // Disable copy constructor and copy operator
+    MenuTree(const MenuTree&);
+    MenuTree& operator=(const MenuTree&);
+  public:
+
+    /// <summary>
+    /// Build the tree from the given root menus and all their sub menus.
+    /// </summary>
+    /// <param name="menus">The root menus of the forest.</param>
+    void Build(const Menu::MenuPtrList& menus);
+
+    /// <summary>
+    /// Removes all nodes from the tree.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Get the number of nodes in the tree.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Get a node of the tree.
+    /// </summary>
+    /// <param name="index">The index of the node. The index must be lower than GetCount().</param>
+    /// <returns>Returns the node at the given index.</returns>
+    const NODE& GetNode(size_t index) const;
+
+    /// <summary>
+    /// Update all menus of the tree. See Menu::Update() for details.
+    /// </summary>
+    /// <param name="context">The selection context</param>
+    void Update(const SelectionContext& context);
+
+    /// <summary>
+    /// Assign unique command ids to all menus of the tree. See Menu::AssignCommandIds() for details.
+    /// </summary>
+    /// <param name="first_command_id">The first command id available.</param>
+    /// <returns>Returns the next available command id. Returns first_command_id if no command id was assigned.</returns>
+    uint32_t AssignCommandIds(const uint32_t& first_command_id);
+
+    /// <summary>
+    /// Finds the first menu of the tree whose command id is command_id.
+    /// </summary>
+    /// <param name="command_id">The search command id value.</param>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    Menu* FindMenuByCommandId(const uint32_t& command_id) const;
+
+    /// <summary>
+    /// Finds the first menu of the tree that matches the given name.
+    /// </summary>
+    /// <param name="name">The name of the menu.</param>
+    /// <param name="flags">The flags for searching by name.</param>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    Menu* FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_NONE) const;
+
+  private:
+    void AddNode(Menu* menu, size_t parent);
+
+    NodeList mNodes;
+  };
+
+} //namespace shellanything
+
+#endif //SA_MENU_TREE_H
@@ -29,6 +29,7 @@
 #include "ConfigFile.h"
 #include "Menu.h"
 #include "Validator.h"
+#include "AttributeView.h"
 #include "ActionClipboard.h"
 #include "ActionExecute.h"
 #include "ActionStop.h"
@@ -54,6 +55,9 @@ namespace shellanything
   static const std::string& NODE_ACTION_PROPERTY = ActionProperty::XML_ELEMENT_NAME;
   static const std::string NODE_PLUGIN = "plugin";
 
+  //active plugins of each thread. Configurations can be parsed concurrently by multiple threads.
+  static thread_local Plugin::PluginPtrList tActivePlugins;
+
   std::string ToXml(const XMLElement* element)
   {
     XMLPrinter printer;
@@ -108,7 +112,19 @@ namespace shellanything
 
   bool ObjectFactory::ParseAttribute(const XMLElement* element, const char* attr_name, bool is_optional, bool allow_empty_values, std::string& attr_value, std::string& error)
   {
-    if (element == NULL)
+    AttributeView attributes(element);
+    return ParseAttribute(attributes, attr_name, is_optional, allow_empty_values, attr_value, error);
+  }
+
+  bool ObjectFactory::ParseAttribute(const XMLElement* element, const char* attr_name, bool is_optional, bool allow_empty_values, int& attr_value, std::string& error)
+  {
+    AttributeView attributes(element);
+    return ParseAttribute(attributes, attr_name, is_optional, allow_empty_values, attr_value, error);
+  }
+
+  bool ObjectFactory::ParseAttribute(const AttributeView& attributes, const char* attr_name, bool is_optional, bool allow_empty_values, std::string& attr_value, std::string& error)
+  {
+    if (attributes.GetElement() == NULL)
     {
       error = "XMLElement is NULL";
       return false;
@@ -116,33 +132,33 @@ namespace shellanything
 
     attr_value = "";
 
-    const XMLAttribute* attr_node = element->FindAttribute(attr_name);
-    if (is_optional && !attr_node)
+    const char* value = attributes.GetAttribute(attr_name);
+    if (is_optional && !value)
     {
       //failed parsing but its not an error
       return false;
     }
-    else if (!attr_node)
+    else if (!value)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is missing attribute '" + std::string(attr_name) + "'.";
+      error = "Node '" + std::string(attributes.GetName()) + "' at line " + ra::strings::ToString(attributes.GetLineNum()) + " is missing attribute '" + std::string(attr_name) + "'.";
       return false;
     }
 
-    attr_value = attr_node->Value();
+    attr_value = value;
 
     if (!allow_empty_values && attr_value.empty())
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " have attribute '" + std::string(attr_name) + "' value empty.";
+      error = "Node '" + std::string(attributes.GetName()) + "' at line " + ra::strings::ToString(attributes.GetLineNum()) + " have attribute '" + std::string(attr_name) + "' value empty.";
       return false;
     }
 
     return true;
   }
 
-  bool ObjectFactory::ParseAttribute(const XMLElement* element, const char* attr_name, bool is_optional, bool allow_empty_values, int& attr_value, std::string& error)
+  bool ObjectFactory::ParseAttribute(const AttributeView& attributes, const char* attr_name, bool is_optional, bool allow_empty_values, int& attr_value, std::string& error)
   {
     std::string str_value;
-    if (!ParseAttribute(element, attr_name, is_optional, allow_empty_values, str_value, error))
+    if (!ParseAttribute(attributes, attr_name, is_optional, allow_empty_values, str_value, error))
       return false; //error is already set
 
     //convert string to int
@@ -150,7 +166,7 @@ namespace shellanything
     if (!ra::strings::Parse(str_value, int_value))
     {
       //failed parsing
-      error << "Failed parsing attribute '" << attr_name << "' of node '" << element->Name() << "'.";
+      error << "Failed parsing attribute '" << attr_name << "' of node '" << attributes.GetName() << "'.";
       return false;
     }
 
@@ -161,12 +177,12 @@ namespace shellanything
 
   void ObjectFactory::SetActivePlugins(const Plugin::PluginPtrList& plugins)
   {
-    mPlugins = plugins;
+    tActivePlugins = plugins;
   }
 
   void ObjectFactory::ClearActivePlugins()
   {
-    mPlugins.clear();
+    tActivePlugins.clear();
   }
 
   Validator* ObjectFactory::ParseValidator(const tinyxml2::XMLElement* element, std::string& error)
@@ -313,9 +329,9 @@ namespace shellanything
 
     //parse plugin's custom conditions attributes
     PropertyStore customs_attributes;
-    for (size_t i = 0; i < mPlugins.size(); i++)
+    for (size_t i = 0; i < tActivePlugins.size(); i++)
     {
-      Plugin* p = mPlugins[i];
+      Plugin* p = tActivePlugins[i];
       if (!p)
         continue;
 
@@ -341,6 +357,11 @@ namespace shellanything
     return validator;
   }
 
+  Validator* ObjectFactory::ParseValidator(const AttributeView& attributes, std::string& error)
+  {
+    return ParseValidator(attributes.GetElement(), error);
+  }
+
   IAction* ObjectFactory::ParseAction(const XMLElement* element, std::string& error)
   {
     if (element == NULL)
@@ -355,9 +376,9 @@ namespace shellanything
     IActionFactory* factory = registry.GetActionFactoryFromName(name);
 
     //or look for a factory in plugin's registry
-    for (size_t i = 0; i < mPlugins.size() && factory == NULL; i++)
+    for (size_t i = 0; i < tActivePlugins.size() && factory == NULL; i++)
     {
-      Plugin* p = mPlugins[i];
+      Plugin* p = tActivePlugins[i];
       if (!p)
         continue;
 
@@ -368,11 +389,9 @@ namespace shellanything
     //if a factory was found
     if (factory)
     {
-      //convert the xml element to a string
-      std::string xml = ToXml(element);
-
-      //try to parse an IAction from the string
-      IAction* action = factory->ParseFromXml(xml, error);
+      //try to parse an IAction from the element's attributes
+      AttributeView attributes(element);
+      IAction* action = factory->ParseFromAttributes(attributes, error);
       if (action)
         return action;
 
@@ -380,7 +399,7 @@ namespace shellanything
       error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " has failed to parse as an Action.";
       error += "\n";
       error += "Failed to parse action from xml: {\n";
-      error += xml;
+      error += ToXml(element);
       error += "\n}";
       SA_VERBOSE_LOG(ERROR) << error;
       return NULL;
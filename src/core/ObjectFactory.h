@@ -35,6 +35,7 @@
 #include "DefaultSettings.h"
 #include "Plugin.h"
 #include "Registry.h"
+#include "AttributeView.h"
 #include "tinyxml2.h"
 
 namespace shellanything
@@ -80,14 +81,39 @@ namespace shellanything
     /// <returns>Returns true if the attribute was parsed. Returns false otherwise.</returns>
     static bool ParseAttribute(const tinyxml2::XMLElement* element, const char* attr_name, bool is_optional, bool allow_empty_values, int& attr_value, std::string& error);
 
+    /// <summary>
+    /// Parse a string attribute from a view of a xml node.
+    /// </summary>
+    /// <param name="attributes">The view of the xml element to read from</param>
+    /// <param name="attr_name">The name of the attribute find</param>
+    /// <param name="is_optional">True if the attribute is optional. False otherwise. An error is reported if the attribute is mandatory and missing.</param>
+    /// <param name="allow_empty_values">True if the attribute is allowed to be empty. False otherwise. An error is reported if the arribute is </param>
+    /// <param name="attr_value">The output attribute value.</param>
+    /// <param name="error">An output error description string.</param>
+    /// <returns>Returns true if the attribute was parsed. Returns false otherwise.</returns>
+    static bool ParseAttribute(const AttributeView& attributes, const char* attr_name, bool is_optional, bool allow_empty_values, std::string& attr_value, std::string& error);
+
+    /// <summary>
+    /// Parse an integer attribute from a view of a xml node.
+    /// </summary>
+    /// <param name="attributes">The view of the xml element to read from</param>
+    /// <param name="attr_name">The name of the attribute find</param>
+    /// <param name="is_optional">True if the attribute is optional. False otherwise. An error is reported if the attribute is mandatory and missing.</param>
+    /// <param name="allow_empty_values">True if the attribute is allowed to be empty. False otherwise. An error is reported if the arribute is </param>
+    /// <param name="attr_value">The output attribute value.</param>
+    /// <param name="error">An output error description string.</param>
+    /// <returns>Returns true if the attribute was parsed. Returns false otherwise.</returns>
+    static bool ParseAttribute(const AttributeView& attributes, const char* attr_name, bool is_optional, bool allow_empty_values, int& attr_value, std::string& error);
+
     /// <summary>
     /// Set the list of active plugins that must be used for parsing object.
+    /// The plugins are only active for the calling thread.
     /// </summary>
     /// <param name="plugins">The list of plugins objects.</param>
     void SetActivePlugins(const Plugin::PluginPtrList& plugins);
 
     /// <summary>
-    /// Clears the active plugins used for parsing.
+    /// Clears the active plugins used for parsing by the calling thread.
     /// </summary>
     void ClearActivePlugins();
 
@@ -107,6 +133,14 @@ namespace shellanything
     /// <returns>Returns a valid Validator pointer if the object was properly parsed. Returns NULL otherwise.</returns>
     Validator* ParseValidator(const tinyxml2::XMLElement* element, std::string& error);
 
+    /// <summary>
+    /// Parses a Validator class from a view of a xml element. Returns NULL if the parsing failed.
+    /// </summary>
+    /// <param name="attributes">The view of the xml element that contains a Validator to parse.</param>
+    /// <param name="error">The error description if the parsing failed.</param>
+    /// <returns>Returns a valid Validator pointer if the object was properly parsed. Returns NULL otherwise.</returns>
+    Validator* ParseValidator(const AttributeView& attributes, std::string& error);
+
     /// <summary>
     /// Parses a IAction class from xml. Returns NULL if the parsing failed.
     /// </summary>
@@ -141,7 +175,6 @@ namespace shellanything
 
   public:
     Registry registry;
-    Plugin::PluginPtrList mPlugins;
   };
 
 } //namespace shellanything
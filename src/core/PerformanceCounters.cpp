@@ -0,0 +1,190 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PerformanceCounters.h"
+
+#include "rapidassist/strings.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace shellanything
+{
+  static std::atomic<bool> gPerformanceCountersEnabled(false);
+
+  // The innermost scope of the calling thread
+  static thread_local PerformanceCounters::Scope* tCurrentScope = NULL;
+
+  static inline void AddCounter(std::atomic<uint64_t>& counter, uint64_t value)
+  {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static inline void CopyCounter(std::atomic<uint64_t>& destination, const std::atomic<uint64_t>& source)
+  {
+    destination.store(source.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+
+  PERFORMANCE_COUNTERS::PERFORMANCE_COUNTERS() :
+    updates(0),
+    total_ns(0),
+    max_ns(0),
+    expansions(0),
+    filesystem_probes(0),
+    exprtk_evaluations(0),
+    plugin_calls(0),
+    plugin_ns(0)
+  {
+  }
+
+  PERFORMANCE_COUNTERS::PERFORMANCE_COUNTERS(const PERFORMANCE_COUNTERS& other)
+  {
+    (*this) = other;
+  }
+
+  PERFORMANCE_COUNTERS& PERFORMANCE_COUNTERS::operator=(const PERFORMANCE_COUNTERS& other)
+  {
+    if (this != &other)
+    {
+      CopyCounter(updates, other.updates);
+      CopyCounter(total_ns, other.total_ns);
+      CopyCounter(max_ns, other.max_ns);
+      CopyCounter(expansions, other.expansions);
+      CopyCounter(filesystem_probes, other.filesystem_probes);
+      CopyCounter(exprtk_evaluations, other.exprtk_evaluations);
+      CopyCounter(plugin_calls, other.plugin_calls);
+      CopyCounter(plugin_ns, other.plugin_ns);
+    }
+    return (*this);
+  }
+
+  PerformanceCounters::Scope::Scope(PERFORMANCE_COUNTERS& counters, bool plugin_callback) :
+    mCounters(NULL),
+    mParent(NULL),
+    mPluginCallback(plugin_callback)
+  {
+    if (!gPerformanceCountersEnabled.load(std::memory_order_relaxed))
+      return;
+
+    mCounters = &counters;
+    mParent = tCurrentScope;
+    memset(&mWork, 0, sizeof(mWork));
+    tCurrentScope = this;
+    mStart = std::chrono::steady_clock::now();
+  }
+
+  PerformanceCounters::Scope::~Scope()
+  {
+    if (mCounters == NULL)
+      return;
+
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - mStart;
+    uint64_t elapsed_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    if (mPluginCallback)
+    {
+      mWork.plugin_calls++;
+      mWork.plugin_ns += elapsed_ns;
+    }
+
+    // The counters of an object may be updated by multiple threads at the same time
+    AddCounter(mCounters->updates, 1);
+    AddCounter(mCounters->total_ns, elapsed_ns);
+    uint64_t max_ns = mCounters->max_ns.load(std::memory_order_relaxed);
+    while (elapsed_ns > max_ns && !mCounters->max_ns.compare_exchange_weak(max_ns, elapsed_ns, std::memory_order_relaxed))
+    {
+    }
+    AddCounter(mCounters->expansions, mWork.expansions);
+    AddCounter(mCounters->filesystem_probes, mWork.filesystem_probes);
+    AddCounter(mCounters->exprtk_evaluations, mWork.exprtk_evaluations);
+    AddCounter(mCounters->plugin_calls, mWork.plugin_calls);
+    AddCounter(mCounters->plugin_ns, mWork.plugin_ns);
+
+    // The work of this scope is also the work of the parent scope
+    tCurrentScope = mParent;
+    if (mParent)
+    {
+      mParent->mWork.expansions += mWork.expansions;
+      mParent->mWork.filesystem_probes += mWork.filesystem_probes;
+      mParent->mWork.exprtk_evaluations += mWork.exprtk_evaluations;
+      mParent->mWork.plugin_calls += mWork.plugin_calls;
+      mParent->mWork.plugin_ns += mWork.plugin_ns;
+    }
+  }
+
+  void PerformanceCounters::SetEnabled(bool enabled)
+  {
+    gPerformanceCountersEnabled.store(enabled);
+  }
+
+  bool PerformanceCounters::IsEnabled()
+  {
+    return gPerformanceCountersEnabled.load(std::memory_order_relaxed);
+  }
+
+  void PerformanceCounters::AddExpansion()
+  {
+    if (tCurrentScope)
+      tCurrentScope->mWork.expansions++;
+  }
+
+  void PerformanceCounters::AddFilesystemProbe()
+  {
+    if (tCurrentScope)
+      tCurrentScope->mWork.filesystem_probes++;
+  }
+
+  void PerformanceCounters::AddExprtkEvaluation()
+  {
+    if (tCurrentScope)
+      tCurrentScope->mWork.exprtk_evaluations++;
+  }
+
+  void PerformanceCounters::Reset(PERFORMANCE_COUNTERS& counters)
+  {
+    counters = PERFORMANCE_COUNTERS();
+  }
+
+  void PerformanceCounters::ToString(const PERFORMANCE_COUNTERS& counters, std::string& str)
+  {
+    // read each counter once
+    const PERFORMANCE_COUNTERS snapshot = counters;
+
+    double total_us = snapshot.total_ns / 1000.0;
+    double max_us = snapshot.max_ns / 1000.0;
+    double average_us = (snapshot.updates > 0 ? total_us / snapshot.updates : 0.0);
+    double plugin_us = snapshot.plugin_ns / 1000.0;
+
+    str += "updates=" + ra::strings::ToString(snapshot.updates);
+    str += ", total=" + ra::strings::Format("%.3f", total_us) + " us";
+    str += ", average=" + ra::strings::Format("%.3f", average_us) + " us";
+    str += ", max=" + ra::strings::Format("%.3f", max_us) + " us";
+    str += ", expansions=" + ra::strings::ToString(snapshot.expansions);
+    str += ", filesystem probes=" + ra::strings::ToString(snapshot.filesystem_probes);
+    str += ", exprtk evaluations=" + ra::strings::ToString(snapshot.exprtk_evaluations);
+    str += ", plugin calls=" + ra::strings::ToString(snapshot.plugin_calls);
+    str += ", plugin time=" + ra::strings::Format("%.3f", plugin_us) + " us";
+  }
+
+} //namespace shellanything
@@ -0,0 +1,160 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_PERFORMANCE_COUNTERS_H
+#define SA_PERFORMANCE_COUNTERS_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <stdint.h>
+#include <string>
+#include <chrono>
+#include <atomic>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// Counters that measure the cost of updating an object (a menu, a validator, a configuration file or a plugin).
+  /// The counters of an object include the work of the nested scopes. See PerformanceCounters::Scope.
+  /// The counters of an object can be updated and read by multiple threads. Each counter is a relaxed atomic value.
+  /// A copy is a snapshot of each counter. The counters of a copy may not be consistent with each other.
+  /// </summary>
+  struct SHELLANYTHING_EXPORT PERFORMANCE_COUNTERS
+  {
+    ///<summary>The number of times the object was updated or validated.</summary>
+    std::atomic<uint64_t> updates;
+    ///<summary>The cumulative time spent updating the object, in nanoseconds.</summary>
+    std::atomic<uint64_t> total_ns;
+    ///<summary>The longest time spent updating the object, in nanoseconds.</summary>
+    std::atomic<uint64_t> max_ns;
+    ///<summary>The number of property expansions performed.</summary>
+    std::atomic<uint64_t> expansions;
+    ///<summary>The number of files or directories queried on the filesystem.</summary>
+    std::atomic<uint64_t> filesystem_probes;
+    ///<summary>The number of exprtk expressions evaluated.</summary>
+    std::atomic<uint64_t> exprtk_evaluations;
+    ///<summary>The number of plugin callbacks executed.</summary>
+    std::atomic<uint64_t> plugin_calls;
+    ///<summary>The cumulative time spent in plugin callbacks, in nanoseconds.</summary>
+    std::atomic<uint64_t> plugin_ns;
+
+    PERFORMANCE_COUNTERS();
+    PERFORMANCE_COUNTERS(const PERFORMANCE_COUNTERS& other);
+    PERFORMANCE_COUNTERS& operator=(const PERFORMANCE_COUNTERS& other);
+  };
+
+  /// <summary>
+  /// Helper class for accumulating PERFORMANCE_COUNTERS.
+  /// </summary>
+  class SHELLANYTHING_EXPORT PerformanceCounters
+  {
+  public:
+    /// <summary>
+    /// Measures a scope of code and accumulates the result in the counters of an object.
+    /// The work reported with AddExpansion(), AddFilesystemProbe() and AddExprtkEvaluation() is
+    /// attributed to the innermost scope of the calling thread and to all its parent scopes.
+    /// The scope does nothing if performance counters are disabled.
+    /// </summary>
+    class SHELLANYTHING_EXPORT Scope
+    {
+    public:
+      /// <summary>
+      /// Enter a new scope.
+      /// </summary>
+      /// <param name="counters">The counters of the measured object.</param>
+      /// <param name="plugin_callback">True if the scope measures a plugin callback.</param>
+      Scope(PERFORMANCE_COUNTERS& counters, bool plugin_callback = false);
+      ~Scope();
+
+    private:
+      // Disable copy constructor and copy operator
+      Scope(const Scope&);
+      Scope& operator=(const Scope&);
+
+      friend class PerformanceCounters;
+
+      struct WORK
+      {
+        uint64_t expansions;
+        uint64_t filesystem_probes;
+        uint64_t exprtk_evaluations;
+        uint64_t plugin_calls;
+        uint64_t plugin_ns;
+      };
+
+    private:
+      PERFORMANCE_COUNTERS* mCounters;
+      Scope* mParent;
+      bool mPluginCallback;
+      std::chrono::steady_clock::time_point mStart;
+      WORK mWork; // work reported while this scope is the innermost scope. Only accessed by the calling thread.
+    };
+
+    /// <summary>
+    /// Enable or disable performance counters.
+    /// Performance counters are disabled by default.
+    /// </summary>
+    /// <param name="enabled">The new state of performance counters.</param>
+    static void SetEnabled(bool enabled);
+
+    /// <summary>
+    /// Check if performance counters are enabled.
+    /// </summary>
+    /// <returns>Returns true if performance counters are enabled. Returns false otherwise.</returns>
+    static bool IsEnabled();
+
+    /// <summary>
+    /// Report a property expansion to the current scope.
+    /// </summary>
+    static void AddExpansion();
+
+    /// <summary>
+    /// Report a file or directory query to the current scope.
+    /// </summary>
+    static void AddFilesystemProbe();
+
+    /// <summary>
+    /// Report an exprtk evaluation to the current scope.
+    /// </summary>
+    static void AddExprtkEvaluation();
+
+    /// <summary>
+    /// Reset the given counters to zero.
+    /// </summary>
+    /// <param name="counters">The counters to reset.</param>
+    static void Reset(PERFORMANCE_COUNTERS& counters);
+
+    /// <summary>
+    /// Get a description of the given counters.
+    /// </summary>
+    /// <param name="counters">The counters to describe.</param>
+    /// <param name="str">The output string.</param>
+    static void ToString(const PERFORMANCE_COUNTERS& counters, std::string& str);
+  };
+
+} //namespace shellanything
+
+#endif //SA_PERFORMANCE_COUNTERS_H
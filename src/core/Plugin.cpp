@@ -37,6 +37,7 @@
 #include "../api/sa_error.cpp"  // to get a local implementation for sa_error_get_error_description()
 
 #include <Windows.h>
+#include <mutex>
 
 #define xstr(a) str(a)
 #define str(a) #a
@@ -52,6 +53,7 @@ namespace shellanything
   };
 
   Plugin* gLoadingPlugin = NULL;
+  static std::mutex gLoadingPluginMutex; // plugins are loaded and unloaded one at a time. Configurations are loaded by multiple threads.
 
   Plugin* Plugin::GetLoadingPlugin()
   {
@@ -61,7 +63,8 @@ namespace shellanything
   Plugin::Plugin() :
     mParentConfigFile(NULL),
     mLoaded(false),
-    mEntryPoints(new Plugin::ENTRY_POINTS)
+    mEntryPoints(new Plugin::ENTRY_POINTS),
+    mPerformanceCounters()
   {
     memset(mEntryPoints, 0, sizeof(Plugin::ENTRY_POINTS));
   }
@@ -92,6 +95,7 @@ namespace shellanything
       // do not copy loaded properties this is instance specific.
       // mEntryPoints skipped on purpose for hModule safety
       // mRegistry skipped on purpose
+      PerformanceCounters::Reset(mPerformanceCounters);
       mLoaded = false;
     }
     return (*this);
@@ -235,6 +239,7 @@ namespace shellanything
     }
 
     // remember this plugin while loading. This is required for plugins that registers features through the API.
+    std::unique_lock<std::mutex> loading_lock(gLoadingPluginMutex);
     gLoadingPlugin = this;
 
     //initialize & register the plugin
@@ -259,6 +264,7 @@ namespace shellanything
       return false;
     }
     gLoadingPlugin = NULL;
+    loading_lock.unlock();
 
     // this plugin is valid.
     this->mEntryPoints->hModule = hModule;
@@ -301,6 +307,7 @@ namespace shellanything
     bool success = true;
 
     // remember this plugin while unloading. This is required for plugins that calls the API.
+    std::unique_lock<std::mutex> loading_lock(gLoadingPluginMutex);
     gLoadingPlugin = this;
 
     sa_error_t terminate_error = this->mEntryPoints->terminate_func();
@@ -313,6 +320,7 @@ namespace shellanything
     }
 
     gLoadingPlugin = NULL;
+    loading_lock.unlock();
 
     mRegistry.Clear();
 
@@ -328,6 +336,21 @@ namespace shellanything
     return mRegistry;
   }
 
+  PERFORMANCE_COUNTERS& Plugin::GetPerformanceCounters()
+  {
+    return mPerformanceCounters;
+  }
+
+  const PERFORMANCE_COUNTERS& Plugin::GetPerformanceCounters() const
+  {
+    return mPerformanceCounters;
+  }
+
+  void Plugin::ResetPerformanceCounters()
+  {
+    PerformanceCounters::Reset(mPerformanceCounters);
+  }
+
   Plugin* Plugin::FindPluginByConditionName(const PluginPtrList& plugins, const std::string& name)
   {
     PropertyManager& pmgr = PropertyManager::GetInstance();
@@ -29,6 +29,7 @@
 #include "shellanything/config.h"
 #include "SelectionContext.h"
 #include "Registry.h"
+#include "PerformanceCounters.h"
 #include <string>
 #include <vector>
 
@@ -153,6 +154,19 @@ namespace shellanything
     /// <returns>Returns this plugin Registry class.</returns>
     Registry& GetRegistry();
 
+    /// <summary>
+    /// Get the performance counters of this plugin. See PerformanceCounters.
+    /// The counters measure the callbacks of the plugin that are executed while updating menus.
+    /// </summary>
+    /// <returns>Returns the performance counters of this plugin.</returns>
+    PERFORMANCE_COUNTERS& GetPerformanceCounters();
+    const PERFORMANCE_COUNTERS& GetPerformanceCounters() const;
+
+    /// <summary>
+    /// Reset the performance counters of this plugin.
+    /// </summary>
+    void ResetPerformanceCounters();
+
     /// <summary>
     /// Find a plugin which has a condition field matching the given name.
     /// </summary>
@@ -182,6 +196,7 @@ namespace shellanything
     struct ENTRY_POINTS;
     ENTRY_POINTS* mEntryPoints;
     Registry mRegistry;
+    PERFORMANCE_COUNTERS mPerformanceCounters;
   };
 
 
@@ -0,0 +1,239 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PollingFileWatcherService.h"
+#include "LoggerHelper.h"
+
+#include "rapidassist/strings.h"
+#include "rapidassist/filesystem_utf8.h"
+
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace shellanything
+{
+  const uint32_t PollingFileWatcherService::DEFAULT_POLLING_INTERVAL = 2000;
+
+  /// <summary>
+  /// The last known content of a watched directory.
+  /// </summary>
+  struct DIRECTORY_SIGNATURE
+  {
+    bool exists;
+    size_t count;   // number of files and directories
+    uint64_t hash;  // hash of the path and modified date of all files and directories
+  };
+
+  inline bool operator==(const DIRECTORY_SIGNATURE& a, const DIRECTORY_SIGNATURE& b)
+  {
+    return (a.exists == b.exists && a.count == b.count && a.hash == b.hash);
+  }
+
+  inline uint64_t HashFnv1a(uint64_t hash, const void* data, size_t size)
+  {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  static DIRECTORY_SIGNATURE GetDirectorySignature(const std::string& path)
+  {
+    DIRECTORY_SIGNATURE signature;
+    signature.exists = false;
+    signature.count = 0;
+    signature.hash = 0;
+
+    ra::strings::StringVector files;
+    if (!ra::filesystem::DirectoryExistsUtf8(path.c_str()) || !ra::filesystem::FindFilesUtf8(files, path.c_str()))
+      return signature;
+    signature.exists = true;
+    signature.count = files.size();
+
+    // Entries are combined with an addition so that the order of the files does not matter.
+    for (size_t i = 0; i < files.size(); i++)
+    {
+      const std::string& file_path = files[i];
+      uint64_t modified_date = ra::filesystem::GetFileModifiedDateUtf8(file_path);
+
+      uint64_t hash = 14695981039346656037ull;
+      hash = HashFnv1a(hash, file_path.c_str(), file_path.size());
+      hash = HashFnv1a(hash, &modified_date, sizeof(modified_date));
+      signature.hash += hash;
+    }
+
+    return signature;
+  }
+
+  typedef std::map<std::string, DIRECTORY_SIGNATURE> DirectorySignatureMap;
+
+  struct PollingFileWatcherService::STATE
+  {
+    uint32_t interval;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    bool stopping;
+    DirectorySignatureMap directories;
+    std::set<std::string> changes;
+
+    STATE() : interval(0), stopping(false) {}
+  };
+
+  PollingFileWatcherService::PollingFileWatcherService() :
+    mState(new STATE())
+  {
+    mState->interval = DEFAULT_POLLING_INTERVAL;
+  }
+
+  PollingFileWatcherService::PollingFileWatcherService(uint32_t interval) :
+    mState(new STATE())
+  {
+    mState->interval = interval;
+  }
+
+  PollingFileWatcherService::~PollingFileWatcherService()
+  {
+    // Stop the background thread
+    {
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      mState->stopping = true;
+    }
+    mState->condition.notify_all();
+    if (mState->thread.joinable())
+      mState->thread.join();
+
+    delete mState;
+    mState = NULL;
+  }
+
+  bool PollingFileWatcherService::Watch(const std::string& path)
+  {
+    if (IsWatching(path))
+      return true; // already watching
+
+    DIRECTORY_SIGNATURE signature = GetDirectorySignature(path);
+    if (!signature.exists)
+    {
+      SA_LOG(WARNING) << "Failed watching directory '" << path << "'. Directory not found.";
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    mState->directories[path] = signature;
+
+    // Start scanning in the background on the first watched directory.
+    if (mState->interval > 0 && !mState->thread.joinable())
+    {
+      STATE* state = mState;
+      mState->thread = std::thread([this, state]()
+      {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (!state->stopping)
+        {
+          state->condition.wait_for(lock, std::chrono::milliseconds(state->interval));
+          if (state->stopping)
+            break;
+
+          lock.unlock();
+          Poll();
+          lock.lock();
+        }
+      });
+    }
+
+    return true;
+  }
+
+  bool PollingFileWatcherService::Unwatch(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    mState->changes.erase(path);
+    return (mState->directories.erase(path) > 0);
+  }
+
+  void PollingFileWatcherService::UnwatchAll()
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    mState->changes.clear();
+    mState->directories.clear();
+  }
+
+  bool PollingFileWatcherService::IsWatching(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return (mState->directories.find(path) != mState->directories.end());
+  }
+
+  bool PollingFileWatcherService::GetChanges(StringList& directories)
+  {
+    directories.clear();
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    directories.assign(mState->changes.begin(), mState->changes.end());
+    mState->changes.clear();
+    return !directories.empty();
+  }
+
+  uint32_t PollingFileWatcherService::GetPollingInterval() const
+  {
+    return mState->interval;
+  }
+
+  void PollingFileWatcherService::Poll()
+  {
+    // Copy the list of directories. Directories are scanned without holding the lock.
+    StringList paths;
+    {
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      for (DirectorySignatureMap::const_iterator it = mState->directories.begin(); it != mState->directories.end(); it++)
+        paths.push_back(it->first);
+    }
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+      const std::string& path = paths[i];
+      DIRECTORY_SIGNATURE signature = GetDirectorySignature(path);
+
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      DirectorySignatureMap::iterator it = mState->directories.find(path);
+      if (it == mState->directories.end())
+        continue; // no longer watched
+      if (it->second == signature)
+        continue;
+
+      SA_VERBOSE_LOG(INFO) << "Detected changes in directory '" << path << "'.";
+      it->second = signature;
+      mState->changes.insert(path);
+    }
+  }
+
+} //namespace shellanything
@@ -0,0 +1,88 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_POLLING_FILE_WATCHER_SERVICE_H
+#define SA_POLLING_FILE_WATCHER_SERVICE_H
+
+#include "IFileWatcherService.h"
+
+#include <stdint.h>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// Polling implementation class of IFileWatcherService.
+  /// Watched directories are scanned periodically by a background thread.
+  /// A directory has changed when the list of its files or their modified dates are different from the previous scan.
+  /// Used as a fallback when the operating system does not provide change notifications.
+  /// </summary>
+  class SHELLANYTHING_EXPORT PollingFileWatcherService : public IFileWatcherService
+  {
+  public:
+    /// <summary>
+    /// Default interval in milliseconds between two scans of the watched directories.
+    /// </summary>
+    static const uint32_t DEFAULT_POLLING_INTERVAL;
+
+    PollingFileWatcherService();
+
+    /// <summary>
+    /// Create a service with a custom polling interval.
+    /// </summary>
+    /// <param name="interval">The interval in milliseconds between two scans. Set to 0 to disable the background thread. See Poll().</param>
+    PollingFileWatcherService(uint32_t interval);
+    virtual ~PollingFileWatcherService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    PollingFileWatcherService(const PollingFileWatcherService&);
+    PollingFileWatcherService& operator=(const PollingFileWatcherService&);
+  public:
+
+    virtual bool Watch(const std::string& path);
+    virtual bool Unwatch(const std::string& path);
+    virtual void UnwatchAll();
+    virtual bool IsWatching(const std::string& path);
+    virtual bool GetChanges(StringList& directories);
+
+    /// <summary>
+    /// Get the interval in milliseconds between two scans of the watched directories.
+    /// </summary>
+    uint32_t GetPollingInterval() const;
+
+    /// <summary>
+    /// Scan all watched directories for changes.
+    /// This function is called periodically by the background thread.
+    /// </summary>
+    void Poll();
+
+  private:
+    struct STATE;
+    STATE* mState;
+  };
+
+} //namespace shellanything
+
+#endif //SA_POLLING_FILE_WATCHER_SERVICE_H
@@ -28,6 +28,7 @@
 #include "SelectionContext.h"
 #include "LoggerHelper.h"
 #include "RandomHelper.h"
+#include "PerformanceCounters.h"
 
 #include "shellanything/version.h"
 
@@ -38,6 +39,9 @@
 namespace shellanything
 {
   static const int EXPANDING_MAX_ITERATIONS = 20;
+  static const size_t TEMPLATE_CACHE_MAX_SIZE = 4096;
+  static const std::string TOKEN_OPEN = "${";
+  static const std::string TOKEN_CLOSE = "}";
 
   static const std::string EMPTY_VALUE;
 
@@ -57,13 +61,22 @@ namespace shellanything
   const std::string PropertyManager::SYSTEM_LOGGING_VERBOSE_PROPERTY_NAME = "system.logging.verbose";
 
   PropertyManager::PropertyManager() :
-    mInitialized(false)
+    mInitialized(false),
+    mTemplateCacheEnabled(true),
+    mTemplateDepth(0),
+    mRecordedNames(NULL),
+    mRecordedVolatile(false),
+    mLiveReadCount(0),
+    mGeneration(0),
+    mClearGeneration(0)
   {
   }
 
   PropertyManager::~PropertyManager()
   {
     ClearLiveProperties();
+    ClearLazyProperties();
+    ClearTemplateCache();
   }
 
   PropertyManager& PropertyManager::GetInstance()
@@ -71,6 +84,9 @@ namespace shellanything
     static PropertyManager _instance;
     if (!_instance.mInitialized)
     {
+      std::lock_guard<std::recursive_mutex> lock(_instance.mMutex);
+      if (_instance.mInitialized)
+        return _instance;
       _instance.mInitialized = true;
 
       // Initialize PropertyManager with default properties.
@@ -85,19 +101,44 @@ namespace shellanything
 
   void PropertyManager::Clear()
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     properties.Clear();
+    ClearLazyProperties();
+
+    //All properties are modified
+    mGeneration++;
+    mClearGeneration = mGeneration;
+    mGenerations.clear();
+    InvalidateTemplates();
+    LoggerHelper::InvalidateVerboseLoggingCache();
+
     RegisterEnvironmentVariables();
     RegisterFixedAndDefaultProperties();
   }
 
   void PropertyManager::ClearProperty(const std::string& name)
   {
-    properties.ClearProperty(name);
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    bool found = DeleteLazyProperty(name);
+    if (properties.HasProperty(name))
+    {
+      properties.ClearProperty(name);
+      found = true;
+    }
+
+    if (found)
+      OnPropertyChanged(name);
   }
 
   bool PropertyManager::HasProperty(const std::string& name) const
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    if (mRecordedNames)
+      mRecordedNames->push_back(name);
+
     bool found = properties.HasProperty(name);
+    if (!found)
+      found = (lazy_properties.find(name) != lazy_properties.end());
     if (!found)
       found = (GetLiveProperty(name) != NULL);
     return found;
@@ -116,6 +157,7 @@ namespace shellanything
 
   void PropertyManager::SetProperty(const std::string& name, const std::string& value)
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     // Prevent polluting the PropertyStore with live property names
     bool found = (GetLiveProperty(name) != NULL);
     if (found)
@@ -123,29 +165,74 @@ namespace shellanything
 
     SA_VERBOSE_LOG(INFO) << "Setting property '" << name << "' to value '" << value << "'.";
 
+    // A regular value overrides a lazy property
+    if (DeleteLazyProperty(name))
+    {
+      properties.SetProperty(name, value);
+      OnPropertyChanged(name);
+      return;
+    }
+
+    // Setting a property to its current value does not invalidate the expressions that depends on it.
+    const std::string* previous_value = NULL;
+    if (properties.TryGetProperty(name, previous_value) && (*previous_value) == value)
+      return;
+
     properties.SetProperty(name, value);
+    OnPropertyChanged(name);
   }
 
   std::string PropertyManager::GetProperty(const std::string& name) const
   {
+    std::string value;
+    TryGetProperty(name, value);
+    return value;
+  }
+
+  bool PropertyManager::TryGetProperty(const std::string& name, std::string& value) const
+  {
+    return TryGetProperty(name, PropertyStore::Hash(name), value);
+  }
+
+  bool PropertyManager::TryGetProperty(const std::string& name, size_t hash, std::string& value) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    if (mRecordedNames)
+      mRecordedNames->push_back(name);
+
     // Search within exiting properties
-    bool found = properties.HasProperty(name);
+    const std::string* store_value = NULL;
+    bool found = properties.TryGetProperty(name, hash, store_value);
     if (found)
     {
-      const std::string& value = properties.GetProperty(name);
-      return value;
+      value = (*store_value);
+      return true;
+    }
+
+    // Search within lazy properties. The instance computes its value on the first call.
+    LivePropertyMap::const_iterator lazyIt = lazy_properties.find(name);
+    if (lazyIt != lazy_properties.end())
+    {
+      const ILiveProperty* p = lazyIt->second;
+      value = p->GetProperty();
+      return true;
     }
 
     // Search within live properties
     const ILiveProperty* p = GetLiveProperty(name);
     if (p)
     {
-      std::string value = p->GetProperty();
+      // The value of a live property may change at any time.
+      mRecordedVolatile = true;
+      mLiveReadCount++;
+
+      value = p->GetProperty();
       SA_VERBOSE_LOG(INFO) << "Live property '" << name << "' evaluates to value '" << value << "'.";
-      return value;
+      return true;
     }
 
-    return EMPTY_VALUE;
+    value = EMPTY_VALUE;
+    return false;
   }
 
   void PropertyManager::FindMissingProperties(const StringList& input_names, StringList& output_names) const
@@ -197,36 +284,139 @@ namespace shellanything
 
   std::string PropertyManager::Expand(const std::string& value) const
   {
+    bool is_volatile = false;
+    return Expand(value, is_volatile);
+  }
+
+  std::string PropertyManager::Expand(const std::string& value, bool& is_volatile) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    PerformanceCounters::AddExpansion();
+
     int count = 1;
     std::string previous = value;
-    std::string output = ExpandOnce(value);
+    std::string output;
+
+    if (!mTemplateCacheEnabled)
+    {
+      is_volatile = true;
+      output = ExpandOnce(value);
+
+      //Prevent circular reference by expanding at most 20 times.
+      while (output != previous && count <= EXPANDING_MAX_ITERATIONS)
+      {
+        previous = output;
+        output = ExpandOnce(output);
+        count++;
+      }
+
+      return output;
+    }
+
+    //A value without a token_open cannot be expanded
+    is_volatile = false;
+    if (value.find(TOKEN_OPEN) == std::string::npos)
+      return value;
+
+    PropertyTemplate local;
+    PropertyTemplate* tmpl = GetTemplate(value, local);
+
+    //Reuse the previous expanded value if none of its properties were modified.
+    if (tmpl->IsExpandedValueValid())
+    {
+      if (mRecordedNames)
+      {
+        const StringList& dependencies = tmpl->GetDependencies();
+        mRecordedNames->insert(mRecordedNames->end(), dependencies.begin(), dependencies.end());
+      }
+      return tmpl->GetExpandedValue();
+    }
+
+    //Record the properties which are read while expanding the template
+    StringList* parent_recorded_names = mRecordedNames;
+    bool parent_recorded_volatile = mRecordedVolatile;
+    StringList recorded_names;
+    mRecordedNames = &recorded_names;
+    mRecordedVolatile = false;
+    mTemplateDepth++;
+
+    bool done = false;
+    if (tmpl->IsSimple())
+    {
+      ExpandTemplate(*tmpl, output);
+
+      //If the first pass did not produce any new token_open, the next pass would not change the output.
+      done = (output.find(TOKEN_OPEN) == std::string::npos);
+    }
+    else
+      output = ExpandOnce(value);
 
     //Prevent circular reference by expanding at most 20 times.
-    while (output != previous && count <= EXPANDING_MAX_ITERATIONS)
+    while (!done && output != previous && count <= EXPANDING_MAX_ITERATIONS)
     {
       previous = output;
       output = ExpandOnce(output);
       count++;
     }
 
+    mTemplateDepth--;
+    is_volatile = mRecordedVolatile;
+    mRecordedNames = parent_recorded_names;
+    mRecordedVolatile = parent_recorded_volatile || is_volatile;
+    if (mRecordedNames)
+      mRecordedNames->insert(mRecordedNames->end(), recorded_names.begin(), recorded_names.end());
+
+    //Remember the expanded value and register the template as a dependent of each property it has read.
+    if (!is_volatile && tmpl != &local)
+    {
+      tmpl->SetExpandedValue(output, recorded_names);
+      for (size_t i = 0; i < recorded_names.size(); i++)
+      {
+        const std::string& name = recorded_names[i];
+        mDependents[name].insert(tmpl);
+      }
+    }
+
+    return output;
+  }
+
+  std::string PropertyManager::Expand(const std::string& value, bool& is_volatile, StringList& dependencies) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    StringList* parent_recorded_names = mRecordedNames;
+    StringList recorded_names;
+    mRecordedNames = &recorded_names;
+    std::string output = Expand(value, is_volatile);
+    mRecordedNames = parent_recorded_names;
+    if (mRecordedNames)
+      mRecordedNames->insert(mRecordedNames->end(), recorded_names.begin(), recorded_names.end());
+
+    dependencies.insert(dependencies.end(), recorded_names.begin(), recorded_names.end());
     return output;
   }
 
   std::string PropertyManager::ExpandOnce(const std::string& value) const
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     //Process expansion in-place
     std::string output;
     output.reserve(value.size() * 2);
     output = value;
 
-    static const std::string token_open = "${";
-    static const std::string token_close = "}";
+    ExpandOnceFrom(output, 0, 0);
 
+    return output;
+  }
+
+  void PropertyManager::ExpandOnceFrom(std::string& output, size_t offset, int count) const
+  {
     //Prevent circular reference by dfining a counter which counts how many time a character position was expanded.
-    int count = 1;
-    size_t previous_pos = std::string::npos;
+    //The given count is the number of times the character at the given offset was already visited.
+    count--;
+    size_t previous_pos = offset;
 
-    for (size_t i = 0; i < output.size(); i++)
+    for (size_t i = offset; i < output.size(); i++)
     {
       //Count how many time we tried to expand this position
       if (i == previous_pos)
@@ -237,13 +427,13 @@ namespace shellanything
 
       //If we find a property reference token at this location...
       std::string name;
-      if (strncmp(&output[i], token_open.c_str(), token_open.size()) == 0 && IsPropertyReference(token_open, token_close, output, i, name))
+      if (strncmp(&output[i], TOKEN_OPEN.c_str(), TOKEN_OPEN.size()) == 0 && IsPropertyReference(TOKEN_OPEN, TOKEN_CLOSE, output, i, name))
       {
         //Found a property reference at output[i]
         const std::string& property_value = this->GetProperty(name);
 
         //Replace the property reference by the property's value
-        size_t token_length = token_open.size() + name.size() + token_close.size();
+        size_t token_length = TOKEN_OPEN.size() + name.size() + TOKEN_CLOSE.size();
         output.replace(output.begin() + i, output.begin() + i + token_length, property_value);
 
         //Prevent circular reference by expanding 20 times maximum.
@@ -261,12 +451,170 @@ namespace shellanything
         }
       }
     }
+  }
 
-    return output;
+  void PropertyManager::ExpandTemplate(const PropertyTemplate& tmpl, std::string& output) const
+  {
+    //Evaluate the template the same way ExpandOnce() would process the source string.
+    //Literal spans never contains a property reference and are copied as is.
+    //A property value that contains a '$' character may form a new property reference with the following characters.
+    //In this case, the remaining of the string is processed by ExpandOnceFrom() to get the exact same result.
+    const std::string& source = tmpl.GetSource();
+    const PropertyTemplate::SegmentList& segments = tmpl.GetSegments();
+
+    output.clear();
+    output.reserve(source.size() * 2);
+
+    //Count how many time a character position was expanded. Empty property values expands at the same position.
+    int count = 0;
+    size_t count_pos = std::string::npos;
+    std::string property_value;
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+      const PropertyTemplate::SEGMENT& segment = segments[i];
+      if (segment.reference && TryGetProperty(segment.name, segment.hash, property_value))
+      {
+        size_t pos = output.size();
+        if (pos != count_pos)
+        {
+          count = 0; //that is a new character
+          count_pos = pos;
+        }
+
+        output.append(property_value);
+
+        if (property_value.find('$') != std::string::npos || count >= EXPANDING_MAX_ITERATIONS)
+        {
+          //Process the remaining of the string in-place, starting at the expanded position.
+          output.append(source, segment.offset + segment.length, std::string::npos);
+          if (count < EXPANDING_MAX_ITERATIONS)
+            ExpandOnceFrom(output, pos, count + 1);
+          else
+            ExpandOnceFrom(output, pos + 1, 0);
+          return;
+        }
+
+        count++;
+        continue;
+      }
+
+      //Literal span or unknown property reference. Left as is.
+      output.append(source, segment.offset, segment.length);
+    }
+  }
+
+  PropertyTemplate* PropertyManager::GetTemplate(const std::string& value, PropertyTemplate& local) const
+  {
+    //The template cache is shared by all threads. The caller, Expand(), holds the lock.
+    PropertyTemplateMap::iterator it = mTemplates.find(value);
+    if (it != mTemplates.end())
+      return it->second;
+
+    if (mTemplates.size() >= TEMPLATE_CACHE_MAX_SIZE)
+    {
+      //Cached templates cannot be deleted while they are evaluated by a parent call to Expand().
+      if (mTemplateDepth > 0)
+      {
+        local.Parse(value);
+        return &local;
+      }
+
+      SA_VERBOSE_LOG(INFO) << "Template cache is full. Clearing " << mTemplates.size() << " templates.";
+      const_cast<PropertyManager*>(this)->ClearTemplateCache();
+    }
+
+    PropertyTemplate* tmpl = new PropertyTemplate();
+    tmpl->Parse(value);
+    mTemplates[value] = tmpl;
+    return tmpl;
+  }
+
+  void PropertyManager::SetTemplateCacheEnabled(bool enabled)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    mTemplateCacheEnabled = enabled;
+  }
+
+  bool PropertyManager::IsTemplateCacheEnabled() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    return mTemplateCacheEnabled;
+  }
+
+  void PropertyManager::ClearTemplateCache()
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    for (PropertyTemplateMap::iterator it = mTemplates.begin(); it != mTemplates.end(); it++)
+    {
+      PropertyTemplate* tmpl = it->second;
+      delete tmpl;
+    }
+    mTemplates.clear();
+    mDependents.clear();
+  }
+
+  size_t PropertyManager::GetTemplateCacheSize() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    return mTemplates.size();
+  }
+
+  uint64_t PropertyManager::GetGeneration() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    return mGeneration;
+  }
+
+  uint64_t PropertyManager::GetPropertyGeneration(const std::string& name) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    GenerationMap::const_iterator it = mGenerations.find(name);
+    if (it != mGenerations.end())
+      return it->second;
+    return mClearGeneration;
+  }
+
+  uint64_t PropertyManager::GetLiveReadCount() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    return mLiveReadCount;
+  }
+
+  void PropertyManager::OnPropertyChanged(const std::string& name)
+  {
+    mGeneration++;
+    mGenerations[name] = mGeneration;
+
+    if (name == SYSTEM_LOGGING_VERBOSE_PROPERTY_NAME)
+      LoggerHelper::InvalidateVerboseLoggingCache();
+
+    //Invalidate the templates that depends on this property.
+    PropertyTemplateIndex::iterator it = mDependents.find(name);
+    if (it == mDependents.end())
+      return;
+    PropertyTemplateSet& dependents = it->second;
+    for (PropertyTemplateSet::iterator dependentIt = dependents.begin(); dependentIt != dependents.end(); dependentIt++)
+    {
+      PropertyTemplate* tmpl = (*dependentIt);
+      tmpl->InvalidateExpandedValue();
+    }
+    mDependents.erase(it);
+  }
+
+  void PropertyManager::InvalidateTemplates()
+  {
+    for (PropertyTemplateMap::iterator it = mTemplates.begin(); it != mTemplates.end(); it++)
+    {
+      PropertyTemplate* tmpl = it->second;
+      tmpl->InvalidateExpandedValue();
+    }
+    mDependents.clear();
   }
 
   void PropertyManager::AddLiveProperty(ILiveProperty* instance)
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     if (!instance)
       return;
     const std::string& name = instance->GetName();
@@ -274,10 +622,12 @@ namespace shellanything
     SA_VERBOSE_LOG(INFO) << "Registering live property '" << name << "'.";
 
     live_properties[name] = instance;
+    OnPropertyChanged(name);
   }
 
   const ILiveProperty* PropertyManager::GetLiveProperty(const std::string& name) const
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     LivePropertyMap::const_iterator propertyIt = live_properties.find(name);
     bool found = (propertyIt != live_properties.end());
     if (found)
@@ -291,6 +641,7 @@ namespace shellanything
 
   void PropertyManager::GetLivePropertyNames(StringList& names) const
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     names.clear();
     LivePropertyMap::const_iterator it;
     for (it = live_properties.begin(); it != live_properties.end(); it++)
@@ -303,6 +654,7 @@ namespace shellanything
 
   size_t PropertyManager::GetLivePropertyCount() const
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     return live_properties.size();
   }
 
@@ -529,6 +881,7 @@ namespace shellanything
 
   void PropertyManager::RegisterLiveProperties()
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     // Check if a live property instance already exists before adding one
     if (GetLiveProperty(SYSTEM_CLIPBOARD_PROPERTY_NAME) == NULL)            AddLiveProperty(new ClipboardLiveProperty());
     if (GetLiveProperty(SYSTEM_KEYBOARD_CTRL_PROPERTY_NAME) == NULL)        AddLiveProperty(new KeyboardModifierLiveProperty(SYSTEM_KEYBOARD_CTRL_PROPERTY_NAME, KMID_CTRL));
@@ -558,16 +911,89 @@ namespace shellanything
 
   void PropertyManager::ClearLiveProperty(const std::string& name)
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     LivePropertyMap::const_iterator propertyIt = live_properties.find(name);
     bool found = (propertyIt != live_properties.end());
     if (found)
     {
       live_properties.erase(propertyIt);
+      OnPropertyChanged(name);
     }
   }
 
+  void PropertyManager::SetLazyProperty(ILiveProperty* instance)
+  {
+    SetLazyProperty(instance, std::string());
+  }
+
+  void PropertyManager::SetLazyProperty(ILiveProperty* instance, const std::string& key)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    if (!instance)
+      return;
+    const std::string name = instance->GetName();
+
+    // Prevent hiding live properties
+    bool found = (GetLiveProperty(name) != NULL);
+    if (found)
+    {
+      delete instance;
+      return;
+    }
+
+    // The existing property computes the same value. Keep it, with its memoized value.
+    LazyKeyMap::const_iterator keyIt = lazy_keys.find(name);
+    if (!key.empty() && keyIt != lazy_keys.end() && keyIt->second == key)
+    {
+      delete instance;
+      return;
+    }
+
+    SA_VERBOSE_LOG(INFO) << "Setting lazy property '" << name << "'.";
+
+    DeleteLazyProperty(name);
+    properties.ClearProperty(name);
+    lazy_properties[name] = instance;
+    if (!key.empty())
+      lazy_keys[name] = key;
+    OnPropertyChanged(name);
+  }
+
+  bool PropertyManager::IsLazyProperty(const std::string& name) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    bool found = (lazy_properties.find(name) != lazy_properties.end());
+    return found;
+  }
+
+  bool PropertyManager::DeleteLazyProperty(const std::string& name)
+  {
+    LivePropertyMap::iterator propertyIt = lazy_properties.find(name);
+    bool found = (propertyIt != lazy_properties.end());
+    if (found)
+    {
+      const ILiveProperty* instance = propertyIt->second;
+      lazy_properties.erase(propertyIt);
+      lazy_keys.erase(name);
+      delete instance;
+    }
+    return found;
+  }
+
+  void PropertyManager::ClearLazyProperties()
+  {
+    for (LivePropertyMap::const_iterator it = lazy_properties.begin(); it != lazy_properties.end(); ++it)
+    {
+      const ILiveProperty* instance = (it->second);
+      delete instance;
+    }
+    lazy_properties.clear();
+    lazy_keys.clear();
+  }
+
   void PropertyManager::ClearLiveProperties()
   {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     for (LivePropertyMap::const_iterator it = live_properties.begin(); it != live_properties.end(); ++it)
     {
       const std::string& key = (it->first);
@@ -575,6 +1001,9 @@ namespace shellanything
       delete instance;
     }
     live_properties.clear();
+
+    mGeneration++;
+    InvalidateTemplates();
   }
 
   void PropertyManager::SplitAndExpand(const std::string& input_value, const char* separator, StringList& output_list)
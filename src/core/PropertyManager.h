@@ -29,15 +29,25 @@
 #include "shellanything/config.h"
 #include "StringList.h"
 #include "PropertyStore.h"
+#include "PropertyTemplate.h"
 #include "ILiveProperty.h"
 #include <string>
 #include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
 
 namespace shellanything
 {
   /// <summary>
   /// Manages the property system
   /// </summary>
+  /// <remarks>
+  /// The manager is shared by all threads. Every public method locks the manager, including the const methods
+  /// that update the template cache. Lazy properties are evaluated while the lock is held: they must not wait
+  /// for another thread that uses the PropertyManager.
+  /// </remarks>
   class SHELLANYTHING_EXPORT PropertyManager
   {
   public:
@@ -56,6 +66,11 @@ namespace shellanything
     // Typedef
     //------------------------
     typedef std::map<std::string /*name*/, ILiveProperty * /*ptr*/> LivePropertyMap;
+    typedef std::map<std::string /*source*/, PropertyTemplate * /*ptr*/> PropertyTemplateMap;
+    typedef std::set<PropertyTemplate * /*ptr*/> PropertyTemplateSet;
+    typedef std::map<std::string /*name*/, PropertyTemplateSet /*dependents*/> PropertyTemplateIndex;
+    typedef std::map<std::string /*name*/, uint64_t /*generation*/> GenerationMap;
+    typedef std::map<std::string /*name*/, std::string /*key*/> LazyKeyMap;
 
     /// <summary>
     /// Name of the property that defines the system true.
@@ -171,6 +186,14 @@ namespace shellanything
     /// <returns>Returns value of the property if the property is set. Returns an empty string otherwise.</returns>
     std::string GetProperty(const std::string& name) const;
 
+    /// <summary>
+    /// Gets the value of the given property name with a single lookup.
+    /// </summary>
+    /// <param name="name">The name of the property to get.</param>
+    /// <param name="value">The output value of the property. Set to an empty string if the property is not set.</param>
+    /// <returns>Returns true if the property is set. Returns false otherwise.</returns>
+    bool TryGetProperty(const std::string& name, std::string& value) const;
+
     /// <summary>
     /// Find the list of properties which are not in the store.
     /// </summary>
@@ -189,6 +212,32 @@ namespace shellanything
     /// <returns>Returns a copy of the given value with the property references expanded.</returns>
     std::string Expand(const std::string& value) const;
 
+    /// <summary>
+    /// Expands the given string by replacing property variable reference by the actual variable's value.
+    /// See Expand() for details.
+    /// </summary>
+    /// <remarks>
+    /// An expanded value is volatile if it depends on a live property. A volatile value must be expanded again on each use.
+    /// A non-volatile value stays valid as long as GetGeneration() returns the same value.
+    /// </remarks>
+    /// <param name="value">The given value to expand.</param>
+    /// <param name="is_volatile">The output volatile state of the expanded value.</param>
+    /// <returns>Returns a copy of the given value with the property references expanded.</returns>
+    std::string Expand(const std::string& value, bool& is_volatile) const;
+
+    /// <summary>
+    /// Expands the given string and reports the properties it depends on.
+    /// See Expand() for details.
+    /// </summary>
+    /// <remarks>
+    /// A non-volatile value stays valid as long as GetPropertyGeneration() returns the same value for each name in dependencies.
+    /// </remarks>
+    /// <param name="value">The given value to expand.</param>
+    /// <param name="is_volatile">The output volatile state of the expanded value.</param>
+    /// <param name="dependencies">The names of the properties that were read while expanding the value are appended to this list.</param>
+    /// <returns>Returns a copy of the given value with the property references expanded.</returns>
+    std::string Expand(const std::string& value, bool& is_volatile, StringList& dependencies) const;
+
     /// <summary>
     /// Expands the given string by replacing property variable reference by the actual variable's value.
     /// The syntax of a property variable reference is the following: `${variable-name}` where `variable-name` is the name of a variable.
@@ -200,6 +249,76 @@ namespace shellanything
     /// <returns>Returns a copy of the given value with the property references expanded.</returns>
     std::string ExpandOnce(const std::string& value) const;
 
+    /// <summary>
+    /// Enable or disable the compiled template mode of Expand().
+    /// When enabled, each string is parsed once into a PropertyTemplate which is cached by source string.
+    /// The expanded results are identical in both modes.
+    /// </summary>
+    /// <param name="enabled">The new state of the compiled template mode.</param>
+    void SetTemplateCacheEnabled(bool enabled);
+
+    /// <summary>
+    /// Check if the compiled template mode of Expand() is enabled.
+    /// </summary>
+    /// <returns>Returns true if the compiled template mode is enabled. Returns false otherwise.</returns>
+    bool IsTemplateCacheEnabled() const;
+
+    /// <summary>
+    /// Destroys all the cached PropertyTemplate instances.
+    /// </summary>
+    void ClearTemplateCache();
+
+    /// <summary>
+    /// Get the number of PropertyTemplate instances in the cache.
+    /// </summary>
+    size_t GetTemplateCacheSize() const;
+
+    /// <summary>
+    /// Get the generation of the manager.
+    /// The generation is increased each time the value of a property is modified, created or deleted.
+    /// Setting a property to its current value does not modify the generation.
+    /// </summary>
+    uint64_t GetGeneration() const;
+
+    /// <summary>
+    /// Get the generation of the given property.
+    /// The returned value is the manager's generation at the time the value of the property was last modified.
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    uint64_t GetPropertyGeneration(const std::string& name) const;
+
+    /// <summary>
+    /// Get the number of times the value of a live property was read.
+    /// A value computed between two calls that return the same count does not depend on a live property.
+    /// </summary>
+    uint64_t GetLiveReadCount() const;
+
+    /// <summary>
+    /// Add a lazy property to the manager. The manager takes ownership of the instance.
+    /// A lazy property behaves like a regular property but its value is only computed when the property is read.
+    /// The instance must memoize its value and always return the same value.
+    /// Setting or clearing a property with the same name deletes the instance.
+    /// </summary>
+    /// <param name="instance">The given instance to add.</param>
+    void SetLazyProperty(ILiveProperty* instance);
+
+    /// <summary>
+    /// Add a lazy property to the manager. The manager takes ownership of the instance.
+    /// The key identifies the inputs used by the instance to compute its value.
+    /// If a lazy property with the same name and the same key is already set, the given instance is deleted
+    /// and the property is not modified. Expressions and states which depends on the property stay valid.
+    /// </summary>
+    /// <param name="instance">The given instance to add.</param>
+    /// <param name="key">The key of the inputs of the instance. An empty key always replaces the existing property.</param>
+    void SetLazyProperty(ILiveProperty* instance, const std::string& key);
+
+    /// <summary>
+    /// Check if the given property is a lazy property. See SetLazyProperty().
+    /// </summary>
+    /// <param name="name">The name of the property to check.</param>
+    /// <returns>Returns true if the property is a lazy property. Returns false otherwise.</returns>
+    bool IsLazyProperty(const std::string& name) const;
+
     /// <summary>
     /// Add a live property to the manager. The manager takes ownership of the instance.
     /// </summary>
@@ -261,9 +380,30 @@ namespace shellanything
 
     void RegisterEnvironmentVariables();
     void RegisterFixedAndDefaultProperties();
-    bool mInitialized; // to prevent calling PropertyManager::GetInstance() while in PropertyManager ctor, creating a circular reference.
+    PropertyTemplate* GetTemplate(const std::string& value, PropertyTemplate& local) const;
+    bool TryGetProperty(const std::string& name, size_t hash, std::string& value) const;
+    void ExpandTemplate(const PropertyTemplate& tmpl, std::string& output) const;
+    void ExpandOnceFrom(std::string& output, size_t offset, int count) const;
+    void OnPropertyChanged(const std::string& name);
+    bool DeleteLazyProperty(const std::string& name);
+    void ClearLazyProperties();
+    void InvalidateTemplates();
+    std::atomic<bool> mInitialized; // to prevent calling PropertyManager::GetInstance() while in PropertyManager ctor, creating a circular reference.
     PropertyStore properties;
     LivePropertyMap live_properties;
+    LivePropertyMap lazy_properties;
+    LazyKeyMap lazy_keys; // key of the inputs of each lazy property
+    bool mTemplateCacheEnabled;
+    mutable PropertyTemplateMap mTemplates;
+    mutable int mTemplateDepth; // number of nested calls to Expand() which are using a cached template.
+    mutable PropertyTemplateIndex mDependents; // reverse index of the templates which expanded value depends on a property.
+    mutable StringList* mRecordedNames; // names of the properties read while expanding a template.
+    mutable bool mRecordedVolatile; // true if a live property was read while expanding a template.
+    mutable uint64_t mLiveReadCount;
+    uint64_t mGeneration;
+    uint64_t mClearGeneration; // generation of the last call to Clear().
+    GenerationMap mGenerations;
+    mutable std::recursive_mutex mMutex; // guards all members, including the caches updated by the const methods.
   };
 
 } //namespace shellanything
@@ -24,9 +24,29 @@
 
 #include "PropertyStore.h"
 
+#include <algorithm>
+#include <stdint.h>
+
 namespace shellanything
 {
-  PropertyStore::PropertyStore()
+  static const size_t INVALID_SLOT = (size_t)-1;
+  static const size_t MIN_CAPACITY = 16;
+
+  size_t PropertyStore::Hash(const std::string& name)
+  {
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < name.size(); i++)
+    {
+      hash ^= (unsigned char)name[i];
+      hash *= 1099511628211ULL;
+    }
+    return (size_t)hash;
+  }
+
+  PropertyStore::PropertyStore() :
+    mCount(0),
+    mUsed(0)
   {
   }
 
@@ -43,30 +63,45 @@ namespace shellanything
   {
     if (this != &store)
     {
-      properties = store.properties;
+      mSlots = store.mSlots;
+      mCount = store.mCount;
+      mUsed = store.mUsed;
     }
     return (*this);
   }
 
   void PropertyStore::Clear()
   {
-    properties.clear();
+    //keep the actual capacity
+    for (size_t i = 0; i < mSlots.size(); i++)
+    {
+      SLOT& slot = mSlots[i];
+      slot.state = SLOT_EMPTY;
+      std::string().swap(slot.name);
+      std::string().swap(slot.value);
+    }
+    mCount = 0;
+    mUsed = 0;
   }
 
   void PropertyStore::ClearProperty(const std::string& name)
   {
-    PropertyMap::const_iterator propertyIt = properties.find(name);
-    bool found = (propertyIt != properties.end());
+    size_t index = FindSlot(name, Hash(name));
+    bool found = (index != INVALID_SLOT);
     if (found)
     {
-      properties.erase(propertyIt);
+      SLOT& slot = mSlots[index];
+      slot.state = SLOT_DELETED;
+      std::string().swap(slot.name);
+      std::string().swap(slot.value);
+      mCount--;
     }
   }
 
   bool PropertyStore::HasProperty(const std::string& name) const
   {
-    PropertyMap::const_iterator propertyIt = properties.find(name);
-    bool found = (propertyIt != properties.end());
+    size_t index = FindSlot(name, Hash(name));
+    bool found = (index != INVALID_SLOT);
     return found;
   }
 
@@ -83,44 +118,92 @@ namespace shellanything
 
   void PropertyStore::SetProperty(const std::string& name, const std::string& value)
   {
+    size_t hash = Hash(name);
+
     //overwrite previous property
-    properties[name] = value;
+    size_t index = FindSlot(name, hash);
+    if (index != INVALID_SLOT)
+    {
+      mSlots[index].value = value;
+      return;
+    }
+
+    //Grow the table to keep the load factor (including deleted slots) under 75%.
+    if ((mUsed + 1) * 4 > mSlots.size() * 3)
+    {
+      size_t capacity = MIN_CAPACITY;
+      while ((mCount + 1) * 2 > capacity)
+        capacity *= 2;
+      Rehash(capacity);
+    }
+
+    //Insert in the first empty or deleted slot
+    size_t mask = mSlots.size() - 1;
+    index = hash & mask;
+    while (mSlots[index].state == SLOT_USED)
+    {
+      index = (index + 1) & mask;
+    }
+
+    SLOT& slot = mSlots[index];
+    if (slot.state == SLOT_EMPTY)
+      mUsed++;
+    slot.name = name;
+    slot.hash = hash;
+    slot.value = value;
+    slot.state = SLOT_USED;
+    mCount++;
   }
 
   const std::string& PropertyStore::GetProperty(const std::string& name) const
   {
-    PropertyMap::const_iterator propertyIt = properties.find(name);
-    bool found = (propertyIt != properties.end());
+    const std::string* value = NULL;
+    bool found = TryGetProperty(name, value);
     if (found)
-    {
-      const std::string& value = propertyIt->second;
-      return value;
-    }
+      return (*value);
 
     static std::string EMPTY_VALUE;
     return EMPTY_VALUE;
   }
 
+  bool PropertyStore::TryGetProperty(const std::string& name, const std::string*& value) const
+  {
+    return TryGetProperty(name, Hash(name), value);
+  }
+
+  bool PropertyStore::TryGetProperty(const std::string& name, size_t hash, const std::string*& value) const
+  {
+    value = NULL;
+    size_t index = FindSlot(name, hash);
+    bool found = (index != INVALID_SLOT);
+    if (found)
+      value = &mSlots[index].value;
+    return found;
+  }
+
   size_t PropertyStore::GetPropertyCount() const
   {
-    return properties.size();
+    return mCount;
   }
 
   bool PropertyStore::IsEmpty() const
   {
-    return properties.empty();
+    return (mCount == 0);
   }
 
   void PropertyStore::GetProperties(StringList& names) const
   {
     names.clear();
-    names.reserve(properties.size());
-    for (PropertyMap::const_iterator it = properties.begin(); it != properties.end(); ++it)
+    names.reserve(mCount);
+    for (size_t i = 0; i < mSlots.size(); i++)
     {
-      const std::string& key = (it->first);
-      const std::string& value = (it->second);
-      names.push_back(key);
+      const SLOT& slot = mSlots[i];
+      if (slot.state == SLOT_USED)
+        names.push_back(slot.name);
     }
+
+    //Keep the names sorted, independently of the hash table order.
+    std::sort(names.begin(), names.end());
   }
 
   void PropertyStore::FindMissingProperties(const StringList& input_names, StringList& output_names) const
@@ -134,4 +217,57 @@ namespace shellanything
     }
   }
 
+  size_t PropertyStore::FindSlot(const std::string& name, size_t hash) const
+  {
+    if (mSlots.empty())
+      return INVALID_SLOT;
+
+    //Linear probing until an empty slot is found
+    size_t mask = mSlots.size() - 1;
+    size_t index = hash & mask;
+    for (size_t i = 0; i < mSlots.size(); i++)
+    {
+      const SLOT& slot = mSlots[index];
+      if (slot.state == SLOT_EMPTY)
+        return INVALID_SLOT;
+      if (slot.state == SLOT_USED && slot.hash == hash && slot.name == name)
+        return index;
+      index = (index + 1) & mask;
+    }
+    return INVALID_SLOT;
+  }
+
+  void PropertyStore::Rehash(size_t capacity)
+  {
+    SLOT empty;
+    empty.hash = 0;
+    empty.state = SLOT_EMPTY;
+
+    SlotList slots;
+    slots.assign(capacity, empty);
+
+    //Move the properties to the new table using the precomputed hash of each name
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < mSlots.size(); i++)
+    {
+      SLOT& slot = mSlots[i];
+      if (slot.state != SLOT_USED)
+        continue;
+
+      size_t index = slot.hash & mask;
+      while (slots[index].state != SLOT_EMPTY)
+      {
+        index = (index + 1) & mask;
+      }
+      SLOT& moved = slots[index];
+      moved.name.swap(slot.name);
+      moved.hash = slot.hash;
+      moved.value.swap(slot.value);
+      moved.state = SLOT_USED;
+    }
+
+    mSlots.swap(slots);
+    mUsed = mCount;
+  }
+
 } //namespace shellanything
@@ -30,12 +30,12 @@
 #include "StringList.h"
 #include <string>
 #include <vector>
-#include <map>
 
 namespace shellanything
 {
   /// <summary>
-  /// Defines a key-value property store
+  /// Defines a key-value property store.
+  /// The store is implemented as an open addressing hash table. Each slot keeps the name of its property with the hash of the name.
   /// </summary>
   class SHELLANYTHING_EXPORT PropertyStore
   {
@@ -49,10 +49,13 @@ namespace shellanything
     /// </summary>
     const PropertyStore& operator =(const PropertyStore& store);
 
-    //------------------------
-    // Typedef
-    //------------------------
-    typedef std::map<std::string /*name*/, std::string /*value*/> PropertyMap;
+    /// <summary>
+    /// Compute the hash value of the given property name.
+    /// A name that is read many times can be hashed once. See TryGetProperty().
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    /// <returns>Returns the hash value of the given name.</returns>
+    static size_t Hash(const std::string& name);
 
     /// <summary>
     /// Clears all the registered properties.
@@ -95,6 +98,23 @@ namespace shellanything
     /// <returns>Returns value of the property if the property is set. Returns an empty string otherwise.</returns>
     const std::string& GetProperty(const std::string& name) const;
 
+    /// <summary>
+    /// Gets the value of the given property name with a single lookup.
+    /// </summary>
+    /// <param name="name">The name of the property to get.</param>
+    /// <param name="value">The output pointer to the value of the property. The pointer is valid until the store is modified.</param>
+    /// <returns>Returns true if the property is set. Returns false otherwise.</returns>
+    bool TryGetProperty(const std::string& name, const std::string*& value) const;
+
+    /// <summary>
+    /// Gets the value of the given property name with a single lookup and without hashing the name.
+    /// </summary>
+    /// <param name="name">The name of the property to get.</param>
+    /// <param name="hash">The hash of the name. Must be the value returned by Hash().</param>
+    /// <param name="value">The output pointer to the value of the property. The pointer is valid until the store is modified.</param>
+    /// <returns>Returns true if the property is set. Returns false otherwise.</returns>
+    bool TryGetProperty(const std::string& name, size_t hash, const std::string*& value) const;
+
     /// <summary>
     /// Counts how many properties are registered in the store.
     /// </summary>
@@ -108,7 +128,7 @@ namespace shellanything
     bool IsEmpty() const;
 
     /// <summary>
-    /// Get the list of properties in the store
+    /// Get the list of properties in the store, sorted by name.
     /// </summary>
     /// <param name="names">The output list of properties</param>
     void GetProperties(StringList& names) const;
@@ -121,7 +141,27 @@ namespace shellanything
     void FindMissingProperties(const StringList& input_names, StringList& output_names) const;
 
   private:
-    PropertyMap properties;
+    enum SLOT_STATE
+    {
+      SLOT_EMPTY,
+      SLOT_USED,
+      SLOT_DELETED, // lookups must continue probing after a deleted slot.
+    };
+    struct SLOT
+    {
+      std::string name;
+      size_t hash;
+      std::string value;
+      SLOT_STATE state;
+    };
+    typedef std::vector<SLOT> SlotList;
+
+    size_t FindSlot(const std::string& name, size_t hash) const;
+    void Rehash(size_t capacity);
+
+    SlotList mSlots;
+    size_t mCount; // number of properties in the store.
+    size_t mUsed;  // number of slots which are used by a property or by a deleted property.
   };
 
 } //namespace shellanything
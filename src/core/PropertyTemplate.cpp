@@ -0,0 +1,190 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PropertyTemplate.h"
+#include "PropertyStore.h"
+
+namespace shellanything
+{
+  static const std::string TOKEN_OPEN = "${";
+  static const std::string TOKEN_CLOSE = "}";
+
+  PropertyTemplate::PropertyTemplate() :
+    mReferenceCount(0),
+    mSimple(true),
+    mExpandedValueValid(false)
+  {
+  }
+
+  PropertyTemplate::PropertyTemplate(const PropertyTemplate& tmpl)
+  {
+    (*this) = tmpl;
+  }
+
+  PropertyTemplate::~PropertyTemplate()
+  {
+  }
+
+  const PropertyTemplate& PropertyTemplate::operator =(const PropertyTemplate& tmpl)
+  {
+    if (this != &tmpl)
+    {
+      mSource = tmpl.mSource;
+      mSegments = tmpl.mSegments;
+      mReferenceCount = tmpl.mReferenceCount;
+      mSimple = tmpl.mSimple;
+      mExpandedValue = tmpl.mExpandedValue;
+      mDependencies = tmpl.mDependencies;
+      mExpandedValueValid = tmpl.mExpandedValueValid;
+    }
+    return (*this);
+  }
+
+  void PropertyTemplate::Parse(const std::string& value)
+  {
+    mSource = value;
+    mSegments.clear();
+    mReferenceCount = 0;
+    mSimple = true;
+    InvalidateExpandedValue();
+
+    size_t literal_start = 0;
+    size_t offset = 0;
+    while (offset < value.size())
+    {
+      //Search for the next token_open position.
+      size_t token_open_pos = value.find(TOKEN_OPEN, offset);
+      if (token_open_pos == std::string::npos)
+        break;
+
+      //Search for the token_close position.
+      //The token_close is searched the same way as PropertyManager::ExpandOnce() does.
+      size_t name_start_pos = token_open_pos + TOKEN_OPEN.size();
+      size_t token_close_pos = value.find(TOKEN_CLOSE, name_start_pos);
+      if (token_close_pos == std::string::npos)
+        break; // no other property reference can be found
+
+      size_t name_length = token_close_pos - name_start_pos;
+      if (name_length == 0)
+      {
+        //Empty name. This is not a property reference.
+        offset = token_open_pos + 1;
+        continue;
+      }
+
+      //A name that contains another token_open is resolved based on the actual property values.
+      std::string name = value.substr(name_start_pos, name_length);
+      if (name.find(TOKEN_OPEN) != std::string::npos)
+      {
+        mSimple = false;
+        offset = token_open_pos + 1;
+        continue;
+      }
+
+      //Flush the literal span before the property reference
+      if (token_open_pos > literal_start)
+      {
+        SEGMENT literal;
+        literal.offset = literal_start;
+        literal.length = token_open_pos - literal_start;
+        literal.reference = false;
+        literal.hash = 0;
+        mSegments.push_back(literal);
+      }
+
+      SEGMENT reference;
+      reference.offset = token_open_pos;
+      reference.length = token_close_pos + TOKEN_CLOSE.size() - token_open_pos;
+      reference.reference = true;
+      reference.name = name;
+      reference.hash = PropertyStore::Hash(name);
+      mSegments.push_back(reference);
+      mReferenceCount++;
+
+      offset = token_close_pos + TOKEN_CLOSE.size();
+      literal_start = offset;
+    }
+
+    //Flush the remaining literal span
+    if (literal_start < value.size())
+    {
+      SEGMENT literal;
+      literal.offset = literal_start;
+      literal.length = value.size() - literal_start;
+      literal.reference = false;
+      literal.hash = 0;
+      mSegments.push_back(literal);
+    }
+  }
+
+  const std::string& PropertyTemplate::GetSource() const
+  {
+    return mSource;
+  }
+
+  const PropertyTemplate::SegmentList& PropertyTemplate::GetSegments() const
+  {
+    return mSegments;
+  }
+
+  size_t PropertyTemplate::GetReferenceCount() const
+  {
+    return mReferenceCount;
+  }
+
+  bool PropertyTemplate::IsSimple() const
+  {
+    return mSimple;
+  }
+
+  bool PropertyTemplate::IsExpandedValueValid() const
+  {
+    return mExpandedValueValid;
+  }
+
+  const std::string& PropertyTemplate::GetExpandedValue() const
+  {
+    return mExpandedValue;
+  }
+
+  const StringList& PropertyTemplate::GetDependencies() const
+  {
+    return mDependencies;
+  }
+
+  void PropertyTemplate::SetExpandedValue(const std::string& value, const StringList& dependencies)
+  {
+    mExpandedValue = value;
+    mDependencies = dependencies;
+    mExpandedValueValid = true;
+  }
+
+  void PropertyTemplate::InvalidateExpandedValue()
+  {
+    mExpandedValue.clear();
+    mDependencies.clear();
+    mExpandedValueValid = false;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,138 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_PROPERTY_TEMPLATE_H
+#define SA_PROPERTY_TEMPLATE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A PropertyTemplate is a pre-parsed version of a string which contains property references.
+  /// The string is split once into a list of literal spans and property reference slots.
+  /// </summary>
+  class SHELLANYTHING_EXPORT PropertyTemplate
+  {
+  public:
+    /// <summary>
+    /// A SEGMENT is either a literal span of the source string or a property reference slot.
+    /// </summary>
+    struct SEGMENT
+    {
+      size_t offset;    // offset of the segment in the source string.
+      size_t length;    // length of the segment in the source string. For references, this includes the `${` and `}` tokens.
+      bool reference;   // true if the segment is a property reference slot.
+      std::string name; // name of the referenced property. Empty for literal spans.
+      size_t hash;      // hash of the name, see PropertyStore::Hash(). 0 for literal spans.
+    };
+
+    /// <summary>
+    /// A list of SEGMENT.
+    /// </summary>
+    typedef std::vector<SEGMENT> SegmentList;
+
+    PropertyTemplate();
+    PropertyTemplate(const PropertyTemplate& tmpl);
+    virtual ~PropertyTemplate();
+
+    /// <summary>
+    /// Copy operator
+    /// </summary>
+    const PropertyTemplate& operator =(const PropertyTemplate& tmpl);
+
+    /// <summary>
+    /// Parse the given string into literal spans and property reference slots.
+    /// </summary>
+    /// <param name="value">The string to parse.</param>
+    void Parse(const std::string& value);
+
+    /// <summary>
+    /// Get the string that was parsed.
+    /// </summary>
+    const std::string& GetSource() const;
+
+    /// <summary>
+    /// Get the list of segments of the template.
+    /// </summary>
+    const SegmentList& GetSegments() const;
+
+    /// <summary>
+    /// Get the number of property reference slots of the template.
+    /// </summary>
+    size_t GetReferenceCount() const;
+
+    /// <summary>
+    /// Check if the template can be evaluated segment by segment.
+    /// A template is not simple if a property reference contains another property reference (for example `${${name}}`).
+    /// The resolution of such references depends on the actual property values and must be expanded with PropertyManager::ExpandOnce().
+    /// </summary>
+    /// <returns>Returns true if the template is simple. Returns false otherwise.</returns>
+    bool IsSimple() const;
+
+    /// <summary>
+    /// Check if the template has a valid expanded value. See SetExpandedValue().
+    /// </summary>
+    /// <returns>Returns true if the expanded value is valid. Returns false otherwise.</returns>
+    bool IsExpandedValueValid() const;
+
+    /// <summary>
+    /// Get the last expanded value of the template.
+    /// </summary>
+    const std::string& GetExpandedValue() const;
+
+    /// <summary>
+    /// Get the names of the properties that were read while computing the expanded value.
+    /// </summary>
+    const StringList& GetDependencies() const;
+
+    /// <summary>
+    /// Set the expanded value of the template and the names of the properties it depends on.
+    /// </summary>
+    /// <param name="value">The expanded value.</param>
+    /// <param name="dependencies">The names of the properties that were read while computing the expanded value.</param>
+    void SetExpandedValue(const std::string& value, const StringList& dependencies);
+
+    /// <summary>
+    /// Invalidate the expanded value of the template.
+    /// </summary>
+    void InvalidateExpandedValue();
+
+  private:
+    std::string mSource;
+    SegmentList mSegments;
+    size_t mReferenceCount;
+    bool mSimple;
+    std::string mExpandedValue;
+    StringList mDependencies;
+    bool mExpandedValueValid;
+  };
+
+} //namespace shellanything
+
+#endif //SA_PROPERTY_TEMPLATE_H
@@ -0,0 +1,352 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "ScopeTracer.h"
+#include "Environment.h"
+#include "App.h"
+#include "SaUtils.h"
+
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/process.h"
+#include "rapidassist/strings.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <Windows.h> // for GetCurrentThreadId
+#undef GetEnvironmentVariable
+#undef DeleteFile
+#undef CreateDirectory
+#undef CopyFile
+#undef CreateFile
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+namespace shellanything
+{
+  const size_t ScopeTracer::MAX_EVENTS_PER_THREAD = 100000;
+
+  enum TRACING_STATE
+  {
+    TRACING_UNKNOWN = 0,
+    TRACING_DISABLED = 1,
+    TRACING_ENABLED = 2,
+  };
+  static const uint64_t TRACING_STATE_MASK = 0x3;
+  static const uint64_t TRACING_GENERATION_INCREMENT = 0x4;
+
+  // The low bits store the cached state. The high bits count the changes of the state.
+  // A state evaluated before SetEnabled() or InvalidateEnabledCache() can never be published after it.
+  static std::atomic<uint64_t> gTracingState(TRACING_UNKNOWN);
+  static std::atomic<uint64_t> gDroppedEvents(0);
+
+  /// <summary>
+  /// Buffer of the scopes recorded by a single thread.
+  /// Only the owner thread appends to the buffer. The mutex protects the buffer while exporting.
+  /// </summary>
+  struct THREAD_BUFFER
+  {
+    std::mutex mutex;
+    ScopeTracer::EventList events;
+    bool in_use; // true while a thread owns the buffer. Protected by the buffers mutex.
+  };
+  typedef std::vector<THREAD_BUFFER*> ThreadBufferList;
+
+  // The buffers are never deleted. A thread may exit while its scopes are not exported yet.
+  // The buffer of an exited thread is recycled by the next thread. The number of buffers is bounded by the maximum number of concurrent threads.
+  static std::mutex& GetBuffersMutex()
+  {
+    static std::mutex _mutex;
+    return _mutex;
+  }
+
+  static ThreadBufferList& GetBuffers()
+  {
+    static ThreadBufferList _buffers;
+    return _buffers;
+  }
+
+  /// <summary>
+  /// Releases the buffer of a thread when the thread exits.
+  /// </summary>
+  struct THREAD_BUFFER_OWNER
+  {
+    THREAD_BUFFER* buffer;
+
+    THREAD_BUFFER_OWNER() : buffer(NULL) {}
+    ~THREAD_BUFFER_OWNER()
+    {
+      if (buffer == NULL)
+        return;
+      std::lock_guard<std::mutex> lock(GetBuffersMutex());
+      buffer->in_use = false;
+    }
+  };
+
+  static thread_local THREAD_BUFFER_OWNER tBufferOwner;
+
+  static THREAD_BUFFER* GetThreadBuffer()
+  {
+    if (tBufferOwner.buffer == NULL)
+    {
+      std::lock_guard<std::mutex> lock(GetBuffersMutex());
+      ThreadBufferList& buffers = GetBuffers();
+
+      //reuse the buffer of an exited thread
+      THREAD_BUFFER* buffer = NULL;
+      for (size_t i = 0; i < buffers.size() && buffer == NULL; i++)
+      {
+        if (!buffers[i]->in_use)
+          buffer = buffers[i];
+      }
+      if (buffer == NULL)
+      {
+        buffer = new THREAD_BUFFER();
+        buffers.push_back(buffer);
+      }
+      buffer->in_use = true;
+      tBufferOwner.buffer = buffer;
+    }
+    return tBufferOwner.buffer;
+  }
+
+  inline void AppendJsonString(std::string& json, const char* value)
+  {
+    json += '"';
+    for (const char* c = value; c && *c != '\0'; c++)
+    {
+      switch (*c)
+      {
+      case '"':
+        json += "\\\"";
+        break;
+      case '\\':
+        json += "\\\\";
+        break;
+      case '\n':
+        json += "\\n";
+        break;
+      case '\r':
+        json += "\\r";
+        break;
+      case '\t':
+        json += "\\t";
+        break;
+      default:
+        if ((unsigned char)*c < 0x20)
+          json += ra::strings::Format("\\u%04x", (unsigned int)(unsigned char)*c);
+        else
+          json += *c;
+        break;
+      };
+    }
+    json += '"';
+  }
+
+  bool ScopeTracer::IsEnabled()
+  {
+    uint64_t cache = gTracingState.load();
+    uint64_t state = (cache & TRACING_STATE_MASK);
+    if (state != TRACING_UNKNOWN)
+      return (state == TRACING_ENABLED);
+
+    Environment& env = Environment::GetInstance();
+    bool enabled = env.IsOptionTrue(Environment::SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME);
+
+    // Publish the state only if it was not changed by another thread while evaluating.
+    uint64_t evaluated = (cache & ~TRACING_STATE_MASK) | (enabled ? TRACING_ENABLED : TRACING_DISABLED);
+    gTracingState.compare_exchange_strong(cache, evaluated);
+    return enabled;
+  }
+
+  static void ChangeTracingState(uint64_t state)
+  {
+    uint64_t cache = gTracingState.load();
+    uint64_t changed;
+    do
+    {
+      changed = ((cache & ~TRACING_STATE_MASK) + TRACING_GENERATION_INCREMENT) | state;
+    } while (!gTracingState.compare_exchange_weak(cache, changed));
+  }
+
+  void ScopeTracer::SetEnabled(bool enabled)
+  {
+    ChangeTracingState(enabled ? TRACING_ENABLED : TRACING_DISABLED);
+  }
+
+  void ScopeTracer::InvalidateEnabledCache()
+  {
+    ChangeTracingState(TRACING_UNKNOWN);
+  }
+
+  uint64_t ScopeTracer::GetTimestamp()
+  {
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  }
+
+  void ScopeTracer::Record(const char* name, const char* filename, int line, const void* instance, uint64_t begin, uint64_t end)
+  {
+    THREAD_BUFFER* buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (buffer->events.size() >= MAX_EVENTS_PER_THREAD)
+    {
+      gDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    EVENT e;
+    e.name = name;
+    e.filename = filename;
+    e.line = line;
+    e.instance = instance;
+    e.begin = begin;
+    e.end = end;
+    e.thread_id = (uint32_t)GetCurrentThreadId();
+    buffer->events.push_back(e);
+  }
+
+  void ScopeTracer::GetEvents(EventList& events)
+  {
+    events.clear();
+
+    std::lock_guard<std::mutex> lock(GetBuffersMutex());
+    ThreadBufferList& buffers = GetBuffers();
+
+    //for each thread
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      THREAD_BUFFER* buffer = buffers[i];
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+    }
+  }
+
+  size_t ScopeTracer::GetEventCount()
+  {
+    size_t count = 0;
+
+    std::lock_guard<std::mutex> lock(GetBuffersMutex());
+    ThreadBufferList& buffers = GetBuffers();
+
+    //for each thread
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      THREAD_BUFFER* buffer = buffers[i];
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      count += buffer->events.size();
+    }
+    return count;
+  }
+
+  size_t ScopeTracer::GetBufferCount()
+  {
+    std::lock_guard<std::mutex> lock(GetBuffersMutex());
+    return GetBuffers().size();
+  }
+
+  uint64_t ScopeTracer::GetDroppedCount()
+  {
+    return gDroppedEvents.load(std::memory_order_relaxed);
+  }
+
+  void ScopeTracer::Clear()
+  {
+    std::lock_guard<std::mutex> lock(GetBuffersMutex());
+    ThreadBufferList& buffers = GetBuffers();
+
+    //for each thread
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      THREAD_BUFFER* buffer = buffers[i];
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      buffer->events.clear();
+    }
+    gDroppedEvents.store(0);
+  }
+
+  std::string ScopeTracer::ToChromeTrace()
+  {
+    EventList events;
+    GetEvents(events);
+
+    const uint32_t pid = (uint32_t)ra::process::GetCurrentProcessId();
+
+    // See the Trace Event Format specification for details:
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    std::string json;
+    json.reserve(events.size() * 192);
+    json += "{\"traceEvents\":[\n";
+
+    //for each scope
+    for (size_t i = 0; i < events.size(); i++)
+    {
+      const EVENT& e = events[i];
+
+      // Complete event
+      json += "{\"name\":";
+      AppendJsonString(json, e.name);
+      json += ",\"cat\":\"scope\",\"ph\":\"X\"";
+      json += ra::strings::Format(",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":%u",
+        (unsigned long long)e.begin,
+        (unsigned long long)(e.end - e.begin),
+        pid,
+        e.thread_id);
+      json += ",\"args\":{";
+      if (e.instance)
+      {
+        json += "\"this\":";
+        AppendJsonString(json, ToHexString(e.instance).c_str());
+        json += ",";
+      }
+      json += "\"file\":";
+      AppendJsonString(json, e.filename ? ra::filesystem::GetFilename(e.filename).c_str() : "");
+      json += ra::strings::Format(",\"line\":%d}}", e.line);
+      if (i + 1 < events.size())
+        json += ",";
+      json += "\n";
+    }
+
+    json += "],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+  }
+
+  bool ScopeTracer::SaveChromeTrace(const std::string& path)
+  {
+    std::string json = ToChromeTrace();
+    bool saved = ra::filesystem::WriteFileUtf8(path, json);
+    return saved;
+  }
+
+  std::string ScopeTracer::GetDefaultTraceFilePath()
+  {
+    std::string log_dir = App::GetInstance().GetLogDirectory();
+    std::string path = log_dir + "\\shellanything." + ra::strings::ToString((uint32_t)ra::process::GetCurrentProcessId()) + ".trace.json";
+    return path;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,164 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_SCOPE_TRACER_H
+#define SA_SCOPE_TRACER_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+
+  /// <summary>
+  /// Records the duration of the scopes declared with a ScopeLogger.
+  /// Each thread records its scopes in its own buffer.
+  /// The recorded scopes can be exported to the Chrome trace event format and opened in a trace viewer
+  /// such as chrome://tracing or https://ui.perfetto.dev.
+  /// </summary>
+  class SHELLANYTHING_EXPORT ScopeTracer
+  {
+  public:
+    /// <summary>
+    /// A recorded scope.
+    /// </summary>
+    struct EVENT
+    {
+      ///<summary>The name of the scope. Usually the function name.</summary>
+      const char* name;
+      ///<summary>The souce code filename of the scope.</summary>
+      const char* filename;
+      ///<summary>The souce code line number of the scope.</summary>
+      int line;
+      ///<summary>The calling class instance of the scope.</summary>
+      const void* instance;
+      ///<summary>The time when the scope was entered, in microseconds.</summary>
+      uint64_t begin;
+      ///<summary>The time when the scope was exited, in microseconds.</summary>
+      uint64_t end;
+      ///<summary>The identifier of the thread that executed the scope.</summary>
+      uint32_t thread_id;
+    };
+    typedef std::vector<EVENT> EventList;
+
+    /// <summary>
+    /// Maximum number of scopes recorded by a single thread.
+    /// Scopes are dropped when the buffer of the thread is full.
+    /// </summary>
+    static const size_t MAX_EVENTS_PER_THREAD;
+
+    /// <summary>
+    /// Define if scope tracing is enabled.
+    /// By default, tracing is enabled with the environment option SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME.
+    /// </summary>
+    /// <returns>Returns true when scope tracing is enabled. Returns false otherwise.</returns>
+    static bool IsEnabled();
+
+    /// <summary>
+    /// Enable or disable scope tracing. Overrides the environment option.
+    /// </summary>
+    /// <param name="enabled">The new tracing state.</param>
+    static void SetEnabled(bool enabled);
+
+    /// <summary>
+    /// Invalidate the cached tracing state.
+    /// The state is evaluated again from the environment option on the next call to IsEnabled().
+    /// </summary>
+    static void InvalidateEnabledCache();
+
+    /// <summary>
+    /// Get the current time of the tracing clock.
+    /// </summary>
+    /// <returns>Returns the current time in microseconds.</returns>
+    static uint64_t GetTimestamp();
+
+    /// <summary>
+    /// Record a scope in the buffer of the calling thread.
+    /// </summary>
+    /// <param name="name">The name of the scope. Must be a string literal.</param>
+    /// <param name="filename">The souce code filename of the scope. Must be a string literal.</param>
+    /// <param name="line">The souce code line number of the scope.</param>
+    /// <param name="instance">The calling class instance of the scope.</param>
+    /// <param name="begin">The time when the scope was entered.</param>
+    /// <param name="end">The time when the scope was exited.</param>
+    static void Record(const char* name, const char* filename, int line, const void* instance, uint64_t begin, uint64_t end);
+
+    /// <summary>
+    /// Get a copy of the scopes recorded by all threads.
+    /// </summary>
+    /// <param name="events">The output list of scopes.</param>
+    static void GetEvents(EventList& events);
+
+    /// <summary>
+    /// Get the number of scopes recorded by all threads.
+    /// </summary>
+    /// <returns>Returns the number of recorded scopes.</returns>
+    static size_t GetEventCount();
+
+    /// <summary>
+    /// Get the number of thread buffers.
+    /// The buffer of an exited thread is reused by the next thread that records a scope.
+    /// </summary>
+    /// <returns>Returns the number of thread buffers.</returns>
+    static size_t GetBufferCount();
+
+    /// <summary>
+    /// Get the number of scopes dropped because a thread buffer was full.
+    /// </summary>
+    /// <returns>Returns the number of dropped scopes.</returns>
+    static uint64_t GetDroppedCount();
+
+    /// <summary>
+    /// Delete all recorded scopes.
+    /// </summary>
+    static void Clear();
+
+    /// <summary>
+    /// Export the recorded scopes to the Chrome trace event json format.
+    /// </summary>
+    /// <returns>Returns a json document.</returns>
+    static std::string ToChromeTrace();
+
+    /// <summary>
+    /// Save the recorded scopes to a file in the Chrome trace event json format.
+    /// </summary>
+    /// <param name="path">The path of the output file.</param>
+    /// <returns>Returns true if the file was saved. Returns false otherwise.</returns>
+    static bool SaveChromeTrace(const std::string& path);
+
+    /// <summary>
+    /// Get the default path of the trace file of the current process.
+    /// The file is located in the log directory.
+    /// </summary>
+    /// <returns>Returns the path of the trace file.</returns>
+    static std::string GetDefaultTraceFilePath();
+  };
+
+} //namespace shellanything
+
+#endif //SA_SCOPE_TRACER_H
@@ -0,0 +1,373 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "SelectionAnalyzer.h"
+#include "FileMagicManager.h"
+#include "LoggerHelper.h"
+#include "PerformanceCounters.h"
+
+#include "rapidassist/unicode.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h> // for GetFileAttributesExW()
+#else
+#include <sys/stat.h>
+#endif
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <system_error>
+
+namespace shellanything
+{
+  const size_t SelectionAnalyzer::MAX_THREAD_COUNT = 16;
+  const size_t SelectionAnalyzer::DEFAULT_MIN_PARALLEL_ELEMENTS = 64;
+
+  // Number of consecutive elements claimed by a worker thread at once.
+  static const size_t ANALYSIS_BATCH_SIZE = 16;
+
+  struct ANALYSIS_JOB
+  {
+    const StringList* elements;
+    ElementInfoList* infos;
+    int flags;
+    size_t max_workers;   // maximum number of workers that can join the job
+    size_t worker_count;  // number of workers that have joined the job
+    std::atomic<size_t> next;
+  };
+
+  struct ANALYSIS_POOL
+  {
+    std::mutex submit_mutex;  // serializes the jobs and the start and stop of the workers
+    std::mutex mutex;         // guards the fields below
+    std::condition_variable job_condition;
+    std::condition_variable done_condition;
+    std::vector<std::thread> threads;
+    ANALYSIS_JOB* job;
+    uint64_t job_id;
+    size_t active;  // number of workers processing the current job
+    bool stop;
+
+    ANALYSIS_POOL() :
+      job(NULL),
+      job_id(0),
+      active(0),
+      stop(false)
+    {
+    }
+
+    ~ANALYSIS_POOL();
+  };
+
+  static void StopAnalysisWorkers(ANALYSIS_POOL& pool)
+  {
+    std::lock_guard<std::mutex> submit_lock(pool.submit_mutex);
+    if (pool.threads.empty())
+      return;
+
+    {
+      std::unique_lock<std::mutex> lock(pool.mutex);
+      pool.stop = true;
+    }
+    pool.job_condition.notify_all();
+    for (size_t i = 0; i < pool.threads.size(); i++)
+    {
+      pool.threads[i].join();
+    }
+    pool.threads.clear();
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.stop = false;
+  }
+
+  ANALYSIS_POOL::~ANALYSIS_POOL()
+  {
+    StopAnalysisWorkers(*this);
+  }
+
+  static ANALYSIS_POOL& GetAnalysisPool()
+  {
+    static ANALYSIS_POOL _instance;
+    return _instance;
+  }
+
+  static void AnalyzeElement(magic_t cookie, int flags, const std::string& element, ELEMENT_INFO& info)
+  {
+    if (flags & SelectionAnalyzer::ANALYZE_FILESYSTEM)
+      SelectionAnalyzer::StatElement(element, info);
+    if (flags & SelectionAnalyzer::ANALYZE_FILE_MAGIC)
+    {
+      info.mimetype = FileMagicManager::GetMIMEType(cookie, element);
+      info.description = FileMagicManager::GetDescription(cookie, element);
+      info.charset = FileMagicManager::GetCharset(cookie, element);
+    }
+  }
+
+  static void AnalyzeBatches(ANALYSIS_JOB* job, magic_t cookie)
+  {
+    const size_t count = job->elements->size();
+    while (true)
+    {
+      size_t begin = job->next.fetch_add(ANALYSIS_BATCH_SIZE);
+      if (begin >= count)
+        break;
+      size_t end = begin + ANALYSIS_BATCH_SIZE;
+      if (end > count)
+        end = count;
+
+      for (size_t i = begin; i < end; i++)
+      {
+        AnalyzeElement(cookie, job->flags, (*job->elements)[i], (*job->infos)[i]);
+      }
+    }
+  }
+
+  static void AnalyzeInline(const StringList& elements, int flags, ElementInfoList& infos)
+  {
+    // Small selections are analyzed with the manager's own cookie
+    FileMagicManager& fm = FileMagicManager::GetInstance();
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      const std::string& element = elements[i];
+      ELEMENT_INFO& info = infos[i];
+      if (flags & SelectionAnalyzer::ANALYZE_FILESYSTEM)
+        SelectionAnalyzer::StatElement(element, info);
+      if (flags & SelectionAnalyzer::ANALYZE_FILE_MAGIC)
+      {
+        info.mimetype = fm.GetMIMEType(element);
+        info.description = fm.GetDescription(element);
+        info.charset = fm.GetCharset(element);
+      }
+    }
+  }
+
+  // Workers must not use the PropertyManager. The analysis runs from lazy properties,
+  // while the calling thread holds the PropertyManager's lock.
+  static void RunAnalysisWorker(ANALYSIS_POOL* pool)
+  {
+    // libmagic cookies are not thread-safe. Each worker opens its own cookie on its first job.
+    magic_t cookie = NULL;
+    bool cookie_opened = false;
+    uint64_t last_job_id = 0;
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    while (true)
+    {
+      while (!pool->stop && (pool->job == NULL || pool->job_id == last_job_id))
+        pool->job_condition.wait(lock);
+      if (pool->stop)
+        break;
+
+      ANALYSIS_JOB* job = pool->job;
+      last_job_id = pool->job_id;
+      if (job->worker_count >= job->max_workers)
+        continue;
+      job->worker_count++;
+      pool->active++;
+      lock.unlock();
+
+      if ((job->flags & SelectionAnalyzer::ANALYZE_FILE_MAGIC) && !cookie_opened)
+      {
+        cookie = FileMagicManager::GetInstance().OpenCookie();
+        cookie_opened = true;
+      }
+      AnalyzeBatches(job, cookie);
+
+      lock.lock();
+      pool->active--;
+      if (pool->active == 0)
+        pool->done_condition.notify_all();
+    }
+    lock.unlock();
+
+    FileMagicManager::CloseCookie(cookie);
+  }
+
+  SelectionAnalyzer::SelectionAnalyzer() :
+    mThreadCount(0),
+    mMinParallelElements(DEFAULT_MIN_PARALLEL_ELEMENTS)
+  {
+  }
+
+  SelectionAnalyzer::~SelectionAnalyzer()
+  {
+  }
+
+  size_t SelectionAnalyzer::GetThreadCount() const
+  {
+    if (mThreadCount == 0)
+      return GetDefaultThreadCount();
+    return mThreadCount;
+  }
+
+  void SelectionAnalyzer::SetThreadCount(size_t count)
+  {
+    if (count > MAX_THREAD_COUNT)
+      count = MAX_THREAD_COUNT;
+    mThreadCount = count;
+  }
+
+  size_t SelectionAnalyzer::GetMinParallelElements() const
+  {
+    return mMinParallelElements;
+  }
+
+  void SelectionAnalyzer::SetMinParallelElements(size_t count)
+  {
+    mMinParallelElements = count;
+  }
+
+  void SelectionAnalyzer::Analyze(const StringList& elements, int flags, ElementInfoList& infos) const
+  {
+    static const ELEMENT_INFO EMPTY_INFO = { false, false, 0, 0, 0 };
+
+    infos.clear();
+    infos.resize(elements.size(), EMPTY_INFO);
+
+    if (elements.empty())
+      return;
+
+    // Limit the number of threads to the number of batches
+    size_t thread_count = GetThreadCount();
+    size_t batch_count = (elements.size() + ANALYSIS_BATCH_SIZE - 1) / ANALYSIS_BATCH_SIZE;
+    if (thread_count > batch_count)
+      thread_count = batch_count;
+
+    if (thread_count <= 1 || elements.size() < mMinParallelElements)
+    {
+      AnalyzeInline(elements, flags, infos);
+      return;
+    }
+
+    ANALYSIS_POOL& pool = GetAnalysisPool();
+    std::lock_guard<std::mutex> submit_lock(pool.submit_mutex);
+
+    // Start the missing workers
+    while (pool.threads.size() < thread_count)
+    {
+      try
+      {
+        pool.threads.push_back(std::thread(&RunAnalysisWorker, &pool));
+      }
+      catch (const std::system_error& e)
+      {
+        // Elements are analyzed by the threads already started
+        SA_LOG(WARNING) << "Failed to start selection analysis thread: " << e.what();
+        break;
+      }
+    }
+    if (pool.threads.empty())
+    {
+      AnalyzeInline(elements, flags, infos);
+      return;
+    }
+
+    ANALYSIS_JOB job;
+    job.elements = &elements;
+    job.infos = &infos;
+    job.flags = flags;
+    job.max_workers = thread_count;
+    job.worker_count = 0;
+    job.next = 0;
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.job = &job;
+    pool.job_id++;
+    pool.job_condition.notify_all();
+
+    // Wait until all elements are claimed and the workers are done with their last batch
+    while (job.next.load() < elements.size() || pool.active != 0)
+      pool.done_condition.wait(lock);
+    pool.job = NULL;
+  }
+
+  bool SelectionAnalyzer::StatElement(const std::string& element, ELEMENT_INFO& info)
+  {
+    info.is_file = false;
+    info.is_directory = false;
+    info.size = 0;
+    info.modified_date = 0;
+    info.attributes = 0;
+
+    PerformanceCounters::AddFilesystemProbe();
+
+#ifdef _WIN32
+    std::wstring element_utf16 = ra::unicode::Utf8ToUnicode(element);
+    WIN32_FILE_ATTRIBUTE_DATA data = { 0 };
+    if (!GetFileAttributesExW(element_utf16.c_str(), GetFileExInfoStandard, &data))
+      return false;
+
+    // Convert from 100-nanosecond intervals since January 1, 1601 to seconds since epoch
+    static const uint64_t FILETIME_EPOCH_OFFSET = 116444736000000000ULL;
+    uint64_t last_write_time = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+
+    info.attributes = data.dwFileAttributes;
+    info.is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    info.is_file = !info.is_directory;
+    info.size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    if (last_write_time > FILETIME_EPOCH_OFFSET)
+      info.modified_date = (last_write_time - FILETIME_EPOCH_OFFSET) / 10000000ULL;
+#else
+    struct stat sb;
+    if (stat(element.c_str(), &sb) != 0)
+      return false;
+
+    info.attributes = (uint32_t)sb.st_mode;
+    info.is_directory = S_ISDIR(sb.st_mode);
+    info.is_file = S_ISREG(sb.st_mode);
+    info.size = (uint64_t)sb.st_size;
+    info.modified_date = (uint64_t)sb.st_mtime;
+#endif
+
+    return true;
+  }
+
+  size_t SelectionAnalyzer::GetDefaultThreadCount()
+  {
+    size_t count = std::thread::hardware_concurrency();
+    if (count == 0)
+      count = 1;
+    if (count > MAX_THREAD_COUNT)
+      count = MAX_THREAD_COUNT;
+    return count;
+  }
+
+  size_t SelectionAnalyzer::GetWorkerCount()
+  {
+    ANALYSIS_POOL& pool = GetAnalysisPool();
+    std::lock_guard<std::mutex> submit_lock(pool.submit_mutex);
+    return pool.threads.size();
+  }
+
+  void SelectionAnalyzer::StopWorkers()
+  {
+    StopAnalysisWorkers(GetAnalysisPool());
+  }
+
+} //namespace shellanything
@@ -0,0 +1,161 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_SELECTION_ANALYZER_H
+#define SA_SELECTION_ANALYZER_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace shellanything
+{
+  /// <summary>
+  /// The result of the analysis of a single selected element.
+  /// </summary>
+  struct ELEMENT_INFO
+  {
+    bool is_file;
+    bool is_directory;
+    uint64_t size;          // Size of the file in bytes.
+    uint64_t modified_date; // Last modification date, in seconds since epoch.
+    uint32_t attributes;    // Platform specific attributes. FILE_ATTRIBUTE_* values on Windows, st_mode otherwise.
+    std::string mimetype;
+    std::string description;
+    std::string charset;
+  };
+  typedef std::vector<ELEMENT_INFO> ElementInfoList;
+
+  /// <summary>
+  /// A SelectionAnalyzer computes filesystem and file magic information of selected elements.
+  /// Large selections are analyzed by a bounded pool of worker threads shared by all instances.
+  /// The worker threads are started on the first large selection and are kept running until StopWorkers() is called.
+  /// </summary>
+  class SHELLANYTHING_EXPORT SelectionAnalyzer
+  {
+  public:
+    /// <summary>
+    /// Flags that defines which information is computed for each element.
+    /// </summary>
+    enum ANALYSIS_FLAGS
+    {
+      ANALYZE_FILESYSTEM = 1, // is_file, is_directory, size, modified_date and attributes.
+      ANALYZE_FILE_MAGIC = 2, // mimetype, description and charset.
+      ANALYZE_ALL = ANALYZE_FILESYSTEM | ANALYZE_FILE_MAGIC,
+    };
+
+    /// <summary>
+    /// Maximum number of worker threads.
+    /// </summary>
+    static const size_t MAX_THREAD_COUNT;
+
+    /// <summary>
+    /// Default minimum number of elements for analyzing a selection with worker threads.
+    /// </summary>
+    static const size_t DEFAULT_MIN_PARALLEL_ELEMENTS;
+
+    SelectionAnalyzer();
+    virtual ~SelectionAnalyzer();
+
+  private:
+    // Disable copy constructor and copy operator
+    SelectionAnalyzer(const SelectionAnalyzer&);
+    SelectionAnalyzer& operator=(const SelectionAnalyzer&);
+  public:
+
+    /// <summary>
+    /// Get the maximum number of threads used for analyzing a selection.
+    /// </summary>
+    size_t GetThreadCount() const;
+
+    /// <summary>
+    /// Set the maximum number of threads used for analyzing a selection.
+    /// A value of 0 selects GetDefaultThreadCount(). A value of 1 disables worker threads.
+    /// </summary>
+    /// <param name="count">The maximum number of threads.</param>
+    void SetThreadCount(size_t count);
+
+    /// <summary>
+    /// Get the minimum number of elements for analyzing a selection with worker threads.
+    /// </summary>
+    size_t GetMinParallelElements() const;
+
+    /// <summary>
+    /// Set the minimum number of elements for analyzing a selection with worker threads.
+    /// Smaller selections are analyzed by the calling thread.
+    /// </summary>
+    /// <param name="count">The minimum number of elements.</param>
+    void SetMinParallelElements(size_t count);
+
+    /// <summary>
+    /// Analyze the given elements.
+    /// </summary>
+    /// <remarks>
+    /// Small selections are analyzed by the calling thread with the FileMagicManager's cookie.
+    /// Each worker thread opens its own file magic cookie once and reuses it for the next selections.
+    /// The results are stored in the same order as the elements.
+    /// </remarks>
+    /// <param name="elements">The elements to analyze.</param>
+    /// <param name="flags">A combination of ANALYSIS_FLAGS values.</param>
+    /// <param name="infos">The output result of each element.</param>
+    void Analyze(const StringList& elements, int flags, ElementInfoList& infos) const;
+
+    /// <summary>
+    /// Read the filesystem information of a single element with a single system call.
+    /// </summary>
+    /// <param name="element">The path of the element.</param>
+    /// <param name="info">The output information of the element.</param>
+    /// <returns>Returns true if the element exists. Returns false otherwise.</returns>
+    static bool StatElement(const std::string& element, ELEMENT_INFO& info);
+
+    /// <summary>
+    /// Get the default number of threads for analyzing a selection. The value is based on the number of cores of the system.
+    /// </summary>
+    static size_t GetDefaultThreadCount();
+
+    /// <summary>
+    /// Get the number of running worker threads.
+    /// </summary>
+    static size_t GetWorkerCount();
+
+    /// <summary>
+    /// Stop the worker threads and close their file magic cookies.
+    /// The worker threads are started again by the next large selection.
+    /// </summary>
+    /// <remarks>
+    /// The worker threads cannot be stopped while the loader lock is held. The function must not be called from DllMain.
+    /// </remarks>
+    static void StopWorkers();
+
+  private:
+    size_t mThreadCount;
+    size_t mMinParallelElements;
+  };
+
+} //namespace shellanything
+
+#endif //SA_SELECTION_ANALYZER_H
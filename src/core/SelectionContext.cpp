@@ -28,10 +28,14 @@
 #include "Validator.h"
 #include "PropertyManager.h"
 #include "DriveClass.h"
+#include "SelectionAnalyzer.h"
+#include "ILiveProperty.h"
 
 #include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/environment_utf8.h"
 
+#include <memory>
+
 namespace shellanything
 {
   const std::string SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME = "selection.multi.separator";
@@ -57,12 +61,218 @@ namespace shellanything
     if (this != &c)
     {
       mElements = c.mElements;
+      mElementTypes = c.mElementTypes;
+      mElementAttributes = c.mElementAttributes;
+      mElementSizes = c.mElementSizes;
+      mElementModifiedDates = c.mElementModifiedDates;
       mNumFiles = c.mNumFiles;
       mNumDirectories = c.mNumDirectories;
     }
     return (*this);
   }
 
+  /// <summary>
+  /// The selected elements at the time SelectionContext::RegisterProperties() was called.
+  /// </summary>
+  struct SELECTION_SNAPSHOT
+  {
+    SelectionContext context;
+    std::string separator;
+
+    // File magic information of each element. Computed on first use.
+    mutable ElementInfoList magic_infos;
+    mutable bool magic_analyzed;
+  };
+  typedef std::shared_ptr<const SELECTION_SNAPSHOT> SelectionSnapshotPtr;
+
+  typedef std::string(*ElementPropertyFunc)(const std::string& element);
+  typedef std::string(*SelectionPropertyFunc)(const SELECTION_SNAPSHOT& snapshot);
+
+  /// <summary>
+  /// A lazy `selection.*` property. The value is computed on first read and memoized.
+  /// </summary>
+  class SelectionLazyProperty : public virtual ILiveProperty
+  {
+  public:
+    SelectionLazyProperty(const std::string& name, const SelectionSnapshotPtr& snapshot, SelectionPropertyFunc func) :
+      mName(name),
+      mSnapshot(snapshot),
+      mFunc(func),
+      mComputed(false)
+    {
+    }
+
+    virtual const std::string& GetName() const
+    {
+      return mName;
+    }
+
+    virtual std::string GetProperty() const
+    {
+      if (!mComputed)
+      {
+        SA_VERBOSE_LOG(INFO) << "Computing property '" << mName << "' for " << mSnapshot->context.GetElements().size() << " elements.";
+        mValue = mFunc(*mSnapshot);
+        mComputed = true;
+      }
+      return mValue;
+    }
+
+  private:
+    std::string mName;
+    SelectionSnapshotPtr mSnapshot;
+    SelectionPropertyFunc mFunc;
+    mutable std::string mValue;
+    mutable bool mComputed;
+  };
+
+  static std::string JoinElementProperty(const SELECTION_SNAPSHOT& snapshot, ElementPropertyFunc func)
+  {
+    const StringList& elements = snapshot.context.GetElements();
+    std::string output;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      const std::string& element = elements[i];
+      std::string element_value = func(element);
+
+      // Add a separator between values
+      if (!output.empty()) output.append(snapshot.separator);
+
+      // Append this specific element property to the global property string
+      output.append(element_value);
+    }
+    return output;
+  }
+
+  //${selection.path} is the full path of the clicked element
+  //${selection.dir} is the directory of the clicked element
+  //${selection.parent.path} is the full path of the parent element
+  //${selection.parent.filename} is the filename of the parent element
+  //${selection.filename} is selection.filename (including file extension)
+  //${selection.filename_noext} is selection.filename without file extension
+  //${selection.filename.extension} is the file extension of the clicked element.
+
+  static std::string GetElementPath(const std::string& element)
+  {
+    return element;
+  }
+
+  static std::string GetElementParentPath(const std::string& element)
+  {
+    return ra::filesystem::GetParentPath(element);
+  }
+
+  static std::string GetElementParentFilename(const std::string& element)
+  {
+    std::string parent_path = ra::filesystem::GetParentPath(element);
+    return ra::filesystem::GetFilename(parent_path.c_str());
+  }
+
+  static std::string GetElementFilename(const std::string& element)
+  {
+    return ra::filesystem::GetFilename(element.c_str());
+  }
+
+  static std::string GetElementFilenameNoExt(const std::string& element)
+  {
+    return ra::filesystem::GetFilenameWithoutExtension(element.c_str());
+  }
+
+  static std::string GetElementFilenameExtension(const std::string& element)
+  {
+    std::string filename = ra::filesystem::GetFilename(element.c_str());
+    return ra::filesystem::GetFileExtention(filename);
+  }
+
+  static std::string GetElementDriveLetter(const std::string& element)
+  {
+    return GetDriveLetter(element);
+  }
+
+  static std::string GetElementDrivePath(const std::string& element)
+  {
+    return GetDrivePath(element);
+  }
+
+  static std::string JoinElementInfo(const SELECTION_SNAPSHOT& snapshot, std::string ELEMENT_INFO::* member)
+  {
+    // Analyze all elements at once. Each file magic property reads the same results.
+    if (!snapshot.magic_analyzed)
+    {
+      SelectionAnalyzer analyzer;
+      analyzer.Analyze(snapshot.context.GetElements(), SelectionAnalyzer::ANALYZE_FILE_MAGIC, snapshot.magic_infos);
+      snapshot.magic_analyzed = true;
+    }
+
+    std::string output;
+    for (size_t i = 0; i < snapshot.magic_infos.size(); i++)
+    {
+      const std::string& element_value = snapshot.magic_infos[i].*member;
+
+      // Add a separator between values
+      if (!output.empty()) output.append(snapshot.separator);
+
+      output.append(element_value);
+    }
+    return output;
+  }
+
+  static std::string GetSelectionDir(const SELECTION_SNAPSHOT& snapshot)
+  {
+    const StringList& elements = snapshot.context.GetElements();
+    std::string output;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+      const std::string& element = elements[i];
+      std::string element_value = snapshot.context.IsFile(i) ? ra::filesystem::GetParentPath(element) : element;
+
+      // Add a separator between values
+      if (!output.empty()) output.append(snapshot.separator);
+
+      output.append(element_value);
+    }
+    return output;
+  }
+
+  static std::string GetSelectionParentPath(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementParentPath); }
+  static std::string GetSelectionParentFilename(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementParentFilename); }
+  static std::string GetSelectionFilename(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementFilename); }
+  static std::string GetSelectionFilenameNoExt(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementFilenameNoExt); }
+  static std::string GetSelectionFilenameExtension(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementFilenameExtension); }
+  static std::string GetSelectionDriveLetter(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementDriveLetter); }
+  static std::string GetSelectionDrivePath(const SELECTION_SNAPSHOT& snapshot) { return JoinElementProperty(snapshot, &GetElementDrivePath); }
+  static std::string GetSelectionMimeType(const SELECTION_SNAPSHOT& snapshot) { return JoinElementInfo(snapshot, &ELEMENT_INFO::mimetype); }
+  static std::string GetSelectionDescription(const SELECTION_SNAPSHOT& snapshot) { return JoinElementInfo(snapshot, &ELEMENT_INFO::description); }
+  static std::string GetSelectionCharset(const SELECTION_SNAPSHOT& snapshot) { return JoinElementInfo(snapshot, &ELEMENT_INFO::charset); }
+
+  static bool FindSingleDirectoryFiles(const SELECTION_SNAPSHOT& snapshot, ra::strings::StringVector& files)
+  {
+    // Directory based properties
+    if (snapshot.context.GetElements().size() != 1)
+      return false;
+    if (!snapshot.context.IsDirectory(0))
+      return false;
+    const std::string& element = snapshot.context.GetElements()[0];
+    bool files_found = ra::filesystem::FindFilesUtf8(files, element.c_str(), 0);
+    return files_found;
+  }
+
+  static std::string GetSelectionDirCount(const SELECTION_SNAPSHOT& snapshot)
+  {
+    ra::strings::StringVector files;
+    if (!FindSingleDirectoryFiles(snapshot, files))
+      return "";
+    return ra::strings::ToString(files.size());
+  }
+
+  static std::string GetSelectionDirEmpty(const SELECTION_SNAPSHOT& snapshot)
+  {
+    ra::strings::StringVector files;
+    if (!FindSingleDirectoryFiles(snapshot, files))
+      return "";
+    return (files.size() == 0 ? "true" : "false");
+  }
+
   void SelectionContext::RegisterProperties() const
   {
     SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
@@ -72,134 +282,53 @@ namespace shellanything
 
     PropertyManager& pmgr = PropertyManager::GetInstance();
 
-    FileMagicManager& fm = FileMagicManager::GetInstance();
-
     const StringList& elements = GetElements();
 
     if (elements.empty())
       return; // Nothing to register
 
-    std::string selection_path;
-    std::string selection_dir;
-    std::string selection_dir_count;
-    std::string selection_dir_empty;
-    std::string selection_parent_path;
-    std::string selection_parent_filename;
-    std::string selection_filename;
-    std::string selection_filename_noext;
-    std::string selection_filename_ext;
-    std::string selection_drive_letter;
-    std::string selection_drive_path;
-    std::string selection_count;
-    std::string selection_files_count;
-    std::string selection_directories_count;
-    std::string selection_mimetype;
-    std::string selection_description;
-    //std::string selection_libmagic_ext ;
-    std::string selection_charset;
-
     // Get the separator string for multiple selection 
-    const std::string& selection_multi_separator = pmgr.GetProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME);
+    const std::string selection_multi_separator = pmgr.GetProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME);
 
-    // For each element
-    for (size_t i = 0; i < elements.size(); i++)
-    {
-      const std::string& element = elements[i];
-
-      bool isFile = ra::filesystem::FileExistsUtf8(element.c_str());
-      bool isDir = ra::filesystem::DirectoryExistsUtf8(element.c_str());
-
-      //${selection.path} is the full path of the clicked element
-      //${selection.dir} is the directory of the clicked element
-      //${selection.parent.path} is the full path of the parent element
-      //${selection.parent.filename} is the filename of the parent element
-      //${selection.filename} is selection.filename (including file extension)
-      //${selection.filename_noext} is selection.filename without file extension
-      //${selection.filename.extension} is the file extension of the clicked element.
-
-      // Build properties for this specific element
-      std::string element_selection_path = element;
-      std::string element_selection_dir = isFile ? ra::filesystem::GetParentPath(element_selection_path) : element;
-      std::string element_selection_parent_path = ra::filesystem::GetParentPath(element_selection_path);
-      std::string element_selection_parent_filename = ra::filesystem::GetFilename(element_selection_parent_path.c_str());
-      std::string element_selection_filename = ra::filesystem::GetFilename(element_selection_path.c_str());
-      std::string element_selection_filename_noext = ra::filesystem::GetFilenameWithoutExtension(element_selection_path.c_str());
-      std::string element_selection_filename_ext = ra::filesystem::GetFileExtention(element_selection_filename);
-      std::string element_selection_drive_letter = GetDriveLetter(element);
-      std::string element_selection_drive_path = GetDrivePath(element);
-      std::string element_selection_mimetype = fm.GetMIMEType(element_selection_path);
-      std::string element_selection_description = fm.GetDescription(element_selection_path);
-      //std::string element_selection_libmagic_ext  = fm.GetExtension(element_selection_path);
-      std::string element_selection_charset = fm.GetCharset(element_selection_path);
+    // Only the path list is built now. Other properties are computed when they are first read.
+    std::shared_ptr<SELECTION_SNAPSHOT> snapshot(new SELECTION_SNAPSHOT());
+    snapshot->context = (*this);
+    snapshot->separator = selection_multi_separator;
+    snapshot->magic_analyzed = false;
 
-      // Add a separator between values
-      if (!selection_path.empty()) selection_path.append(selection_multi_separator);
-      if (!selection_dir.empty()) selection_dir.append(selection_multi_separator);
-      if (!selection_parent_path.empty()) selection_parent_path.append(selection_multi_separator);
-      if (!selection_parent_filename.empty()) selection_parent_filename.append(selection_multi_separator);
-      if (!selection_filename.empty()) selection_filename.append(selection_multi_separator);
-      if (!selection_filename_noext.empty()) selection_filename_noext.append(selection_multi_separator);
-      if (!selection_filename_ext.empty()) selection_filename_ext.append(selection_multi_separator);
-      if (!selection_drive_letter.empty()) selection_drive_letter.append(selection_multi_separator);
-      if (!selection_drive_path.empty()) selection_drive_path.append(selection_multi_separator);
-      if (!selection_mimetype.empty()) selection_mimetype.append(selection_multi_separator);
-      if (!selection_description.empty()) selection_description.append(selection_multi_separator);
-      //if (!selection_libmagic_ext .empty()) selection_libmagic_ext    .append( selection_multi_separator );
-      if (!selection_charset.empty()) selection_charset.append(selection_multi_separator);
-
-      // Append this specific element properties to the global property string
-      selection_path.append(element_selection_path);
-      selection_dir.append(element_selection_dir);
-      selection_parent_path.append(element_selection_parent_path);
-      selection_parent_filename.append(element_selection_parent_filename);
-      selection_filename.append(element_selection_filename);
-      selection_filename_noext.append(element_selection_filename_noext);
-      selection_filename_ext.append(element_selection_filename_ext);
-      selection_drive_letter.append(element_selection_drive_letter);
-      selection_drive_path.append(element_selection_drive_path);
-      selection_mimetype.append(element_selection_mimetype);
-      selection_description.append(element_selection_description);
-      //selection_libmagic_ext .append( element_selection_libmagic_ext    );
-      selection_charset.append(element_selection_charset);
-    }
+    std::string selection_path = JoinElementProperty(*snapshot, &GetElementPath);
+    pmgr.SetProperty("selection.path", selection_path);
 
-    // Directory based properties
-    if (elements.size() == 1)
+    // Registering the same selection again must not count as a change of the lazy properties.
+    // The key identifies the elements, their metadata and the separator used to compute the values.
+    std::string key = selection_multi_separator;
+    for (size_t i = 0; i < elements.size(); i++)
     {
-      const std::string& element = elements[0];
-      bool isDir = ra::filesystem::DirectoryExistsUtf8(element.c_str());
-      if (isDir)
-      {
-        ra::strings::StringVector files;
-        bool files_found = ra::filesystem::FindFilesUtf8(files, element.c_str(), 0);
-        if (files_found)
-        {
-          selection_dir_count = ra::strings::ToString(files.size());
-          selection_dir_empty = (files.size() == 0 ? "true" : "false");
-        }
-      }
+      key.append("\n");
+      key.append(elements[i]);
+      key.append("|");
+      key.append(ra::strings::ToString(GetElementSize(i)));
+      key.append("|");
+      key.append(ra::strings::ToString(GetElementModifiedDate(i)));
     }
 
-    pmgr.SetProperty("selection.path", selection_path);
-    pmgr.SetProperty("selection.dir", selection_dir);
-    pmgr.SetProperty("selection.dir.count", selection_dir_count);
-    pmgr.SetProperty("selection.dir.empty", selection_dir_empty);
-    pmgr.SetProperty("selection.parent.path", selection_parent_path);
-    pmgr.SetProperty("selection.parent.filename", selection_parent_filename);
-    pmgr.SetProperty("selection.filename", selection_filename);
-    pmgr.SetProperty("selection.filename.noext", selection_filename_noext);
-    pmgr.SetProperty("selection.filename.extension", selection_filename_ext);
-    pmgr.SetProperty("selection.drive.letter", selection_drive_letter);
-    pmgr.SetProperty("selection.drive.path", selection_drive_path);
-    pmgr.SetProperty("selection.drive.path", selection_drive_path);
-    pmgr.SetProperty("selection.mimetype", selection_mimetype);
-    pmgr.SetProperty("selection.description", selection_description);
-    //pmgr.SetProperty("selection.libmagic_ext"     , selection_libmagic_ext   );
-    pmgr.SetProperty("selection.charset", selection_charset);
-
-    selection_count = ra::strings::ToString(elements.size());
-    selection_files_count = ra::strings::ToString(this->GetNumFiles());
-    selection_directories_count = ra::strings::ToString(this->GetNumDirectories());
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.dir", snapshot, &GetSelectionDir), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.dir.count", snapshot, &GetSelectionDirCount), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.dir.empty", snapshot, &GetSelectionDirEmpty), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.parent.path", snapshot, &GetSelectionParentPath), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.parent.filename", snapshot, &GetSelectionParentFilename), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.filename", snapshot, &GetSelectionFilename), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.filename.noext", snapshot, &GetSelectionFilenameNoExt), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.filename.extension", snapshot, &GetSelectionFilenameExtension), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.drive.letter", snapshot, &GetSelectionDriveLetter), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.drive.path", snapshot, &GetSelectionDrivePath), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.mimetype", snapshot, &GetSelectionMimeType), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.description", snapshot, &GetSelectionDescription), key);
+    pmgr.SetLazyProperty(new SelectionLazyProperty("selection.charset", snapshot, &GetSelectionCharset), key);
+
+    std::string selection_count = ra::strings::ToString(elements.size());
+    std::string selection_files_count = ra::strings::ToString(this->GetNumFiles());
+    std::string selection_directories_count = ra::strings::ToString(this->GetNumDirectories());
 
     pmgr.SetProperty("selection.count", selection_count);
     pmgr.SetProperty("selection.files.count", selection_files_count);
@@ -211,6 +340,8 @@ namespace shellanything
     PropertyManager& pmgr = PropertyManager::GetInstance();
     pmgr.ClearProperty("selection.path");
     pmgr.ClearProperty("selection.dir");
+    pmgr.ClearProperty("selection.dir.count");
+    pmgr.ClearProperty("selection.dir.empty");
     pmgr.ClearProperty("selection.parent.path");
     pmgr.ClearProperty("selection.parent.filename");
     pmgr.ClearProperty("selection.filename");
@@ -220,7 +351,6 @@ namespace shellanything
     pmgr.ClearProperty("selection.drive.path");
     pmgr.ClearProperty("selection.mimetype");
     pmgr.ClearProperty("selection.description");
-    //pmgr.ClearProperty("selection.libmagic_ext"       );
     pmgr.ClearProperty("selection.charset");
   }
 
@@ -236,19 +366,77 @@ namespace shellanything
     mNumFiles = 0;
     mNumDirectories = 0;
 
+    // Read the filesystem information of each element once
+    SelectionAnalyzer analyzer;
+    ElementInfoList infos;
+    analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_FILESYSTEM, infos);
+
+    mElementTypes.resize(infos.size());
+    mElementAttributes.resize(infos.size());
+    mElementSizes.resize(infos.size());
+    mElementModifiedDates.resize(infos.size());
+
     // Update stats
-    for (size_t i = 0; i < elements.size(); i++)
+    for (size_t i = 0; i < infos.size(); i++)
     {
-      const std::string& element = elements[i];
-      bool isFile = ra::filesystem::FileExistsUtf8(element.c_str());
-      bool isDir = ra::filesystem::DirectoryExistsUtf8(element.c_str());
-      if (isFile)
+      const ELEMENT_INFO& info = infos[i];
+
+      ELEMENT_TYPE type = ELEMENT_TYPE_NONE;
+      if (info.is_file)
+        type = ELEMENT_TYPE_FILE;
+      else if (info.is_directory)
+        type = ELEMENT_TYPE_DIRECTORY;
+
+      mElementTypes[i] = (uint8_t)type;
+      mElementAttributes[i] = info.attributes;
+      mElementSizes[i] = info.size;
+      mElementModifiedDates[i] = info.modified_date;
+
+      if (info.is_file)
         mNumFiles++;
-      if (isDir)
+      if (info.is_directory)
         mNumDirectories++;
     }
   }
 
+  SelectionContext::ELEMENT_TYPE SelectionContext::GetElementType(size_t index) const
+  {
+    if (index >= mElementTypes.size())
+      return ELEMENT_TYPE_NONE;
+    return (ELEMENT_TYPE)mElementTypes[index];
+  }
+
+  bool SelectionContext::IsFile(size_t index) const
+  {
+    return GetElementType(index) == ELEMENT_TYPE_FILE;
+  }
+
+  bool SelectionContext::IsDirectory(size_t index) const
+  {
+    return GetElementType(index) == ELEMENT_TYPE_DIRECTORY;
+  }
+
+  uint64_t SelectionContext::GetElementSize(size_t index) const
+  {
+    if (index >= mElementSizes.size())
+      return 0;
+    return mElementSizes[index];
+  }
+
+  uint64_t SelectionContext::GetElementModifiedDate(size_t index) const
+  {
+    if (index >= mElementModifiedDates.size())
+      return 0;
+    return mElementModifiedDates[index];
+  }
+
+  uint32_t SelectionContext::GetElementAttributes(size_t index) const
+  {
+    if (index >= mElementAttributes.size())
+      return 0;
+    return mElementAttributes[index];
+  }
+
   int SelectionContext::GetNumFiles() const
   {
     return mNumFiles;
@@ -30,6 +30,7 @@
 #include "StringList.h"
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 namespace shellanything
 {
@@ -50,6 +51,16 @@ namespace shellanything
     /// </summary>
     static const std::string DEFAULT_MULTI_SELECTION_SEPARATOR;
 
+    /// <summary>
+    /// Type of a selected element.
+    /// </summary>
+    enum ELEMENT_TYPE
+    {
+      ELEMENT_TYPE_NONE = 0, // The element does not exist.
+      ELEMENT_TYPE_FILE,
+      ELEMENT_TYPE_DIRECTORY,
+    };
+
     SelectionContext();
     SelectionContext(const SelectionContext& c);
     virtual ~SelectionContext();
@@ -61,6 +72,8 @@ namespace shellanything
 
     /// <summary>
     /// Register a list of 'properties' based on the context elements.
+    /// Only 'selection.path' and the count properties are computed immediately.
+    /// Other properties are registered as lazy properties and computed when first read.
     /// </summary>
     void RegisterProperties() const;
 
@@ -76,9 +89,48 @@ namespace shellanything
 
     /// <summary>
     /// Set the list of elements to the SelectionContext.
+    /// The filesystem information of each element is read once and stored in the context.
     /// </summary>
     void SetElements(const StringList& elements);
 
+    /// <summary>
+    /// Get the type of the element at the given index.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    /// <returns>Returns the type of the element. Returns ELEMENT_TYPE_NONE if the element does not exist or if the index is out of range.</returns>
+    ELEMENT_TYPE GetElementType(size_t index) const;
+
+    /// <summary>
+    /// Check if the element at the given index is a file.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    bool IsFile(size_t index) const;
+
+    /// <summary>
+    /// Check if the element at the given index is a directory.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    bool IsDirectory(size_t index) const;
+
+    /// <summary>
+    /// Get the size in bytes of the element at the given index.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    uint64_t GetElementSize(size_t index) const;
+
+    /// <summary>
+    /// Get the last modification date of the element at the given index, in seconds since epoch.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    uint64_t GetElementModifiedDate(size_t index) const;
+
+    /// <summary>
+    /// Get the platform specific attributes of the element at the given index.
+    /// The value is a combination of FILE_ATTRIBUTE_* values on Windows.
+    /// </summary>
+    /// <param name="index">The index of the element in GetElements().</param>
+    uint32_t GetElementAttributes(size_t index) const;
+
     /// <summary>
     /// Get the number of files in the context.
     /// </summary>
@@ -91,6 +143,13 @@ namespace shellanything
 
   private:
     StringList mElements;
+
+    // Filesystem information of each element, indexed like mElements.
+    std::vector<uint8_t> mElementTypes;
+    std::vector<uint32_t> mElementAttributes;
+    std::vector<uint64_t> mElementSizes;
+    std::vector<uint64_t> mElementModifiedDates;
+
     int mNumFiles;
     int mNumDirectories;
   };
@@ -25,6 +25,10 @@
 #include "shellanything/sa_plugin_definitions.h"
 #include <string>
 #include <limits>
+#include <unordered_set>
+#include <chrono>
+#include <atomic>
+#include <string.h>
 #include "Validator.h"
 #include "PropertyManager.h"
 #include "ConfigFile.h"
@@ -33,7 +37,7 @@
 #include "LoggerHelper.h"
 #include "KeyboardHelper.h"
 #include "SaUtils.h"
-#include "libexprtk.h"
+#include "ExprtkHelper.h"
 #include "rapidassist/strings.h"
 #include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/environment.h"
@@ -68,15 +72,6 @@ namespace shellanything
     return false;
   }
 
-  void Uppercase(ra::strings::StringVector& values)
-  {
-    for (size_t i = 0; i < values.size(); i++)
-    {
-      std::string tmp = ra::strings::Uppercase(values[i]);
-      values[i] = tmp;
-    }
-  }
-
   inline std::string GetPrevalidateMessage(const char* attr_name, bool inversed, const std::string & value)
   {
     std::string s;
@@ -127,16 +122,309 @@ namespace shellanything
   static const int MAX_FILES = std::numeric_limits<int>::max();
   static const int MAX_DIRS = std::numeric_limits<int>::max();
 
+  // Attributes that can be listed in the 'inverse' attribute. The index of each name is its flag in Validator::mInversedFlags.
+  static const char* INVERSABLE_ATTRIBUTES[] = {
+    "all",
+    "maxfiles",
+    "maxfolders",
+    "properties",
+    "fileextensions",
+    "exists",
+    "class",
+    "pattern",
+    "exprtk",
+    "istrue",
+    "isfalse",
+    "isempty",
+    "keyboard",
+  };
+  static const size_t NUM_INVERSABLE_ATTRIBUTES = sizeof(INVERSABLE_ATTRIBUTES) / sizeof(INVERSABLE_ATTRIBUTES[0]);
+  static const uint32_t INVERSED_ALL = 1;
+
+  static inline int FindInversableAttribute(const std::string& name)
+  {
+    for (size_t i = 0; i < NUM_INVERSABLE_ATTRIBUTES; i++)
+    {
+      if (name == INVERSABLE_ATTRIBUTES[i])
+        return (int)i;
+    }
+    return -1;
+  }
+
+  // Checks of a validator, in source order.
+  enum VALIDATION_CHECK
+  {
+    CHECK_MAXFILES,
+    CHECK_MAXFOLDERS,
+    CHECK_PROPERTIES,
+    CHECK_FILEEXTENSIONS,
+    CHECK_EXISTS,
+    CHECK_CLASS,
+    CHECK_PATTERN,
+    CHECK_EXPRTK,
+    CHECK_ISTRUE,
+    CHECK_ISFALSE,
+    CHECK_ISEMPTY,
+    CHECK_PLUGINS,
+    CHECK_KEYBOARD,
+    CHECK_CONFIG_PLUGINS,
+    NUM_VALIDATION_CHECKS
+  };
+
+  static const char* VALIDATION_CHECK_NAMES[NUM_VALIDATION_CHECKS] = {
+    "maxfiles",
+    "maxfolders",
+    "properties",
+    "fileextensions",
+    "exists",
+    "class",
+    "pattern",
+    "exprtk",
+    "istrue",
+    "isfalse",
+    "isempty",
+    "plugins",
+    "keyboard",
+    "configplugins",
+  };
+
+  // Checks of a validator, ordered by estimated cost.
+  // Counters first, then string checks, filesystem checks and expressions.
+  // Plugins may have side effects. They keep their source order position relative to
+  // the keyboard check so that a plugin is called in exactly the same cases as before.
+  static const VALIDATION_CHECK VALIDATION_PLAN[NUM_VALIDATION_CHECKS] = {
+    CHECK_MAXFILES,
+    CHECK_MAXFOLDERS,
+    CHECK_PROPERTIES,
+    CHECK_FILEEXTENSIONS,
+    CHECK_PATTERN,
+    CHECK_ISTRUE,
+    CHECK_ISFALSE,
+    CHECK_ISEMPTY,
+    CHECK_EXISTS,
+    CHECK_CLASS,
+    CHECK_EXPRTK,
+    CHECK_PLUGINS,
+    CHECK_KEYBOARD,
+    CHECK_CONFIG_PLUGINS,
+  };
+
+  static std::atomic<bool> gStatisticsEnabled(false);
+
+  static const std::string& GetCheckAttribute(int check)
+  {
+    static const std::string EMPTY;
+    switch (check)
+    {
+    case CHECK_MAXFILES:        return Validator::ATTRIBUTE_MAXFILES;
+    case CHECK_MAXFOLDERS:      return Validator::ATTRIBUTE_MAXDIRECTORIES;
+    case CHECK_PROPERTIES:      return Validator::ATTRIBUTE_PROPERTIES;
+    case CHECK_FILEEXTENSIONS:  return Validator::ATTRIBUTE_FILEEXTENSIONS;
+    case CHECK_EXISTS:          return Validator::ATTRIBUTE_EXISTS;
+    case CHECK_CLASS:           return Validator::ATTRIBUTE_CLASS;
+    case CHECK_PATTERN:         return Validator::ATTRIBUTE_PATTERN;
+    case CHECK_EXPRTK:          return Validator::ATTRIBUTE_EXPRTK;
+    case CHECK_ISTRUE:          return Validator::ATTRIBUTE_ISTRUE;
+    case CHECK_ISFALSE:         return Validator::ATTRIBUTE_ISFALSE;
+    case CHECK_ISEMPTY:         return Validator::ATTRIBUTE_ISEMPTY;
+    case CHECK_KEYBOARD:        return Validator::ATTRIBUTE_KEYBOARD;
+    default:
+      return EMPTY;
+    };
+  }
+
+  // Classes of a selected element.
+  enum CLASS_FLAGS
+  {
+    CLASS_FILE = 1 << 0,
+    CLASS_DIRECTORY = 1 << 1,
+    CLASS_DRIVE = 1 << 2,
+  };
+
+  static inline uint32_t GetDriveClassFlag(DRIVE_CLASS drive_class)
+  {
+    return (1 << (3 + (int)drive_class));
+  }
+
+  static const uint32_t CLASS_DRIVE_CLASSES =
+    (1 << (3 + DRIVE_CLASS_REMOVABLE)) |
+    (1 << (3 + DRIVE_CLASS_FIXED)) |
+    (1 << (3 + DRIVE_CLASS_NETWORK)) |
+    (1 << (3 + DRIVE_CLASS_OPTICAL)) |
+    (1 << (3 + DRIVE_CLASS_RAMDISK));
+
+  /// <summary>
+  /// An attribute value compiled from an expanded attribute value.
+  /// </summary>
+  template <typename T>
+  struct COMPILED_VALUE
+  {
+    std::string source;
+    bool compiled;
+    T value;
+
+    COMPILED_VALUE() : compiled(false) {}
+
+    // Returns true if 'value' must be compiled again from the given expanded value.
+    bool Update(const std::string& expanded)
+    {
+      if (compiled && source == expanded)
+        return false;
+      source = expanded;
+      compiled = true;
+      return true;
+    }
+  };
+
+  struct Validator::FILE_EXTENSIONS
+  {
+    std::string uppercase; // all file extensions, for logging.
+    std::unordered_set<std::string> values; // each file extension, in uppercase.
+  };
+
+  struct Validator::COMPILED_ATTRIBUTES
+  {
+    struct CLASSES
+    {
+      bool has_file_extensions;
+      std::string file_extensions; // file extensions found in the classes, for logging.
+      FILE_EXTENSIONS extensions;
+      bool has_classes;
+      uint32_t flags; // CLASS_FLAGS of all known classes.
+      StringList unknown_classes;
+      std::string valid_classes; // known drive classes, for logging.
+    };
+
+    COMPILED_VALUE<StringList> properties;
+    COMPILED_VALUE<FILE_EXTENSIONS> file_extensions;
+    COMPILED_VALUE<StringList> exists;
+    COMPILED_VALUE<CLASSES> classes;
+    COMPILED_VALUE<WildcardMatcher> patterns;
+    COMPILED_VALUE<StringList> istrue;
+    COMPILED_VALUE<StringList> isfalse;
+    COMPILED_VALUE<StringList> keyboard;
+
+    struct CHECK_STATISTICS
+    {
+      uint64_t evaluations;
+      uint64_t failures;
+      uint64_t skipped;     // number of times the check was not evaluated because a less expensive check has failed.
+      uint64_t saved;       // number of skipped evaluations which would have been evaluated in source order.
+      uint64_t elapsed_ns;  // total evaluation time in nanoseconds.
+    };
+    struct STATISTICS
+    {
+      uint64_t validations;
+      uint64_t failures;
+      CHECK_STATISTICS checks[NUM_VALIDATION_CHECKS];
+
+      STATISTICS() : validations(0), failures(0)
+      {
+        memset(checks, 0, sizeof(checks));
+      }
+    };
+    STATISTICS statistics;
+
+    static void CompileFileExtensions(const std::string& file_extensions, FILE_EXTENSIONS& output)
+    {
+      output.uppercase = ra::strings::Uppercase(file_extensions);
+      output.values.clear();
+
+      ra::strings::StringVector values = ra::strings::Split(output.uppercase, SA_FILEEXTENSION_ATTR_SEPARATOR_STR);
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        output.values.insert(values[i]);
+      }
+    }
+
+    static void CompileClasses(const std::string& class_, CLASSES& output)
+    {
+      output.has_file_extensions = false;
+      output.file_extensions.clear();
+      output.has_classes = false;
+      output.flags = 0;
+      output.unknown_classes.clear();
+      output.valid_classes.clear();
+
+      //split
+      ra::strings::StringVector classes = ra::strings::Split(class_, SA_CLASS_ATTR_SEPARATOR_STR);
+
+      // Search for file extensions. All file extensions must be extracted from the list and evaluated all at once.
+      ra::strings::StringVector remaining_classes;
+      for (size_t i = classes.size(); i > 0; i--)
+      {
+        const std::string& element = classes[i - 1];
+
+        // Is this a class file extension filter?
+        if (!element.empty() && element[0] == '.')
+        {
+          // Extract the file extension
+          std::string file_extension;
+          if (element.size() >= 2)
+            file_extension = element.substr(1);
+
+          // Add to the file extension list
+          if (!output.file_extensions.empty())
+            output.file_extensions.insert(0, 1, SA_CLASS_ATTR_SEPARATOR_CHAR);
+          output.file_extensions.insert(0, file_extension.c_str());
+
+          output.has_file_extensions = true;
+        }
+        else
+          remaining_classes.insert(remaining_classes.begin(), element);
+      }
+      CompileFileExtensions(output.file_extensions, output.extensions);
+
+      // Parse the remaining class elements
+      if (!remaining_classes.empty())
+      {
+        output.has_classes = true;
+
+        //join remaining classes into a single string and split again
+        std::string classes_str = ra::strings::Join(remaining_classes, SA_CLASS_ATTR_SEPARATOR_STR);
+        remaining_classes = ra::strings::Split(classes_str, SA_CLASS_ATTR_SEPARATOR_STR);
+
+        for (size_t i = 0; i < remaining_classes.size(); i++)
+        {
+          const std::string& class_name = remaining_classes[i];
+          DRIVE_CLASS drive_class = GetDriveClassFromString(class_name.c_str());
+
+          if (class_name == "file")
+            output.flags |= CLASS_FILE;
+          else if (class_name == "folder" || class_name == "directory")
+            output.flags |= CLASS_DIRECTORY;
+          else if (class_name == "drive")
+            output.flags |= CLASS_DRIVE;
+          else if (drive_class != DRIVE_CLASS_UNKNOWN)
+            output.flags |= GetDriveClassFlag(drive_class);
+          else
+            output.unknown_classes.push_back(class_name);
+
+          // Build a valid classes list from the given classes (strings)
+          if (drive_class != DRIVE_CLASS_UNKNOWN)
+          {
+            if (!output.valid_classes.empty()) output.valid_classes.append(1, ',');
+            output.valid_classes += class_name;
+          }
+        }
+      }
+    }
+  };
 
   Validator::Validator() :
     mMaxFiles(MAX_FILES),
     mMaxDirectories(MAX_DIRS),
-    mLastValidateSuccessful(true)
+    mLastValidateSuccessful(true),
+    mCompiled(new COMPILED_ATTRIBUTES()),
+    mPerformanceCounters(),
+    mInversedFlags(0)
   {
   }
 
   Validator::~Validator()
   {
+    delete mCompiled;
+    mCompiled = NULL;
   }
 
   Menu* Validator::GetParentMenu()
@@ -296,6 +584,16 @@ namespace shellanything
   void Validator::SetInserve(const std::string& inserve)
   {
     mAttributes.SetProperty(ATTRIBUTE_INSERVE, inserve);
+
+    // Compile the list of inversed attributes
+    mInversedFlags = 0;
+    mInversedNames = ra::strings::Split(inserve, SA_INVERSE_ATTR_SEPARATOR_STR);
+    for (size_t i = 0; i < mInversedNames.size(); i++)
+    {
+      int index = FindInversableAttribute(mInversedNames[i]);
+      if (index >= 0)
+        mInversedFlags |= (1 << index);
+    }
   }
 
   bool Validator::IsInversed(const char* name) const
@@ -305,287 +603,333 @@ namespace shellanything
     if (name[0] == '\0')
       return false;
 
-    std::string tmp_name = name;
-
     // Validate with 'all' attribute
-    if (tmp_name != "all")
-    {
-      if (IsInversed("all"))
-        return true;
-    }
-
-    const std::string& inverse_attr = mAttributes.GetProperty(Validator::ATTRIBUTE_INSERVE);
-
-    size_t name_length = tmp_name.size();
-    size_t search_index = 0;
-    size_t pos = inverse_attr.find(name, search_index);
-    while (pos != std::string::npos)
-    {
-      // The name of the attribute was found.
-
-      // To prevent finding attribute 'foo' from attribute 'foobar',
-      // The end of the attribute should match the end of the mInverse string or
-      // followed by a ';' character.
-      char next = '\0';
-      if (pos + name_length < inverse_attr.size())
-        next = inverse_attr[pos + name_length];
-
-      if (next == '\0' || next == SA_INVERSE_ATTR_SEPARATOR_CHAR)
-      {
-        // Good. Keep looking
-
-        // To prevent finding attribute 'bar' from attribute 'foobar',
-        // The beginning of the attribute should match the beginning of the mInverse string or
-        // the previous character must be a ';' character.
-        if (pos == 0)
-          return true; // We have a match!
-
-        char previous = SA_INVERSE_ATTR_SEPARATOR_CHAR;
-        if (pos >= 1)
-          previous = inverse_attr[pos - 1];
-
-        if (previous == SA_INVERSE_ATTR_SEPARATOR_CHAR)
-          return true; // We have a match!
-      }
+    if (mInversedFlags & INVERSED_ALL)
+      return true;
 
-      // This is not the attribute we are looking for.
-      // Move the searched position at the next possible offset
-      // and search again.
-      search_index += name_length;
-      pos = inverse_attr.find(name, search_index);
-    }
+    std::string tmp_name = name;
+    int index = FindInversableAttribute(tmp_name);
+    if (index >= 0)
+      return (mInversedFlags & (1 << index)) != 0;
 
-    return false;
+    // Custom attribute
+    return HasValue(mInversedNames, tmp_name);
   }
 
-  bool Validator::Validate(const SelectionContext& context) const
+  const std::string& Validator::ExpandAttribute(const std::string& name) const
   {
-    SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
-    sli.verbose = true;
-    sli.instance = this;
-    ScopeLogger logger(&sli);
-
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-    const char * attr_name = "";
-
-    // assume validation will fail
-    mLastValidateSuccessful = false;
+    // Attributes are only expanded again when a property they depends on is modified.
+    CachedExpansion& expansion = mExpandedAttributes[name];
+    const std::string& expanded = expansion.Expand(mAttributes.GetProperty(name));
+    return expanded;
+  }
 
-    attr_name = "maxfiles";
-    bool maxfiles_inversed = IsInversed(attr_name);
-    if (!maxfiles_inversed && context.GetNumFiles() > mMaxFiles)
+  bool Validator::IsCheckDefined(int check) const
+  {
+    switch (check)
     {
-      SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, maxfiles_inversed);
-      return false; //too many files selected
-    }
-    if (maxfiles_inversed && context.GetNumFiles() <= mMaxFiles)
+    case CHECK_MAXFILES:
+    case CHECK_MAXFOLDERS:
+      return true;
+    case CHECK_PROPERTIES:
+      return !mAttributes.GetProperty(ATTRIBUTE_PROPERTIES).empty();
+    case CHECK_FILEEXTENSIONS:
+      return !mAttributes.GetProperty(ATTRIBUTE_FILEEXTENSIONS).empty();
+    case CHECK_EXISTS:
+      return !mAttributes.GetProperty(ATTRIBUTE_EXISTS).empty();
+    case CHECK_CLASS:
+      return !mAttributes.GetProperty(ATTRIBUTE_CLASS).empty();
+    case CHECK_PATTERN:
+      return !mAttributes.GetProperty(ATTRIBUTE_PATTERN).empty();
+    case CHECK_EXPRTK:
+      return !mAttributes.GetProperty(ATTRIBUTE_EXPRTK).empty();
+    case CHECK_ISTRUE:
+      return !mAttributes.GetProperty(ATTRIBUTE_ISTRUE).empty();
+    case CHECK_ISFALSE:
+      return !mAttributes.GetProperty(ATTRIBUTE_ISFALSE).empty();
+    case CHECK_ISEMPTY:
+      return !mAttributes.GetProperty(ATTRIBUTE_ISEMPTY).empty();
+    case CHECK_PLUGINS:
+      return !mPlugins.empty();
+    case CHECK_KEYBOARD:
+      return !mAttributes.GetProperty(ATTRIBUTE_KEYBOARD).empty();
+    case CHECK_CONFIG_PLUGINS:
     {
-      SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, maxfiles_inversed);
-      return false; //too many files selected
+      //check if we are updating a ConfigFile.
+      ConfigFile* updating_config = ConfigFile::GetUpdatingConfigFile();
+      return (updating_config != NULL && !updating_config->GetPlugins().empty());
     }
+    default:
+      return false;
+    };
+  }
 
-    attr_name = "maxfolders";
-    bool maxfolders_inversed = IsInversed(attr_name);
-    if (!maxfolders_inversed && context.GetNumDirectories() > mMaxDirectories)
-    {
-      SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, maxfolders_inversed);
-      return false; //too many directories selected
-    }
-    if (maxfolders_inversed && context.GetNumDirectories() <= mMaxDirectories)
-    {
-      SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, maxfolders_inversed);
-      return false; //too many directories selected
-    }
+  bool Validator::ValidateCheck(const SelectionContext& context, int check) const
+  {
+    const char* attr_name = VALIDATION_CHECK_NAMES[check];
 
-    //validate properties
-    const std::string properties = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_PROPERTIES));
-    if (!properties.empty())
+    switch (check)
     {
-      attr_name = "properties";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, properties);
-      bool valid = ValidateProperties(context, properties, inversed);
-      if (!valid)
-      {
-        SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
-      }
-    }
-
-    //validate file extentions
-    const std::string file_extensions = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_FILEEXTENSIONS));
-    if (!file_extensions.empty())
+    case CHECK_MAXFILES:
     {
-      attr_name = "fileextensions";
       bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, file_extensions);
-      bool valid = ValidateFileExtensions(context, file_extensions, inversed);
-      if (!valid)
+      if (!inversed && context.GetNumFiles() > mMaxFiles)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
+        return false; //too many files selected
       }
-    }
-
-    //validate file/directory exists
-    const std::string file_exists = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_EXISTS));
-    if (!file_exists.empty())
-    {
-      attr_name = "exists";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, file_exists);
-      bool valid = ValidateExists(context, file_exists, inversed);
-      if (!valid)
+      if (inversed && context.GetNumFiles() <= mMaxFiles)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
+        return false; //too many files selected
       }
+      return true;
     }
-
-    //validate class
-    const std::string class_ = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_CLASS));
-    if (!class_.empty())
+    case CHECK_MAXFOLDERS:
     {
-      attr_name = "class";
       bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, class_);
-      bool valid = ValidateClass(context, class_, inversed);
-      if (!valid)
+      if (!inversed && context.GetNumDirectories() > mMaxDirectories)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
+        return false; //too many directories selected
       }
-    }
-
-    //validate pattern
-    const std::string pattern = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_PATTERN));
-    if (!pattern.empty())
-    {
-      attr_name = "pattern";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, pattern);
-      bool valid = ValidatePattern(context, pattern, inversed);
-      if (!valid)
+      if (inversed && context.GetNumDirectories() <= mMaxDirectories)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
+        return false; //too many directories selected
       }
+      return true;
     }
-
-    //validate exprtx
-    const std::string exprtk = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_EXPRTK));
-    if (!exprtk.empty())
+    case CHECK_PROPERTIES:
+    case CHECK_FILEEXTENSIONS:
+    case CHECK_EXISTS:
+    case CHECK_CLASS:
+    case CHECK_PATTERN:
+    case CHECK_EXPRTK:
+    case CHECK_ISTRUE:
+    case CHECK_ISFALSE:
     {
-      attr_name = "exprtk";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, exprtk);
-      bool valid = ValidateExprtk(context, exprtk, inversed);
-      if (!valid)
-      {
-        SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
-      }
-    }
+      const std::string& value = ExpandAttribute(GetCheckAttribute(check));
+      if (value.empty())
+        return true;
 
-    //validate istrue
-    const std::string istrue = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_ISTRUE));
-    if (!istrue.empty())
-    {
-      attr_name = "istrue";
       bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, istrue);
-      bool valid = ValidateIsTrue(context, istrue, inversed);
-      if (!valid)
+      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, value);
+      bool valid = false;
+      switch (check)
       {
-        SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
-      }
-    }
-
-    //validate isfalse
-    const std::string isfalse = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_ISFALSE));
-    if (!isfalse.empty())
-    {
-      attr_name = "isfalse";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, isfalse);
-      bool valid = ValidateIsFalse(context, isfalse, inversed);
+      case CHECK_PROPERTIES:
+        valid = ValidateProperties(context, value, inversed);
+        break;
+      case CHECK_FILEEXTENSIONS:
+        valid = ValidateFileExtensions(context, value, inversed);
+        break;
+      case CHECK_EXISTS:
+        valid = ValidateExists(context, value, inversed);
+        break;
+      case CHECK_CLASS:
+        valid = ValidateClass(context, value, inversed);
+        break;
+      case CHECK_PATTERN:
+        valid = ValidatePattern(context, value, inversed);
+        break;
+      case CHECK_EXPRTK:
+        valid = ValidateExprtk(context, value, inversed);
+        break;
+      case CHECK_ISTRUE:
+        valid = ValidateIsTrue(context, value, inversed);
+        break;
+      default:
+        valid = ValidateIsFalse(context, value, inversed);
+        break;
+      };
       if (!valid)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
         return false;
       }
+      return true;
     }
-
-    //validate isempty
-    const std::string& isempty_attr = mAttributes.GetProperty(ATTRIBUTE_ISEMPTY);
-    const std::string isempty = pmgr.Expand(isempty_attr);
-    if (!isempty_attr.empty())  // note, testing with non-expanded value instead of expanded value
+    case CHECK_ISEMPTY:
+    case CHECK_KEYBOARD:
     {
-      attr_name = "isempty";
+      // note, these attributes are defined by their non-expanded value instead of their expanded value
+      const std::string& attribute_name = GetCheckAttribute(check);
+      const std::string& attr = mAttributes.GetProperty(attribute_name);
+      const std::string& value = ExpandAttribute(attribute_name);
       bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, isempty_attr);
-      bool valid = ValidateIsEmpty(context, isempty, inversed);
+      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, attr);
+      bool valid = false;
+      if (check == CHECK_ISEMPTY)
+        valid = ValidateIsEmpty(context, value, inversed);
+      else
+        valid = ValidateKeyboard(context, value, inversed);
       if (!valid)
       {
         SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
         return false;
       }
+      return true;
     }
-
-    //validate using plugins
-    //for each plugins
-    for (size_t i = 0; i < mPlugins.size(); i++)
+    case CHECK_PLUGINS:
+    case CHECK_CONFIG_PLUGINS:
     {
-      Plugin* p = mPlugins[i];
-      bool valid = ValidatePlugin(context, p);
-      if (!valid)
+      const Plugin::PluginPtrList* plugins = &mPlugins;
+      if (check == CHECK_CONFIG_PLUGINS)
+        plugins = &ConfigFile::GetUpdatingConfigFile()->GetPlugins();
+
+      //for each plugins
+      for (size_t i = 0; i < plugins->size(); i++)
       {
-        std::string plugin_desc = std::string("plugin '") + p->GetPath() + "'";
-        SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, plugin_desc.c_str(), false);
-        return false;
+        Plugin* p = (*plugins)[i];
+        bool valid = ValidatePlugin(context, p);
+        if (!valid)
+        {
+          std::string plugin_desc = std::string("plugin '") + p->GetPath() + "'";
+          SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, plugin_desc.c_str(), false);
+          return false;
+        }
       }
+      return true;
     }
+    default:
+      return true;
+    };
+  }
+
+  bool Validator::Validate(const SelectionContext& context) const
+  {
+    SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
+    sli.verbose = true;
+    sli.instance = this;
+    ScopeLogger logger(&sli);
+    PerformanceCounters::Scope performance_scope(mPerformanceCounters);
+
+    // the expanded attributes, the compiled attributes (including the not thread safe WildcardMatcher) and the statistics are updated while validating
+    std::lock_guard<std::recursive_mutex> lock(mCacheMutex);
+
+    // assume validation will fail
+    mLastValidateSuccessful = false;
+
+    COMPILED_ATTRIBUTES::STATISTICS* statistics = (gStatisticsEnabled ? &mCompiled->statistics : NULL);
+    if (statistics)
+      statistics->validations++;
 
-    //validate keyboard
-    const std::string& keyboard_attr = mAttributes.GetProperty(ATTRIBUTE_KEYBOARD);
-    const std::string keyboard = pmgr.Expand(keyboard_attr);
-    if (!keyboard_attr.empty())  // note, testing with non-expanded value instead of expanded value
+    // Evaluate the defined checks from the least expensive to the most expensive.
+    // Attributes are only expanded when their check is evaluated.
+    for (size_t i = 0; i < NUM_VALIDATION_CHECKS; i++)
     {
-      attr_name = "keyboard";
-      bool inversed = IsInversed(attr_name);
-      SA_VERBOSE_LOG(DEBUG) << GetPrevalidateMessage(attr_name, inversed, keyboard_attr);
-      bool valid = ValidateKeyboard(context, keyboard, inversed);
-      if (!valid)
+      VALIDATION_CHECK check = VALIDATION_PLAN[i];
+      if (!IsCheckDefined(check))
+        continue;
+
+      bool valid = false;
+      if (statistics == NULL)
       {
-        SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, attr_name, inversed);
-        return false;
+        valid = ValidateCheck(context, check);
       }
-    }
-
-    //check if we are updating a ConfigFile.
-    ConfigFile* updating_config = ConfigFile::GetUpdatingConfigFile();
-    if (updating_config != NULL)
-    {
-      const Plugin::PluginPtrList& config_plugins = updating_config->GetPlugins();
-      //for each plugins
-      for (size_t i = 0; i < config_plugins.size(); i++)
+      else
       {
-        Plugin* p = config_plugins[i];
-        bool valid = ValidatePlugin(context, p);
+        std::chrono::steady_clock::time_point time_start = std::chrono::steady_clock::now();
+        valid = ValidateCheck(context, check);
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - time_start;
+
+        COMPILED_ATTRIBUTES::CHECK_STATISTICS& check_statistics = statistics->checks[check];
+        check_statistics.evaluations++;
+        check_statistics.elapsed_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
         if (!valid)
         {
-          std::string plugin_desc = std::string("plugin '") + p->GetPath() + "'";
-          SA_VERBOSE_LOG(DEBUG) << GetAttrFailMessage(this, plugin_desc.c_str(), false);
-          return false;
+          statistics->failures++;
+          check_statistics.failures++;
+
+          // Remember the checks that were not evaluated.
+          for (size_t j = i + 1; j < NUM_VALIDATION_CHECKS; j++)
+          {
+            VALIDATION_CHECK skipped = VALIDATION_PLAN[j];
+            if (!IsCheckDefined(skipped))
+              continue;
+            statistics->checks[skipped].skipped++;
+            if (skipped < check)
+              statistics->checks[skipped].saved++; // would have been evaluated before the failing check in source order.
+          }
         }
       }
+
+      if (!valid)
+        return false;
     }
 
     mLastValidateSuccessful = true;
     return true;
   }
 
+  void Validator::SetStatisticsEnabled(bool enabled)
+  {
+    gStatisticsEnabled = enabled;
+  }
+
+  bool Validator::IsStatisticsEnabled()
+  {
+    return gStatisticsEnabled;
+  }
+
+  void Validator::ResetStatistics()
+  {
+    std::lock_guard<std::recursive_mutex> lock(mCacheMutex);
+    mCompiled->statistics = COMPILED_ATTRIBUTES::STATISTICS();
+  }
+
+  const PERFORMANCE_COUNTERS& Validator::GetPerformanceCounters() const
+  {
+    return mPerformanceCounters;
+  }
+
+  void Validator::ResetPerformanceCounters()
+  {
+    PerformanceCounters::Reset(mPerformanceCounters);
+  }
+
+  void Validator::ToStatisticsString(std::string& str, int indent) const
+  {
+    const std::string indent_str = std::string(indent, ' ');
+    std::lock_guard<std::recursive_mutex> lock(mCacheMutex);
+    const COMPILED_ATTRIBUTES::STATISTICS& statistics = mCompiled->statistics;
+
+    // Estimate the time saved by not evaluating checks that would have been evaluated in source order.
+    double saved_us = 0.0;
+    for (size_t i = 0; i < NUM_VALIDATION_CHECKS; i++)
+    {
+      const COMPILED_ATTRIBUTES::CHECK_STATISTICS& check_statistics = statistics.checks[i];
+      if (check_statistics.evaluations > 0)
+        saved_us += check_statistics.saved * (check_statistics.elapsed_ns / 1000.0 / check_statistics.evaluations);
+    }
+
+    str += indent_str + "Validator " + ToHexString(this) + " statistics: ";
+    str += ra::strings::ToString(statistics.validations) + " validations, ";
+    str += ra::strings::ToString(statistics.failures) + " failures, ";
+    str += "estimated time saved: " + ra::strings::Format("%.3f", saved_us) + " us";
+
+    // Checks in evaluation order
+    for (size_t i = 0; i < NUM_VALIDATION_CHECKS; i++)
+    {
+      VALIDATION_CHECK check = VALIDATION_PLAN[i];
+      const COMPILED_ATTRIBUTES::CHECK_STATISTICS& check_statistics = statistics.checks[check];
+      if (check_statistics.evaluations == 0 && check_statistics.skipped == 0)
+        continue;
+
+      double elapsed_us = check_statistics.elapsed_ns / 1000.0;
+      double average_us = (check_statistics.evaluations > 0 ? elapsed_us / check_statistics.evaluations : 0.0);
+
+      str += "\n";
+      str += indent_str + "  " + VALIDATION_CHECK_NAMES[check] + ": ";
+      str += "evaluations=" + ra::strings::ToString(check_statistics.evaluations);
+      str += ", failures=" + ra::strings::ToString(check_statistics.failures);
+      str += ", skipped=" + ra::strings::ToString(check_statistics.skipped);
+      str += ", total=" + ra::strings::Format("%.3f", elapsed_us) + " us";
+      str += ", average=" + ra::strings::Format("%.3f", average_us) + " us";
+    }
+  }
+
   bool Validator::IsTrue(const std::string& value)
   {
     std::string upper_case_value = ra::strings::Uppercase(value);
@@ -634,7 +978,10 @@ namespace shellanything
     PropertyManager& pmgr = PropertyManager::GetInstance();
 
     //split
-    ra::strings::StringVector property_list = ra::strings::Split(properties, SA_PROPERTIES_ATTR_SEPARATOR_STR);
+    COMPILED_VALUE<StringList>& compiled = mCompiled->properties;
+    if (compiled.Update(properties))
+      compiled.value = ra::strings::Split(properties, SA_PROPERTIES_ATTR_SEPARATOR_STR);
+    const ra::strings::StringVector& property_list = compiled.value;
 
     //each property specified must exists and be non-empty
     for (size_t i = 0; i < property_list.size(); i++)
@@ -678,11 +1025,19 @@ namespace shellanything
     if (file_extensions.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    COMPILED_VALUE<FILE_EXTENSIONS>& compiled = mCompiled->file_extensions;
+    if (compiled.Update(file_extensions))
+      COMPILED_ATTRIBUTES::CompileFileExtensions(file_extensions, compiled.value);
 
-    //split
-    std::string file_extensions_uppercase = ra::strings::Uppercase(file_extensions);
-    ra::strings::StringVector accepted_file_extensions = ra::strings::Split(file_extensions_uppercase, SA_FILEEXTENSION_ATTR_SEPARATOR_STR);
+    return ValidateFileExtensions(context, compiled.value, inversed);
+  }
+
+  bool Validator::ValidateFileExtensions(const SelectionContext& context, const FILE_EXTENSIONS& file_extensions, bool inversed) const
+  {
+    if (file_extensions.uppercase.empty())
+      return true;
+
+    const std::string& file_extensions_uppercase = file_extensions.uppercase;
 
     //for each file selected
     const StringList& context_elements = context.GetElements();
@@ -691,8 +1046,8 @@ namespace shellanything
       const std::string& path = context_elements[i];
       std::string current_file_extension_uppercase = ra::strings::Uppercase(ra::filesystem::GetFileExtention(path));
 
-      //each file extension must be part of accepted_file_extensions
-      bool found = HasValue(accepted_file_extensions, current_file_extension_uppercase);
+      //each file extension must be part of accepted file extensions
+      bool found = (file_extensions.values.find(current_file_extension_uppercase) != file_extensions.values.end());
       if (!inversed && !found)
       {
         SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " File extension '" << current_file_extension_uppercase << "' from selected file '" << path << "' is not allowed because only the extensions '" << file_extensions_uppercase << "' are accepted.";
@@ -713,16 +1068,18 @@ namespace shellanything
     if (file_exists.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
-    ra::strings::StringVector mandatory_files = ra::strings::Split(file_exists, SA_EXISTS_ATTR_SEPARATOR_STR);
+    COMPILED_VALUE<StringList>& compiled = mCompiled->exists;
+    if (compiled.Update(file_exists))
+      compiled.value = ra::strings::Split(file_exists, SA_EXISTS_ATTR_SEPARATOR_STR);
+    const ra::strings::StringVector& mandatory_files = compiled.value;
 
     //for each file
     for (size_t i = 0; i < mandatory_files.size(); i++)
     {
       const std::string& element = mandatory_files[i];
       bool element_exists = false;
+      PerformanceCounters::AddFilesystemProbe();
       element_exists |= ra::filesystem::FileExistsUtf8(element.c_str());
       element_exists |= ra::filesystem::DirectoryExistsUtf8(element.c_str());
       if (!inversed && !element_exists)
@@ -740,247 +1097,110 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateSingleFileSingleClass(const std::string& path, const std::string& class_, bool inversed) const
+  static inline uint32_t GetElementClassFlags(const SelectionContext& context, size_t index, uint32_t required_flags)
   {
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    const std::string& path = context.GetElements()[index];
 
-    if (class_ == "file")
-    {
-      // Selected element must be a file
-      bool is_file = ra::filesystem::FileExistsUtf8(path.c_str());
-      if (!inversed && !is_file)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not a file.";
-        return false;
-      }
-      if (inversed && is_file)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is a file.";
-        return false;
-      }
-    }
-    else if (class_ == "folder" || class_ == "directory")
-    {
-      // Selected elements must be a directory
-      bool is_directory = ra::filesystem::DirectoryExistsUtf8(path.c_str());
-      if (!inversed && !is_directory)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not a directory.";
-        return false;
-      }
-      if (inversed && is_directory)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is a directory.";
-        return false;
-      }
-    }
-    else if (class_ == "drive")
-    {
-      // Selected elements must be mapped to a drive
-      std::string drive = GetDriveLetter(path);
-      if (!inversed && drive.empty())  // All elements must be mapped to a drive
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not on a drive.";
-        return false;
-      }
-      if (inversed && !drive.empty())  // All elements must NOT be mapped to a drive.
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is on a drive.";
-        return false;
-      }
-    }
-    else if (GetDriveClassFromString(class_.c_str()) != DRIVE_CLASS_UNKNOWN)
-    {
-      DRIVE_CLASS required_class = GetDriveClassFromString(class_.c_str());
+    uint32_t flags = 0;
+    if (context.IsFile(index))
+      flags |= CLASS_FILE;
+    if (context.IsDirectory(index))
+      flags |= CLASS_DIRECTORY;
 
-      // Selected elements must be of the same drive class
-      DRIVE_CLASS element_class = GetDriveClassFromPath(path);
-      if (!inversed && element_class != required_class)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not of class " << ToString(required_class) <<  ".";
-        return false;
-      }
-      if (inversed && element_class == required_class)
-      {
-        //SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is of class " << ToString(required_class) << ".";
-        return false;
-      }
-    }
-    else
-    {
-      SA_LOG(WARNING) << "Unknown class '" << class_ << "'.";
-      return false;
-    }
-
-    return true;
-  }
+    // Drive based classes are only resolved when required
+    if ((required_flags & CLASS_DRIVE) && !GetDriveLetter(path).empty())
+      flags |= CLASS_DRIVE;
+    if (required_flags & CLASS_DRIVE_CLASSES)
+      flags |= GetDriveClassFlag(GetDriveClassFromPath(path));
 
-  static inline bool IsValidClass(const std::string& class_)
-  {
-    DRIVE_CLASS parsed_class = GetDriveClassFromString(class_.c_str());
-    if (parsed_class != DRIVE_CLASS_UNKNOWN)
-      return true;
-    return false;
+    return flags;
   }
 
-  bool Validator::ValidateSingleFileMultipleClasses(const std::string& path, const std::string& class_, bool inversed) const
+  bool Validator::ValidateClass(const SelectionContext& context, const std::string& class_, bool inversed) const
   {
     if (class_.empty())
       return true;
 
-    //split
-    ra::strings::StringVector classes = ra::strings::Split(class_, SA_CLASS_ATTR_SEPARATOR_STR);
-    std::string valid_classes;
+    COMPILED_VALUE<COMPILED_ATTRIBUTES::CLASSES>& compiled = mCompiled->classes;
+    if (compiled.Update(class_))
+      COMPILED_ATTRIBUTES::CompileClasses(class_, compiled.value);
+    const COMPILED_ATTRIBUTES::CLASSES& classes = compiled.value;
 
-    bool valid = false;
-    for (size_t i = 0; i < classes.size(); i++)
+    // Validate file extensions
+    if (classes.has_file_extensions)
     {
-      const std::string& class_ = classes[i];
-      valid |= ValidateSingleFileSingleClass(path, class_, inversed);
-
-      // Build a valid classes list from the given classes (strings)
-      if (IsValidClass(class_))
+      bool valid = ValidateFileExtensions(context, classes.extensions, inversed);
+      if (!valid)
       {
-        if (!valid_classes.empty()) valid_classes.append(1, ',');
-        valid_classes += class_;
+        if (!inversed)
+          SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path(s) is/are not of file extensions '" << classes.file_extensions << "'.";
+        else
+          SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path(s) is/are one of file extensions '" << classes.file_extensions << "'.";
+        return false;
       }
     }
 
-    if (!valid)
-    {
-      if (!inversed)
-        SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not of classes '" << valid_classes << "'.";
-      else
-        SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is of classes '" << valid_classes << "'.";
-      return false;
-    }
-
-    return true;
-  }
-
-  bool Validator::ValidateClass(const SelectionContext& context, const std::string& class_, bool inversed) const
-  {
-    if (class_.empty())
-      return true;
-
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
-    //split
-    ra::strings::StringVector classes = ra::strings::Split(class_, SA_CLASS_ATTR_SEPARATOR_STR);
-
-    // Search for file extensions. All file extensions must be extracted from the list and evaluated all at once.
-    std::string file_extensions;
-    if (!classes.empty())
+    // Continue validation for the remaining class elements
+    if (classes.has_classes)
     {
-      static const size_t INVALID_INDEX_POSITION = (size_t)-1;
-
-      // Remember each file extension's index to delete them after searching.
-      std::vector<size_t> delete_positions;
-
-      bool found_file_extensions = false;
+      const StringList& context_elements = context.GetElements();
 
-      for (size_t i = classes.size() - 1; i >= 0 && i != INVALID_INDEX_POSITION; i--)
+      for (size_t i = 0; i < classes.unknown_classes.size() && !context_elements.empty(); i++)
       {
-        const std::string& element = classes[i];
-
-        // Is this a class file extension filter?
-        if (!element.empty() && element[0] == '.')
-        {
-          // Extract the file extension
-          std::string file_extension;
-          if (element.size() >= 2)
-            file_extension = element.substr(1);
-
-          // Add to the file extension list
-          if (!file_extensions.empty())
-            file_extensions.insert(0, 1, SA_CLASS_ATTR_SEPARATOR_CHAR);
-          file_extensions.insert(0, file_extension.c_str());
-
-          found_file_extensions = true;
-
-          // Remember this index
-          delete_positions.push_back(i);
-        }
+        SA_LOG(WARNING) << "Unknown class '" << classes.unknown_classes[i] << "'.";
       }
 
-      // Delete elements of classes which were identified as file extensions
-      for (size_t i = 0; i < delete_positions.size(); i++)
+      //for each file selected
+      for (size_t i = 0; i < context_elements.size(); i++)
       {
-        const size_t& delete_position = delete_positions[i];
-        classes.erase(classes.begin() + delete_position);
-      }
+        const std::string& path = context_elements[i];
+        uint32_t element_flags = GetElementClassFlags(context, i, classes.flags);
+
+        //each element must match one of the classes.
+        //when inversed, each element must not match at least one of the classes.
+        bool valid = false;
+        if (!inversed)
+          valid = (element_flags & classes.flags) != 0;
+        else
+          valid = (classes.flags & ~element_flags) != 0;
 
-      // Validate file extensions
-      if (found_file_extensions)
-      {
-        bool valid = ValidateFileExtensions(context, file_extensions, inversed);
         if (!valid)
         {
           if (!inversed)
-            SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path(s) is/are not of file extensions '" << file_extensions << "'.";
+            SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is not of classes '" << classes.valid_classes << "'.";
           else
-            SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path(s) is/are one of file extensions '" << file_extensions << "'.";
-          return false;
+            SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' is of classes '" << classes.valid_classes << "'.";
         }
-      }
-    }
-
-    // Continue validation for the remaining class elements
-    if (!classes.empty())
-    {
-      //join remaining classes into a single string
-      std::string classes_str = ra::strings::Join(classes, SA_CLASS_ATTR_SEPARATOR_STR);
-
-      //for each file selected
-      const StringList& context_elements = context.GetElements();
-      for (size_t i = 0; i < context_elements.size(); i++)
-      {
-        const std::string& path = context_elements[i];
 
-        //each element must match one of the classes
-        bool valid = ValidateSingleFileMultipleClasses(path, classes_str, inversed);
         if (!inversed && !valid)
-          return false; //verbose log is already printed in ValidateSingleFileMultipleClasses()
+          return false;
         if (inversed && valid)
-          return false; //verbose log is already printed in ValidateSingleFileMultipleClasses()
+          return false;
       }
     }
 
     return true;
   }
 
-  bool WildcardMatch(const ra::strings::StringVector& patterns, const char* value)
-  {
-    for (size_t j = 0; j < patterns.size(); j++)
-    {
-      const std::string& pattern = patterns[j];
-      bool match = WildcardMatch(pattern.c_str(), value);
-      if (match)
-        return true;
-    }
-    return false;
-  }
-
   bool Validator::ValidatePattern(const SelectionContext& context, const std::string& pattern, bool inversed) const
   {
     if (pattern.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
-    //split
-    ra::strings::StringVector patterns_uppercase = ra::strings::Split(pattern, SA_PATTERN_ATTR_SEPARATOR_STR);
-    Uppercase(patterns_uppercase);
+    //split and compile all patterns, ignoring case
+    COMPILED_VALUE<WildcardMatcher>& compiled = mCompiled->patterns;
+    if (compiled.Update(pattern))
+      compiled.value.Compile(ra::strings::Split(pattern, SA_PATTERN_ATTR_SEPARATOR_STR), false);
+    const WildcardMatcher& matcher = compiled.value;
 
     //for each file selected
     const StringList& context_elements = context.GetElements();
     for (size_t i = 0; i < context_elements.size(); i++)
     {
       const std::string& path = context_elements[i];
-      std::string path_uppercase = ra::strings::Uppercase(path);
 
       //each element must match one of the patterns
-      bool match = WildcardMatch(patterns_uppercase, path_uppercase.c_str());
+      bool match = matcher.IsMatch(path.c_str());
       if (!inversed && !match)
       {
         SA_VERBOSE_LOG(DEBUG) << GetCheckFailMessage(this, inversed) << " Selected path '" << path << "' does not match the pattern '" << pattern << "'.";
@@ -1001,14 +1221,10 @@ namespace shellanything
     if (exprtk.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
-    static const size_t ERROR_SIZE = 10480;
-    char error[ERROR_SIZE];
-    error[0] = '\0';
-
-    int result = false;
-    int evaluated = EvaluateBoolean(exprtk.c_str(), &result, error, ERROR_SIZE);
+    // Evaluate numeric properties as variables of the unexpanded expression to reuse the compiled expression.
+    std::string error;
+    bool result = false;
+    bool evaluated = ExprtkHelper::EvaluateBoolean(GetExprtk(), exprtk, result, error);
     if (!evaluated)
     {
       SA_LOG(WARNING) << "Failed evaluating exprtk expression '" << exprtk << "'.";
@@ -1035,10 +1251,11 @@ namespace shellanything
     if (istrue.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
-    ra::strings::StringVector statements = ra::strings::Split(istrue, SA_ISTRUE_ATTR_SEPARATOR_STR);
+    COMPILED_VALUE<StringList>& compiled = mCompiled->istrue;
+    if (compiled.Update(istrue))
+      compiled.value = ra::strings::Split(istrue, SA_ISTRUE_ATTR_SEPARATOR_STR);
+    const ra::strings::StringVector& statements = compiled.value;
 
     //for each boolean statement
     for (size_t i = 0; i < statements.size(); i++)
@@ -1065,10 +1282,11 @@ namespace shellanything
     if (isfalse.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
-    ra::strings::StringVector statements = ra::strings::Split(isfalse, SA_ISTRUE_ATTR_SEPARATOR_STR);
+    COMPILED_VALUE<StringList>& compiled = mCompiled->isfalse;
+    if (compiled.Update(isfalse))
+      compiled.value = ra::strings::Split(isfalse, SA_ISFALSE_ATTR_SEPARATOR_STR);
+    const ra::strings::StringVector& statements = compiled.value;
 
     //for each boolean statement
     for (size_t i = 0; i < statements.size(); i++)
@@ -1184,7 +1402,11 @@ namespace shellanything
       IAttributeValidator* attr_validator = validators[i];
       attr_validator->SetSelectionContext(&context);
       attr_validator->SetCustomAttributes(&mCustomAttributes);
-      bool valid = attr_validator->Validate();
+      bool valid = false;
+      {
+        PerformanceCounters::Scope performance_scope(plugin->GetPerformanceCounters(), true);
+        valid = attr_validator->Validate();
+      }
       attr_validator->SetSelectionContext(NULL);
       attr_validator->SetCustomAttributes(NULL);
       if (!valid)
@@ -1217,10 +1439,11 @@ namespace shellanything
       return false; // invalid. No keyboard setup to validate.
     }
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
-    ra::strings::StringVector mandatory_keyboard_ids = ra::strings::Split(keyboard, SA_KEYBOARD_ATTR_SEPARATOR_STR);
+    COMPILED_VALUE<StringList>& compiled = mCompiled->keyboard;
+    if (compiled.Update(keyboard))
+      compiled.value = ra::strings::Split(keyboard, SA_KEYBOARD_ATTR_SEPARATOR_STR);
+    const ra::strings::StringVector& mandatory_keyboard_ids = compiled.value;
 
     //for each modifiers
     for (size_t i = 0; i < mandatory_keyboard_ids.size(); i++)
@@ -31,8 +31,13 @@
 #include "PropertyStore.h"
 #include "SelectionContext.h"
 #include "Plugin.h"
+#include "CachedExpansion.h"
+#include "PerformanceCounters.h"
 #include <string>
 #include <vector>
+#include <map>
+#include <mutex>
+#include <stdint.h>
 
 #define SA_DEFAULT_ATTRIBUTE_SEPARATOR_CHAR   ';'
 #define SA_DEFAULT_ATTRIBUTE_SEPARATOR_STR    ";"
@@ -259,11 +264,51 @@ namespace shellanything
     /// <summary>
     /// Validate the object against a set of constraints.
     /// Note: this function is usually used to enable or disable a menu.
+    /// The function can be called by multiple threads. Validations of the same validator are serialized.
     /// </summary>
     /// <param name="context">The selection context used for validating.</param>
     /// <returns>Returns true if the given context is valid against the set of constraints. Returns false otherwise.</returns>
     bool Validate(const SelectionContext& context) const;
 
+    /// <summary>
+    /// Enable or disable the collection of validation statistics for all validators.
+    /// When enabled, the evaluation time of each check of a validator is measured. See ToStatisticsString().
+    /// </summary>
+    /// <param name="enabled">Set to true to collect validation statistics.</param>
+    static void SetStatisticsEnabled(bool enabled);
+
+    /// <summary>
+    /// Check if validation statistics are collected.
+    /// </summary>
+    /// <returns>Returns true if validation statistics are collected. Returns false otherwise.</returns>
+    static bool IsStatisticsEnabled();
+
+    /// <summary>
+    /// Reset the validation statistics of this validator.
+    /// </summary>
+    void ResetStatistics();
+
+    /// <summary>
+    /// Get a description of the validation statistics of this validator.
+    /// The description lists each check in evaluation order with its number of evaluations, failures and evaluation time
+    /// and an estimation of the time saved by evaluating the less expensive checks first.
+    /// </summary>
+    /// <param name="str">The output string.</param>
+    /// <param name="indent">The indentation of the output string.</param>
+    void ToStatisticsString(std::string& str, int indent) const;
+
+    /// <summary>
+    /// Get the performance counters of this validator. See PerformanceCounters.
+    /// The counters measure Validate().
+    /// </summary>
+    /// <returns>Returns the performance counters of this validator.</returns>
+    const PERFORMANCE_COUNTERS& GetPerformanceCounters() const;
+
+    /// <summary>
+    /// Reset the performance counters of this validator.
+    /// </summary>
+    void ResetPerformanceCounters();
+
     // IObject methods
     virtual std::string ToShortString() const;
     virtual void ToLongString(std::string& str, int indent) const;
@@ -301,12 +346,17 @@ namespace shellanything
     static bool IsFalse(const std::string& value);
 
   private:
+    struct FILE_EXTENSIONS;
+    struct COMPILED_ATTRIBUTES;
+
+    const std::string& ExpandAttribute(const std::string& name) const;
+    bool IsCheckDefined(int check) const;
+    bool ValidateCheck(const SelectionContext& context, int check) const;
     bool ValidateProperties(const SelectionContext& context, const std::string& properties, bool inversed) const;
     bool ValidateFileExtensions(const SelectionContext& context, const std::string& file_extensions, bool inversed) const;
+    bool ValidateFileExtensions(const SelectionContext& context, const FILE_EXTENSIONS& file_extensions, bool inversed) const;
     bool ValidateExists(const SelectionContext& context, const std::string& file_exists, bool inversed) const;
     bool ValidateClass(const SelectionContext& context, const std::string& class_, bool inversed) const;
-    bool ValidateSingleFileMultipleClasses(const std::string& path, const std::string& class_, bool inversed) const;
-    bool ValidateSingleFileSingleClass(const std::string& path, const std::string& class_, bool inversed) const;
     bool ValidatePattern(const SelectionContext& context, const std::string& pattern, bool inversed) const;
     bool ValidateExprtk(const SelectionContext& context, const std::string& exprtk, bool inversed) const;
     bool ValidateIsTrue(const SelectionContext& context, const std::string& istrue, bool inversed) const;
@@ -323,6 +373,12 @@ namespace shellanything
     Plugin::PluginPtrList mPlugins;
     Menu* mParentMenu;
     mutable bool mLastValidateSuccessful; // private value used for ToString() implementation.
+    mutable std::recursive_mutex mCacheMutex; // protects the caches below. They are modified by Validate().
+    mutable std::map<std::string, CachedExpansion> mExpandedAttributes; // expanded attributes values, by attribute name.
+    mutable COMPILED_ATTRIBUTES* mCompiled; // attributes compiled from their expanded values and the validation statistics.
+    mutable PERFORMANCE_COUNTERS mPerformanceCounters;
+    uint32_t mInversedFlags; // known attributes listed in the 'inverse' attribute.
+    StringList mInversedNames; // all attributes listed in the 'inverse' attribute.
   };
 
 } //namespace shellanything
@@ -24,6 +24,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <algorithm>
 
 #include "Wildcard.h"
 
@@ -395,4 +397,279 @@ namespace shellanything
     return false;
   }
 
+  const size_t WildcardMatcher::INVALID_PATTERN_INDEX = (size_t)-1;
+
+  /// <summary>
+  /// Maximum number of cached states of the automaton.
+  /// When the limit is reached, the cache is cleared and states are computed again.
+  /// </summary>
+  static const size_t MAX_AUTOMATON_STATES = 1024;
+  static const size_t NUM_CHARACTERS = 256;
+  static const int UNKNOWN_STATE = -1;
+
+  enum NFA_STATE_KIND
+  {
+    NFA_STATE_LITERAL,
+    NFA_STATE_ANY,    // '?' wildcard character
+    NFA_STATE_STAR,   // '*' wildcard character
+    NFA_STATE_ACCEPT, // end of a pattern
+  };
+
+  /// <summary>
+  /// A pattern character of the non deterministic automaton (NFA).
+  /// </summary>
+  struct NFA_STATE
+  {
+    NFA_STATE_KIND kind;
+    unsigned char character; // folded character for NFA_STATE_LITERAL.
+    size_t pattern;          // index of the pattern of the state.
+  };
+
+  typedef std::vector<size_t> NfaStateSet;
+
+  /// <summary>
+  /// The compiled patterns.
+  /// The patterns are compiled in a NFA. The states of the deterministic automaton (DFA) are computed on demand
+  /// from sets of NFA states, like a lazy subset construction.
+  /// </summary>
+  struct WildcardMatcher::AUTOMATON
+  {
+    bool case_sensitive;
+    size_t num_patterns;
+    unsigned char fold[NUM_CHARACTERS];
+    std::vector<NFA_STATE> nfa;
+    NfaStateSet nfa_start;
+
+    // DFA states cache
+    std::vector<NfaStateSet> dfa_sets;
+    std::vector<int> dfa_transitions; // NUM_CHARACTERS transitions per DFA state.
+    std::vector<size_t> dfa_accepts;  // index of the first matching pattern per DFA state.
+    std::map<NfaStateSet, int> dfa_index;
+
+    // Temporary storage for computing DFA states.
+    std::vector<size_t> marks;
+    size_t mark_generation;
+
+    AUTOMATON() : case_sensitive(true), num_patterns(0), mark_generation(0)
+    {
+      for (size_t i = 0; i < NUM_CHARACTERS; i++)
+        fold[i] = (unsigned char)i;
+    }
+
+    void AddClosure(NfaStateSet& set, size_t state)
+    {
+      // A '*' character can match an empty string. Add the following state as well.
+      while (marks[state] != mark_generation)
+      {
+        marks[state] = mark_generation;
+        set.push_back(state);
+        if (nfa[state].kind != NFA_STATE_STAR)
+          break;
+        state++;
+      }
+    }
+
+    void ClearStates()
+    {
+      dfa_sets.clear();
+      dfa_transitions.clear();
+      dfa_accepts.clear();
+      dfa_index.clear();
+    }
+
+    int GetState(NfaStateSet& set)
+    {
+      std::sort(set.begin(), set.end());
+
+      std::map<NfaStateSet, int>::const_iterator it = dfa_index.find(set);
+      if (it != dfa_index.end())
+        return it->second;
+
+      size_t accept = INVALID_PATTERN_INDEX;
+      for (size_t i = 0; i < set.size(); i++)
+      {
+        const NFA_STATE& state = nfa[set[i]];
+        if (state.kind == NFA_STATE_ACCEPT && state.pattern < accept)
+          accept = state.pattern;
+      }
+
+      int id = (int)dfa_sets.size();
+      dfa_sets.push_back(set);
+      dfa_transitions.resize(dfa_transitions.size() + NUM_CHARACTERS, UNKNOWN_STATE);
+      dfa_accepts.push_back(accept);
+      dfa_index[set] = id;
+      return id;
+    }
+
+    int GetStartState()
+    {
+      if (dfa_sets.empty())
+      {
+        NfaStateSet set = nfa_start;
+        GetState(set);
+      }
+      return 0;
+    }
+
+    int ComputeTransition(int from, unsigned char c)
+    {
+      if (dfa_sets.size() >= MAX_AUTOMATON_STATES)
+      {
+        // Restart with an empty cache from the current state.
+        NfaStateSet current = dfa_sets[from];
+        ClearStates();
+        GetStartState();
+        from = GetState(current);
+      }
+
+      mark_generation++;
+      NfaStateSet next;
+      const NfaStateSet& set = dfa_sets[from];
+      for (size_t i = 0; i < set.size(); i++)
+      {
+        size_t index = set[i];
+        const NFA_STATE& state = nfa[index];
+        switch (state.kind)
+        {
+        case NFA_STATE_LITERAL:
+          if (state.character == c)
+            AddClosure(next, index + 1);
+          break;
+        case NFA_STATE_ANY:
+          AddClosure(next, index + 1);
+          break;
+        case NFA_STATE_STAR:
+          AddClosure(next, index);
+          break;
+        default:
+          break;
+        };
+      }
+
+      int to = GetState(next);
+      dfa_transitions[from * NUM_CHARACTERS + c] = to;
+      return to;
+    }
+  };
+
+  WildcardMatcher::WildcardMatcher() :
+    mAutomaton(new AUTOMATON())
+  {
+  }
+
+  WildcardMatcher::WildcardMatcher(const WildcardMatcher& matcher) :
+    mAutomaton(new AUTOMATON())
+  {
+    (*this) = matcher;
+  }
+
+  WildcardMatcher::~WildcardMatcher()
+  {
+    delete mAutomaton;
+  }
+
+  const WildcardMatcher& WildcardMatcher::operator =(const WildcardMatcher& matcher)
+  {
+    if (this != &matcher)
+    {
+      (*mAutomaton) = (*matcher.mAutomaton);
+    }
+    return (*this);
+  }
+
+  void WildcardMatcher::Compile(const StringList& patterns, bool case_sensitive)
+  {
+    Clear();
+
+    AUTOMATON& a = *mAutomaton;
+    a.case_sensitive = case_sensitive;
+    a.num_patterns = patterns.size();
+    if (!case_sensitive)
+    {
+      for (size_t i = 'a'; i <= 'z'; i++)
+        a.fold[i] = (unsigned char)(i - 'a' + 'A');
+    }
+
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+      // Force the pattern to its simplest form
+      std::string pattern = patterns[i];
+      WildcardSimplify(pattern);
+
+      a.nfa_start.push_back(a.nfa.size());
+      for (size_t j = 0; j < pattern.size(); j++)
+      {
+        unsigned char c = (unsigned char)pattern[j];
+        NFA_STATE state;
+        state.kind = NFA_STATE_LITERAL;
+        state.character = a.fold[c];
+        state.pattern = i;
+        if (c == '*')
+          state.kind = NFA_STATE_STAR;
+        else if (c == '?')
+          state.kind = NFA_STATE_ANY;
+        a.nfa.push_back(state);
+      }
+
+      NFA_STATE accept;
+      accept.kind = NFA_STATE_ACCEPT;
+      accept.character = 0;
+      accept.pattern = i;
+      a.nfa.push_back(accept);
+    }
+    a.marks.assign(a.nfa.size(), 0);
+    a.mark_generation = 0;
+
+    // Apply the closure of the start states
+    a.mark_generation++;
+    NfaStateSet starts;
+    starts.swap(a.nfa_start);
+    for (size_t i = 0; i < starts.size(); i++)
+      a.AddClosure(a.nfa_start, starts[i]);
+  }
+
+  void WildcardMatcher::Clear()
+  {
+    delete mAutomaton;
+    mAutomaton = new AUTOMATON();
+  }
+
+  size_t WildcardMatcher::GetPatternCount() const
+  {
+    return mAutomaton->num_patterns;
+  }
+
+  bool WildcardMatcher::IsCaseSensitive() const
+  {
+    return mAutomaton->case_sensitive;
+  }
+
+  size_t WildcardMatcher::Match(const char* value) const
+  {
+    if (value == NULL || mAutomaton->num_patterns == 0)
+      return INVALID_PATTERN_INDEX;
+
+    AUTOMATON& a = *mAutomaton;
+    int state = a.GetStartState();
+    for (const unsigned char* p = (const unsigned char*)value; *p != '\0'; p++)
+    {
+      unsigned char c = a.fold[*p];
+      int next = a.dfa_transitions[state * NUM_CHARACTERS + c];
+      if (next == UNKNOWN_STATE)
+        next = a.ComputeTransition(state, c);
+      state = next;
+
+      // No pattern can match the value
+      if (a.dfa_sets[state].empty())
+        return INVALID_PATTERN_INDEX;
+    }
+
+    return a.dfa_accepts[state];
+  }
+
+  size_t WildcardMatcher::GetStateCount() const
+  {
+    return mAutomaton->dfa_sets.size();
+  }
+
 } //namespace shellanything
@@ -27,6 +27,7 @@
 
 #include "shellanything/export.h"
 #include "shellanything/config.h"
+#include "StringList.h"
 
 namespace shellanything
 {
@@ -108,6 +109,78 @@ namespace shellanything
   /// <returns>Returns true if the given pattern with wildcard characters matches the given value. Returns false otherwise.</returns>
   SHELLANYTHING_EXPORT bool WildcardMatch(const char* pattern, const char* value);
 
+  /// <summary>
+  /// A compiled list of wildcard patterns.
+  /// All patterns are compiled into a single automaton which matches a value against every patterns in a single pass.
+  /// The states of the automaton are computed on demand and cached for the next matches.
+  /// The class is not thread safe.
+  /// </summary>
+  class SHELLANYTHING_EXPORT WildcardMatcher
+  {
+  public:
+    /// <summary>
+    /// Pattern index returned when a value does not match any pattern.
+    /// </summary>
+    static const size_t INVALID_PATTERN_INDEX;
+
+    WildcardMatcher();
+    WildcardMatcher(const WildcardMatcher& matcher);
+    virtual ~WildcardMatcher();
+
+    /// <summary>
+    /// Copy operator
+    /// </summary>
+    const WildcardMatcher& operator =(const WildcardMatcher& matcher);
+
+    /// <summary>
+    /// Compile the given wildcard patterns. Replaces previously compiled patterns.
+    /// </summary>
+    /// <param name="patterns">The list of wildcard patterns.</param>
+    /// <param name="case_sensitive">Set to false to match values regardless of the case of ascii letters.</param>
+    void Compile(const StringList& patterns, bool case_sensitive);
+
+    /// <summary>
+    /// Remove all compiled patterns.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Get the number of compiled patterns.
+    /// </summary>
+    size_t GetPatternCount() const;
+
+    /// <summary>
+    /// Check if the patterns are matched with case sensitivity.
+    /// </summary>
+    bool IsCaseSensitive() const;
+
+    /// <summary>
+    /// Find the first pattern which matches the given value.
+    /// </summary>
+    /// <param name="value">The value to match.</param>
+    /// <returns>Returns the index of the first pattern that matches the given value. Returns INVALID_PATTERN_INDEX if no pattern matches.</returns>
+    size_t Match(const char* value) const;
+
+    /// <summary>
+    /// Returns true if at least one of the compiled patterns matches the given value.
+    /// </summary>
+    /// <param name="value">The value to match.</param>
+    /// <returns>Returns true if at least one of the compiled patterns matches the given value. Returns false otherwise.</returns>
+    inline bool IsMatch(const char* value) const
+    {
+      return (Match(value) != INVALID_PATTERN_INDEX);
+    }
+
+    /// <summary>
+    /// Get the number of states of the automaton which were computed.
+    /// </summary>
+    size_t GetStateCount() const;
+
+  private:
+    struct AUTOMATON;
+    AUTOMATON* mAutomaton;
+  };
+
 } //namespace shellanything
 
 #endif //SA_WILDCARD_H
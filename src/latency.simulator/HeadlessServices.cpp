@@ -0,0 +1,173 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "HeadlessServices.h"
+
+#include <stdio.h>
+
+namespace shellanything
+{
+  static const char* GetLevelString(const ILoggerService::LOG_LEVEL& level)
+  {
+    switch (level)
+    {
+    default:
+    case ILoggerService::LOG_LEVEL_DEBUG:
+      return "DEBUG";
+    case ILoggerService::LOG_LEVEL_INFO:
+      return "INFO";
+    case ILoggerService::LOG_LEVEL_WARNING:
+      return "WARNING";
+    case ILoggerService::LOG_LEVEL_ERROR:
+      return "ERROR";
+    case ILoggerService::LOG_LEVEL_FATAL:
+      return "FATAL";
+    };
+  }
+
+  HeadlessLoggerService::HeadlessLoggerService() :
+    mMinimumLevel(ILoggerService::LOG_LEVEL_WARNING)
+  {
+  }
+
+  HeadlessLoggerService::~HeadlessLoggerService()
+  {
+  }
+
+  void HeadlessLoggerService::SetMinimumLevel(const ILoggerService::LOG_LEVEL& level)
+  {
+    mMinimumLevel = level;
+  }
+
+  void HeadlessLoggerService::LogMessage(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    if (level < mMinimumLevel)
+      return;
+    fprintf(stderr, "%s %s:%d] %s\n", GetLevelString(level), filename, line, message);
+  }
+
+  void HeadlessLoggerService::LogMessage(const ILoggerService::LOG_LEVEL& level, const char* message)
+  {
+    if (level < mMinimumLevel)
+      return;
+    fprintf(stderr, "%s] %s\n", GetLevelString(level), message);
+  }
+
+  HeadlessClipboardService::HeadlessClipboardService()
+  {
+  }
+
+  HeadlessClipboardService::~HeadlessClipboardService()
+  {
+  }
+
+  bool HeadlessClipboardService::GetClipboardText(std::string& value)
+  {
+    value = mText;
+    return true;
+  }
+
+  bool HeadlessClipboardService::SetClipboardText(const std::string& value)
+  {
+    mText = value;
+    return true;
+  }
+
+  HeadlessKeyboardService::HeadlessKeyboardService()
+  {
+  }
+
+  HeadlessKeyboardService::~HeadlessKeyboardService()
+  {
+  }
+
+  bool HeadlessKeyboardService::IsModifierKeyUp(KEYB_MODIFIER_ID key) const
+  {
+    return true;
+  }
+
+  bool HeadlessKeyboardService::IsModifierKeyDown(KEYB_MODIFIER_ID key) const
+  {
+    return false;
+  }
+
+  bool HeadlessKeyboardService::IsToggleStateOn(KEYB_TOGGLE_ID state) const
+  {
+    return false;
+  }
+
+  bool HeadlessKeyboardService::IsToggleStateOff(KEYB_TOGGLE_ID state) const
+  {
+    return true;
+  }
+
+  HeadlessRegistryService::HeadlessRegistryService()
+  {
+  }
+
+  HeadlessRegistryService::~HeadlessRegistryService()
+  {
+  }
+
+  bool HeadlessRegistryService::GetRegistryKeyAsString(const std::string& path, std::string& value)
+  {
+    value.clear();
+    return false;
+  }
+
+  HeadlessProcessLauncherService::HeadlessProcessLauncherService()
+  {
+  }
+
+  HeadlessProcessLauncherService::~HeadlessProcessLauncherService()
+  {
+  }
+
+  bool HeadlessProcessLauncherService::StartProcess(const std::string& path, const std::string& basedir, const std::string& arguments, PropertyStore& options, ProcessLaunchResult* result) const
+  {
+    return false;
+  }
+
+  bool HeadlessProcessLauncherService::OpenDocument(const std::string& path, ProcessLaunchResult* result) const
+  {
+    return false;
+  }
+
+  bool HeadlessProcessLauncherService::OpenPath(const std::string& path, ProcessLaunchResult* result) const
+  {
+    return false;
+  }
+
+  bool HeadlessProcessLauncherService::IsValidUrl(const std::string& value) const
+  {
+    size_t pos = value.find("://");
+    return (pos != std::string::npos && pos > 0);
+  }
+
+  bool HeadlessProcessLauncherService::OpenUrl(const std::string& path, ProcessLaunchResult* result) const
+  {
+    return false;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,184 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_HEADLESS_SERVICES_H
+#define SA_HEADLESS_SERVICES_H
+
+#include "ILoggerService.h"
+#include "IClipboardService.h"
+#include "IKeyboardService.h"
+#include "IRegistryService.h"
+#include "IProcessLauncherService.h"
+
+namespace shellanything
+{
+  /// <summary>
+  /// Headless implementation class of ILoggerService.
+  /// Messages are written to stderr if their level is greater or equal to the minimum level.
+  /// </summary>
+  class HeadlessLoggerService : public virtual ILoggerService
+  {
+  public:
+    HeadlessLoggerService();
+    virtual ~HeadlessLoggerService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    HeadlessLoggerService(const HeadlessLoggerService&);
+    HeadlessLoggerService& operator=(const HeadlessLoggerService&);
+  public:
+
+    /// <summary>
+    /// Set the minimum level of the messages written to stderr.
+    /// </summary>
+    /// <param name="level">The minimum level of the messages.</param>
+    void SetMinimumLevel(const ILoggerService::LOG_LEVEL& level);
+
+    /// <summary>
+    /// Send a message to this logger.
+    /// </summary>
+    /// <param name="filename">The originating source code file name.</param>
+    /// <param name="line">The line number that produced this message.</param>
+    /// <param name="level">The log level of the message.</param>
+    /// <param name="message">The actual message.</param>
+    virtual void LogMessage(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message);
+
+    /// <summary>
+    /// Send a message to this logger.
+    /// </summary>
+    /// <param name="level">The log level of the message.</param>
+    /// <param name="message">The actual message.</param>
+    virtual void LogMessage(const ILoggerService::LOG_LEVEL& level, const char* message);
+
+  private:
+    ILoggerService::LOG_LEVEL mMinimumLevel;
+  };
+
+  /// <summary>
+  /// Headless implementation class of IClipboardService.
+  /// The clipboard is an in-memory string.
+  /// </summary>
+  class HeadlessClipboardService : public virtual IClipboardService
+  {
+  public:
+    HeadlessClipboardService();
+    virtual ~HeadlessClipboardService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    HeadlessClipboardService(const HeadlessClipboardService&);
+    HeadlessClipboardService& operator=(const HeadlessClipboardService&);
+  public:
+
+    /// <summary>
+    /// Get the clipboard text.
+    /// </summary>
+    /// <param name="value">The output value to store the clipboard text.</param>
+    /// <returns>Returns true. The function never fails.</returns>
+    virtual bool GetClipboardText(std::string& value);
+
+    /// <summary>
+    /// Set the clipboard text.
+    /// </summary>
+    /// <param name="value">The new value of the clipboard text.</param>
+    /// <returns>Returns true. The function never fails.</returns>
+    virtual bool SetClipboardText(const std::string& value);
+
+  private:
+    std::string mText;
+  };
+
+  /// <summary>
+  /// Headless implementation class of IKeyboardService.
+  /// All modifier keys are up and all toggle keys are off.
+  /// </summary>
+  class HeadlessKeyboardService : public virtual IKeyboardService
+  {
+  public:
+    HeadlessKeyboardService();
+    virtual ~HeadlessKeyboardService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    HeadlessKeyboardService(const HeadlessKeyboardService&);
+    HeadlessKeyboardService& operator=(const HeadlessKeyboardService&);
+  public:
+
+    virtual bool IsModifierKeyUp(KEYB_MODIFIER_ID key) const;
+    virtual bool IsModifierKeyDown(KEYB_MODIFIER_ID key) const;
+    virtual bool IsToggleStateOn(KEYB_TOGGLE_ID state) const;
+    virtual bool IsToggleStateOff(KEYB_TOGGLE_ID state) const;
+  };
+
+  /// <summary>
+  /// Headless implementation class of IRegistryService.
+  /// The registry is always empty.
+  /// </summary>
+  class HeadlessRegistryService : public virtual IRegistryService
+  {
+  public:
+    HeadlessRegistryService();
+    virtual ~HeadlessRegistryService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    HeadlessRegistryService(const HeadlessRegistryService&);
+    HeadlessRegistryService& operator=(const HeadlessRegistryService&);
+  public:
+
+    /// <summary>
+    /// Get a registry key as a string.
+    /// </summary>
+    /// <param name="path">The path to a registry key or a registry value.</param>
+    /// <param name="value">The output value to store the result.</param>
+    /// <returns>Returns false. No registry key is ever found.</returns>
+    virtual bool GetRegistryKeyAsString(const std::string& path, std::string& value);
+  };
+
+  /// <summary>
+  /// Headless implementation class of IProcessLauncherService.
+  /// Processes, documents, directories and urls are never opened.
+  /// </summary>
+  class HeadlessProcessLauncherService : public virtual IProcessLauncherService
+  {
+  public:
+    HeadlessProcessLauncherService();
+    virtual ~HeadlessProcessLauncherService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    HeadlessProcessLauncherService(const HeadlessProcessLauncherService&);
+    HeadlessProcessLauncherService& operator=(const HeadlessProcessLauncherService&);
+  public:
+
+    virtual bool StartProcess(const std::string& path, const std::string& basedir, const std::string& arguments, PropertyStore& options, ProcessLaunchResult* result = NULL) const;
+    virtual bool OpenDocument(const std::string& path, ProcessLaunchResult* result = NULL) const;
+    virtual bool OpenPath(const std::string& path, ProcessLaunchResult* result = NULL) const;
+    virtual bool IsValidUrl(const std::string& value) const;
+    virtual bool OpenUrl(const std::string& path, ProcessLaunchResult* result = NULL) const;
+  };
+
+} //namespace shellanything
+
+#endif //SA_HEADLESS_SERVICES_H
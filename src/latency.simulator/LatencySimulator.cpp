@@ -0,0 +1,296 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "LatencySimulator.h"
+#include "ConfigManager.h"
+#include "PropertyManager.h"
+
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/strings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+namespace shellanything
+{
+  const uint32_t LatencySimulator::FIRST_COMMAND_ID = 1;
+
+  static uint64_t GetElapsedNanoseconds(const std::chrono::steady_clock::time_point& begin, const std::chrono::steady_clock::time_point& end)
+  {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  }
+
+  static std::string ToMillisecondsString(uint64_t nanoseconds)
+  {
+    return ra::strings::Format("%.3f", nanoseconds / 1000000.0);
+  }
+
+  LatencySimulator::LatencySimulator() :
+    mLastMenuItemCount(0)
+  {
+  }
+
+  LatencySimulator::~LatencySimulator()
+  {
+    mContext.UnregisterProperties();
+  }
+
+  const char* LatencySimulator::GetStageName(STAGE stage)
+  {
+    switch (stage)
+    {
+    case STAGE_REGISTER_PROPERTIES:
+      return "register_properties";
+    case STAGE_REFRESH:
+      return "refresh";
+    case STAGE_UPDATE:
+      return "update";
+    case STAGE_ASSIGN_COMMAND_IDS:
+      return "assign_command_ids";
+    case STAGE_BUILD_MENU_TREE:
+      return "build_menu_tree";
+    case STAGE_TOTAL:
+      return "total";
+    default:
+      return "unknown";
+    };
+  }
+
+  bool LatencySimulator::LoadSelectionFile(const std::string& path, SelectionList& selections, std::string& error)
+  {
+    selections.clear();
+    error.clear();
+
+    std::string content;
+    if (!ra::filesystem::ReadFileUtf8(path, content))
+    {
+      error = "Failed reading selections file '" + path + "'.";
+      return false;
+    }
+
+    StringList elements;
+
+    //for each lines
+    ra::strings::StringVector lines = ra::strings::Split(content, "\n");
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      std::string line = lines[i];
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+
+      if (!line.empty() && line[0] == '#')
+        continue; // comment
+
+      if (line.empty())
+      {
+        // End of the current selection
+        if (!elements.empty())
+          selections.push_back(elements);
+        elements.clear();
+        continue;
+      }
+
+      elements.push_back(line);
+    }
+    if (!elements.empty())
+      selections.push_back(elements);
+
+    if (selections.empty())
+    {
+      error = "Selections file '" + path + "' does not define any selection.";
+      return false;
+    }
+
+    return true;
+  }
+
+  uint64_t LatencySimulator::GetPercentile(const DurationList& sorted, double percentile)
+  {
+    if (sorted.empty())
+      return 0;
+
+    // Nearest-rank method
+    size_t rank = (size_t)ceil(percentile / 100.0 * sorted.size());
+    if (rank < 1)
+      rank = 1;
+    if (rank > sorted.size())
+      rank = sorted.size();
+    return sorted[rank - 1];
+  }
+
+  void LatencySimulator::Simulate(const StringList& elements)
+  {
+    ConfigManager& cmgr = ConfigManager::GetInstance();
+    uint64_t durations[STAGE_COUNT] = { 0 };
+
+    // See CContextMenu::Initialize()
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    mContext.UnregisterProperties();
+    mContext.SetElements(elements);
+    mContext.RegisterProperties();
+    std::chrono::steady_clock::time_point register_end = std::chrono::steady_clock::now();
+
+    // See CContextMenu::QueryContextMenu()
+    cmgr.Refresh();
+    mConfigFiles = cmgr.GetConfigFileSet();
+    std::chrono::steady_clock::time_point refresh_end = std::chrono::steady_clock::now();
+
+    cmgr.Update(mContext);
+    std::chrono::steady_clock::time_point update_end = std::chrono::steady_clock::now();
+
+    cmgr.AssignCommandIds(FIRST_COMMAND_ID);
+    std::chrono::steady_clock::time_point assign_end = std::chrono::steady_clock::now();
+
+    mLastMenuItemCount = BuildMenuTree();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    durations[STAGE_REGISTER_PROPERTIES] = GetElapsedNanoseconds(begin, register_end);
+    durations[STAGE_REFRESH] = GetElapsedNanoseconds(register_end, refresh_end);
+    durations[STAGE_UPDATE] = GetElapsedNanoseconds(refresh_end, update_end);
+    durations[STAGE_ASSIGN_COMMAND_IDS] = GetElapsedNanoseconds(update_end, assign_end);
+    durations[STAGE_BUILD_MENU_TREE] = GetElapsedNanoseconds(assign_end, end);
+    durations[STAGE_TOTAL] = GetElapsedNanoseconds(begin, end);
+
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+    {
+      mDurations[i].push_back(durations[i]);
+    }
+  }
+
+  void LatencySimulator::Clear()
+  {
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+    {
+      mDurations[i].clear();
+    }
+    mLastMenuItemCount = 0;
+    mConfigFiles.reset();
+  }
+
+  size_t LatencySimulator::GetSimulationCount() const
+  {
+    return mDurations[STAGE_TOTAL].size();
+  }
+
+  const LatencySimulator::DurationList& LatencySimulator::GetDurations(STAGE stage) const
+  {
+    return mDurations[stage];
+  }
+
+  uint64_t LatencySimulator::GetStagePercentile(STAGE stage, double percentile) const
+  {
+    DurationList sorted = mDurations[stage];
+    std::sort(sorted.begin(), sorted.end());
+    return GetPercentile(sorted, percentile);
+  }
+
+  size_t LatencySimulator::GetLastMenuItemCount() const
+  {
+    return mLastMenuItemCount;
+  }
+
+  void LatencySimulator::ToReportString(std::string& str) const
+  {
+    str += ra::strings::Format("%-20s %10s %12s %12s %12s %12s\n", "stage", "samples", "p50 (ms)", "p95 (ms)", "p99 (ms)", "max (ms)");
+
+    //for each stage
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+    {
+      STAGE stage = (STAGE)i;
+      DurationList sorted = mDurations[stage];
+      std::sort(sorted.begin(), sorted.end());
+      uint64_t max = (sorted.empty() ? 0 : sorted[sorted.size() - 1]);
+
+      str += ra::strings::Format("%-20s %10s %12s %12s %12s %12s\n",
+        GetStageName(stage),
+        ra::strings::ToString((uint64_t)sorted.size()).c_str(),
+        ToMillisecondsString(GetPercentile(sorted, 50.0)).c_str(),
+        ToMillisecondsString(GetPercentile(sorted, 95.0)).c_str(),
+        ToMillisecondsString(GetPercentile(sorted, 99.0)).c_str(),
+        ToMillisecondsString(max).c_str());
+    }
+  }
+
+  size_t LatencySimulator::BuildMenuTree()
+  {
+    size_t count = 0;
+    if (mConfigFiles == NULL)
+      return 0;
+
+    //for each configuration used by the simulation
+    const ConfigManager::ConfigFileRefList& configs = *mConfigFiles;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+      ConfigFile* config = configs[i].get();
+      if (config == NULL)
+        continue;
+
+      //walk the menus in pre-order, like the recursion of CContextMenu::BuildSubMenuTree()
+      const MenuTree& tree = config->GetMenuTree();
+      size_t j = 0;
+      while (j < tree.GetCount())
+      {
+        const MenuTree::NODE& node = tree.GetNode(j);
+        if (BuildMenuItem(node.menu))
+        {
+          count++;
+          j++;
+        }
+        else
+          j = node.end; // the submenus of a skipped menu are not built
+      }
+    }
+
+    return count;
+  }
+
+  bool LatencySimulator::BuildMenuItem(Menu* menu)
+  {
+    // Same string processing as CContextMenu::BuildSubMenuTree() without the win32 menu and icon handles.
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    std::string title = pmgr.Expand(menu->GetName());
+    std::string description = pmgr.Expand(menu->GetDescription());
+
+    if (menu->IsColumnSeparator())
+      return false;
+    if (!menu->IsVisible())
+      return false;
+    if (menu->GetCommandId() == Menu::INVALID_COMMAND_ID)
+      return false;
+
+    menu->TruncateName(title);
+    menu->TruncateName(description);
+
+    const Icon& icon = menu->GetIcon();
+    if (!menu->IsSeparator() && icon.IsValid())
+    {
+      std::string file_extension = pmgr.Expand(icon.GetFileExtension());
+      std::string icon_filename = pmgr.Expand(icon.GetPath());
+    }
+
+    return true;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,159 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_LATENCY_SIMULATOR_H
+#define SA_LATENCY_SIMULATOR_H
+
+#include "SelectionContext.h"
+#include "ConfigManager.h"
+#include "Menu.h"
+#include "StringList.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Simulates the right-click flow of the shell extension without File Explorer.
+  /// Each simulation executes the same stages as CContextMenu::Initialize() and CContextMenu::QueryContextMenu()
+  /// and measures the duration of each stage.
+  /// </summary>
+  class LatencySimulator
+  {
+  public:
+    /// <summary>
+    /// The measured stages of a simulation.
+    /// </summary>
+    enum STAGE
+    {
+      STAGE_REGISTER_PROPERTIES,  // SelectionContext::SetElements() and SelectionContext::RegisterProperties()
+      STAGE_REFRESH,              // ConfigManager::Refresh()
+      STAGE_UPDATE,               // ConfigManager::Update()
+      STAGE_ASSIGN_COMMAND_IDS,   // ConfigManager::AssignCommandIds()
+      STAGE_BUILD_MENU_TREE,      // Expansion of the visible menus strings of the refreshed configurations, like CContextMenu::BuildTopMenuTree()
+      STAGE_TOTAL,                // All stages
+      STAGE_COUNT,
+    };
+
+    typedef std::vector<StringList> SelectionList;
+    typedef std::vector<uint64_t> DurationList;
+
+    /// <summary>
+    /// The first command id assigned to the menus.
+    /// </summary>
+    static const uint32_t FIRST_COMMAND_ID;
+
+    LatencySimulator();
+    virtual ~LatencySimulator();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    LatencySimulator(const LatencySimulator&);
+    LatencySimulator& operator=(const LatencySimulator&);
+  public:
+
+    /// <summary>
+    /// Get the name of a stage.
+    /// </summary>
+    /// <param name="stage">The stage.</param>
+    /// <returns>Returns the name of the stage.</returns>
+    static const char* GetStageName(STAGE stage);
+
+    /// <summary>
+    /// Load a file of selections.
+    /// Each line of the file is the path of a selected file or directory.
+    /// An empty line ends a selection. Lines starting with '#' are comments.
+    /// </summary>
+    /// <param name="path">The path of the selections file.</param>
+    /// <param name="selections">The output list of selections.</param>
+    /// <param name="error">The output error message if the function fails.</param>
+    /// <returns>Returns true if the file was loaded. Returns false otherwise.</returns>
+    static bool LoadSelectionFile(const std::string& path, SelectionList& selections, std::string& error);
+
+    /// <summary>
+    /// Get a percentile of sorted durations using the nearest-rank method.
+    /// </summary>
+    /// <param name="sorted">A list of durations sorted in ascending order.</param>
+    /// <param name="percentile">The requested percentile, between 0 and 100.</param>
+    /// <returns>Returns the requested percentile. Returns 0 if the list is empty.</returns>
+    static uint64_t GetPercentile(const DurationList& sorted, double percentile);
+
+    /// <summary>
+    /// Simulate a right-click on the given elements and measure the duration of each stage.
+    /// </summary>
+    /// <param name="elements">The selected files and directories.</param>
+    void Simulate(const StringList& elements);
+
+    /// <summary>
+    /// Clear all measured durations.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Get the number of measured simulations.
+    /// </summary>
+    size_t GetSimulationCount() const;
+
+    /// <summary>
+    /// Get the measured durations of a stage, in nanoseconds.
+    /// </summary>
+    /// <param name="stage">The stage.</param>
+    /// <returns>Returns the durations of the stage in the order of the simulations.</returns>
+    const DurationList& GetDurations(STAGE stage) const;
+
+    /// <summary>
+    /// Get a percentile of the durations of a stage, in nanoseconds.
+    /// </summary>
+    /// <param name="stage">The stage.</param>
+    /// <param name="percentile">The requested percentile, between 0 and 100.</param>
+    /// <returns>Returns the requested percentile. Returns 0 if no simulation was measured.</returns>
+    uint64_t GetStagePercentile(STAGE stage, double percentile) const;
+
+    /// <summary>
+    /// Get the number of menu items built by the last simulation.
+    /// </summary>
+    size_t GetLastMenuItemCount() const;
+
+    /// <summary>
+    /// Get a report of the p50, p95 and p99 latencies of each stage.
+    /// </summary>
+    /// <param name="str">The output report.</param>
+    void ToReportString(std::string& str) const;
+
+  private:
+    size_t BuildMenuTree();
+    bool BuildMenuItem(Menu* menu);
+
+  private:
+    SelectionContext mContext;
+    ConfigManager::ConfigFileSetPtr mConfigFiles; // configurations used by the last simulation
+    DurationList mDurations[STAGE_COUNT];
+    size_t mLastMenuItemCount;
+  };
+
+} //namespace shellanything
+
+#endif //SA_LATENCY_SIMULATOR_H
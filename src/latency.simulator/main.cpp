@@ -0,0 +1,285 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <string>
+#include <chrono>
+
+#include "rapidassist/cli.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/process_utf8.h"
+#include "rapidassist/strings.h"
+
+#include "App.h"
+#include "ConfigManager.h"
+#include "PcgRandomService.h"
+#include "PerformanceCounters.h"
+#include "HeadlessServices.h"
+#include "LatencySimulator.h"
+
+using namespace shellanything;
+
+static const int EXIT_CODE_SUCCESS = 0;
+static const int EXIT_CODE_INVALID_ARGUMENTS = 1;
+static const int EXIT_CODE_LOAD_FAILURE = 2;
+static const int EXIT_CODE_BUDGET_EXCEEDED = 3;
+
+void PrintUsage()
+{
+  printf("Usage: latency.simulator --configurations=<dir> --selections=<file> [options]\n");
+  printf("\n");
+  printf("Simulates right-clicks on the selections of <file> with the Configuration Files of <dir>\n");
+  printf("and reports the p50, p95 and p99 latency of each stage.\n");
+  printf("\n");
+  printf("The selections file lists the path of a selected file or directory per line.\n");
+  printf("An empty line ends a selection. Lines starting with '#' are comments.\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("  --iterations=<n>      Number of measured replays of the selections file. Default: 10.\n");
+  printf("  --warmup=<n>          Number of unmeasured replays of the selections file. Default: 1.\n");
+  printf("  --max_p95_ms=<value>  Fail with exit code %d if the total p95 latency exceeds the given value.\n", EXIT_CODE_BUDGET_EXCEEDED);
+  printf("  --max_p99_ms=<value>  Fail with exit code %d if the total p99 latency exceeds the given value.\n", EXIT_CODE_BUDGET_EXCEEDED);
+  printf("  --slowest_menus=<n>   Enable performance counters and report the <n> slowest menus.\n");
+  printf("  --verbose             Print informational log messages.\n");
+}
+
+bool HasFlag(const char* name, int argc, char** argv)
+{
+  const std::string flag = std::string("--") + name;
+  for (int i = 1; i < argc; i++)
+  {
+    if (argv[i] != NULL && flag == argv[i])
+      return true;
+  }
+  return false;
+}
+
+bool ParseCount(const char* name, int default_value, int& value, int argc, char** argv)
+{
+  value = default_value;
+  std::string str;
+  if (!ra::cli::ParseArgument(name, str, argc, argv))
+    return true; // use default value
+  if (!ra::strings::Parse(str, value) || value < 0)
+  {
+    printf("Invalid value for argument '%s': '%s'.\n", name, str.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ParseBudget(const char* name, double& value, int argc, char** argv)
+{
+  value = 0.0; // no budget
+  std::string str;
+  if (!ra::cli::ParseArgument(name, str, argc, argv))
+    return true;
+  if (!ra::strings::Parse(str, value) || value <= 0.0)
+  {
+    printf("Invalid value for argument '%s': '%s'.\n", name, str.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool IsBudgetExceeded(const char* name, double budget_ms, uint64_t latency_ns)
+{
+  if (budget_ms <= 0.0)
+    return false;
+  double latency_ms = latency_ns / 1000000.0;
+  if (latency_ms <= budget_ms)
+    return false;
+  printf("Budget exceeded: total latency %s is %.3f ms, the budget is %.3f ms.\n", name, latency_ms, budget_ms);
+  return true;
+}
+
+void Replay(LatencySimulator& simulator, const LatencySimulator::SelectionList& selections, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    for (size_t j = 0; j < selections.size(); j++)
+    {
+      simulator.Simulate(selections[j]);
+    }
+  }
+}
+
+void PrintSlowestMenus(size_t count)
+{
+  ConfigManager& cmgr = ConfigManager::GetInstance();
+
+  Menu::MenuPtrList menus;
+  cmgr.GetSlowestMenus(count, menus);
+
+  printf("\n");
+  printf("Slowest menus:\n");
+  for (size_t i = 0; i < menus.size(); i++)
+  {
+    const Menu* menu = menus[i];
+    const ConfigFile* config = menu->GetParentConfigFile();
+
+    std::string counters;
+    PerformanceCounters::ToString(menu->GetPerformanceCounters(), counters);
+
+    printf("  #%d '%s' (%s): %s\n", (int)(i + 1), menu->GetName().c_str(), (config ? config->GetFilePath().c_str() : ""), counters.c_str());
+  }
+}
+
+int Run(int argc, char** argv)
+{
+  std::string configurations_dir;
+  std::string selections_path;
+  int iterations = 0;
+  int warmup = 0;
+  int slowest_menus = 0;
+  double max_p95_ms = 0.0;
+  double max_p99_ms = 0.0;
+
+  if (!ra::cli::ParseArgument("configurations", configurations_dir, argc, argv) ||
+      !ra::cli::ParseArgument("selections", selections_path, argc, argv))
+  {
+    PrintUsage();
+    return EXIT_CODE_INVALID_ARGUMENTS;
+  }
+  if (!ParseCount("iterations", 10, iterations, argc, argv) ||
+      !ParseCount("warmup", 1, warmup, argc, argv) ||
+      !ParseCount("slowest_menus", 0, slowest_menus, argc, argv) ||
+      !ParseBudget("max_p95_ms", max_p95_ms, argc, argv) ||
+      !ParseBudget("max_p99_ms", max_p99_ms, argc, argv))
+  {
+    return EXIT_CODE_INVALID_ARGUMENTS;
+  }
+  if (iterations == 0)
+  {
+    printf("Invalid value for argument 'iterations': must be greater than 0.\n");
+    return EXIT_CODE_INVALID_ARGUMENTS;
+  }
+  if (!ra::filesystem::DirectoryExistsUtf8(configurations_dir.c_str()))
+  {
+    printf("Configurations directory '%s' not found.\n", configurations_dir.c_str());
+    return EXIT_CODE_LOAD_FAILURE;
+  }
+
+  LatencySimulator::SelectionList selections;
+  std::string error;
+  if (!LatencySimulator::LoadSelectionFile(selections_path, selections, error))
+  {
+    printf("%s\n", error.c_str());
+    return EXIT_CODE_LOAD_FAILURE;
+  }
+
+  // Load the Configuration Files
+  ConfigManager& cmgr = ConfigManager::GetInstance();
+  cmgr.ClearSearchPath();
+  cmgr.Clear();
+  cmgr.AddSearchPath(configurations_dir);
+
+  std::chrono::steady_clock::time_point load_begin = std::chrono::steady_clock::now();
+  cmgr.Refresh();
+  std::chrono::steady_clock::time_point load_end = std::chrono::steady_clock::now();
+  double load_ms = std::chrono::duration_cast<std::chrono::microseconds>(load_end - load_begin).count() / 1000.0;
+
+  ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+  if (configs.empty())
+  {
+    printf("No Configuration File found in directory '%s'.\n", configurations_dir.c_str());
+    return EXIT_CODE_LOAD_FAILURE;
+  }
+  printf("Loaded %d configuration file(s) in %.3f ms.\n", (int)configs.size(), load_ms);
+  printf("Replaying %d selection(s), %d warmup and %d measured iteration(s).\n", (int)selections.size(), warmup, iterations);
+
+  LatencySimulator simulator;
+  Replay(simulator, selections, warmup);
+  simulator.Clear();
+
+  if (slowest_menus > 0)
+  {
+    PerformanceCounters::SetEnabled(true);
+    cmgr.ResetPerformanceCounters();
+  }
+
+  Replay(simulator, selections, iterations);
+
+  printf("Last simulation built %d menu item(s).\n", (int)simulator.GetLastMenuItemCount());
+  printf("\n");
+
+  std::string report;
+  simulator.ToReportString(report);
+  printf("%s", report.c_str());
+
+  if (slowest_menus > 0)
+    PrintSlowestMenus((size_t)slowest_menus);
+
+  bool exceeded = false;
+  exceeded |= IsBudgetExceeded("p95", max_p95_ms, simulator.GetStagePercentile(LatencySimulator::STAGE_TOTAL, 95.0));
+  exceeded |= IsBudgetExceeded("p99", max_p99_ms, simulator.GetStagePercentile(LatencySimulator::STAGE_TOTAL, 99.0));
+  if (exceeded)
+    return EXIT_CODE_BUDGET_EXCEEDED;
+
+  return EXIT_CODE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  App& app = App::GetInstance();
+
+  //Define application's main executable path.
+  std::string exec_path = ra::process::GetCurrentProcessPathUtf8();
+  app.SetApplicationPath(exec_path);
+
+  // Setup headless services in ShellAnything's core.
+  HeadlessLoggerService* logger_service = new HeadlessLoggerService();
+  if (HasFlag("verbose", argc, argv))
+    logger_service->SetMinimumLevel(ILoggerService::LOG_LEVEL_INFO);
+  app.SetLoggerService(logger_service);
+
+  IRegistryService* registry_service = new HeadlessRegistryService();
+  app.SetRegistryService(registry_service);
+
+  IClipboardService* clipboard_service = new HeadlessClipboardService();
+  app.SetClipboardService(clipboard_service);
+
+  IKeyboardService* keyboard_service = new HeadlessKeyboardService();
+  app.SetKeyboardService(keyboard_service);
+
+  IRandomService* random_service = new PcgRandomService();
+  app.SetRandomService(random_service);
+
+  IProcessLauncherService* process_launcher_service = new HeadlessProcessLauncherService();
+  app.SetProcessLauncherService(process_launcher_service);
+
+  int exit_code = Run(argc, argv);
+
+  // Destroy services
+  ConfigManager::GetInstance().Clear();
+  app.ClearServices();
+  delete process_launcher_service;
+  delete random_service;
+  delete keyboard_service;
+  delete clipboard_service;
+  delete registry_service;
+  delete logger_service;
+
+  return exit_code;
+}
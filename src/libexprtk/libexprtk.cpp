@@ -29,6 +29,11 @@
 
 #include <algorithm>    // std::min
 #include <stdio.h>      // snprintf
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
 
 #define _SCL_SECURE_NO_WARNINGS
 #include "exprtk.hpp"
@@ -66,36 +71,224 @@ __inline int c99_snprintf(char* outBuf, size_t size, const char* format, ...)
 #endif
 
 
-int EvaluateDouble(const char* expression_string, double* result, char* error_buffer, int error_size)
+typedef exprtk::symbol_table<double> symbol_table_t;
+typedef exprtk::expression<double>     expression_t;
+typedef exprtk::parser<double>         parser_t;
+
+static const int DEFAULT_EXPRESSION_CACHE_MAX_SIZE = 256;
+
+/// <summary>
+/// A compiled expression and the variables it is bound to.
+/// The expression keeps references to the values of the variables.
+/// An entry must not be moved once compiled.
+/// </summary>
+struct COMPILED_EXPRESSION
+{
+  std::string key;
+  std::vector<double> values;
+  symbol_table_t symbol_table;
+  expression_t expression;
+};
+typedef std::list<COMPILED_EXPRESSION> CompiledExpressionList;
+typedef std::unordered_map<std::string, CompiledExpressionList::iterator> CompiledExpressionMap;
+
+/// <summary>
+/// Least recently used cache of compiled expressions.
+/// The most recently used expression is at the front of the list.
+/// </summary>
+struct EXPRESSION_CACHE
+{
+  std::mutex mutex;
+  parser_t parser;
+  CompiledExpressionList entries;
+  CompiledExpressionMap index;
+  size_t max_size;
+
+  EXPRESSION_CACHE() : max_size(DEFAULT_EXPRESSION_CACHE_MAX_SIZE) {}
+};
+
+static EXPRESSION_CACHE& GetExpressionCache()
+{
+  static EXPRESSION_CACHE cache;
+  return cache;
+}
+
+static void SetErrorDescription(const std::string& error_description, char* error_buffer, int error_size)
+{
+  //Output error description in output
+  if (error_buffer != NULL && error_size > 0)
+  {
+    size_t min_buffer_size = MIN(error_description.size() + 1, (size_t)error_size); // +1 to include the last non-NULL character
+    snprintf(error_buffer, min_buffer_size, "%s", error_description.c_str());
+  }
+}
+
+static std::string GetExpressionKey(const char* expression_string, const char* const* names, int count)
+{
+  // Variable names cannot contain a NULL character. Use it as a separator.
+  std::string key = expression_string;
+  for (int i = 0; i < count; i++)
+  {
+    key.append(1, '\0');
+    key.append(names[i]);
+  }
+  return key;
+}
+
+static bool CompileExpression(parser_t& parser, COMPILED_EXPRESSION& entry, const char* expression_string, const char* const* names, int count, std::string& error)
+{
+  entry.values.assign(count, 0.0);
+  for (int i = 0; i < count; i++)
+  {
+    if (!entry.symbol_table.add_variable(names[i], entry.values[i]))
+    {
+      error = std::string("Invalid or duplicate variable name: '") + names[i] + "'.";
+      return false;
+    }
+  }
+  entry.expression.register_symbol_table(entry.symbol_table);
+
+  if (!parser.compile(expression_string, entry.expression))
+  {
+    error = parser.error();
+    return false;
+  }
+  return true;
+}
+
+int EvaluateDoubleWithVariables(const char* expression_string, const char* const* names, const double* values, int count, double* result, char* error_buffer, int error_size)
 {
   if (error_buffer != NULL && error_size > 0)
     error_buffer[0] = '\0';
 
-  typedef exprtk::expression<double> expression_t;
-  typedef exprtk::parser<double>         parser_t;
+  if (expression_string == NULL || count < 0 || (count > 0 && (names == NULL || values == NULL)))
+  {
+    SetErrorDescription("Invalid arguments.", error_buffer, error_size);
+    return 0;
+  }
 
-  expression_t expression;
-  parser_t parser;
+  EXPRESSION_CACHE& cache = GetExpressionCache();
+  std::unique_lock<std::mutex> lock(cache.mutex);
 
-  if (!parser.compile(expression_string, expression))
+  if (cache.max_size == 0)
   {
-    //Output error description in output
-    if (error_buffer != NULL && error_size > 0)
+    // Cache is disabled. Compile the expression for this evaluation only.
+    lock.unlock();
+
+    parser_t parser;
+    COMPILED_EXPRESSION entry;
+    std::string error;
+    if (!CompileExpression(parser, entry, expression_string, names, count, error))
     {
-      std::string error_description = parser.error();
+      SetErrorDescription(error, error_buffer, error_size);
+      return 0;
+    }
+
+    for (int i = 0; i < count; i++)
+      entry.values[i] = values[i];
+    if (result)
+      *result = entry.expression.value();
+    return 1;
+  }
+
+  std::string key = GetExpressionKey(expression_string, names, count);
 
-      size_t min_buffer_size = MIN(error_description.size() + 1, error_size); // +1 to include the last non-NULL character
-      snprintf(error_buffer, min_buffer_size, "%s", error_description.c_str());
+  CompiledExpressionMap::iterator it = cache.index.find(key);
+  if (it != cache.index.end())
+  {
+    // Move the entry to the front of the list. Entries of a list are not moved in memory.
+    cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+  }
+  else
+  {
+    cache.entries.emplace_front();
+    COMPILED_EXPRESSION& entry = cache.entries.front();
+
+    std::string error;
+    if (!CompileExpression(cache.parser, entry, expression_string, names, count, error))
+    {
+      // Do not keep expressions that cannot be compiled
+      cache.entries.pop_front();
+      SetErrorDescription(error, error_buffer, error_size);
+      return 0;
+    }
+
+    entry.key = key;
+    cache.index[key] = cache.entries.begin();
+
+    // Evict the least recently used expressions
+    while (cache.entries.size() > cache.max_size)
+    {
+      cache.index.erase(cache.entries.back().key);
+      cache.entries.pop_back();
     }
-    return 0;
   }
 
+  COMPILED_EXPRESSION& entry = cache.entries.front();
+  for (int i = 0; i < count; i++)
+    entry.values[i] = values[i];
   if (result)
-    *result = expression.value();
+    *result = entry.expression.value();
 
   return 1;
 }
 
+int EvaluateBooleanWithVariables(const char* expression_string, const char* const* names, const double* values, int count, int* result, char* error_buffer, int error_size)
+{
+  double tmp = 0.0;
+  bool success = EvaluateDoubleWithVariables(expression_string, names, values, count, &tmp, error_buffer, error_size);
+  if (!success)
+    return 0;
+
+  if (result)
+  {
+    if (tmp != 0.0)
+      *result = 1;
+    else
+      *result = 0;
+  }
+  return 1;
+}
+
+void SetExpressionCacheMaxSize(int size)
+{
+  EXPRESSION_CACHE& cache = GetExpressionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  cache.max_size = (size > 0 ? (size_t)size : 0);
+  while (cache.entries.size() > cache.max_size)
+  {
+    cache.index.erase(cache.entries.back().key);
+    cache.entries.pop_back();
+  }
+}
+
+int GetExpressionCacheMaxSize()
+{
+  EXPRESSION_CACHE& cache = GetExpressionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return (int)cache.max_size;
+}
+
+int GetExpressionCacheSize()
+{
+  EXPRESSION_CACHE& cache = GetExpressionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return (int)cache.entries.size();
+}
+
+void ClearExpressionCache()
+{
+  EXPRESSION_CACHE& cache = GetExpressionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.index.clear();
+  cache.entries.clear();
+}
+
+int EvaluateDouble(const char* expression_string, double* result, char* error_buffer, int error_size)
+{
+  return EvaluateDoubleWithVariables(expression_string, NULL, NULL, 0, result, error_buffer, error_size);
+}
 int EvaluateBoolean(const char* expression_string, int* result, char* error, int error_size)
 {
   double tmp = 0.0;
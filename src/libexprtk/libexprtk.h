@@ -36,6 +36,7 @@ extern "C" {
 
 /// <summary>
 /// Evaluates a text expression and calculates the result.
+/// The compiled expression is kept in a cache. See EvaluateDoubleWithVariables() for details.
 /// </summary>
 /// <param name="expression_string">The text expression to evaluate.</param>
 /// <param name="result">The output double value of the result expression.</param>
@@ -54,6 +55,59 @@ int EvaluateDouble(const char* expression_string, double* result, char* error_bu
 /// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
 int EvaluateBoolean(const char* expression_string, int* result, char* error_buffer, int error_size);
 
+/// <summary>
+/// Evaluates a text expression which contains variables and calculates the result.
+/// Compiled expressions are kept in a cache. Evaluating the same expression again only updates the values of the variables.
+/// </summary>
+/// <param name="expression_string">The text expression to evaluate.</param>
+/// <param name="names">The names of the variables of the expression.</param>
+/// <param name="values">The values of the variables of the expression.</param>
+/// <param name="count">The number of variables.</param>
+/// <param name="result">The output double value of the result expression.</param>
+/// <param name="error_buffer">The output error description, if compilation of expression fails.</param>
+/// <param name="error_size">The size in bytes of the error buffer.</param>
+/// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
+int EvaluateDoubleWithVariables(const char* expression_string, const char* const* names, const double* values, int count, double* result, char* error_buffer, int error_size);
+
+/// <summary>
+/// Evaluates a boolean text expression which contains variables as a true or false value.
+/// See EvaluateDoubleWithVariables() for details.
+/// </summary>
+/// <param name="expression_string">The text expression to evaluate.</param>
+/// <param name="names">The names of the variables of the expression.</param>
+/// <param name="values">The values of the variables of the expression.</param>
+/// <param name="count">The number of variables.</param>
+/// <param name="result">The output bool value of the result expression.</param>
+/// <param name="error_buffer">The output error description, if compilation of expression fails.</param>
+/// <param name="error_size">The size in bytes of the error buffer.</param>
+/// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
+int EvaluateBooleanWithVariables(const char* expression_string, const char* const* names, const double* values, int count, int* result, char* error_buffer, int error_size);
+
+/// <summary>
+/// Set the maximum number of compiled expressions kept in the cache.
+/// The least recently used expressions are removed from the cache when the cache is full.
+/// A value of 0 disables the cache.
+/// </summary>
+/// <param name="size">The maximum number of compiled expressions.</param>
+void SetExpressionCacheMaxSize(int size);
+
+/// <summary>
+/// Get the maximum number of compiled expressions kept in the cache.
+/// </summary>
+/// <returns>Returns the maximum number of compiled expressions kept in the cache.</returns>
+int GetExpressionCacheMaxSize();
+
+/// <summary>
+/// Get the number of compiled expressions in the cache.
+/// </summary>
+/// <returns>Returns the number of compiled expressions in the cache.</returns>
+int GetExpressionCacheSize();
+
+/// <summary>
+/// Delete all compiled expressions from the cache.
+/// </summary>
+void ClearExpressionCache();
+
 /// <summary>
 /// Evaluates a text expression and calculates the result.
 /// </summary>
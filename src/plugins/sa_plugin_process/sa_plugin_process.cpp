@@ -186,21 +186,19 @@ sa_error_t terminate_process_by_pid(DWORD pid)
 sa_error_t killprocess_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = KILLPROCESS_ATTRIBUTES;
   size_t count = KILLPROCESS_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
-  result = sa_xml_attr_group_is_mutually_exclusive(attrs, count, 1, &store_immutable);
+  result = sa_xml_attr_group_is_mutually_exclusive_table(attrs, count, 1, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -210,14 +208,18 @@ sa_error_t killprocess_event_create(sa_action_event_t evnt)
 sa_error_t killprocess_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = KILLPROCESS_ATTRIBUTES;
   size_t count = KILLPROCESS_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const char* pid_str = attrs[0].tmp_expanded;
@@ -228,7 +230,7 @@ sa_error_t killprocess_event_execute(sa_action_event_t evnt)
   if (pid_str != NULL)
     parse_string_dword(pid_str, pid);
 
-  sa_error_t result = SA_ERROR_SUCCESS;
+  result = SA_ERROR_SUCCESS;
 
   // Execute this action
   // <killprocess pid="${processid}" />
@@ -285,21 +287,19 @@ sa_error_t killprocess_event(sa_action_event_t evnt)
 sa_error_t terminateprocess_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = TERMINATEPROCESS_ATTRIBUTES;
   size_t count = TERMINATEPROCESS_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
-  result = sa_xml_attr_group_is_mutually_exclusive(attrs, count, 1, &store_immutable);
+  result = sa_xml_attr_group_is_mutually_exclusive_table(attrs, count, 1, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -309,14 +309,18 @@ sa_error_t terminateprocess_event_create(sa_action_event_t evnt)
 sa_error_t terminateprocess_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = TERMINATEPROCESS_ATTRIBUTES;
   size_t count = TERMINATEPROCESS_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const char* pid_str = attrs[0].tmp_expanded;
@@ -327,7 +331,7 @@ sa_error_t terminateprocess_event_execute(sa_action_event_t evnt)
   if (pid_str != NULL)
     parse_string_dword(pid_str, pid);
 
-  sa_error_t result = SA_ERROR_SUCCESS;
+  result = SA_ERROR_SUCCESS;
 
   // Execute this action
   // <killprocess pid="${processid}" />
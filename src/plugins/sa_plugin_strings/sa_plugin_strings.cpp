@@ -148,17 +148,15 @@ void string_replace(std::string& text, const std::string& token, const std::stri
 sa_error_t substr_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = SUBSTR_ATTRIBUTES;
   size_t count = SUBSTR_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -168,14 +166,18 @@ sa_error_t substr_event_create(sa_action_event_t evnt)
 sa_error_t substr_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = SUBSTR_ATTRIBUTES;
   size_t count = SUBSTR_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const char* pid_str = attrs[0].tmp_expanded;
@@ -232,17 +234,15 @@ sa_error_t substr_event(sa_action_event_t evnt)
 sa_error_t strlen_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRLEN_ATTRIBUTES;
   size_t count = STRLEN_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -252,14 +252,18 @@ sa_error_t strlen_event_create(sa_action_event_t evnt)
 sa_error_t strlen_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRLEN_ATTRIBUTES;
   size_t count = STRLEN_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const std::string attr_value = attrs[0].tmp_expanded;
@@ -304,17 +308,15 @@ sa_error_t strlen_event(sa_action_event_t evnt)
 sa_error_t strreplace_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRREPLACE_ATTRIBUTES;
   size_t count = STRREPLACE_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -324,14 +326,18 @@ sa_error_t strreplace_event_create(sa_action_event_t evnt)
 sa_error_t strreplace_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRREPLACE_ATTRIBUTES;
   size_t count = STRREPLACE_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   std::string attr_text = attrs[0].tmp_expanded;
@@ -375,17 +381,15 @@ sa_error_t strreplace_event(sa_action_event_t evnt)
 sa_error_t struppercase_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRUPPERCASE_ATTRIBUTES;
   size_t count = STRUPPERCASE_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -395,14 +399,18 @@ sa_error_t struppercase_event_create(sa_action_event_t evnt)
 sa_error_t struppercase_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRUPPERCASE_ATTRIBUTES;
   size_t count = STRUPPERCASE_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const char* attr_value = attrs[0].tmp_expanded;
@@ -446,17 +454,15 @@ sa_error_t struppercase_event(sa_action_event_t evnt)
 sa_error_t strlowercase_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRLOWERCASE_ATTRIBUTES;
   size_t count = STRLOWERCASE_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -466,14 +472,18 @@ sa_error_t strlowercase_event_create(sa_action_event_t evnt)
 sa_error_t strlowercase_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRLOWERCASE_ATTRIBUTES;
   size_t count = STRLOWERCASE_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const char* attr_value = attrs[0].tmp_expanded;
@@ -517,17 +527,15 @@ sa_error_t strlowercase_event(sa_action_event_t evnt)
 sa_error_t strfind_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRFIND_ATTRIBUTES;
   size_t count = STRFIND_ATTRIBUTES_COUNT;
 
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -537,14 +545,18 @@ sa_error_t strfind_event_create(sa_action_event_t evnt)
 sa_error_t strfind_event_execute(sa_action_event_t evnt)
 {
   const char* action_name = sa_plugin_action_get_name();
-  sa_property_store_t* store = sa_plugin_action_get_property_store();
 
-  sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
+  sa_attribute_table_immutable_t table;
   XML_ATTR* attrs = STRFIND_ATTRIBUTES;
   size_t count = STRFIND_ATTRIBUTES_COUNT;
 
+  // Get the attributes parsed when the action was created
+  sa_error_t result = sa_plugin_action_get_attributes(attrs, count, &table);
+  if (result != SA_ERROR_SUCCESS)
+    return result;
+
   // Expand attributes
-  sa_xml_attr_list_update(attrs, count, &store_immutable);
+  sa_xml_attr_list_update_table(attrs, count, &table);
 
   // Get expanded attribute values individually
   const std::string attr_text = attrs[0].tmp_expanded;
@@ -291,15 +291,14 @@ void CContextMenu::BuildTopMenuTree(HMENU hMenu)
 
   //browse through all shellanything menus and build the win32 popup menus
 
-  //for each configuration
-  shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
-  shellanything::ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+  //for each configuration used by QueryContextMenu()
+  const shellanything::ConfigManager::ConfigFileRefList& configs = *m_ConfigFiles;
   UINT insert_pos = 0;
   SA_VERBOSE_LOG(INFO) << "System has " << configs.size() << " configuration file loaded.";
   for (size_t i = 0; i < configs.size(); i++)
   {
     SA_VERBOSE_LOG(INFO) << "Build of configuration " << (i + 1) << " of " << configs.size() << " started.";
-    shellanything::ConfigFile* config = configs[i];
+    shellanything::ConfigFile* config = configs[i].get();
     if (config)
     {
       //for each menu child
@@ -338,6 +337,24 @@ void CContextMenu::PrintVerboseMenuStructure() const
   SA_VERBOSE_LOG(INFO) << __FUNCTION__ "(), Menu tree:\n" << menu_tree.c_str();
 }
 
+shellanything::Menu* CContextMenu::FindMenuByCommandId(UINT command_id)
+{
+  //Use the index of the manager if the configurations were not refreshed since QueryContextMenu()
+  shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
+  if (m_ConfigFiles == NULL || m_ConfigFiles == cmgr.GetConfigFileSet())
+    return cmgr.FindMenuByCommandId(command_id);
+
+  //Search the configurations used by QueryContextMenu()
+  const shellanything::ConfigManager::ConfigFileRefList& configs = *m_ConfigFiles;
+  for (size_t i = 0; i < configs.size(); i++)
+  {
+    shellanything::Menu* menu = configs[i]->FindMenuByCommandId(command_id);
+    if (menu)
+      return menu;
+  }
+  return NULL;
+}
+
 CContextMenu::CContextMenu()
 {
   SA_VERBOSE_LOG(INFO) << __FUNCTION__ "(), new instance " << ToHexString(this);
@@ -421,6 +438,13 @@ HRESULT STDMETHODCALLTYPE CContextMenu::QueryContextMenu(HMENU hMenu, UINT menu_
   shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
   cmgr.Refresh();
 
+  //Load new or modified configuration files in the background for the next calls
+  if (!cmgr.IsBackgroundRefreshRunning())
+    cmgr.StartBackgroundRefresh();
+
+  //Keep the configurations alive until InvokeCommand() is called
+  m_ConfigFiles = cmgr.GetConfigFileSet();
+
   //Update all menus with the new context
   //This will refresh the visibility flags which is required before calling ConfigManager::AssignCommandIds()
   cmgr.Update(m_Context);
@@ -487,8 +511,7 @@ HRESULT STDMETHODCALLTYPE CContextMenu::InvokeCommand(LPCMINVOKECOMMANDINFO pici
   CCriticalSectionGuard cs_guard(&m_CS);
 
   //find the menu that is requested
-  shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
-  shellanything::Menu* menu = cmgr.FindMenuByCommandId(target_command_id);
+  shellanything::Menu* menu = FindMenuByCommandId(target_command_id);
   if (menu == NULL)
   {
     SA_LOG(ERROR) << __FUNCTION__ << "(), unknown menu for command_id=" << target_command_offset << ". QueryContextMenu() ended with m_FirstCommandId=" << m_FirstCommandId << ", target_command_id=" << target_command_id;
@@ -521,8 +544,7 @@ HRESULT STDMETHODCALLTYPE CContextMenu::GetCommandString(UINT_PTR command_id, UI
   CCriticalSectionGuard cs_guard(&m_CS);
 
   //find the menu that is requested
-  shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
-  shellanything::Menu* menu = cmgr.FindMenuByCommandId(target_command_id);
+  shellanything::Menu* menu = FindMenuByCommandId(target_command_id);
   if (menu == NULL)
   {
     SA_LOG(ERROR) << __FUNCTION__ << "(), unknown menu for command_id=" << target_command_offset << ". QueryContextMenu() ended with m_FirstCommandId=" << m_FirstCommandId << ", target_command_id=" << target_command_id;
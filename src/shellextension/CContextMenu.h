@@ -41,6 +41,7 @@
 #include "SelectionContext.h"
 #include "Menu.h"
 #include "Icon.h"
+#include "ConfigManager.h"
 
 #include <vector>
 #include <map>
@@ -82,6 +83,7 @@ private:
   void BuildTopMenuTree(HMENU hMenu);
   void BuildSubMenuTree(HMENU hMenu, shellanything::Menu* menu, UINT& insert_pos, bool& next_menu_is_column);
   void PrintVerboseMenuStructure() const;
+  shellanything::Menu* FindMenuByCommandId(UINT command_id);
 
   CCriticalSection            m_CS; //protects class members
   ULONG                       m_refCount;
@@ -92,4 +94,5 @@ private:
   IconMap                     m_FileExtensionCache;
   static HMENU                m_previousMenu; // issue #6. Field must be static
   shellanything::SelectionContext      m_Context;
+  shellanything::ConfigManager::ConfigFileSetPtr m_ConfigFiles; // configurations used by QueryContextMenu()
 };
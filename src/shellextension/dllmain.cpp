@@ -33,14 +33,19 @@
 #include "shellext_i.c"
 
 #include "LoggerHelper.h"
+#include "ConfigManager.h"
+#include "ScopeTracer.h"
+#include "SelectionAnalyzer.h"
 
 #include "GlogLoggerService.h"
+#include "AsyncLoggerService.h"
 #include "WindowsRegistryService.h"
 #include "WindowsClipboardService.h"
 #include "WindowsKeyboardService.h"
 #include "PcgRandomService.h"
 #include "WindowsIconResolutionService.h"
 #include "WindowsProcessLauncherService.h"
+#include "WindowsFileWatcherService.h"
 
 #include "shellanything/version.h"
 #include "shellanything/config.h"
@@ -54,12 +59,14 @@
 
 //Declarations
 shellanything::ILoggerService* logger_service = NULL;
+shellanything::AsyncLoggerService* async_logger_service = NULL;
 shellanything::IRegistryService* registry_service = NULL;
 shellanything::IClipboardService* clipboard_service = NULL;
 shellanything::IKeyboardService* keyboard_service = NULL;
 shellanything::IRandomService* random_service = NULL;
 shellanything::IIconResolutionService* icon_resolution_service = NULL;
 shellanything::IProcessLauncherService* process_launcher_service = NULL;
+shellanything::IFileWatcherService* file_watcher_service = NULL;
 
 class CShellAnythingModule : public ATL::CAtlDllModuleT< CShellAnythingModule >
 {
@@ -79,6 +86,11 @@ STDAPI DllGetClassObject(_In_ REFCLSID clsid, _In_ REFIID riid, _Outptr_ LPVOID*
   std::string clsid_str = GuidToInterfaceName(clsid);
   std::string riid_str = GuidToInterfaceName(riid);
 
+  // Write log messages from a background thread instead of Explorer's UI thread.
+  // The thread cannot be started while the loader lock is held (within DllMain).
+  if (async_logger_service && !async_logger_service->IsRunning())
+    async_logger_service->Start();
+
   HRESULT hr = _AtlModule.DllGetClassObject(clsid, riid, ppv);
 
   if (hr == CLASS_E_CLASSNOTAVAILABLE)
@@ -90,6 +102,15 @@ STDAPI DllGetClassObject(_In_ REFCLSID clsid, _In_ REFIID riid, _Outptr_ LPVOID*
   return hr;
 }
 
+static void SaveScopeTraces()
+{
+  std::string path = shellanything::ScopeTracer::GetDefaultTraceFilePath();
+  if (shellanything::ScopeTracer::SaveChromeTrace(path))
+    SA_LOG(INFO) << "Saved scope traces to file '" << path << "'.";
+  else
+    SA_LOG(ERROR) << "Failed saving scope traces to file '" << path << "'.";
+}
+
 // Used to determine whether the DLL can be unloaded by OLE.
 _Use_decl_annotations_
 STDAPI DllCanUnloadNow(void)
@@ -101,6 +122,15 @@ STDAPI DllCanUnloadNow(void)
   if (hr == S_OK)
   {
     SA_LOG(INFO) << __FUNCTION__ << "() -> Yes";
+
+    //The background threads cannot be stopped while the loader lock is held (within DllMain)
+    shellanything::ConfigManager::GetInstance().StopBackgroundRefresh();
+    shellanything::SelectionAnalyzer::StopWorkers();
+    if (async_logger_service)
+      async_logger_service->Stop();
+
+    if (shellanything::ScopeTracer::IsEnabled())
+      SaveScopeTraces();
     return S_OK;
   }
   SA_LOG(INFO) << __FUNCTION__ << "() -> No.";
@@ -229,8 +259,10 @@ extern "C" int APIENTRY DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID lpRe
       shellanything::logging::glog::InitGlog();
 
       // Setup an active logger in ShellAnything's core.
+      // Messages are forwarded synchronously until the asynchronous logger is started.
       logger_service = new shellanything::GlogLoggerService();
-      app.SetLoggerService(logger_service);
+      async_logger_service = new shellanything::AsyncLoggerService(logger_service);
+      app.SetLoggerService(async_logger_service);
 
       // Setup an active registry service in ShellAnything's core.
       registry_service = new shellanything::WindowsRegistryService();
@@ -256,8 +288,17 @@ extern "C" int APIENTRY DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID lpRe
       process_launcher_service = new shellanything::WindowsProcessLauncherService();
       app.SetProcessLauncherService(process_launcher_service);
 
-      // Setup and starting application
+      // Setup an active file watcher service in ShellAnything's core.
+      file_watcher_service = new shellanything::WindowsFileWatcherService();
+      app.SetFileWatcherService(file_watcher_service);
+
+      // Setup and starting application.
+      // Threads cannot be joined while the loader lock is held.
+      // Configuration files loaded during startup are loaded on the calling thread.
+      shellanything::ConfigManager& cmgr = shellanything::ConfigManager::GetInstance();
+      cmgr.SetMaxLoadingThreads(1);
       app.Start();
+      cmgr.SetMaxLoadingThreads(0);
 
       LogEnvironment();
     }
@@ -266,25 +307,30 @@ extern "C" int APIENTRY DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID lpRe
   {
     if (!app.IsTestingEnvironment())
     {
-      // Shutdown Google's logging library.
-      shellanything::logging::glog::ShutdownGlog();
+      // The recorded scopes are saved by DllCanUnloadNow(). File I/O is not allowed while the loader lock is held.
 
-      // Destroy services
+      // Destroy services.
+      // Pending log messages are flushed before shutting down Google's logging library.
       app.ClearServices();
+      shellanything::logging::glog::ShutdownGlog();
       delete random_service;
       delete keyboard_service;
       delete clipboard_service;
       delete registry_service;
+      delete async_logger_service;
       delete logger_service;
       delete icon_resolution_service;
       delete process_launcher_service;
+      delete file_watcher_service;
       random_service = NULL;
       keyboard_service = NULL;
       clipboard_service = NULL;
       registry_service = NULL;
+      async_logger_service = NULL;
       logger_service = NULL;
       icon_resolution_service = NULL;
       process_launcher_service = NULL;
+      file_watcher_service = NULL;
     }
   }
 
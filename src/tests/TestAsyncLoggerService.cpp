@@ -0,0 +1,259 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestAsyncLoggerService.h"
+#include "AsyncLoggerService.h"
+
+#include "rapidassist/timing.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace shellanything
+{
+  namespace test
+  {
+    // Logger that records the received messages. Can block the calling thread on demand.
+    class RecordingLoggerService : public virtual ILoggerService
+    {
+    public:
+      struct ENTRY
+      {
+        std::string filename;
+        int line;
+        ILoggerService::LOG_LEVEL level;
+        std::string message;
+      };
+      typedef std::vector<ENTRY> EntryList;
+
+      RecordingLoggerService() : mBlocking(false), mBlocked(false) {}
+      virtual ~RecordingLoggerService() {}
+
+      virtual void LogMessage(const char* filename, int line, const ILoggerService::LOG_LEVEL& level, const char* message)
+      {
+        // Block until the test releases this logger
+        if (mBlocking)
+        {
+          mBlocked = true;
+          while (mBlocking)
+          {
+            ra::timing::Millisleep(1);
+          }
+          mBlocked = false;
+        }
+
+        ENTRY entry;
+        entry.filename = (filename ? filename : "");
+        entry.line = line;
+        entry.level = level;
+        entry.message = message;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries.push_back(entry);
+      }
+
+      virtual void LogMessage(const ILoggerService::LOG_LEVEL& level, const char* message)
+      {
+        LogMessage(NULL, 0, level, message);
+      }
+
+      EntryList GetEntries()
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries;
+      }
+
+      std::atomic<bool> mBlocking;
+      std::atomic<bool> mBlocked;
+
+    private:
+      std::mutex mMutex;
+      EntryList mEntries;
+    };
+
+    bool WaitForFlag(const std::atomic<bool>& flag, uint64_t timeout_ms)
+    {
+      uint64_t deadline = ra::timing::GetMillisecondsCounterU64() + timeout_ms;
+      while (!flag && ra::timing::GetMillisecondsCounterU64() < deadline)
+      {
+        ra::timing::Millisleep(1);
+      }
+      return flag;
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestAsyncLoggerService::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestAsyncLoggerService::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAsyncLoggerService, testSynchronousWhenStopped)
+    {
+      RecordingLoggerService target;
+      AsyncLoggerService logger(&target);
+      ASSERT_FALSE(logger.IsRunning());
+
+      // Messages are forwarded immediately
+      logger.LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_INFO, "foo");
+      logger.LogMessage(ILoggerService::LOG_LEVEL_WARNING, "bar");
+
+      RecordingLoggerService::EntryList entries = target.GetEntries();
+      ASSERT_EQ(2, entries.size());
+      ASSERT_EQ(std::string(__FILE__), entries[0].filename);
+      ASSERT_EQ(ILoggerService::LOG_LEVEL_INFO, entries[0].level);
+      ASSERT_EQ(std::string("foo"), entries[0].message);
+      ASSERT_EQ(std::string(""), entries[1].filename);
+      ASSERT_EQ(ILoggerService::LOG_LEVEL_WARNING, entries[1].level);
+      ASSERT_EQ(std::string("bar"), entries[1].message);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAsyncLoggerService, testLogMessage)
+    {
+      RecordingLoggerService target;
+      AsyncLoggerService logger(&target);
+      ASSERT_TRUE(logger.Start());
+      ASSERT_TRUE(logger.IsRunning());
+
+      static const size_t COUNT = 100;
+      for (size_t i = 0; i < COUNT; i++)
+      {
+        std::string message = "message " + std::to_string(i);
+        logger.LogMessage(__FILE__, (int)i, ILoggerService::LOG_LEVEL_DEBUG, message.c_str());
+      }
+      logger.Flush();
+
+      // Assert all messages are received in order
+      RecordingLoggerService::EntryList entries = target.GetEntries();
+      ASSERT_EQ(COUNT, entries.size());
+      for (size_t i = 0; i < COUNT; i++)
+      {
+        std::string expected_message = "message " + std::to_string(i);
+        ASSERT_EQ(std::string(__FILE__), entries[i].filename);
+        ASSERT_EQ((int)i, entries[i].line);
+        ASSERT_EQ(expected_message, entries[i].message);
+      }
+
+      logger.Stop();
+      ASSERT_FALSE(logger.IsRunning());
+      ASSERT_EQ(0, logger.GetDroppedCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAsyncLoggerService, testBlockPolicy)
+    {
+      RecordingLoggerService target;
+      AsyncLoggerService logger(&target, 0, AsyncLoggerService::OVERFLOW_POLICY_BLOCK); // smallest ring buffer
+      ASSERT_EQ(2, logger.GetCapacity());
+      ASSERT_TRUE(logger.Start());
+
+      // Flood the ring buffer from multiple threads
+      static const size_t NUM_THREADS = 4;
+      static const size_t COUNT = 500;
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        threads.push_back(std::thread([&logger]()
+          {
+            for (size_t j = 0; j < COUNT; j++)
+            {
+              logger.LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_INFO, "flood");
+            }
+          }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+      logger.Stop();
+
+      // Assert no message is lost
+      RecordingLoggerService::EntryList entries = target.GetEntries();
+      ASSERT_EQ(NUM_THREADS * COUNT, entries.size());
+      ASSERT_EQ(0, logger.GetDroppedCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAsyncLoggerService, testDropPolicy)
+    {
+      RecordingLoggerService target;
+      AsyncLoggerService logger(&target, 64 * 1024, AsyncLoggerService::OVERFLOW_POLICY_DROP);
+      const size_t capacity = logger.GetCapacity();
+      ASSERT_TRUE(logger.Start());
+
+      // Block the background thread on the first message
+      target.mBlocking = true;
+      logger.LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_INFO, "first");
+      ASSERT_TRUE(WaitForFlag(target.mBlocked, 5000));
+
+      // Fill the ring buffer and overflow it. The slot of the first message is not released yet.
+      static const size_t OVERFLOW_COUNT = 10;
+      for (size_t i = 0; i < capacity - 1 + OVERFLOW_COUNT; i++)
+      {
+        logger.LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_INFO, "fill");
+      }
+      ASSERT_EQ(OVERFLOW_COUNT, logger.GetDroppedCount());
+
+      // Release the background thread
+      target.mBlocking = false;
+      logger.Flush();
+
+      // Assert the dropped messages are reported
+      RecordingLoggerService::EntryList entries = target.GetEntries();
+      ASSERT_EQ(capacity + 1, entries.size());
+      size_t num_reports = 0;
+      for (size_t i = 0; i < entries.size(); i++)
+      {
+        const RecordingLoggerService::ENTRY& entry = entries[i];
+        if (entry.level == ILoggerService::LOG_LEVEL_WARNING && entry.message.find("10 log messages were dropped") != std::string::npos)
+          num_reports++;
+      }
+      ASSERT_EQ(1, num_reports);
+
+      logger.Stop();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAsyncLoggerService, testTruncation)
+    {
+      RecordingLoggerService target;
+      AsyncLoggerService logger(&target);
+      ASSERT_TRUE(logger.Start());
+
+      std::string message(AsyncLoggerService::SLOT_TEXT_SIZE * 4, 'a');
+      logger.LogMessage(__FILE__, __LINE__, ILoggerService::LOG_LEVEL_INFO, message.c_str());
+      logger.Stop();
+
+      RecordingLoggerService::EntryList entries = target.GetEntries();
+      ASSERT_EQ(1, entries.size());
+      ASSERT_EQ(std::string(__FILE__), entries[0].filename);
+      ASSERT_LT(entries[0].message.size(), AsyncLoggerService::SLOT_TEXT_SIZE);
+      ASSERT_EQ(0, message.find(entries[0].message));
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
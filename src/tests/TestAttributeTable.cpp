@@ -0,0 +1,255 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestAttributeTable.h"
+#include "AttributeTable.h"
+#include "AttributeView.h"
+#include "PropertyManager.h"
+
+#include "shellanything/sa_attribute_table.h"
+#include "shellanything/sa_xml.h"
+
+#include "tinyxml2.h"
+
+#include <string>
+
+namespace shellanything
+{
+  namespace test
+  {
+    static const char* KILL_ACTION_XML = "<killprocess pid=\"42\" signal=\"\" />";
+    static const char* KILL_ACTION_BOTH_XML = "<killprocess pid=\"42\" filename=\"notepad.exe\" />";
+    static const char* KILL_ACTION_NONE_XML = "<killprocess signal=\"9\" />";
+
+    static sa_attribute_table_immutable_t GetTableHandle(const AttributeTable& table)
+    {
+      sa_attribute_table_immutable_t handle;
+      handle.opaque = (void*)(&table);
+      return handle;
+    }
+
+    static StringList GetKillProcessAttributeNames()
+    {
+      StringList names;
+      names.push_back("pid");
+      names.push_back("filename");
+      names.push_back("signal");
+      return names;
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestAttributeTable::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestAttributeTable::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testLookupByName)
+    {
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_XML));
+      AttributeView view(doc.FirstChildElement());
+      AttributeTable table(view, GetKillProcessAttributeNames());
+
+      // The id of each attribute is its index in the list of names
+      ASSERT_EQ(3, table.GetCount());
+      ASSERT_EQ(std::string("pid"), table.GetName(0));
+      ASSERT_EQ(std::string("filename"), table.GetName(1));
+      ASSERT_EQ(std::string("signal"), table.GetName(2));
+
+      // Assert values are read by name
+      ASSERT_TRUE(table.HasValue(0));
+      ASSERT_EQ(std::string("42"), table.GetValue(0));
+      const std::string* value = NULL;
+      ASSERT_TRUE(table.TryGetValue(0, value));
+      ASSERT_TRUE(value != NULL);
+      ASSERT_EQ(std::string("42"), *value);
+
+      // An empty attribute is defined
+      ASSERT_TRUE(table.HasValue(2));
+      ASSERT_EQ(std::string(""), table.GetValue(2));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testMissingAttributes)
+    {
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_XML));
+      AttributeView view(doc.FirstChildElement());
+      AttributeTable table(view, GetKillProcessAttributeNames());
+
+      // Attribute not in the xml element
+      ASSERT_FALSE(table.HasValue(1));
+      ASSERT_EQ(std::string(""), table.GetValue(1));
+      const std::string* value = NULL;
+      ASSERT_FALSE(table.TryGetValue(1, value));
+
+      // Out of bounds
+      ASSERT_EQ(std::string(""), table.GetName(3));
+      ASSERT_FALSE(table.HasValue(3));
+      ASSERT_EQ(std::string(""), table.GetValue(3));
+      ASSERT_FALSE(table.TryGetValue(3, value));
+
+      // An empty view defines no attribute
+      AttributeView empty_view(NULL);
+      AttributeTable empty_table(empty_view, GetKillProcessAttributeNames());
+      ASSERT_EQ(3, empty_table.GetCount());
+      ASSERT_EQ(std::string("pid"), empty_table.GetName(0));
+      ASSERT_FALSE(empty_table.HasValue(0));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testApi)
+    {
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_XML));
+      AttributeView view(doc.FirstChildElement());
+      AttributeTable table(view, GetKillProcessAttributeNames());
+      sa_attribute_table_immutable_t handle = GetTableHandle(table);
+
+      ASSERT_EQ(3, sa_attribute_table_get_count(&handle));
+      ASSERT_EQ(std::string("filename"), sa_attribute_table_get_name(&handle, 1));
+      ASSERT_TRUE(sa_attribute_table_get_name(&handle, 3) == NULL);
+      ASSERT_EQ(1, sa_attribute_table_has_value(&handle, 0));
+      ASSERT_EQ(0, sa_attribute_table_has_value(&handle, 1));
+      ASSERT_EQ(std::string("42"), sa_attribute_table_get_value_cstr(&handle, 0));
+      ASSERT_TRUE(sa_attribute_table_get_value_cstr(&handle, 1) == NULL);
+      ASSERT_TRUE(sa_attribute_table_get_value_cstr(&handle, 3) == NULL);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testApiNullArguments)
+    {
+      sa_attribute_table_immutable_t empty_handle;
+      empty_handle.opaque = NULL;
+
+      ASSERT_EQ(0, sa_attribute_table_get_count(NULL));
+      ASSERT_EQ(0, sa_attribute_table_get_count(&empty_handle));
+      ASSERT_TRUE(sa_attribute_table_get_name(NULL, 0) == NULL);
+      ASSERT_TRUE(sa_attribute_table_get_name(&empty_handle, 0) == NULL);
+      ASSERT_EQ(0, sa_attribute_table_has_value(NULL, 0));
+      ASSERT_EQ(0, sa_attribute_table_has_value(&empty_handle, 0));
+      ASSERT_TRUE(sa_attribute_table_get_value_cstr(NULL, 0) == NULL);
+      ASSERT_TRUE(sa_attribute_table_get_value_cstr(&empty_handle, 0) == NULL);
+
+      XML_ATTR attributes[] = {
+        {"pid",       SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"filename",  SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+      };
+      static const size_t count = sizeof(attributes) / sizeof(attributes[0]);
+
+      // Updating from a NULL table leaves the attributes undefined
+      sa_xml_attr_list_update_table(NULL, count, NULL);
+      sa_xml_attr_list_update_table(attributes, count, NULL);
+      ASSERT_TRUE(attributes[0].tmp_value == NULL);
+      ASSERT_TRUE(attributes[1].tmp_value == NULL);
+
+      ASSERT_EQ(SA_ERROR_INVALID_ARGUMENTS, sa_xml_attr_group_is_mutually_exclusive_table(NULL, count, 1, &empty_handle));
+      ASSERT_EQ(SA_ERROR_INVALID_ARGUMENTS, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 1, NULL));
+      ASSERT_EQ(SA_ERROR_INVALID_ARGUMENTS, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 1, &empty_handle));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testUpdateTable)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("TestAttributeTable.pid", "1234");
+
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse("<killprocess pid=\"${TestAttributeTable.pid}\" />"));
+      AttributeView view(doc.FirstChildElement());
+      AttributeTable table(view, GetKillProcessAttributeNames());
+      sa_attribute_table_immutable_t handle = GetTableHandle(table);
+
+      XML_ATTR attributes[] = {
+        {"pid",       SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"filename",  SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"signal",    SA_XML_ATTR_OPTINAL, SA_XML_ATTR_GROUP_ANY, NULL, NULL},
+      };
+      static const size_t count = sizeof(attributes) / sizeof(attributes[0]);
+
+      sa_xml_attr_list_update_table(attributes, count, &handle);
+
+      // Assert raw and expanded values
+      ASSERT_TRUE(attributes[0].tmp_value != NULL);
+      ASSERT_TRUE(attributes[0].tmp_expanded != NULL);
+      ASSERT_EQ(std::string("${TestAttributeTable.pid}"), attributes[0].tmp_value);
+      ASSERT_EQ(std::string("1234"), attributes[0].tmp_expanded);
+
+      // Assert missing attributes
+      ASSERT_TRUE(attributes[1].tmp_value == NULL);
+      ASSERT_TRUE(attributes[1].tmp_expanded == NULL);
+      ASSERT_TRUE(attributes[2].tmp_value == NULL);
+      ASSERT_TRUE(attributes[2].tmp_expanded == NULL);
+
+      sa_xml_attr_list_cleanup(attributes, count);
+      ASSERT_TRUE(attributes[0].tmp_value == NULL);
+      ASSERT_TRUE(attributes[0].tmp_expanded == NULL);
+
+      pmgr.ClearProperty("TestAttributeTable.pid");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestAttributeTable, testMutuallyExclusiveGroup)
+    {
+      XML_ATTR attributes[] = {
+        {"pid",       SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"filename",  SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"signal",    SA_XML_ATTR_OPTINAL, SA_XML_ATTR_GROUP_ANY, NULL, NULL},
+      };
+      static const size_t count = sizeof(attributes) / sizeof(attributes[0]);
+
+      // A single attribute of the group is specified
+      {
+        tinyxml2::XMLDocument doc;
+        ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_XML));
+        AttributeView view(doc.FirstChildElement());
+        AttributeTable table(view, GetKillProcessAttributeNames());
+        sa_attribute_table_immutable_t handle = GetTableHandle(table);
+        ASSERT_EQ(SA_ERROR_SUCCESS, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 1, &handle));
+      }
+
+      // Both attributes of the group are specified
+      {
+        tinyxml2::XMLDocument doc;
+        ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_BOTH_XML));
+        AttributeView view(doc.FirstChildElement());
+        AttributeTable table(view, GetKillProcessAttributeNames());
+        sa_attribute_table_immutable_t handle = GetTableHandle(table);
+        ASSERT_EQ(SA_ERROR_VALUE_OUT_OF_BOUNDS, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 1, &handle));
+      }
+
+      // No attribute of the group is specified
+      {
+        tinyxml2::XMLDocument doc;
+        ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse(KILL_ACTION_NONE_XML));
+        AttributeView view(doc.FirstChildElement());
+        AttributeTable table(view, GetKillProcessAttributeNames());
+        sa_attribute_table_immutable_t handle = GetTableHandle(table);
+        ASSERT_EQ(SA_ERROR_VALUE_OUT_OF_BOUNDS, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 1, &handle));
+
+        // Unknown group
+        ASSERT_EQ(SA_ERROR_NOT_FOUND, sa_xml_attr_group_is_mutually_exclusive_table(attributes, count, 7, &handle));
+      }
+    }
+
+  } //namespace test
+} //namespace shellanything
@@ -29,10 +29,12 @@
 #include "ConfigManager.h"
 #include "PropertyManager.h"
 #include "SelectionContext.h"
+#include "PollingFileWatcherService.h"
 
 #include "rapidassist/testing.h"
 #include "rapidassist/filesystem.h"
 #include "rapidassist/environment.h"
+#include "rapidassist/strings.h"
 #include "rapidassist/timing.h"
 
 namespace shellanything
@@ -216,6 +218,144 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testRefreshOnChangeNotification)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      App& app = App::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      static const std::string CONFIG_XML = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"Start WordPad\">\n"
+        "      <actions>\n"
+        "        <exec path=\"C:\\windows\\system32\\write.exe\" />\n"
+        "      </actions>\n"
+        "    </menu>\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("first.xml"), CONFIG_XML));
+
+      //Watch for changes manually
+      IFileWatcherService* previous_watcher = app.GetFileWatcherService();
+      PollingFileWatcherService watcher(0);
+      app.SetFileWatcherService(&watcher);
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      //ASSERT the file is loaded and the search path is watched
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+      ASSERT_TRUE(watcher.IsWatching(workspace.GetBaseDirectory()));
+      ASSERT_FALSE(cmgr.IsRefreshRequired());
+
+      //Import another file into the workspace
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("second.xml"), CONFIG_XML));
+
+      //ASSERT the new file is ignored until a change is notified
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      watcher.Poll();
+      ASSERT_TRUE(cmgr.IsRefreshRequired());
+      cmgr.Refresh();
+      ASSERT_EQ(2, cmgr.GetConfigFiles().size());
+      ASSERT_FALSE(cmgr.IsRefreshRequired());
+
+      //Restore the previous watcher
+      app.SetFileWatcherService(previous_watcher);
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testParallelLoading)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      const size_t previous_max_threads = cmgr.GetMaxLoadingThreads();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate multiple configuration files. One of them is invalid.
+      static const size_t NUM_FILES = 20;
+      for (size_t i = 0; i < NUM_FILES; i++)
+      {
+        std::string name = ra::strings::Format("config%03d", (int)i);
+        std::string xml = ""
+          "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+          "<root>\n"
+          "  <shell>\n";
+        for (size_t j = 0; j < 50; j++)
+        {
+          xml += ra::strings::Format("    <menu name=\"%s menu %03d\">\n", name.c_str(), (int)j);
+          xml += "      <actions>\n";
+          xml += "        <exec path=\"C:\\windows\\system32\\calc.exe\" />\n";
+          xml += "      </actions>\n";
+          xml += "    </menu>\n";
+        }
+        xml += ""
+          "  </shell>\n"
+          "</root>\n";
+        if (i == 7)
+          xml = "<root><shell>"; // malformed
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8((name + ".xml").c_str()), xml));
+      }
+
+      //Load the files with a single thread and then with multiple threads
+      static const size_t MAX_THREADS[] = { 1, 4, 0 };
+      static const size_t NUM_TESTS = sizeof(MAX_THREADS) / sizeof(MAX_THREADS[0]);
+      StringList expected_files;
+      for (size_t i = 0; i < NUM_TESTS; i++)
+      {
+        cmgr.SetMaxLoadingThreads(MAX_THREADS[i]);
+        cmgr.ClearSearchPath();
+        cmgr.AddSearchPath(workspace.GetBaseDirectory());
+
+        uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+        cmgr.Refresh();
+        uint64_t time_end = ra::timing::GetMillisecondsCounterU64();
+        printf("Loaded %d configuration files with max %d threads in %d ms.\n", (int)cmgr.GetConfigFiles().size(), (int)MAX_THREADS[i], (int)(time_end - time_start));
+
+        //ASSERT the invalid file is skipped and files are loaded in the same order
+        ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+        ASSERT_EQ(NUM_FILES - 1, configs.size());
+        StringList files;
+        for (size_t j = 0; j < configs.size(); j++)
+        {
+          ConfigFile* config = configs[j];
+          ASSERT_EQ(50, config->GetMenus().size());
+          files.push_back(config->GetFilePath());
+        }
+        if (i == 0)
+          expected_files = files;
+        ASSERT_EQ(expected_files, files);
+
+        //Unload all configurations
+        cmgr.ClearSearchPath();
+        cmgr.Refresh();
+        ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      }
+
+      //Restore
+      cmgr.SetMaxLoadingThreads(previous_max_threads);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestConfigManager, testFileModifications)
     {
       ConfigManager& cmgr = ConfigManager::GetInstance();
@@ -335,6 +475,102 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testFindMenuByCommandIdBenchmark)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a configuration file with 5000 menus
+      static const size_t NUM_ROOT_MENUS = 100;
+      static const size_t NUM_SUB_MENUS = 49;
+      static const size_t NUM_MENUS = NUM_ROOT_MENUS * (NUM_SUB_MENUS + 1);
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n";
+      for (size_t i = 0; i < NUM_ROOT_MENUS; i++)
+      {
+        xml += ra::strings::Format("    <menu name=\"menu %03d\">\n", (int)i);
+        for (size_t j = 0; j < NUM_SUB_MENUS; j++)
+        {
+          xml += ra::strings::Format("      <menu name=\"menu %03d.%03d\">\n", (int)i, (int)j);
+          xml += "        <actions>\n";
+          xml += "          <exec path=\"C:\\windows\\system32\\calc.exe\" />\n";
+          xml += "        </actions>\n";
+          xml += "      </menu>\n";
+        }
+        xml += "    </menu>\n";
+      }
+      xml += ""
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("benchmark.xml"), xml));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      //ASSERT the file is loaded
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      ConfigFile* config = configs[0];
+
+      //Assign unique command ids
+      static const uint32_t FIRST_COMMAND_ID = 101;
+      uint32_t next_command_id = cmgr.AssignCommandIds(FIRST_COMMAND_ID);
+      ASSERT_EQ(FIRST_COMMAND_ID + NUM_MENUS, next_command_id);
+
+      //ASSERT invalid command ids
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(FIRST_COMMAND_ID - 1));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(next_command_id));
+
+      static const size_t NUM_LOOKUPS = 10;
+
+      //Find all menus by searching the menu tree
+      uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+      std::vector<Menu*> expected;
+      for (size_t i = 0; i < NUM_LOOKUPS; i++)
+      {
+        for (uint32_t command_id = FIRST_COMMAND_ID; command_id < next_command_id; command_id++)
+        {
+          Menu* menu = config->FindMenuByCommandId(command_id);
+          if (i == 0)
+            expected.push_back(menu);
+        }
+      }
+      uint64_t elapsed_search = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      //Find all menus with the index
+      time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOOKUPS; i++)
+      {
+        for (uint32_t command_id = FIRST_COMMAND_ID; command_id < next_command_id; command_id++)
+        {
+          Menu* menu = cmgr.FindMenuByCommandId(command_id);
+          ASSERT_TRUE(menu != NULL);
+          ASSERT_EQ(expected[command_id - FIRST_COMMAND_ID], menu);
+        }
+      }
+      uint64_t elapsed_index = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      printf("Found %d menus %d times by searching the menu tree in %d ms.\n", (int)NUM_MENUS, (int)NUM_LOOKUPS, (int)elapsed_search);
+      printf("Found %d menus %d times with the command id index in %d ms.\n", (int)NUM_MENUS, (int)NUM_LOOKUPS, (int)elapsed_index);
+
+      //ASSERT the index is invalidated when configurations are unloaded
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(FIRST_COMMAND_ID));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestConfigManager, testDescription)
     {
       ConfigManager& mgr = ConfigManager::GetInstance();
@@ -668,5 +904,355 @@ namespace shellanything
     }
     //--------------------------------------------------------------------------------------------------
 
+    TEST_F(TestConfigManager, testFindMenuByNameIndex)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a configuration file with duplicate and expanding names
+      static const size_t NUM_MENUS = 1000;
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"Duplicate\">\n"
+        "      <menu name=\"duplicate\" />\n"
+        "    </menu>\n"
+        "    <menu name=\"menu ${test.index.name}\" />\n";
+      for (size_t i = 0; i < NUM_MENUS; i++)
+      {
+        xml += ra::strings::Format("    <menu name=\"menu %04d\" />\n", (int)i);
+      }
+      xml += ""
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("index.xml"), xml));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      //ASSERT the file is loaded
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      ConfigFile* config = configs[0];
+
+      //ASSERT the first menu in search order is returned
+      FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_CASE_INSENSITIVE;
+      Menu* duplicate_upper = cmgr.FindMenuByName("Duplicate");
+      Menu* duplicate_lower = cmgr.FindMenuByName("duplicate");
+      ASSERT_TRUE(duplicate_upper != NULL);
+      ASSERT_TRUE(duplicate_lower != NULL);
+      ASSERT_NE(duplicate_upper, duplicate_lower);
+      ASSERT_EQ(duplicate_upper, cmgr.FindMenuByName("duplicate", flags));
+      ASSERT_EQ(duplicate_upper, cmgr.FindMenuByName("DUPLICATE", flags));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("DUPLICATE"));
+
+      //ASSERT the index of expanded names follows the properties
+      flags = FIND_BY_NAME_EXPANDS;
+      pmgr.SetProperty("test.index.name", "foo");
+      Menu* expanded = cmgr.FindMenuByName("menu foo", flags);
+      ASSERT_TRUE(expanded != NULL);
+      ASSERT_EQ(expanded, cmgr.FindMenuByName("menu ${test.index.name}"));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("menu bar", flags));
+      pmgr.SetProperty("test.index.name", "bar");
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("menu foo", flags));
+      ASSERT_EQ(expanded, cmgr.FindMenuByName("menu bar", flags));
+      ASSERT_EQ(expanded, cmgr.FindMenuByName("MENU BAR", (FIND_BY_NAME_FLAGS)(FIND_BY_NAME_EXPANDS | FIND_BY_NAME_CASE_INSENSITIVE)));
+      pmgr.ClearProperty("test.index.name");
+
+      //ASSERT modifying an unrelated property does not change the expanded names
+      pmgr.SetProperty("test.index.unrelated", "foo");
+      ASSERT_EQ(duplicate_upper, cmgr.FindMenuByName("Duplicate", flags));
+      pmgr.ClearProperty("test.index.unrelated");
+
+      //ASSERT the index follows the names of the menus
+      duplicate_lower->SetName("renamed");
+      ASSERT_EQ(duplicate_lower, cmgr.FindMenuByName("renamed"));
+      ASSERT_EQ(duplicate_lower, cmgr.FindMenuByName("RENAMED", FIND_BY_NAME_CASE_INSENSITIVE));
+      ASSERT_EQ(duplicate_lower, cmgr.FindMenuByName("renamed", flags));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("duplicate"));
+      duplicate_lower->SetName("duplicate");
+      ASSERT_EQ(duplicate_lower, cmgr.FindMenuByName("duplicate"));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("renamed", flags));
+
+      static const size_t NUM_LOOKUPS = 10;
+
+      //Find all menus by searching the menu tree
+      uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+      std::vector<Menu*> expected;
+      for (size_t i = 0; i < NUM_LOOKUPS; i++)
+      {
+        for (size_t j = 0; j < NUM_MENUS; j++)
+        {
+          Menu* menu = config->FindMenuByName(ra::strings::Format("menu %04d", (int)j), flags);
+          if (i == 0)
+            expected.push_back(menu);
+        }
+      }
+      uint64_t elapsed_search = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      //Find all menus with the index
+      time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOOKUPS; i++)
+      {
+        for (size_t j = 0; j < NUM_MENUS; j++)
+        {
+          Menu* menu = cmgr.FindMenuByName(ra::strings::Format("menu %04d", (int)j), flags);
+          ASSERT_TRUE(menu != NULL);
+          ASSERT_EQ(expected[j], menu);
+        }
+      }
+      uint64_t elapsed_index = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      printf("Found %d menus %d times by searching the menu tree in %d ms.\n", (int)NUM_MENUS, (int)NUM_LOOKUPS, (int)elapsed_search);
+      printf("Found %d menus %d times with the name index in %d ms.\n", (int)NUM_MENUS, (int)NUM_LOOKUPS, (int)elapsed_index);
+
+      //ASSERT the index is invalidated when configurations are unloaded
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByName("Duplicate"));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+    TEST_F(TestConfigManager, testUpdateCache)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a configuration file with a menu that is visible if a file exists
+      const std::string marker_path = workspace.GetFullPathUtf8("marker.txt");
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"marker\">\n"
+        "      <visibility exists=\"" + marker_path + "\" />\n"
+        "    </menu>\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("cache.xml"), xml));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      cmgr.SetUpdateCacheTimeout(60000);
+
+      Menu* marker = cmgr.FindMenuByName("marker");
+      ASSERT_TRUE(marker != NULL);
+
+      SelectionContext context = GetContextSingleFile();
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //ASSERT the previous states are reused for the same selection
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(marker_path, "marker"));
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //ASSERT the states are updated when a property is modified
+      pmgr.SetProperty("test.update.cache", ra::strings::ToString(pmgr.GetGeneration()));
+      cmgr.Update(context);
+      ASSERT_TRUE(marker->IsVisible());
+
+      //ASSERT the states are updated when the cache is invalidated
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(marker_path.c_str()));
+      cmgr.Update(context);
+      ASSERT_TRUE(marker->IsVisible());
+      cmgr.InvalidateUpdateCache();
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //ASSERT the states are updated when the cache is disabled
+      cmgr.SetUpdateCacheTimeout(0);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(marker_path, "marker"));
+      cmgr.Update(context);
+      ASSERT_TRUE(marker->IsVisible());
+
+      //Add a menu that depends on a live property
+      xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"live\">\n"
+        "      <visibility isempty=\"${random.guid}\" inverse=\"isempty\" />\n"
+        "    </menu>\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("live.xml"), xml));
+      cmgr.Refresh();
+      ASSERT_EQ(2, cmgr.GetConfigFiles().size());
+
+      //ASSERT the states are always updated if a live property is read
+      cmgr.SetUpdateCacheTimeout(60000);
+      cmgr.Update(context);
+      ASSERT_TRUE(marker->IsVisible());
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(marker_path.c_str()));
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //Cleanup
+      cmgr.SetUpdateCacheTimeout(ConfigManager::DEFAULT_UPDATE_CACHE_TIMEOUT);
+      pmgr.ClearProperty("test.update.cache");
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+    TEST_F(TestConfigManager, testUpdateCacheRegisterProperties)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a configuration file with a menu that is visible if a file exists
+      const std::string marker_path = workspace.GetFullPathUtf8("marker.txt");
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"marker\">\n"
+        "      <visibility exists=\"" + marker_path + "\" />\n"
+        "    </menu>\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("cache.xml"), xml));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      cmgr.SetUpdateCacheTimeout(60000);
+
+      Menu* marker = cmgr.FindMenuByName("marker");
+      ASSERT_TRUE(marker != NULL);
+
+      //Register the selection properties before each update, like the shell extension does
+      SelectionContext context = GetContextSingleFile();
+      context.RegisterProperties();
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //ASSERT registering the same selection again does not modify the properties
+      const uint64_t generation = pmgr.GetGeneration();
+      context.RegisterProperties();
+      ASSERT_EQ(generation, pmgr.GetGeneration());
+
+      //ASSERT the previous states are reused for the same selection
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(marker_path, "marker"));
+      context.RegisterProperties();
+      cmgr.Update(context);
+      ASSERT_FALSE(marker->IsVisible());
+
+      //ASSERT the states are updated for another selection
+      SelectionContext other = GetContextSingleDirectory();
+      other.RegisterProperties();
+      ASSERT_NE(generation, pmgr.GetGeneration());
+      cmgr.Update(other);
+      ASSERT_TRUE(marker->IsVisible());
+
+      //Cleanup
+      other.UnregisterProperties();
+      cmgr.SetUpdateCacheTimeout(ConfigManager::DEFAULT_UPDATE_CACHE_TIMEOUT);
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(marker_path.c_str()));
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testBackgroundRefresh)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      static const char* XML_TEMPLATE = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"%s\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+      const std::string first_path = workspace.GetFullPathUtf8("first.xml");
+      const std::string second_path = workspace.GetFullPathUtf8("second.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(first_path, ra::strings::Format(XML_TEMPLATE, "first")));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      //Keep a reference to the loaded configurations
+      ConfigManager::ConfigFileSetPtr previous = cmgr.GetConfigFileSet();
+      ASSERT_TRUE(previous != NULL);
+      ASSERT_EQ(1, previous->size());
+      Menu* first = cmgr.FindMenuByName("first");
+      ASSERT_TRUE(first != NULL);
+
+      ASSERT_TRUE(cmgr.StartBackgroundRefresh(50));
+      ASSERT_TRUE(cmgr.IsBackgroundRefreshRunning());
+
+      //ASSERT a new file is loaded in the background
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(second_path, ra::strings::Format(XML_TEMPLATE, "second")));
+      for (int i = 0; i < 100 && cmgr.GetConfigFiles().size() != 2; i++)
+      {
+        ra::timing::Millisleep(50);
+        cmgr.Refresh();
+      }
+      ASSERT_EQ(2, cmgr.GetConfigFiles().size());
+      ASSERT_TRUE(cmgr.FindMenuByName("second") != NULL);
+      ASSERT_EQ(first, cmgr.FindMenuByName("first"));
+
+      //Wait to make sure that the next file modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //ASSERT a modified file is loaded again in the background
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(first_path, ra::strings::Format(XML_TEMPLATE, "modified")));
+      for (int i = 0; i < 100 && cmgr.FindMenuByName("modified") == NULL; i++)
+      {
+        ra::timing::Millisleep(50);
+        cmgr.Refresh();
+      }
+      ASSERT_TRUE(cmgr.FindMenuByName("modified") != NULL);
+      ASSERT_TRUE(cmgr.FindMenuByName("first") == NULL);
+      ASSERT_EQ(2, cmgr.GetConfigFiles().size());
+
+      //ASSERT the previous configurations are still alive
+      ASSERT_EQ(first, previous->at(0)->FindMenuByName("first"));
+      ASSERT_NE(previous, cmgr.GetConfigFileSet());
+      previous.reset();
+
+      cmgr.StopBackgroundRefresh();
+      ASSERT_FALSE(cmgr.IsBackgroundRefreshRunning());
+
+      //Cleanup
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
   } //namespace test
 } //namespace shellanything
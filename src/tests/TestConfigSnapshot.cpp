@@ -0,0 +1,442 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestConfigSnapshot.h"
+#include "App.h"
+#include "Workspace.h"
+#include "ConfigFile.h"
+#include "ConfigSnapshot.h"
+#include "Menu.h"
+#include "ActionFile.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+#include <ctype.h>
+
+namespace shellanything
+{
+  namespace test
+  {
+    static const ConfigFile* INVALID_CONFIGURATION = NULL;
+    static std::string gPreviousSnapshotDirectory;
+
+    static const std::string CONFIG_XML = ""
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+      "<root>\n"
+      "  <!-- comments are not part of the snapshot -->\n"
+      "  <shell>\n"
+      "    <default>\n"
+      "      <property name=\"foo\" value=\"bar\" />\n"
+      "    </default>\n"
+      "    <menu name=\"Parent &amp; &quot;child&quot;\">\n"
+      "      <icon path=\"C:\\Windows\\System32\\shell32.dll\" index=\"3\" />\n"
+      "      <menu name=\"Open command prompt\">\n"
+      "        <visibility maxfiles=\"1\" maxfolders=\"0\" fileextensions=\"txt;xml\" />\n"
+      "        <validity properties=\"foo\" />\n"
+      "        <actions>\n"
+      "          <exec path=\"${env.ComSpec}\" basedir=\"${selection.parent.path}\" />\n"
+      "        </actions>\n"
+      "      </menu>\n"
+      "      <menu separator=\"true\" />\n"
+      "      <menu name=\"Write file\">\n"
+      "        <actions>\n"
+      "          <file path=\"${temp}\\\\foo.txt\">first line\n"
+      "second line &lt;with markup&gt;</file>\n"
+      "          <file path=\"${temp}\\\\bar.txt\"><![CDATA[<raw> & text]]></file>\n"
+      "        </actions>\n"
+      "      </menu>\n"
+      "    </menu>\n"
+      "  </shell>\n"
+      "</root>\n";
+
+    std::string GetConfigFileString(const ConfigFile* config)
+    {
+      std::string str;
+      config->ToLongString(str, 0);
+
+      //remove the addresses of the objects
+      std::string result;
+      for (size_t i = 0; i < str.size(); i++)
+      {
+        result += str[i];
+        if (str[i] == '0' && i + 1 < str.size() && str[i + 1] == 'x')
+        {
+          result += 'x';
+          i++;
+          while (i + 1 < str.size() && isxdigit((unsigned char)str[i + 1]))
+            i++;
+        }
+      }
+      return result;
+    }
+
+    const ActionFile* GetActionFile(ConfigFile* config, size_t index)
+    {
+      Menu* menu = config->GetMenus()[0]->GetSubMenus()[2];
+      const IAction* action = menu->GetActions()[index];
+      return dynamic_cast<const ActionFile*>(action);
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestConfigSnapshot::SetUp()
+    {
+      gPreviousSnapshotDirectory = ConfigSnapshot::GetDirectory();
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestConfigSnapshot::TearDown()
+    {
+      ConfigSnapshot::SetDirectory(gPreviousSnapshotDirectory);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testLoadFromSnapshot)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, CONFIG_XML));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT the first load creates the snapshot
+      std::string error;
+      ConfigFile* config_xml = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config_xml) << "error=" << error;
+      ASSERT_TRUE(ra::filesystem::FileExistsUtf8(ConfigSnapshot::GetSnapshotPath(path).c_str()));
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT no temporary file is left in the snapshot directory
+      ra::strings::StringVector snapshot_files;
+      ASSERT_TRUE(ra::filesystem::FindFilesUtf8(snapshot_files, ConfigSnapshot::GetDirectory().c_str(), 0));
+      ASSERT_EQ(1, snapshot_files.size());
+
+      //ASSERT the configuration loaded from the snapshot is identical
+      ConfigFile* config_snapshot = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config_snapshot) << "error=" << error;
+      ASSERT_EQ(GetConfigFileString(config_xml), GetConfigFileString(config_snapshot));
+      ASSERT_EQ(1, config_snapshot->GetMenus().size());
+      ASSERT_EQ(3, config_snapshot->GetMenus()[0]->GetSubMenus().size());
+
+      //ASSERT text and cdata elements are restored
+      const ActionFile* file1 = GetActionFile(config_snapshot, 0);
+      const ActionFile* file2 = GetActionFile(config_snapshot, 1);
+      ASSERT_TRUE(file1 != NULL);
+      ASSERT_TRUE(file2 != NULL);
+      ASSERT_EQ(GetActionFile(config_xml, 0)->GetText(), file1->GetText());
+      ASSERT_EQ(GetActionFile(config_xml, 1)->GetText(), file2->GetText());
+      ASSERT_EQ(std::string("<raw> & text"), file2->GetText());
+
+      //Cleanup
+      delete config_xml;
+      delete config_snapshot;
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testOutOfDate)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, CONFIG_XML));
+
+      std::string error;
+      ConfigFile* config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      delete config;
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+
+      //Wait to make sure that the next modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //Change the file
+      std::string modified_xml = CONFIG_XML;
+      ra::strings::Replace(modified_xml, "Open command prompt", "Open prompt");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, modified_xml));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT the modified file is loaded and the snapshot is updated
+      config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+      std::string str = GetConfigFileString(config);
+      ASSERT_NE(std::string::npos, str.find("Open prompt"));
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testSameSize)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, CONFIG_XML));
+
+      std::string error;
+      ConfigFile* config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      delete config;
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+
+      //Wait to make sure that the next modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //Change the file without changing its size
+      std::string modified_xml = CONFIG_XML;
+      ra::strings::Replace(modified_xml, "Open command prompt", "Open command PROMPT");
+      ASSERT_EQ(CONFIG_XML.size(), modified_xml.size());
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, modified_xml));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT the modified file is loaded
+      config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      std::string str = GetConfigFileString(config);
+      ASSERT_NE(std::string::npos, str.find("Open command PROMPT"));
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testInvalidNotSaved)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      static const std::string INVALID_XML = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <menu name=\"missing shell\" />\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, INVALID_XML));
+
+      //ASSERT a document without a <shell> node is not saved
+      std::string error;
+      ConfigFile* config = ConfigFile::LoadFile(path, error);
+      ASSERT_EQ(INVALID_CONFIGURATION, config);
+      ASSERT_FALSE(ra::filesystem::FileExistsUtf8(ConfigSnapshot::GetSnapshotPath(path).c_str()));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testLineNumbers)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      static const std::string UNKNOWN_ACTION_XML = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"foo\">\n"
+        "      <actions>\n"
+        "        <unknown />\n"
+        "      </actions>\n"
+        "    </menu>\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, UNKNOWN_ACTION_XML));
+
+      //The document is valid but the configuration is not. The snapshot is not saved.
+      std::string error_xml;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_xml);
+      ASSERT_EQ(INVALID_CONFIGURATION, config);
+      ASSERT_NE(std::string::npos, error_xml.find("at line 6")) << "error=" << error_xml;
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT the errors of the next load report the same line numbers
+      std::string error_snapshot;
+      config = ConfigFile::LoadFile(path, error_snapshot);
+      ASSERT_EQ(INVALID_CONFIGURATION, config);
+      ASSERT_EQ(error_xml, error_snapshot);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testCorrupted)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, CONFIG_XML));
+
+      std::string error;
+      ConfigFile* config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      std::string expected = GetConfigFileString(config);
+      delete config;
+
+      //Truncate the snapshot and flip a byte of the payload
+      const std::string snapshot_path = ConfigSnapshot::GetSnapshotPath(path);
+      std::string data;
+      ASSERT_TRUE(ra::filesystem::ReadFileUtf8(snapshot_path, data));
+      ASSERT_TRUE(ra::filesystem::WriteFileUtf8(snapshot_path, data.substr(0, data.size() / 2)));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+      data[data.size() - 10] ^= 0x55;
+      ASSERT_TRUE(ra::filesystem::WriteFileUtf8(snapshot_path, data));
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+
+      //ASSERT the xml file is parsed and the snapshot is repaired
+      config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      ASSERT_EQ(expected, GetConfigFileString(config));
+      ASSERT_TRUE(ConfigSnapshot::IsUpToDate(path));
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testDisabled)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      ConfigSnapshot::SetDirectory("");
+      ASSERT_FALSE(ConfigSnapshot::IsEnabled());
+
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, CONFIG_XML));
+      ASSERT_TRUE(ConfigSnapshot::GetSnapshotPath(path).empty());
+
+      std::string error;
+      ConfigFile* config = ConfigFile::LoadFile(path, error);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error=" << error;
+      ASSERT_FALSE(ConfigSnapshot::IsUpToDate(path));
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigSnapshot, testBenchmark)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Import the shipped configurations into the workspace
+      const std::string install_dir = shellanything::App::GetInstallDirectory();
+      const std::string configurations_dir = install_dir + "/resources/configurations";
+      ra::strings::StringVector files;
+      ASSERT_TRUE(ra::filesystem::FindFilesUtf8(files, configurations_dir.c_str(), 0));
+      ra::strings::StringVector paths;
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        const std::string& file_path = files[i];
+        if (!ConfigFile::IsValidConfigFile(file_path))
+          continue;
+        ASSERT_TRUE(workspace.ImportFileUtf8(file_path.c_str()));
+        paths.push_back(workspace.GetFullPathUtf8(ra::filesystem::GetFilename(file_path.c_str()).c_str()));
+      }
+      ASSERT_FALSE(paths.empty());
+
+      static const size_t NUM_LOADS = 20;
+      std::string error;
+
+      //Load from xml
+      ConfigSnapshot::SetDirectory("");
+      std::vector<std::string> expected;
+      uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < paths.size(); j++)
+        {
+          ConfigFile* config = ConfigFile::LoadFile(paths[j], error);
+          ASSERT_NE(INVALID_CONFIGURATION, config) << "path=" << paths[j] << ", error=" << error;
+          if (i == 0)
+            expected.push_back(GetConfigFileString(config));
+          delete config;
+        }
+      }
+      uint64_t elapsed_xml = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      //Create the snapshots
+      ConfigSnapshot::SetDirectory(workspace.GetFullPathUtf8("snapshots"));
+      for (size_t j = 0; j < paths.size(); j++)
+      {
+        ConfigFile* config = ConfigFile::LoadFile(paths[j], error);
+        ASSERT_NE(INVALID_CONFIGURATION, config) << "path=" << paths[j] << ", error=" << error;
+        delete config;
+        ASSERT_TRUE(ConfigSnapshot::IsUpToDate(paths[j])) << "path=" << paths[j];
+      }
+
+      //Load from snapshots
+      time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < paths.size(); j++)
+        {
+          ConfigFile* config = ConfigFile::LoadFile(paths[j], error);
+          ASSERT_NE(INVALID_CONFIGURATION, config) << "path=" << paths[j] << ", error=" << error;
+          if (i == 0)
+            ASSERT_EQ(expected[j], GetConfigFileString(config)) << "path=" << paths[j];
+          delete config;
+        }
+      }
+      uint64_t elapsed_snapshot = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      printf("Loaded %d configuration files %d times from xml in %d ms.\n", (int)paths.size(), (int)NUM_LOADS, (int)elapsed_xml);
+      printf("Loaded %d configuration files %d times from snapshots in %d ms.\n", (int)paths.size(), (int)NUM_LOADS, (int)elapsed_snapshot);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
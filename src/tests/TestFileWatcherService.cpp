@@ -0,0 +1,223 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestFileWatcherService.h"
+#include "Workspace.h"
+#include "PollingFileWatcherService.h"
+#include "InotifyFileWatcherService.h"
+#ifdef _WIN32
+#include "WindowsFileWatcherService.h"
+#endif
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    static const uint32_t CHANGE_NOTIFICATION_TIMEOUT = 2000; //ms
+
+    bool WaitForChanges(IFileWatcherService& service, StringList& directories)
+    {
+      uint64_t timeout_time = ra::timing::GetMillisecondsCounterU64() + CHANGE_NOTIFICATION_TIMEOUT;
+      while (ra::timing::GetMillisecondsCounterU64() < timeout_time)
+      {
+        if (service.GetChanges(directories))
+          return true;
+        ra::timing::Millisleep(50);
+      }
+      return false;
+    }
+
+    void TestNotificationService(IFileWatcherService& service)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+      const std::string base_dir = workspace.GetBaseDirectory();
+
+      ASSERT_TRUE(service.Watch(base_dir));
+      ASSERT_TRUE(service.IsWatching(base_dir));
+
+      //ASSERT no change is reported
+      StringList directories;
+      ASSERT_FALSE(service.GetChanges(directories));
+      ASSERT_EQ(0, directories.size());
+
+      //Create a new file
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(workspace.GetFullPathUtf8("foo.xml"), "foo"));
+
+      //ASSERT the change is reported once
+      ASSERT_TRUE(WaitForChanges(service, directories));
+      ASSERT_EQ(1, directories.size());
+      ASSERT_EQ(base_dir, directories[0]);
+      ra::timing::Millisleep(100);
+      service.GetChanges(directories); //ignore duplicate notifications of the same change
+      ASSERT_FALSE(service.GetChanges(directories));
+
+      //Create a file in a subdirectory
+      ASSERT_TRUE(ra::filesystem::CreateDirectoryUtf8(workspace.GetFullPathUtf8("bar").c_str()));
+      ASSERT_TRUE(WaitForChanges(service, directories));
+      ra::timing::Millisleep(100);
+      service.GetChanges(directories);
+      static const std::string path_separator = ra::filesystem::GetPathSeparatorStr();
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(workspace.GetFullPathUtf8("bar") + path_separator + "baz.xml", "baz"));
+      ASSERT_TRUE(WaitForChanges(service, directories));
+      ASSERT_EQ(base_dir, directories[0]);
+
+      //ASSERT changes are not reported after unwatching
+      ASSERT_TRUE(service.Unwatch(base_dir));
+      ASSERT_FALSE(service.IsWatching(base_dir));
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(workspace.GetFullPathUtf8("qux.xml"), "qux"));
+      ra::timing::Millisleep(100);
+      ASSERT_FALSE(service.GetChanges(directories));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestFileWatcherService::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestFileWatcherService::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileWatcherService, testPollingManual)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+      const std::string base_dir = workspace.GetBaseDirectory();
+
+      //Do not scan in the background
+      PollingFileWatcherService service(0);
+      ASSERT_EQ(0, service.GetPollingInterval());
+      ASSERT_TRUE(service.Watch(base_dir));
+
+      //Create a new file
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(workspace.GetFullPathUtf8("foo.xml"), "foo"));
+
+      //ASSERT the change is not detected until the directories are polled
+      StringList directories;
+      ASSERT_FALSE(service.GetChanges(directories));
+      service.Poll();
+      ASSERT_TRUE(service.GetChanges(directories));
+      ASSERT_EQ(1, directories.size());
+      ASSERT_EQ(base_dir, directories[0]);
+
+      //ASSERT changes are cleared
+      service.Poll();
+      ASSERT_FALSE(service.GetChanges(directories));
+
+      //Delete the file
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(workspace.GetFullPathUtf8("foo.xml").c_str()));
+      service.Poll();
+      ASSERT_TRUE(service.GetChanges(directories));
+
+      service.UnwatchAll();
+      ASSERT_FALSE(service.IsWatching(base_dir));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileWatcherService, testPollingMissingDirectory)
+    {
+      PollingFileWatcherService service(0);
+      std::string path = ra::filesystem::GetTemporaryDirectoryUtf8() + ra::filesystem::GetPathSeparatorStr() + ra::testing::GetTestQualifiedName();
+      ASSERT_FALSE(service.Watch(path));
+      ASSERT_FALSE(service.IsWatching(path));
+      ASSERT_FALSE(service.Unwatch(path));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileWatcherService, testPollingNotifications)
+    {
+      PollingFileWatcherService service(50);
+      TestNotificationService(service);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileWatcherService, testInotifyNotifications)
+    {
+      if (!InotifyFileWatcherService::IsSupported())
+        return; //not supported on this platform
+
+      InotifyFileWatcherService service;
+      TestNotificationService(service);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileWatcherService, testInotifyDeletedDirectory)
+    {
+      if (!InotifyFileWatcherService::IsSupported())
+        return; //not supported on this platform
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      const std::string watched_dir = workspace.GetFullPathUtf8("watched");
+      ASSERT_TRUE(ra::filesystem::CreateDirectoryUtf8(watched_dir.c_str()));
+
+      InotifyFileWatcherService service;
+      ASSERT_TRUE(service.Watch(watched_dir));
+      ASSERT_TRUE(service.IsWatching(watched_dir));
+
+      //ASSERT a deleted directory is reported and is no longer watched
+      ASSERT_TRUE(ra::filesystem::DeleteDirectory(watched_dir.c_str()));
+      StringList directories;
+      ASSERT_TRUE(WaitForChanges(service, directories));
+      ASSERT_EQ(watched_dir, directories[0]);
+      ra::timing::Millisleep(100);
+      service.GetChanges(directories);
+      ASSERT_FALSE(service.IsWatching(watched_dir));
+
+      //ASSERT the recreated directory can be watched again
+      ASSERT_TRUE(ra::filesystem::CreateDirectoryUtf8(watched_dir.c_str()));
+      ASSERT_TRUE(service.Watch(watched_dir));
+      ASSERT_TRUE(service.IsWatching(watched_dir));
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(workspace.GetFullPathUtf8("watched") + ra::filesystem::GetPathSeparatorStr() + "foo.xml", "foo"));
+      ASSERT_TRUE(WaitForChanges(service, directories));
+      ASSERT_EQ(watched_dir, directories[0]);
+
+      //Cleanup
+      service.UnwatchAll();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+#ifdef _WIN32
+    TEST_F(TestFileWatcherService, testWindowsNotifications)
+    {
+      WindowsFileWatcherService service;
+      TestNotificationService(service);
+    }
+#endif
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
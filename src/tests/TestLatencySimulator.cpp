@@ -0,0 +1,205 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestLatencySimulator.h"
+#include "LatencySimulator.h"
+#include "ConfigManager.h"
+#include "Workspace.h"
+
+#include "rapidassist/filesystem_utf8.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    void TestLatencySimulator::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestLatencySimulator::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLatencySimulator, testLoadSelectionFile)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      //Selections separated by one or more empty lines, with comments and Windows line endings
+      std::string content = ""
+        "# A single file\r\n"
+        "foo.txt\r\n"
+        "\r\n"
+        "\r\n"
+        "# Two files\r\n"
+        "bar.txt\r\n"
+        "# comment within a selection\r\n"
+        "baz.txt\r\n"
+        "\r\n"
+        "last.txt";
+      std::string path = workspace.GetFullPathUtf8("selections.txt");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, content));
+
+      LatencySimulator::SelectionList selections;
+      std::string error;
+      ASSERT_TRUE(LatencySimulator::LoadSelectionFile(path, selections, error)) << error;
+      ASSERT_TRUE(error.empty());
+
+      ASSERT_EQ(3, selections.size());
+      ASSERT_EQ(1, selections[0].size());
+      ASSERT_EQ("foo.txt", selections[0][0]);
+      ASSERT_EQ(2, selections[1].size());
+      ASSERT_EQ("bar.txt", selections[1][0]);
+      ASSERT_EQ("baz.txt", selections[1][1]);
+      ASSERT_EQ(1, selections[2].size());
+      ASSERT_EQ("last.txt", selections[2][0]);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLatencySimulator, testLoadSelectionFileErrors)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      LatencySimulator::SelectionList selections;
+      std::string error;
+
+      //ASSERT a missing file fails
+      std::string missing_path = workspace.GetFullPathUtf8("missing.txt");
+      ASSERT_FALSE(LatencySimulator::LoadSelectionFile(missing_path, selections, error));
+      ASSERT_FALSE(error.empty());
+      ASSERT_TRUE(selections.empty());
+
+      //ASSERT a file without any selection fails
+      std::string empty_path = workspace.GetFullPathUtf8("empty.txt");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(empty_path, "# only comments\n\n# and empty lines\n"));
+      error.clear();
+      ASSERT_FALSE(LatencySimulator::LoadSelectionFile(empty_path, selections, error));
+      ASSERT_FALSE(error.empty());
+      ASSERT_TRUE(selections.empty());
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLatencySimulator, testGetPercentile)
+    {
+      LatencySimulator::DurationList sorted;
+
+      //ASSERT an empty list returns 0
+      ASSERT_EQ(0, LatencySimulator::GetPercentile(sorted, 50.0));
+
+      //ASSERT a single duration is every percentile
+      sorted.push_back(42);
+      ASSERT_EQ(42, LatencySimulator::GetPercentile(sorted, 0.0));
+      ASSERT_EQ(42, LatencySimulator::GetPercentile(sorted, 50.0));
+      ASSERT_EQ(42, LatencySimulator::GetPercentile(sorted, 100.0));
+
+      //ASSERT the nearest-rank method
+      sorted.clear();
+      for (uint64_t i = 1; i <= 10; i++)
+      {
+        sorted.push_back(i * 10);
+      }
+      ASSERT_EQ(10, LatencySimulator::GetPercentile(sorted, 0.0));
+      ASSERT_EQ(10, LatencySimulator::GetPercentile(sorted, 10.0));
+      ASSERT_EQ(20, LatencySimulator::GetPercentile(sorted, 11.0));
+      ASSERT_EQ(50, LatencySimulator::GetPercentile(sorted, 50.0));
+      ASSERT_EQ(100, LatencySimulator::GetPercentile(sorted, 95.0));
+      ASSERT_EQ(100, LatencySimulator::GetPercentile(sorted, 99.0));
+      ASSERT_EQ(100, LatencySimulator::GetPercentile(sorted, 100.0));
+
+      //ASSERT out of range percentiles are clamped
+      ASSERT_EQ(10, LatencySimulator::GetPercentile(sorted, -5.0));
+      ASSERT_EQ(100, LatencySimulator::GetPercentile(sorted, 150.0));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLatencySimulator, testSimulate)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //The submenus of an invisible menu are not built
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"parent\">\n"
+        "      <menu name=\"child1\" />\n"
+        "      <menu name=\"child2\">\n"
+        "        <visibility maxfiles=\"0\" />\n"
+        "      </menu>\n"
+        "    </menu>\n"
+        "    <menu name=\"empty parent\">\n"
+        "      <menu name=\"hidden\">\n"
+        "        <visibility maxfiles=\"0\" />\n"
+        "      </menu>\n"
+        "    </menu>\n"
+        "    <menu name=\"last\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+      std::string path = workspace.GetFullPathUtf8("simulate.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, xml));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      StringList elements;
+      elements.push_back(path);
+
+      {
+        LatencySimulator simulator;
+        simulator.Simulate(elements);
+        simulator.Simulate(elements);
+
+        //ASSERT 'parent', 'child1' and 'last' are built
+        ASSERT_EQ(2, simulator.GetSimulationCount());
+        ASSERT_EQ(3, simulator.GetLastMenuItemCount());
+        ASSERT_EQ(2, simulator.GetDurations(LatencySimulator::STAGE_TOTAL).size());
+
+        simulator.Clear();
+        ASSERT_EQ(0, simulator.GetSimulationCount());
+        ASSERT_EQ(0, simulator.GetLastMenuItemCount());
+      }
+
+      //Cleanup
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
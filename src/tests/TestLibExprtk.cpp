@@ -25,6 +25,12 @@
 #include "TestLibExprtk.h"
 #include "libexprtk.h"
 #include "PropertyManager.h"
+#include "ExprtkHelper.h"
+
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+#include <iostream>
 
 namespace shellanything
 {
@@ -97,6 +103,215 @@ namespace shellanything
       ASSERT_NEAR(result, 5.7, epsilon);
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testVariables)
+    {
+      static const size_t BUFFER_SIZE = 1024;
+      char buffer[BUFFER_SIZE] = { 0 };
+      const char* names[] = { "x", "y" };
+      double values[] = { 4.0, 2.5 };
+
+      ClearExpressionCache();
+      ASSERT_EQ(0, GetExpressionCacheSize());
+
+      double result = 0.0;
+      int success = EvaluateDoubleWithVariables("x * y + 1", names, values, 2, &result, buffer, BUFFER_SIZE);
+      ASSERT_EQ(1, success) << buffer;
+      ASSERT_NEAR(result, 11.0, epsilon);
+      ASSERT_EQ(1, GetExpressionCacheSize());
+
+      // Assert the cached expression is evaluated with the new values
+      values[0] = 10.0;
+      values[1] = 3.0;
+      success = EvaluateDoubleWithVariables("x * y + 1", names, values, 2, &result, buffer, BUFFER_SIZE);
+      ASSERT_EQ(1, success) << buffer;
+      ASSERT_NEAR(result, 31.0, epsilon);
+      ASSERT_EQ(1, GetExpressionCacheSize());
+
+      // Assert boolean evaluation
+      int boolean = 0;
+      success = EvaluateBooleanWithVariables("x > y", names, values, 2, &boolean, buffer, BUFFER_SIZE);
+      ASSERT_EQ(1, success) << buffer;
+      ASSERT_EQ(1, boolean);
+      ASSERT_EQ(2, GetExpressionCacheSize());
+
+      // Assert unknown variables fails and are not cached
+      success = EvaluateDoubleWithVariables("x + z", names, values, 2, &result, buffer, BUFFER_SIZE);
+      ASSERT_EQ(0, success);
+      ASSERT_GT(strlen(buffer), 0);
+      ASSERT_EQ(2, GetExpressionCacheSize());
+
+      // Assert duplicate variable names fails
+      const char* duplicates[] = { "x", "x" };
+      success = EvaluateDoubleWithVariables("x + 1", duplicates, values, 2, &result, buffer, BUFFER_SIZE);
+      ASSERT_EQ(0, success);
+
+      ClearExpressionCache();
+      ASSERT_EQ(0, GetExpressionCacheSize());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testExpressionCacheMaxSize)
+    {
+      const int previous = GetExpressionCacheMaxSize();
+      ClearExpressionCache();
+
+      SetExpressionCacheMaxSize(3);
+      ASSERT_EQ(3, GetExpressionCacheMaxSize());
+
+      double result = 0.0;
+      for (int i = 0; i < 10; i++)
+      {
+        std::string expression = ra::strings::ToString(i) + " + 1";
+        ASSERT_EQ(1, EvaluateDoubleEx(expression.c_str(), &result));
+        ASSERT_NEAR(result, i + 1.0, epsilon);
+        ASSERT_LE(GetExpressionCacheSize(), 3);
+      }
+      ASSERT_EQ(3, GetExpressionCacheSize());
+
+      // Assert reducing the maximum size evicts expressions
+      SetExpressionCacheMaxSize(1);
+      ASSERT_EQ(1, GetExpressionCacheSize());
+
+      // Assert a disabled cache still evaluates expressions
+      SetExpressionCacheMaxSize(0);
+      ASSERT_EQ(0, GetExpressionCacheSize());
+      ASSERT_EQ(1, EvaluateDoubleEx("2 * 21", &result));
+      ASSERT_NEAR(result, 42.0, epsilon);
+      ASSERT_EQ(0, GetExpressionCacheSize());
+
+      SetExpressionCacheMaxSize(previous);
+      ClearExpressionCache();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testHelperPropertyVariables)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      ClearExpressionCache();
+
+      const std::string exprtk = "${test.count} * 2 > ${test.limit}";
+      double result = 0.0;
+      bool boolean = false;
+      std::string error;
+
+      // Assert the same compiled expression is used for all property values
+      for (int i = 0; i < 10; i++)
+      {
+        pmgr.SetProperty("test.count", ra::strings::ToString(i));
+        pmgr.SetProperty("test.limit", "9");
+        std::string expanded = pmgr.Expand(exprtk);
+
+        ASSERT_TRUE(ExprtkHelper::EvaluateBoolean(exprtk, expanded, boolean, error)) << error;
+        ASSERT_EQ(i * 2 > 9, boolean) << "Failed evaluating '" << expanded << "'.";
+      }
+      ASSERT_EQ(1, GetExpressionCacheSize());
+
+      // Assert a property referenced twice is a single variable
+      ClearExpressionCache();
+      pmgr.SetProperty("test.count", "7");
+      const std::string square = "${test.count}*${test.count}";
+      ASSERT_TRUE(ExprtkHelper::EvaluateDouble(square, pmgr.Expand(square), result, error)) << error;
+      ASSERT_NEAR(result, 49.0, epsilon);
+
+      pmgr.ClearProperty("test.count");
+      pmgr.ClearProperty("test.limit");
+      ClearExpressionCache();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testHelperFallback)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      ClearExpressionCache();
+
+      pmgr.SetProperty("test.number", "12");
+      pmgr.SetProperty("test.decimal", "1.5");
+      pmgr.SetProperty("test.text", "foo");
+      pmgr.SetProperty("test.expression", "3+4");
+
+      struct FALLBACK_TEST
+      {
+        const char* exprtk;
+        double expected;
+      };
+      static const FALLBACK_TEST tests[] = {
+        { "${test.decimal} * 2", 3.0 },                     // not an integer
+        { "'${test.text}' == 'foo'", 1.0 },                 // not a number
+        { "'${test.number}' == '12'", 1.0 },                // inside a string
+        { "${test.expression} * 2", 11.0 },                 // not a number, evaluated as an expression
+        { "1${test.number} + 0", 112.0 },                   // part of a literal number
+        { "${test.number}${test.number} + 0", 1212.0 },     // adjacent references
+        { "${test.number}.5 + 0", 12.5 },                   // part of a literal number
+        { "${test.unknown} + 1 == 1", 0.0 },                // unknown property
+      };
+      static const size_t num_tests = sizeof(tests) / sizeof(tests[0]);
+
+      for (size_t i = 0; i < num_tests; i++)
+      {
+        const FALLBACK_TEST& test = tests[i];
+        std::string expanded = pmgr.Expand(test.exprtk);
+
+        // Assert the expanded expression is evaluated.
+        double expected = 0.0;
+        int success = EvaluateDoubleEx(expanded.c_str(), &expected);
+
+        double result = 0.0;
+        std::string error;
+        bool evaluated = ExprtkHelper::EvaluateDouble(test.exprtk, expanded, result, error);
+        ASSERT_EQ(success == 1, evaluated) << "Failed evaluating '" << test.exprtk << "'. Error: " << error;
+        if (evaluated)
+        {
+          ASSERT_NEAR(result, expected, epsilon) << "Failed evaluating '" << test.exprtk << "'.";
+          ASSERT_NEAR(result, test.expected, epsilon) << "Failed evaluating '" << test.exprtk << "'.";
+        }
+      }
+
+      pmgr.ClearProperty("test.number");
+      pmgr.ClearProperty("test.decimal");
+      pmgr.ClearProperty("test.text");
+      pmgr.ClearProperty("test.expression");
+      ClearExpressionCache();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testExpressionCacheBenchmark)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      const std::string exprtk = "if (${test.size} > 1024 * 1024 and ${test.count} < 10, ${test.size} / ${test.count}, ${test.count} * 3 + ${test.size} % 7)";
+
+      static const size_t NUM_ITERATIONS = 2000;
+      const int previous = GetExpressionCacheMaxSize();
+      uint64_t elapsed[2] = { 0 };
+      double sum[2] = { 0.0 };
+      for (size_t mode = 0; mode < 2; mode++)
+      {
+        ClearExpressionCache();
+        SetExpressionCacheMaxSize(mode == 0 ? 0 : previous);
+
+        uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+        for (size_t i = 0; i < NUM_ITERATIONS; i++)
+        {
+          pmgr.SetProperty("test.size", ra::strings::ToString(i * 1000));
+          pmgr.SetProperty("test.count", ra::strings::ToString(i % 20 + 1));
+          std::string expanded = pmgr.Expand(exprtk);
+
+          double result = 0.0;
+          std::string error;
+          ASSERT_TRUE(ExprtkHelper::EvaluateDouble(exprtk, expanded, result, error)) << error;
+          sum[mode] += result;
+        }
+        elapsed[mode] = ra::timing::GetMillisecondsCounterU64() - time_start;
+      }
+      SetExpressionCacheMaxSize(previous);
+      ClearExpressionCache();
+
+      pmgr.ClearProperty("test.size");
+      pmgr.ClearProperty("test.count");
+
+      // Assert both modes produces the same results
+      ASSERT_NEAR(sum[0], sum[1], epsilon);
+
+      std::cout << "Evaluated exprtk expression " << NUM_ITERATIONS << " times.\n";
+      std::cout << "Evaluation without expression cache: " << elapsed[0] << " ms\n";
+      std::cout << "Evaluation with expression cache:    " << elapsed[1] << " ms\n";
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
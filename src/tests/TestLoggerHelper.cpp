@@ -27,8 +27,55 @@
 #include "PropertyManager.h"
 #include "Environment.h"
 #include "Validator.h"
+#include "Menu.h"
+#include "SelectionContext.h"
 
-#include "rapidassist/environment_utf8.h"
+#include <atomic>
+#include <thread>
+#include <new>
+#include <stdlib.h>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+
+// Count the allocations of the counting thread with a replacement of the global operator new.
+// The replacement is used in all build configurations.
+static std::atomic<bool> gCountingAllocations(false);
+static std::thread::id gCountingThreadId;
+static std::atomic<size_t> gNewAllocationCount(0);
+
+static inline void* CountedAllocation(size_t size)
+{
+  if (gCountingAllocations.load() && std::this_thread::get_id() == gCountingThreadId)
+    gNewAllocationCount++;
+  if (size == 0)
+    size = 1;
+  void* ptr = malloc(size);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(size_t size)
+{
+  return CountedAllocation(size);
+}
+
+void* operator new[](size_t size)
+{
+  return CountedAllocation(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  free(ptr);
+}
 
 namespace shellanything
 {
@@ -41,6 +88,22 @@ namespace shellanything
     static bool gVerboseEnvVarIsSet = false;
     static bool gVerbosePropertyIsSet = false;
 
+#if defined(_MSC_VER) && defined(_DEBUG)
+    // The debug CRT also reports the allocations of the other modules, such as sa.core.dll,
+    // which are not using the operator new of the test executable.
+    static size_t gAllocationCount = 0;
+
+    int CountAllocationsHook(int alloc_type, void* user_data, size_t size, int block_type, long request_number, const unsigned char* filename, int line_number)
+    {
+      // Ignore the CRT's internal allocations
+      if (block_type == _CRT_BLOCK)
+        return TRUE;
+      if (alloc_type == _HOOK_ALLOC || alloc_type == _HOOK_REALLOC)
+        gAllocationCount++;
+      return TRUE;
+    }
+#endif
+
     //--------------------------------------------------------------------------------------------------
     void TestLoggerHelper::SetUp()
     {
@@ -60,9 +123,9 @@ namespace shellanything
 
         // restore env var
         if (gVerboseEnvVarIsSet)
-          ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), true_value.c_str());
+          env.SetOption(VERBOSE_OPTION_NAME, true_value);
         else
-          ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), NULL);
+          env.ClearOption(VERBOSE_OPTION_NAME);
 
         // restore property
         if (gVerbosePropertyIsSet)
@@ -85,33 +148,33 @@ namespace shellanything
       gRestoreVerboseState = true; // tell TearDown() to restore this state
 
       // clear all
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), NULL);
+      env.ClearOption(VERBOSE_OPTION_NAME);
       pmgr.ClearProperty(VERBOSE_PROPERTY_NAME);
       ASSERT_FALSE(LoggerHelper::IsVerboseLoggingEnabled());
 
       // enable from env var (only)
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), true_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, true_value);
       pmgr.ClearProperty(VERBOSE_PROPERTY_NAME);
       ASSERT_TRUE(LoggerHelper::IsVerboseLoggingEnabled());
 
       // enable from property (only)
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), NULL);
+      env.ClearOption(VERBOSE_OPTION_NAME);
       pmgr.SetProperty(VERBOSE_PROPERTY_NAME, true_value);
       ASSERT_TRUE(LoggerHelper::IsVerboseLoggingEnabled());
 
       // enable from env var and property
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), true_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, true_value);
       pmgr.SetProperty(VERBOSE_PROPERTY_NAME, true_value);
       ASSERT_TRUE(LoggerHelper::IsVerboseLoggingEnabled());
 
 
       // assert env variable has priority
       // test 1
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), true_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, true_value);
       pmgr.SetProperty(VERBOSE_PROPERTY_NAME, false_value);
       ASSERT_TRUE(LoggerHelper::IsVerboseLoggingEnabled());
       // test 2
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), false_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, false_value);
       pmgr.SetProperty(VERBOSE_PROPERTY_NAME, true_value);
       ASSERT_FALSE(LoggerHelper::IsVerboseLoggingEnabled());
     }
@@ -150,14 +213,68 @@ namespace shellanything
       gRestoreVerboseState = true; // tell TearDown() to restore this state
 
       // set verbose OFF
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), false_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, false_value);
       SA_VERBOSE_LOG(INFO) << "This VERBOSE message SHOULD NOT be visible since verbose is OFF.";
 
       // set verbose ON
-      ra::environment::SetEnvironmentVariableUtf8(VERBOSE_OPTION_NAME.c_str(), true_value.c_str());
+      env.SetOption(VERBOSE_OPTION_NAME, true_value);
       SA_VERBOSE_LOG(INFO) << "This VERBOSE message is expected to be visible since verbose is ON.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLoggerHelper, testDisabledVerboseLoggingAllocations)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      Environment& env = Environment::GetInstance();
+      const std::string& false_value = pmgr.GetProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME);
+
+      // backup current status
+      gVerboseEnvVarIsSet = env.IsOptionTrue(Environment::SYSTEM_LOGGING_VERBOSE_ENVIRONMENT_VARIABLE_NAME);
+      gVerbosePropertyIsSet = Validator::IsTrue(pmgr.GetProperty(PropertyManager::SYSTEM_LOGGING_VERBOSE_PROPERTY_NAME));
+      gRestoreVerboseState = true; // tell TearDown() to restore this state
+
+      // set verbose OFF
+      env.SetOption(VERBOSE_OPTION_NAME, false_value);
+      ASSERT_FALSE(LoggerHelper::IsVerboseLoggingEnabled());
+
+      // Build a menu tree without validators. Updating such a tree only produces verbose logs.
+      Menu* root = new Menu();
+      Menu* body = new Menu();
+      Menu* child1 = new Menu();
+      Menu* child2 = new Menu();
+      root->SetName("root");
+      body->SetName("body");
+      child1->SetName("child1");
+      child2->SetName("child2");
+      root->AddMenu(body);
+      body->AddMenu(child1);
+      body->AddMenu(child2);
+
+      SelectionContext context;
+
+      // Warm up
+      root->Update(context);
+
+      gCountingThreadId = std::this_thread::get_id();
+      gNewAllocationCount = 0;
+      gCountingAllocations = true;
+#if defined(_MSC_VER) && defined(_DEBUG)
+      gAllocationCount = 0;
+      _CRT_ALLOC_HOOK previous_hook = _CrtSetAllocHook(CountAllocationsHook);
+#endif
+
+      root->Update(context);
+      SA_VERBOSE_LOG(INFO) << "This VERBOSE message SHOULD NOT be formatted since verbose is OFF. root=" << root->GetName();
+
+      gCountingAllocations = false;
+#if defined(_MSC_VER) && defined(_DEBUG)
+      _CrtSetAllocHook(previous_hook);
+      ASSERT_EQ((size_t)0, gAllocationCount);
+#endif
+      ASSERT_EQ((size_t)0, gNewAllocationCount.load());
+
+      delete root;
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
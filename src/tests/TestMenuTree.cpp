@@ -0,0 +1,227 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestMenuTree.h"
+#include "MenuTree.h"
+#include "ConfigFile.h"
+#include "Menu.h"
+#include "Validator.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    static Menu* NewTreeMenu(const std::string& name, bool visible = true)
+    {
+      Menu* menu = new Menu();
+      menu->SetName(name);
+      if (!visible)
+      {
+        Validator* validator = new Validator();
+        validator->SetIsTrue("false");
+        menu->AddVisibility(validator);
+      }
+      return menu;
+    }
+
+    // Build the following forest:
+    //   a
+    //     a1
+    //       a1a
+    //     a2 (invisible)
+    //   b
+    //   c
+    //     c1 (invisible)
+    static void NewForest(Menu::MenuPtrList& menus)
+    {
+      Menu* a = NewTreeMenu("a");
+      Menu* a1 = NewTreeMenu("a1");
+      a1->AddMenu(NewTreeMenu("a1a"));
+      a->AddMenu(a1);
+      a->AddMenu(NewTreeMenu("a2", false));
+      menus.push_back(a);
+      menus.push_back(NewTreeMenu("b"));
+      Menu* c = NewTreeMenu("c");
+      c->AddMenu(NewTreeMenu("c1", false));
+      menus.push_back(c);
+    }
+
+    static void DeleteForest(Menu::MenuPtrList& menus)
+    {
+      for (size_t i = 0; i < menus.size(); i++)
+      {
+        delete menus[i];
+      }
+      menus.clear();
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestMenuTree::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestMenuTree::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMenuTree, testBuild)
+    {
+      Menu::MenuPtrList menus;
+      NewForest(menus);
+
+      MenuTree tree;
+      tree.Build(menus);
+
+      //ASSERT the nodes are in pre-order
+      static const char* EXPECTED_NAMES[] = { "a", "a1", "a1a", "a2", "b", "c", "c1" };
+      static const size_t EXPECTED_PARENTS[] = { MenuTree::INVALID_INDEX, 0, 1, 0, MenuTree::INVALID_INDEX, MenuTree::INVALID_INDEX, 5 };
+      static const size_t EXPECTED_ENDS[] = { 4, 3, 3, 4, 5, 7, 7 };
+      static const size_t EXPECTED_COUNT = sizeof(EXPECTED_NAMES) / sizeof(EXPECTED_NAMES[0]);
+      ASSERT_EQ(EXPECTED_COUNT, tree.GetCount());
+      for (size_t i = 0; i < EXPECTED_COUNT; i++)
+      {
+        const MenuTree::NODE& node = tree.GetNode(i);
+        ASSERT_EQ(std::string(EXPECTED_NAMES[i]), node.menu->GetName()) << "at index " << i;
+        ASSERT_EQ(EXPECTED_PARENTS[i], node.parent) << "at index " << i;
+        ASSERT_EQ(EXPECTED_ENDS[i], node.end) << "at index " << i;
+      }
+
+      tree.Clear();
+      ASSERT_EQ(0, tree.GetCount());
+
+      DeleteForest(menus);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMenuTree, testUpdate)
+    {
+      Menu::MenuPtrList expected_menus;
+      Menu::MenuPtrList menus;
+      NewForest(expected_menus);
+      NewForest(menus);
+
+      SelectionContext context;
+
+      //update recursively
+      for (size_t i = 0; i < expected_menus.size(); i++)
+      {
+        expected_menus[i]->Update(context);
+      }
+
+      //update linearly
+      MenuTree tree;
+      tree.Build(menus);
+      tree.Update(context);
+
+      MenuTree expected_tree;
+      expected_tree.Build(expected_menus);
+      ASSERT_EQ(expected_tree.GetCount(), tree.GetCount());
+      for (size_t i = 0; i < tree.GetCount(); i++)
+      {
+        const Menu* expected = expected_tree.GetNode(i).menu;
+        const Menu* menu = tree.GetNode(i).menu;
+        ASSERT_EQ(expected->IsVisible(), menu->IsVisible()) << "Menu '" << menu->GetName() << "' visibility does not match.";
+        ASSERT_EQ(expected->IsEnabled(), menu->IsEnabled()) << "Menu '" << menu->GetName() << "' enabled state does not match.";
+      }
+
+      //ASSERT 'a2' is invisible and 'c' is forced invisible
+      ASSERT_TRUE(tree.GetNode(0).menu->IsVisible());
+      ASSERT_FALSE(tree.GetNode(3).menu->IsVisible());
+      ASSERT_FALSE(tree.GetNode(5).menu->IsVisible());
+
+      DeleteForest(expected_menus);
+      DeleteForest(menus);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMenuTree, testAssignCommandIds)
+    {
+      Menu::MenuPtrList expected_menus;
+      Menu::MenuPtrList menus;
+      NewForest(expected_menus);
+      NewForest(menus);
+
+      SelectionContext context;
+      static const uint32_t FIRST_COMMAND_ID = 101;
+
+      //assign recursively
+      uint32_t expected_next_command_id = FIRST_COMMAND_ID;
+      for (size_t i = 0; i < expected_menus.size(); i++)
+      {
+        expected_menus[i]->Update(context);
+        expected_next_command_id = expected_menus[i]->AssignCommandIds(expected_next_command_id);
+      }
+
+      //assign linearly
+      MenuTree tree;
+      tree.Build(menus);
+      tree.Update(context);
+      uint32_t next_command_id = tree.AssignCommandIds(FIRST_COMMAND_ID);
+      ASSERT_EQ(expected_next_command_id, next_command_id);
+
+      MenuTree expected_tree;
+      expected_tree.Build(expected_menus);
+      for (size_t i = 0; i < tree.GetCount(); i++)
+      {
+        const Menu* expected = expected_tree.GetNode(i).menu;
+        const Menu* menu = tree.GetNode(i).menu;
+        ASSERT_EQ(expected->GetCommandId(), menu->GetCommandId()) << "Menu '" << menu->GetName() << "' command id does not match.";
+      }
+
+      //ASSERT invisible menus have no command id
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, tree.GetNode(3).menu->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, tree.GetNode(5).menu->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, tree.GetNode(6).menu->GetCommandId());
+
+      //ASSERT lookups
+      ASSERT_EQ(tree.GetNode(2).menu, tree.FindMenuByCommandId(tree.GetNode(2).menu->GetCommandId()));
+      ASSERT_EQ(tree.GetNode(2).menu, tree.FindMenuByName("a1a"));
+      ASSERT_EQ(tree.GetNode(4).menu, tree.FindMenuByName("B", FIND_BY_NAME_CASE_INSENSITIVE));
+      ASSERT_EQ((Menu*)NULL, tree.FindMenuByName("B"));
+      ASSERT_EQ((Menu*)NULL, tree.FindMenuByCommandId(next_command_id));
+
+      DeleteForest(expected_menus);
+      DeleteForest(menus);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMenuTree, testConfigFileInvalidation)
+    {
+      ConfigFile config;
+      ASSERT_EQ(0, config.GetMenuTree().GetCount());
+
+      //ASSERT adding a root menu updates the tree
+      Menu* root = NewTreeMenu("root");
+      config.AddMenu(root);
+      ASSERT_EQ(1, config.GetMenuTree().GetCount());
+
+      //ASSERT adding a sub menu updates the tree
+      Menu* child = NewTreeMenu("child");
+      root->AddMenu(child);
+      ASSERT_EQ(2, config.GetMenuTree().GetCount());
+      child->AddMenu(NewTreeMenu("grandchild"));
+      ASSERT_EQ(3, config.GetMenuTree().GetCount());
+      ASSERT_EQ(child, config.FindMenuByName("child"));
+      ASSERT_EQ(1, config.GetMenuTree().GetNode(2).parent);
+    }
+    //--------------------------------------------------------------------------------------------------
+  } //namespace test
+} //namespace shellanything
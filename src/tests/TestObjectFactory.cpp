@@ -32,11 +32,14 @@
 #include "ActionPrompt.h"
 #include "ActionMessage.h"
 #include "ActionProperty.h"
+#include "ConfigSnapshot.h"
+#include "IActionFactory.h"
 
 #include "rapidassist/testing.h"
 #include "rapidassist/filesystem.h"
 #include "rapidassist/environment.h"
 #include "rapidassist/timing.h"
+#include "rapidassist/strings.h"
 
 namespace shellanything
 {
@@ -1080,6 +1083,98 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestObjectFactory, testParseActionBenchmark)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a large configuration file. Keep the xml of each action.
+      static const size_t NUM_MENUS = 500;
+      std::vector<std::string> exec_xml;
+      std::vector<std::string> file_xml;
+      std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n";
+      for (size_t i = 0; i < NUM_MENUS; i++)
+      {
+        exec_xml.push_back(ra::strings::Format("<exec path=\"C:\\Windows\\notepad%03d.exe\" arguments=\"${selection.path}\" basedir=\"C:\\Windows\" wait=\"true\" />", (int)i));
+        file_xml.push_back(ra::strings::Format("<file path=\"C:\\temp\\file%03d.txt\" encoding=\"utf-8\">text %03d</file>", (int)i, (int)i));
+
+        xml += ra::strings::Format("    <menu name=\"menu %03d\">\n", (int)i);
+        xml += "      <actions>\n";
+        xml += "        " + exec_xml[i] + "\n";
+        xml += "        " + file_xml[i] + "\n";
+        xml += "      </actions>\n";
+        xml += "    </menu>\n";
+      }
+      xml += ""
+        "  </shell>\n"
+        "</root>\n";
+      const std::string path = workspace.GetFullPathUtf8("benchmark.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, xml));
+
+      //Disable snapshots to always parse the xml
+      const std::string previous_snapshot_directory = ConfigSnapshot::GetDirectory();
+      ConfigSnapshot::SetDirectory("");
+
+      static const size_t NUM_LOADS = 10;
+      std::string error;
+
+      //Load the configuration. Actions are parsed directly from the document's elements.
+      uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        ConfigFile* config = ConfigFile::LoadFile(path, error);
+        ASSERT_NE(INVALID_CONFIGURATION, config) << "path=" << path << ", error=" << error;
+
+        //ASSERT the actions are properly parsed
+        Menu::MenuPtrList menus = config->GetMenus();
+        ASSERT_EQ(NUM_MENUS, menus.size());
+        ActionExecute* exec = GetFirstActionExecute(menus[NUM_MENUS - 1]);
+        ASSERT_TRUE(exec != NULL);
+        ASSERT_EQ("C:\\Windows\\notepad499.exe", exec->GetPath());
+        ASSERT_EQ("true", exec->GetWait());
+        ActionFile* file = GetFirstActionFile(menus[NUM_MENUS - 1]);
+        ASSERT_TRUE(file != NULL);
+        ASSERT_EQ("text 499", file->GetText());
+
+        delete config;
+      }
+      uint64_t elapsed_load = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      ConfigSnapshot::SetDirectory(previous_snapshot_directory);
+
+      //Parse the same actions from xml strings.
+      //This is the extra work that was previously required for each action while loading a configuration.
+      IActionFactory* exec_factory = ActionExecute::NewFactory();
+      IActionFactory* file_factory = ActionFile::NewFactory();
+      time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < NUM_MENUS; j++)
+        {
+          IAction* exec = exec_factory->ParseFromXml(exec_xml[j], error);
+          IAction* file = file_factory->ParseFromXml(file_xml[j], error);
+          ASSERT_TRUE(exec != NULL) << "error=" << error;
+          ASSERT_TRUE(file != NULL) << "error=" << error;
+          delete exec;
+          delete file;
+        }
+      }
+      uint64_t elapsed_xml = ra::timing::GetMillisecondsCounterU64() - time_start;
+      delete exec_factory;
+      delete file_factory;
+
+      printf("Loaded a configuration file with %d actions %d times in %d ms.\n", (int)(NUM_MENUS * 2), (int)NUM_LOADS, (int)elapsed_load);
+      printf("Parsed %d actions %d times from xml strings in %d ms.\n", (int)(NUM_MENUS * 2), (int)NUM_LOADS, (int)elapsed_xml);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
@@ -0,0 +1,286 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestPerformanceCounters.h"
+#include "PerformanceCounters.h"
+#include "ConfigManager.h"
+#include "PropertyManager.h"
+#include "SelectionContext.h"
+#include "Validator.h"
+#include "Menu.h"
+#include "Workspace.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem.h"
+#include "rapidassist/process.h"
+#include "rapidassist/timing.h"
+
+#include <thread>
+#include <vector>
+
+namespace shellanything
+{
+  namespace test
+  {
+    static bool gPerformanceCountersEnabled = false;
+
+    bool IsEmpty(const PERFORMANCE_COUNTERS& counters)
+    {
+      return (counters.updates == 0 &&
+        counters.total_ns == 0 &&
+        counters.max_ns == 0 &&
+        counters.expansions == 0 &&
+        counters.filesystem_probes == 0 &&
+        counters.exprtk_evaluations == 0 &&
+        counters.plugin_calls == 0 &&
+        counters.plugin_ns == 0);
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestPerformanceCounters::SetUp()
+    {
+      gPerformanceCountersEnabled = PerformanceCounters::IsEnabled();
+
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestPerformanceCounters::TearDown()
+    {
+      PerformanceCounters::SetEnabled(gPerformanceCountersEnabled);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPerformanceCounters, testDisabled)
+    {
+      PerformanceCounters::SetEnabled(false);
+      ASSERT_FALSE(PerformanceCounters::IsEnabled());
+
+      PERFORMANCE_COUNTERS counters;
+      {
+        PerformanceCounters::Scope scope(counters);
+        PerformanceCounters::AddExpansion();
+        PerformanceCounters::AddFilesystemProbe();
+        PerformanceCounters::AddExprtkEvaluation();
+      }
+
+      //assert nothing was measured
+      ASSERT_TRUE(IsEmpty(counters));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPerformanceCounters, testNestedScopes)
+    {
+      PerformanceCounters::SetEnabled(true);
+
+      PERFORMANCE_COUNTERS parent;
+      PERFORMANCE_COUNTERS child;
+      PERFORMANCE_COUNTERS plugin;
+      {
+        PerformanceCounters::Scope parent_scope(parent);
+        PerformanceCounters::AddExpansion();
+
+        for (int i = 0; i < 3; i++)
+        {
+          PerformanceCounters::Scope child_scope(child);
+          PerformanceCounters::AddFilesystemProbe();
+          PerformanceCounters::AddExprtkEvaluation();
+        }
+
+        {
+          PerformanceCounters::Scope plugin_scope(plugin, true);
+          ra::timing::Millisleep(2);
+        }
+      }
+
+      //assert child scopes
+      ASSERT_EQ(3, child.updates);
+      ASSERT_EQ(0, child.expansions);
+      ASSERT_EQ(3, child.filesystem_probes);
+      ASSERT_EQ(3, child.exprtk_evaluations);
+      ASSERT_LE(child.max_ns, child.total_ns);
+
+      //assert plugin scope
+      ASSERT_EQ(1, plugin.updates);
+      ASSERT_EQ(1, plugin.plugin_calls);
+      ASSERT_GE(plugin.plugin_ns, 1000000);
+
+      //assert the parent scope includes the work of its child scopes
+      ASSERT_EQ(1, parent.updates);
+      ASSERT_EQ(1, parent.expansions);
+      ASSERT_EQ(3, parent.filesystem_probes);
+      ASSERT_EQ(3, parent.exprtk_evaluations);
+      ASSERT_EQ(1, parent.plugin_calls);
+      ASSERT_EQ(plugin.plugin_ns, parent.plugin_ns);
+      ASSERT_GE(parent.total_ns, child.total_ns + plugin.total_ns);
+
+      //assert reset
+      PerformanceCounters::Reset(parent);
+      ASSERT_TRUE(IsEmpty(parent));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPerformanceCounters, testMultipleThreads)
+    {
+      PerformanceCounters::SetEnabled(true);
+
+      static const size_t NUM_THREADS = 4;
+      static const size_t NUM_SCOPES = 10000;
+      PERFORMANCE_COUNTERS counters;
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        threads.push_back(std::thread([&counters]()
+        {
+          for (size_t j = 0; j < NUM_SCOPES; j++)
+          {
+            PerformanceCounters::Scope scope(counters);
+            PerformanceCounters::AddExpansion();
+          }
+        }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+
+      //assert no update was lost
+      ASSERT_EQ(NUM_THREADS * NUM_SCOPES, counters.updates);
+      ASSERT_EQ(NUM_THREADS * NUM_SCOPES, counters.expansions);
+      ASSERT_LE(counters.max_ns, counters.total_ns);
+
+      //assert a copy is a snapshot of the counters
+      PERFORMANCE_COUNTERS copy = counters;
+      ASSERT_EQ(counters.updates, copy.updates);
+      PerformanceCounters::Reset(counters);
+      ASSERT_TRUE(IsEmpty(counters));
+      ASSERT_EQ(NUM_THREADS * NUM_SCOPES, copy.updates);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPerformanceCounters, testMenuAndValidator)
+    {
+      PerformanceCounters::SetEnabled(true);
+
+      const std::string process_path = ra::process::GetCurrentProcessPath();
+      ASSERT_TRUE(ra::filesystem::FileExists(process_path.c_str()));
+
+      SelectionContext c;
+
+      Validator* visibility = new Validator();
+      visibility->SetFileExists(process_path);
+      visibility->SetExprtk("1 == 1");
+
+      Menu menu;
+      menu.SetName("Test");
+      menu.AddVisibility(visibility);
+
+      menu.UpdateState(c);
+      menu.UpdateState(c);
+      ASSERT_TRUE(menu.IsVisible());
+
+      //assert the validator counters
+      const PERFORMANCE_COUNTERS& validator_counters = visibility->GetPerformanceCounters();
+      ASSERT_EQ(2, validator_counters.updates);
+      ASSERT_EQ(2, validator_counters.filesystem_probes);
+      ASSERT_EQ(2, validator_counters.exprtk_evaluations);
+
+      //assert the menu counters includes the validator
+      const PERFORMANCE_COUNTERS& menu_counters = menu.GetPerformanceCounters();
+      ASSERT_EQ(2, menu_counters.updates);
+      ASSERT_EQ(2, menu_counters.filesystem_probes);
+      ASSERT_EQ(2, menu_counters.exprtk_evaluations);
+      ASSERT_GE(menu_counters.expansions, validator_counters.expansions);
+      ASSERT_GE(menu_counters.total_ns, validator_counters.total_ns);
+
+      //assert reset also resets the validators of the menu
+      menu.ResetPerformanceCounters();
+      ASSERT_TRUE(IsEmpty(menu.GetPerformanceCounters()));
+      ASSERT_TRUE(IsEmpty(visibility->GetPerformanceCounters()));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPerformanceCounters, testConfigManager)
+    {
+      PerformanceCounters::SetEnabled(true);
+
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Import the required files into the workspace
+      static const std::string path_separator = ra::filesystem::GetPathSeparatorStr();
+      std::string template_source_path = std::string("test_files") + path_separator + "TestConfigManager.testAssignCommandId.1.xml";
+      ASSERT_TRUE(workspace.ImportAndRenameFileUtf8(template_source_path.c_str(), "tmp.xml"));
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      cmgr.ResetPerformanceCounters();
+
+      SelectionContext c;
+      cmgr.Update(c);
+
+      //assert the configuration was measured
+      ASSERT_EQ(1, configs[0]->GetPerformanceCounters().updates);
+
+      //assert the slowest menus are sorted
+      Menu::MenuPtrList menus;
+      cmgr.GetSlowestMenus(3, menus);
+      ASSERT_FALSE(menus.empty());
+      ASSERT_LE(menus.size(), 3);
+      for (size_t i = 1; i < menus.size(); i++)
+      {
+        ASSERT_GE(menus[i - 1]->GetPerformanceCounters().total_ns, menus[i]->GetPerformanceCounters().total_ns);
+      }
+      cmgr.LogSlowestMenus(3);
+
+      //assert the counters are part of the description
+      std::string str;
+      cmgr.ToLongString(str, 0);
+      ASSERT_NE(std::string::npos, str.find("Performance counters {"));
+      ASSERT_NE(std::string::npos, str.find("Menu '" + menus[0]->GetName() + "': updates="));
+
+      //assert reset
+      cmgr.ResetPerformanceCounters();
+      ASSERT_TRUE(IsEmpty(configs[0]->GetPerformanceCounters()));
+      cmgr.GetSlowestMenus(3, menus);
+      ASSERT_TRUE(menus.empty());
+
+      //assert the counters are not part of the description when disabled
+      PerformanceCounters::SetEnabled(false);
+      str.clear();
+      cmgr.ToLongString(str, 0);
+      ASSERT_EQ(std::string::npos, str.find("Performance counters {"));
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
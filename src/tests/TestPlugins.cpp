@@ -30,6 +30,8 @@
 #include "SelectionContext.h"
 #include "ActionExecute.h"
 
+#include "shellanything/sa_plugin.h"
+
 #include "rapidassist/testing.h"
 #include "rapidassist/filesystem.h"
 #include "rapidassist/environment.h"
@@ -241,6 +243,61 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPlugins, testProcessMutuallyExclusive)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Import the required files into the workspace
+      static const std::string path_separator = ra::filesystem::GetPathSeparatorStr();
+      std::string test_name = ra::testing::GetTestQualifiedName();
+      std::string template_source_path = std::string("test_files") + path_separator + test_name + ".xml";
+      ASSERT_TRUE(workspace.ImportFileUtf8(template_source_path.c_str()));
+
+      //Wait to make sure that the next file copy/modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      //ASSERT the file is rejected. The plugin refuses an action that defines both 'pid' and 'filename'.
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(0, configs.size());
+
+      //Cleanup
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPlugins, testPluginActionGetAttributes)
+    {
+      //The action accessors are only valid while an action event is processed.
+      ASSERT_TRUE(sa_plugin_action_get_name() == NULL);
+      ASSERT_TRUE(sa_plugin_action_get_xml() == NULL);
+      ASSERT_TRUE(sa_plugin_action_get_data() == NULL);
+
+      XML_ATTR attributes[] = {
+        {"pid",       SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+        {"filename",  SA_XML_ATTR_OPTINAL, 1, NULL, NULL},
+      };
+      static const size_t count = sizeof(attributes) / sizeof(attributes[0]);
+
+      //NULL arguments
+      sa_attribute_table_immutable_t table;
+      ASSERT_EQ(SA_ERROR_INVALID_ARGUMENTS, sa_plugin_action_get_attributes(NULL, count, &table));
+      ASSERT_EQ(SA_ERROR_INVALID_ARGUMENTS, sa_plugin_action_get_attributes(attributes, count, NULL));
+
+      //Outside of an action event
+      ASSERT_EQ(SA_ERROR_NOT_FOUND, sa_plugin_action_get_attributes(attributes, count, &table));
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestPlugins, testServices)
     {
       ConfigManager& cmgr = ConfigManager::GetInstance();
@@ -639,6 +696,56 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPlugins, testBackgroundRefresh)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Setup ConfigManager to read files from the empty workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+
+      ASSERT_TRUE(cmgr.StartBackgroundRefresh(50));
+
+      //Import the required files into the workspace
+      static const std::string path_separator = ra::filesystem::GetPathSeparatorStr();
+      std::string test_name = ra::testing::GetTestQualifiedName();
+      std::string template_source_path = std::string("test_files") + path_separator + test_name + ".xml";
+      ASSERT_TRUE(workspace.ImportFileUtf8(template_source_path.c_str()));
+
+      //ASSERT the configuration is loaded in the background and published by Refresh()
+      for (int i = 0; i < 100 && cmgr.GetConfigFiles().size() != 1; i++)
+      {
+        ra::timing::Millisleep(50);
+        cmgr.Refresh();
+      }
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      //ASSERT all plugins were loaded
+      ConfigFile* config0 = cmgr.GetConfigFiles()[0];
+      ASSERT_EQ(1, config0->GetPlugins().size());
+      for (size_t i = 0; i < config0->GetPlugins().size(); i++)
+      {
+        const Plugin* plugin = config0->GetPlugins()[i];
+        ASSERT_TRUE(plugin->IsLoaded()) << "The plugin '" << plugin->GetPath() << "' is not loaded.";
+      }
+      ASSERT_EQ(1, config0->GetMenus().size());
+
+      cmgr.StopBackgroundRefresh();
+
+      //Cleanup
+      cmgr.ClearSearchPath();
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestPlugins, testPluginActionGetData)
     {
       ConfigManager& cmgr = ConfigManager::GetInstance();
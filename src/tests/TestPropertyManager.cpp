@@ -28,10 +28,14 @@
 #include "TestKeyboardService.h"
 #include "IRandomService.h"
 #include "App.h"
+#include "SelectionContext.h"
+#include "CachedExpansion.h"
+#include "ILiveProperty.h"
 
 #include "rapidassist/testing_utf8.h"
 #include "rapidassist/random.h"
 #include "rapidassist/timing.h"
+#include "rapidassist/filesystem.h"
 #include "rapidassist/filesystem_utf8.h"
 
 extern shellanything::TestKeyboardService* keyboard_service;
@@ -643,6 +647,383 @@ namespace shellanything
       }
     }
     //--------------------------------------------------------------------------------------------------
+    std::string ExpandWithTemplateCache(const std::string& value, bool enabled)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      bool previous = pmgr.IsTemplateCacheEnabled();
+      pmgr.SetTemplateCacheEnabled(enabled);
+      std::string output = pmgr.Expand(value);
+      pmgr.SetTemplateCacheEnabled(previous);
+      return output;
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testPropertyTemplateParse)
+    {
+      PropertyTemplate tmpl;
+      tmpl.Parse("${} ${color} fox {dog} $ ${size}");
+
+      ASSERT_TRUE(tmpl.IsSimple());
+      ASSERT_EQ(2, tmpl.GetReferenceCount());
+
+      const PropertyTemplate::SegmentList& segments = tmpl.GetSegments();
+      ASSERT_EQ(4, segments.size());
+      ASSERT_FALSE(segments[0].reference);
+      ASSERT_TRUE(segments[1].reference);
+      ASSERT_FALSE(segments[2].reference);
+      ASSERT_TRUE(segments[3].reference);
+      ASSERT_EQ("${} ", tmpl.GetSource().substr(segments[0].offset, segments[0].length));
+      ASSERT_EQ("${color}", tmpl.GetSource().substr(segments[1].offset, segments[1].length));
+      ASSERT_EQ(" fox {dog} $ ", tmpl.GetSource().substr(segments[2].offset, segments[2].length));
+      ASSERT_EQ("${size}", tmpl.GetSource().substr(segments[3].offset, segments[3].length));
+      ASSERT_EQ("color", segments[1].name);
+      ASSERT_EQ("size", segments[3].name);
+
+      //Assert nested references are not simple
+      tmpl.Parse("${${name}}");
+      ASSERT_FALSE(tmpl.IsSimple());
+
+      //Assert strings without references
+      tmpl.Parse("The quick brown fox");
+      ASSERT_TRUE(tmpl.IsSimple());
+      ASSERT_EQ(0, tmpl.GetReferenceCount());
+      ASSERT_EQ(1, tmpl.GetSegments().size());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testExpandTemplateCompatibility)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      pmgr.SetProperty("first", "Silence");
+      pmgr.SetProperty("second", "${third}");
+      pmgr.SetProperty("third", "Lambs");
+      pmgr.SetProperty("sec", "second");
+      pmgr.SetProperty("varname", "first");
+      pmgr.SetProperty("empty", "");
+      pmgr.SetProperty("dollar", "$");
+      pmgr.SetProperty("brace", "{first}");
+      pmgr.SetProperty("half", "${fir");
+      pmgr.SetProperty("circular", "${circular}!");
+      pmgr.SetProperty("ping", "${pong}");
+      pmgr.SetProperty("pong", "${ping}");
+
+      std::string many_empty;
+      for (size_t i = 0; i < 25; i++)
+      {
+        many_empty += "${empty}";
+      }
+
+      static const char* values[] = {
+        "",
+        "The quick brown fox",
+        "${first} of the ${second}",
+        "${first} of the ${${sec}}",
+        "${${varname}}",
+        "${first}ond}",
+        "${half}st}",
+        "${dollar}{first}",
+        "$${brace}",
+        "${dollar}${brace}",
+        "${}${first}${",
+        "${unknown} ${first",
+        "${circular}",
+        "${ping}",
+        "${empty}${empty}${first}",
+      };
+      static const size_t num_values = sizeof(values) / sizeof(values[0]);
+
+      std::vector<std::string> all_values(values, values + num_values);
+      all_values.push_back(many_empty + "${first}");
+      all_values.push_back(many_empty + "${dollar}{first}");
+
+      for (size_t i = 0; i < all_values.size(); i++)
+      {
+        const std::string& value = all_values[i];
+        const std::string expected = ExpandWithTemplateCache(value, false);
+        const std::string actual1 = ExpandWithTemplateCache(value, true); // compile the template
+        const std::string actual2 = ExpandWithTemplateCache(value, true); // use the cached template
+        ASSERT_EQ(expected, actual1) << "Failed expanding value '" << value << "'.";
+        ASSERT_EQ(expected, actual2) << "Failed expanding value '" << value << "'.";
+      }
+
+      //Assert the results are updated when properties are modified
+      pmgr.SetProperty("third", "Innocents");
+      ASSERT_EQ("Silence of the Innocents", ExpandWithTemplateCache("${first} of the ${second}", true));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testExpandTemplateCache)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      ASSERT_TRUE(pmgr.IsTemplateCacheEnabled());
+
+      pmgr.ClearTemplateCache();
+      ASSERT_EQ(0, pmgr.GetTemplateCacheSize());
+
+      pmgr.SetProperty("name", "Brad Pitt");
+
+      //Assert strings without references are not cached
+      pmgr.Expand("The quick brown fox");
+      ASSERT_EQ(0, pmgr.GetTemplateCacheSize());
+
+      //Assert a template is created once per source string
+      ASSERT_EQ("Brad Pitt", pmgr.Expand("${name}"));
+      ASSERT_EQ(1, pmgr.GetTemplateCacheSize());
+      ASSERT_EQ("Brad Pitt", pmgr.Expand("${name}"));
+      ASSERT_EQ(1, pmgr.GetTemplateCacheSize());
+      ASSERT_EQ("Hello Brad Pitt", pmgr.Expand("Hello ${name}"));
+      ASSERT_EQ(2, pmgr.GetTemplateCacheSize());
+
+      pmgr.ClearTemplateCache();
+      ASSERT_EQ(0, pmgr.GetTemplateCacheSize());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testPropertyGeneration)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      pmgr.SetProperty("foo", "bar");
+      uint64_t generation = pmgr.GetGeneration();
+      uint64_t foo_generation = pmgr.GetPropertyGeneration("foo");
+      ASSERT_EQ(generation, foo_generation);
+
+      //Assert setting the same value does not modify the generation
+      pmgr.SetProperty("foo", "bar");
+      ASSERT_EQ(generation, pmgr.GetGeneration());
+      ASSERT_EQ(foo_generation, pmgr.GetPropertyGeneration("foo"));
+
+      //Assert modifying a property only modifies its own generation
+      pmgr.SetProperty("baz", "qux");
+      ASSERT_GT(pmgr.GetGeneration(), generation);
+      ASSERT_EQ(foo_generation, pmgr.GetPropertyGeneration("foo"));
+      ASSERT_EQ(pmgr.GetGeneration(), pmgr.GetPropertyGeneration("baz"));
+
+      pmgr.SetProperty("foo", "BAR");
+      ASSERT_GT(pmgr.GetPropertyGeneration("foo"), foo_generation);
+      foo_generation = pmgr.GetPropertyGeneration("foo");
+
+      //Assert deleting a property modifies its generation
+      pmgr.ClearProperty("foo");
+      ASSERT_GT(pmgr.GetPropertyGeneration("foo"), foo_generation);
+      foo_generation = pmgr.GetPropertyGeneration("foo");
+
+      //Assert deleting an unknown property does not
+      pmgr.ClearProperty("foo");
+      ASSERT_EQ(foo_generation, pmgr.GetPropertyGeneration("foo"));
+
+      //Assert clearing the manager modifies all generations
+      generation = pmgr.GetGeneration();
+      pmgr.Clear();
+      ASSERT_GT(pmgr.GetPropertyGeneration("foo"), generation);
+      ASSERT_GT(pmgr.GetPropertyGeneration("baz"), generation);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testExpandIncremental)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      ASSERT_TRUE(pmgr.IsTemplateCacheEnabled());
+
+      pmgr.SetProperty("first", "Silence");
+      pmgr.SetProperty("second", "${third}");
+      pmgr.SetProperty("third", "Lambs");
+
+      bool is_volatile = true;
+      ASSERT_EQ("Silence of the Lambs", pmgr.Expand("${first} of the ${second}", is_volatile));
+      ASSERT_FALSE(is_volatile);
+      ASSERT_EQ("Silence of the Lambs", pmgr.Expand("${first} of the ${second}"));
+
+      //Assert modifying a property referenced indirectly updates the expanded value
+      pmgr.SetProperty("third", "Innocents");
+      ASSERT_EQ("Silence of the Innocents", pmgr.Expand("${first} of the ${second}"));
+
+      //Assert creating and deleting an unknown property updates the expanded value
+      ASSERT_EQ("${unknown} fox", pmgr.Expand("${unknown} fox"));
+      pmgr.SetProperty("unknown", "brown");
+      ASSERT_EQ("brown fox", pmgr.Expand("${unknown} fox"));
+      pmgr.ClearProperty("unknown");
+      ASSERT_EQ("${unknown} fox", pmgr.Expand("${unknown} fox"));
+
+      //Assert clearing the manager updates the expanded value
+      pmgr.Clear();
+      ASSERT_EQ("${first} of the ${second}", pmgr.Expand("${first} of the ${second}"));
+
+      //Assert values that depends on live properties are volatile
+      pmgr.Expand("${" + PropertyManager::SYSTEM_RANDOM_GUID_PROPERTY_NAME + "}", is_volatile);
+      ASSERT_TRUE(is_volatile);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testCachedExpansion)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      pmgr.SetProperty("animal", "fox");
+
+      CachedExpansion expansion;
+      ASSERT_EQ("The quick fox", expansion.Expand("The quick ${animal}"));
+      ASSERT_EQ("The quick fox", expansion.Expand("The quick ${animal}"));
+
+      //Assert a modified property is detected
+      pmgr.SetProperty("animal", "dog");
+      ASSERT_EQ("The quick dog", expansion.Expand("The quick ${animal}"));
+
+      //Assert a modified source value is detected
+      ASSERT_EQ("The lazy dog", expansion.Expand("The lazy ${animal}"));
+
+      //Assert volatile values are always expanded
+      const std::string guid_reference = "${" + PropertyManager::SYSTEM_RANDOM_GUID_PROPERTY_NAME + "}";
+      std::string guid1 = expansion.Expand(guid_reference);
+      std::string guid2 = expansion.Expand(guid_reference);
+      ASSERT_NE(guid1, guid2);
+    }
+    //--------------------------------------------------------------------------------------------------
+    class CountingLazyProperty : public virtual ILiveProperty
+    {
+    public:
+      CountingLazyProperty(const std::string& name, const std::string& value, int* count) :
+        mName(name),
+        mValue(value),
+        mCount(count)
+      {
+      }
+      virtual const std::string& GetName() const
+      {
+        return mName;
+      }
+      virtual std::string GetProperty() const
+      {
+        (*mCount)++;
+        return mValue;
+      }
+    private:
+      std::string mName;
+      std::string mValue;
+      int* mCount;
+    };
+    TEST_F(TestPropertyManager, testLazyProperty)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      int count = 0;
+      pmgr.SetLazyProperty(new CountingLazyProperty("animal", "fox", &count));
+
+      //Assert the value is not computed until read
+      ASSERT_TRUE(pmgr.HasProperty("animal"));
+      ASSERT_TRUE(pmgr.IsLazyProperty("animal"));
+      ASSERT_EQ(0, count);
+
+      ASSERT_EQ("fox", pmgr.GetProperty("animal"));
+      ASSERT_EQ(1, count);
+
+      //Assert lazy values are not volatile
+      bool is_volatile = true;
+      ASSERT_EQ("The quick fox", pmgr.Expand("The quick ${animal}", is_volatile));
+      ASSERT_FALSE(is_volatile);
+
+      //Assert a regular property overrides the lazy property
+      pmgr.SetProperty("animal", "dog");
+      ASSERT_FALSE(pmgr.IsLazyProperty("animal"));
+      ASSERT_EQ("The quick dog", pmgr.Expand("The quick ${animal}"));
+
+      //Assert a lazy property overrides a regular property
+      pmgr.SetLazyProperty(new CountingLazyProperty("animal", "cat", &count));
+      ASSERT_EQ("The quick cat", pmgr.Expand("The quick ${animal}"));
+
+      //Assert lazy properties can be cleared
+      pmgr.ClearProperty("animal");
+      ASSERT_FALSE(pmgr.HasProperty("animal"));
+      ASSERT_FALSE(pmgr.IsLazyProperty("animal"));
+
+      pmgr.SetLazyProperty(new CountingLazyProperty("animal", "cat", &count));
+      pmgr.Clear();
+      ASSERT_FALSE(pmgr.HasProperty("animal"));
+
+      //Assert live properties cannot be replaced
+      pmgr.SetLazyProperty(new CountingLazyProperty(PropertyManager::SYSTEM_RANDOM_GUID_PROPERTY_NAME, "foo", &count));
+      ASSERT_FALSE(pmgr.IsLazyProperty(PropertyManager::SYSTEM_RANDOM_GUID_PROPERTY_NAME));
+      ASSERT_NE("foo", pmgr.GetProperty(PropertyManager::SYSTEM_RANDOM_GUID_PROPERTY_NAME));
+    }
+    //--------------------------------------------------------------------------------------------------
+    void FindConfigurationStrings(StringList& values)
+    {
+      // Collect all attribute values with a property reference from the default configuration files.
+      values.clear();
+      const std::string configurations_dir = App::GetInstallDirectory() + "/resources/configurations";
+
+      ra::strings::StringVector files;
+      bool found = ra::filesystem::FindFilesUtf8(files, configurations_dir.c_str(), 0);
+      ASSERT_TRUE(found) << "Failed searching for configuration files in directory '" << configurations_dir << "'.";
+
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        const std::string& path = files[i];
+        if (ra::filesystem::GetFileExtention(path) != "xml")
+          continue;
+
+        std::string content;
+        ASSERT_TRUE(ra::filesystem::ReadTextFile(path, content)) << "Failed reading file '" << path << "'.";
+
+        size_t offset = content.find('"');
+        while (offset != std::string::npos)
+        {
+          size_t end = content.find('"', offset + 1);
+          if (end == std::string::npos)
+            break;
+          std::string value = content.substr(offset + 1, end - offset - 1);
+          if (value.find("${") != std::string::npos)
+            values.push_back(value);
+          offset = content.find('"', end + 1);
+        }
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testExpandTemplateBenchmark)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      StringList values;
+      FindConfigurationStrings(values);
+      ASSERT_FALSE(values.empty());
+
+      // Register selection properties like a right-click on a file would.
+      const std::string install_dir = App::GetInstallDirectory();
+      SelectionContext c;
+      StringList elements;
+      elements.push_back(install_dir + "\\resources\\configurations\\default.xml");
+      c.SetElements(elements);
+      c.RegisterProperties();
+
+      // Assert both modes produces the same results
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        const std::string& value = values[i];
+        ASSERT_EQ(ExpandWithTemplateCache(value, false), ExpandWithTemplateCache(value, true)) << "Failed expanding value '" << value << "'.";
+      }
+
+      static const size_t NUM_ITERATIONS = 200;
+      const bool previous = pmgr.IsTemplateCacheEnabled();
+      uint64_t elapsed[2] = { 0 };
+      for (size_t mode = 0; mode < 2; mode++)
+      {
+        pmgr.SetTemplateCacheEnabled(mode == 1);
+
+        uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+        for (size_t i = 0; i < NUM_ITERATIONS; i++)
+        {
+          for (size_t j = 0; j < values.size(); j++)
+          {
+            const std::string& value = values[j];
+            std::string expanded = pmgr.Expand(value);
+          }
+        }
+        elapsed[mode] = ra::timing::GetMillisecondsCounterU64() - time_start;
+      }
+      pmgr.SetTemplateCacheEnabled(previous);
+
+      c.UnregisterProperties();
+
+      std::cout << "Expanded " << values.size() << " configuration strings " << NUM_ITERATIONS << " times.\n";
+      std::cout << "Expand() without template cache: " << elapsed[0] << " ms\n";
+      std::cout << "Expand() with template cache:    " << elapsed[1] << " ms\n";
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
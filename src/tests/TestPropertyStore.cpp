@@ -0,0 +1,256 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestPropertyStore.h"
+#include "PropertyStore.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/environment_utf8.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+#include <map>
+
+namespace shellanything
+{
+  namespace test
+  {
+
+    //--------------------------------------------------------------------------------------------------
+    void TestPropertyStore::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestPropertyStore::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testSetProperty)
+    {
+      PropertyStore store;
+      ASSERT_TRUE(store.IsEmpty());
+
+      store.SetProperty("foo", "bar");
+      ASSERT_TRUE(store.HasProperty("foo"));
+      ASSERT_EQ("bar", store.GetProperty("foo"));
+      ASSERT_EQ(1, store.GetPropertyCount());
+
+      //overwrite existing
+      store.SetProperty("foo", "baz");
+      ASSERT_EQ("baz", store.GetProperty("foo"));
+      ASSERT_EQ(1, store.GetPropertyCount());
+
+      //test unknown property
+      ASSERT_FALSE(store.HasProperty("unknown"));
+      ASSERT_EQ("", store.GetProperty("unknown"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testTryGetProperty)
+    {
+      PropertyStore store;
+      store.SetProperty("foo", "bar");
+      store.SetProperty("empty", "");
+
+      const std::string* value = NULL;
+      ASSERT_TRUE(store.TryGetProperty("foo", value));
+      ASSERT_TRUE(value != NULL);
+      ASSERT_EQ("bar", *value);
+
+      //Assert an empty value is a valid value
+      ASSERT_TRUE(store.TryGetProperty("empty", value));
+      ASSERT_TRUE(value != NULL);
+      ASSERT_EQ("", *value);
+
+      ASSERT_FALSE(store.TryGetProperty("unknown", value));
+      ASSERT_TRUE(value == NULL);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testClearProperty)
+    {
+      PropertyStore store;
+
+      //Fill the store to force multiple rehash and probing over deleted slots
+      static const size_t NUM_PROPERTIES = 1000;
+      for (size_t i = 0; i < NUM_PROPERTIES; i++)
+      {
+        std::string name = "name" + ra::strings::ToString(i);
+        std::string value = "value" + ra::strings::ToString(i);
+        store.SetProperty(name, value);
+      }
+      ASSERT_EQ(NUM_PROPERTIES, store.GetPropertyCount());
+
+      //Delete half of the properties
+      for (size_t i = 0; i < NUM_PROPERTIES; i += 2)
+      {
+        std::string name = "name" + ra::strings::ToString(i);
+        store.ClearProperty(name);
+      }
+      ASSERT_EQ(NUM_PROPERTIES / 2, store.GetPropertyCount());
+
+      for (size_t i = 0; i < NUM_PROPERTIES; i++)
+      {
+        std::string name = "name" + ra::strings::ToString(i);
+        std::string value = "value" + ra::strings::ToString(i);
+        bool expected = (i % 2 == 1);
+        ASSERT_EQ(expected, store.HasProperty(name)) << "name=" << name;
+        if (expected)
+        {
+          ASSERT_EQ(value, store.GetProperty(name)) << "name=" << name;
+        }
+      }
+
+      //Assert deleted properties can be set again
+      store.SetProperty("name0", "foo");
+      ASSERT_EQ("foo", store.GetProperty("name0"));
+      ASSERT_EQ(NUM_PROPERTIES / 2 + 1, store.GetPropertyCount());
+
+      store.Clear();
+      ASSERT_TRUE(store.IsEmpty());
+      ASSERT_FALSE(store.HasProperty("name1"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testGetProperties)
+    {
+      PropertyStore store;
+      store.SetProperty("charlie", "3");
+      store.SetProperty("alpha", "1");
+      store.SetProperty("delta", "4");
+      store.SetProperty("bravo", "2");
+
+      //Assert names are sorted
+      StringList names;
+      store.GetProperties(names);
+      ASSERT_EQ(4, names.size());
+      ASSERT_EQ("alpha", names[0]);
+      ASSERT_EQ("bravo", names[1]);
+      ASSERT_EQ("charlie", names[2]);
+      ASSERT_EQ("delta", names[3]);
+
+      //Assert copies are independent
+      PropertyStore copy = store;
+      copy.SetProperty("alpha", "one");
+      ASSERT_EQ("1", store.GetProperty("alpha"));
+      ASSERT_EQ("one", copy.GetProperty("alpha"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testPrecomputedHash)
+    {
+      PropertyStore store;
+      store.SetProperty("foo", "bar");
+
+      const size_t foo_hash = PropertyStore::Hash("foo");
+      ASSERT_EQ(foo_hash, PropertyStore::Hash(std::string("f") + "oo"));
+      ASSERT_NE(foo_hash, PropertyStore::Hash("bar"));
+
+      //ASSERT a lookup with a precomputed hash matches a lookup by name
+      const std::string* value = NULL;
+      ASSERT_TRUE(store.TryGetProperty("foo", foo_hash, value));
+      ASSERT_TRUE(value != NULL);
+      ASSERT_EQ("bar", *value);
+      ASSERT_FALSE(store.TryGetProperty("baz", PropertyStore::Hash("baz"), value));
+      ASSERT_TRUE(value == NULL);
+
+      //ASSERT the hash is still valid after the table grows
+      for (size_t i = 0; i < 100; i++)
+      {
+        store.SetProperty(ra::strings::Format("name%03d", (int)i), "value");
+      }
+      ASSERT_TRUE(store.TryGetProperty("foo", foo_hash, value));
+      ASSERT_EQ("bar", *value);
+
+      //ASSERT a deleted property is not found
+      store.ClearProperty("foo");
+      ASSERT_FALSE(store.TryGetProperty("foo", foo_hash, value));
+      store.SetProperty("foo", "baz");
+      ASSERT_TRUE(store.TryGetProperty("foo", foo_hash, value));
+      ASSERT_EQ("baz", *value);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyStore, testBenchmarkEnvironmentVariables)
+    {
+      // Build the same workload as PropertyManager::RegisterEnvironmentVariables()
+      StringList names;
+      StringList values;
+      ra::strings::StringVector vars = ra::environment::GetEnvironmentVariablesUtf8();
+      for (size_t i = 0; i < vars.size(); i++)
+      {
+        const std::string& var = vars[i];
+        names.push_back("env." + var);
+        values.push_back(ra::environment::GetEnvironmentVariableUtf8(var.c_str()));
+      }
+      ASSERT_FALSE(names.empty());
+
+      static const size_t NUM_ITERATIONS = 2000;
+
+      // Previous implementation, based on std::map.
+      typedef std::map<std::string, std::string> PropertyMap;
+      uint64_t map_time_start = ra::timing::GetMillisecondsCounterU64();
+      size_t map_found = 0;
+      for (size_t i = 0; i < NUM_ITERATIONS; i++)
+      {
+        PropertyMap map;
+        for (size_t j = 0; j < names.size(); j++)
+        {
+          map[names[j]] = values[j];
+        }
+        for (size_t j = 0; j < names.size(); j++)
+        {
+          // HasProperty() followed by GetProperty()
+          if (map.find(names[j]) != map.end())
+          {
+            const std::string& value = map.find(names[j])->second;
+            map_found += (value.size() > 0 ? 1 : 0);
+          }
+        }
+      }
+      uint64_t map_elapsed = ra::timing::GetMillisecondsCounterU64() - map_time_start;
+
+      uint64_t store_time_start = ra::timing::GetMillisecondsCounterU64();
+      size_t store_found = 0;
+      for (size_t i = 0; i < NUM_ITERATIONS; i++)
+      {
+        PropertyStore store;
+        for (size_t j = 0; j < names.size(); j++)
+        {
+          store.SetProperty(names[j], values[j]);
+        }
+        for (size_t j = 0; j < names.size(); j++)
+        {
+          const std::string* value = NULL;
+          if (store.TryGetProperty(names[j], value))
+            store_found += (value->size() > 0 ? 1 : 0);
+        }
+      }
+      uint64_t store_elapsed = ra::timing::GetMillisecondsCounterU64() - store_time_start;
+
+      ASSERT_EQ(map_found, store_found);
+
+      std::cout << "Registered and read " << names.size() << " environment variables " << NUM_ITERATIONS << " times.\n";
+      std::cout << "std::map:      " << map_elapsed << " ms\n";
+      std::cout << "PropertyStore: " << store_elapsed << " ms\n";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
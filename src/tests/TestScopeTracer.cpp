@@ -0,0 +1,224 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestScopeTracer.h"
+#include "ScopeTracer.h"
+#include "LoggerHelper.h"
+#include "Environment.h"
+#include "PropertyManager.h"
+#include "Workspace.h"
+
+#include "rapidassist/filesystem_utf8.h"
+
+#include <thread>
+
+namespace shellanything
+{
+  namespace test
+  {
+    static bool gTracingEnabled = false;
+
+    void TracedFunction()
+    {
+      SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
+      sli.verbose = true;
+      sli.instance = &gTracingEnabled;
+      ScopeLogger logger(&sli);
+    }
+
+    void TracedParentFunction()
+    {
+      SA_DECLARE_SCOPE_LOGGER_ARGS(sli);
+      sli.verbose = true;
+      ScopeLogger logger(&sli);
+
+      TracedFunction();
+    }
+
+    size_t CountOccurrences(const std::string& text, const std::string& pattern)
+    {
+      size_t count = 0;
+      size_t pos = text.find(pattern);
+      while (pos != std::string::npos)
+      {
+        count++;
+        pos = text.find(pattern, pos + pattern.size());
+      }
+      return count;
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestScopeTracer::SetUp()
+    {
+      gTracingEnabled = ScopeTracer::IsEnabled();
+      ScopeTracer::Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestScopeTracer::TearDown()
+    {
+      ScopeTracer::SetEnabled(gTracingEnabled);
+      ScopeTracer::Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestScopeTracer, testEnvironmentOption)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      Environment& env = Environment::GetInstance();
+      const std::string& true_value = pmgr.GetProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME);
+      const std::string& false_value = pmgr.GetProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME);
+      const std::string& OPTION_NAME = Environment::SYSTEM_LOGGING_TRACE_ENVIRONMENT_VARIABLE_NAME;
+
+      bool was_set = env.IsOptionSet(OPTION_NAME);
+      std::string previous_value = env.GetOptionValue(OPTION_NAME);
+
+      env.SetOption(OPTION_NAME, true_value);
+      ASSERT_TRUE(ScopeTracer::IsEnabled());
+      env.SetOption(OPTION_NAME, false_value);
+      ASSERT_FALSE(ScopeTracer::IsEnabled());
+      env.ClearOption(OPTION_NAME);
+      ASSERT_FALSE(ScopeTracer::IsEnabled());
+
+      // Assert SetEnabled() overrides the environment option
+      ScopeTracer::SetEnabled(true);
+      ASSERT_TRUE(ScopeTracer::IsEnabled());
+
+      // restore
+      if (was_set)
+        env.SetOption(OPTION_NAME, previous_value);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestScopeTracer, testRecord)
+    {
+      // Nothing is recorded while tracing is disabled
+      ScopeTracer::SetEnabled(false);
+      TracedParentFunction();
+      ASSERT_EQ(0, ScopeTracer::GetEventCount());
+
+      ScopeTracer::SetEnabled(true);
+      TracedParentFunction();
+      ScopeTracer::SetEnabled(false);
+
+      ScopeTracer::EventList events;
+      ScopeTracer::GetEvents(events);
+      ASSERT_EQ(2, events.size());
+
+      // Inner scopes ends first
+      const ScopeTracer::EVENT& child = events[0];
+      const ScopeTracer::EVENT& parent = events[1];
+      ASSERT_NE(std::string::npos, std::string(child.name).find("TracedFunction"));
+      ASSERT_NE(std::string::npos, std::string(parent.name).find("TracedParentFunction"));
+      ASSERT_EQ(&gTracingEnabled, child.instance);
+      ASSERT_TRUE(parent.instance == NULL);
+      ASSERT_EQ(parent.thread_id, child.thread_id);
+
+      // Assert the child scope is nested in the parent scope
+      ASSERT_LE(parent.begin, child.begin);
+      ASSERT_LE(child.begin, child.end);
+      ASSERT_LE(child.end, parent.end);
+
+      ScopeTracer::Clear();
+      ASSERT_EQ(0, ScopeTracer::GetEventCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestScopeTracer, testMultipleThreads)
+    {
+      static const size_t NUM_THREADS = 4;
+      static const size_t COUNT = 100;
+
+      ScopeTracer::SetEnabled(true);
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        threads.push_back(std::thread([]()
+          {
+            for (size_t j = 0; j < COUNT; j++)
+            {
+              TracedFunction();
+            }
+          }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+      ScopeTracer::SetEnabled(false);
+
+      // The scopes of exited threads are kept
+      ASSERT_EQ(NUM_THREADS * COUNT, ScopeTracer::GetEventCount());
+      ASSERT_EQ(0, ScopeTracer::GetDroppedCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestScopeTracer, testRecycledBuffers)
+    {
+      static const size_t NUM_THREADS = 20;
+      static const size_t COUNT = 10;
+
+      ScopeTracer::SetEnabled(true);
+      TracedFunction();
+      const size_t buffer_count = ScopeTracer::GetBufferCount();
+
+      // Run the threads one after the other
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        std::thread t([]()
+          {
+            for (size_t j = 0; j < COUNT; j++)
+            {
+              TracedFunction();
+            }
+          });
+        t.join();
+      }
+      ScopeTracer::SetEnabled(false);
+
+      // Assert the buffer of an exited thread is reused by the next thread
+      ASSERT_LE(ScopeTracer::GetBufferCount(), buffer_count + 1);
+
+      // The scopes of exited threads are kept
+      ASSERT_EQ(1 + NUM_THREADS * COUNT, ScopeTracer::GetEventCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestScopeTracer, testSaveChromeTrace)
+    {
+      ScopeTracer::SetEnabled(true);
+      TracedParentFunction();
+      ScopeTracer::SetEnabled(false);
+
+      std::string json = ScopeTracer::ToChromeTrace();
+      ASSERT_EQ(0, json.find("{\"traceEvents\":["));
+      ASSERT_EQ(2, CountOccurrences(json, "\"ph\":\"X\""));
+      ASSERT_NE(std::string::npos, json.find("TracedParentFunction"));
+      ASSERT_NE(std::string::npos, json.find("\"file\":\"TestScopeTracer.cpp\""));
+      ASSERT_NE(std::string::npos, json.find("\"displayTimeUnit\":\"ms\"}"));
+
+      // Save to a file
+      Workspace workspace;
+      std::string path = workspace.GetFullPathUtf8("trace.json");
+      ASSERT_TRUE(ScopeTracer::SaveChromeTrace(path));
+      ASSERT_TRUE(ra::filesystem::FileExistsUtf8(path.c_str()));
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
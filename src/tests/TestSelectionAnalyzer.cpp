@@ -0,0 +1,268 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestSelectionAnalyzer.h"
+#include "SelectionAnalyzer.h"
+#include "FileMagicManager.h"
+#include "Workspace.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+#undef CreateDirectory
+
+namespace shellanything
+{
+  namespace test
+  {
+    void CreateSelectionFiles(Workspace& workspace, size_t count, StringList& elements)
+    {
+      static const char* CONTENTS[] = {
+        "The quick brown fox jumps over the lazy dog.\n",
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<root><item name=\"foo\" /></root>\n",
+        "#!/bin/sh\necho Hello World\n",
+        "{ \"name\": \"foo\", \"value\": 42 }\n",
+      };
+      static const char* EXTENSIONS[] = { "txt", "xml", "sh", "json" };
+      static const size_t NUM_CONTENTS = sizeof(CONTENTS) / sizeof(CONTENTS[0]);
+
+      elements.clear();
+      for (size_t i = 0; i < count; i++)
+      {
+        const size_t type = i % NUM_CONTENTS;
+        std::string filename = ra::strings::Format("file%05d.%s", (int)i, EXTENSIONS[type]);
+        std::string path = workspace.GetFullPathUtf8(filename.c_str());
+        bool created = ra::filesystem::WriteTextFileUtf8(path, CONTENTS[type]);
+        ASSERT_TRUE(created) << "Failed creating file '" << path << "'.";
+        elements.push_back(path);
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    void AssertElementInfoEquals(const ElementInfoList& expected, const ElementInfoList& actual)
+    {
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); i++)
+      {
+        ASSERT_EQ(expected[i].is_file, actual[i].is_file) << "at index " << i;
+        ASSERT_EQ(expected[i].is_directory, actual[i].is_directory) << "at index " << i;
+        ASSERT_EQ(expected[i].mimetype, actual[i].mimetype) << "at index " << i;
+        ASSERT_EQ(expected[i].description, actual[i].description) << "at index " << i;
+        ASSERT_EQ(expected[i].charset, actual[i].charset) << "at index " << i;
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestSelectionAnalyzer::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestSelectionAnalyzer::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testThreadCount)
+    {
+      SelectionAnalyzer analyzer;
+      ASSERT_EQ(SelectionAnalyzer::GetDefaultThreadCount(), analyzer.GetThreadCount());
+      ASSERT_GE(analyzer.GetThreadCount(), (size_t)1);
+      ASSERT_LE(analyzer.GetThreadCount(), SelectionAnalyzer::MAX_THREAD_COUNT);
+
+      analyzer.SetThreadCount(3);
+      ASSERT_EQ(3, analyzer.GetThreadCount());
+
+      analyzer.SetThreadCount(SelectionAnalyzer::MAX_THREAD_COUNT + 10);
+      ASSERT_EQ(SelectionAnalyzer::MAX_THREAD_COUNT, analyzer.GetThreadCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testAnalyzeEmpty)
+    {
+      SelectionAnalyzer analyzer;
+      StringList elements;
+      ElementInfoList infos(3);
+      analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, infos);
+      ASSERT_TRUE(infos.empty());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testAnalyzeOrder)
+    {
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      StringList elements;
+      CreateSelectionFiles(workspace, 300, elements);
+
+      // Mix directories and missing elements with the files
+      const std::string directory = workspace.GetFullPathUtf8("directory");
+      ASSERT_TRUE(ra::filesystem::CreateDirectoryUtf8(directory.c_str()));
+      const std::string missing = workspace.GetFullPathUtf8("missing.txt");
+      elements.insert(elements.begin() + 10, directory);
+      elements.insert(elements.begin() + 150, missing);
+      elements.push_back(directory);
+
+      SelectionAnalyzer serial;
+      serial.SetThreadCount(1);
+      ElementInfoList expected;
+      serial.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, expected);
+
+      SelectionAnalyzer parallel;
+      parallel.SetThreadCount(4);
+      parallel.SetMinParallelElements(0);
+      ElementInfoList actual;
+      parallel.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, actual);
+
+      AssertElementInfoEquals(expected, actual);
+
+      ASSERT_TRUE(actual[0].is_file);
+      ASSERT_FALSE(actual[0].is_directory);
+      ASSERT_EQ("text/plain", actual[0].mimetype);
+      ASSERT_FALSE(actual[10].is_file);
+      ASSERT_TRUE(actual[10].is_directory);
+      ASSERT_FALSE(actual[150].is_file);
+      ASSERT_FALSE(actual[150].is_directory);
+      ASSERT_TRUE(actual[elements.size() - 1].is_directory);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testAnalyzeFilesystemOnly)
+    {
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      StringList elements;
+      CreateSelectionFiles(workspace, 200, elements);
+
+      SelectionAnalyzer analyzer;
+      analyzer.SetMinParallelElements(0);
+      ElementInfoList infos;
+      analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_FILESYSTEM, infos);
+
+      ASSERT_EQ(elements.size(), infos.size());
+      for (size_t i = 0; i < infos.size(); i++)
+      {
+        ASSERT_TRUE(infos[i].is_file);
+        ASSERT_TRUE(infos[i].mimetype.empty());
+      }
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testWorkerPool)
+    {
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      StringList elements;
+      CreateSelectionFiles(workspace, 200, elements);
+
+      SelectionAnalyzer::StopWorkers();
+      ASSERT_EQ(0, SelectionAnalyzer::GetWorkerCount());
+
+      SelectionAnalyzer serial;
+      serial.SetThreadCount(1);
+      ElementInfoList expected;
+      serial.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, expected);
+
+      //ASSERT small selections do not start workers
+      SelectionAnalyzer analyzer;
+      analyzer.SetThreadCount(4);
+      ElementInfoList actual;
+      StringList small(elements.begin(), elements.begin() + 10);
+      analyzer.Analyze(small, SelectionAnalyzer::ANALYZE_ALL, actual);
+      ASSERT_EQ(small.size(), actual.size());
+      ASSERT_EQ(0, SelectionAnalyzer::GetWorkerCount());
+
+      //ASSERT the workers are kept running between selections
+      analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, actual);
+      AssertElementInfoEquals(expected, actual);
+      ASSERT_EQ(4, SelectionAnalyzer::GetWorkerCount());
+      for (size_t i = 0; i < 10; i++)
+      {
+        SelectionAnalyzer other;
+        other.SetThreadCount(4);
+        other.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, actual);
+        AssertElementInfoEquals(expected, actual);
+      }
+      ASSERT_EQ(4, SelectionAnalyzer::GetWorkerCount());
+
+      //ASSERT the workers are started again after they are stopped
+      SelectionAnalyzer::StopWorkers();
+      ASSERT_EQ(0, SelectionAnalyzer::GetWorkerCount());
+      analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, actual);
+      AssertElementInfoEquals(expected, actual);
+      ASSERT_EQ(4, SelectionAnalyzer::GetWorkerCount());
+
+      //Cleanup
+      SelectionAnalyzer::StopWorkers();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionAnalyzer, testBenchmark10000Files)
+    {
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      StringList elements;
+      CreateSelectionFiles(workspace, 10000, elements);
+
+      // Previous implementation, a serial loop over all elements.
+      FileMagicManager& fm = FileMagicManager::GetInstance();
+      ElementInfoList expected(elements.size());
+      uint64_t serial_time_start = ra::timing::GetMillisecondsCounterU64();
+      for (size_t i = 0; i < elements.size(); i++)
+      {
+        const std::string& element = elements[i];
+        ELEMENT_INFO& info = expected[i];
+        info.is_file = ra::filesystem::FileExistsUtf8(element.c_str());
+        info.is_directory = ra::filesystem::DirectoryExistsUtf8(element.c_str());
+        info.mimetype = fm.GetMIMEType(element);
+        info.description = fm.GetDescription(element);
+        info.charset = fm.GetCharset(element);
+      }
+      uint64_t serial_elapsed = ra::timing::GetMillisecondsCounterU64() - serial_time_start;
+
+      SelectionAnalyzer analyzer;
+      ElementInfoList actual;
+      uint64_t parallel_time_start = ra::timing::GetMillisecondsCounterU64();
+      analyzer.Analyze(elements, SelectionAnalyzer::ANALYZE_ALL, actual);
+      uint64_t parallel_elapsed = ra::timing::GetMillisecondsCounterU64() - parallel_time_start;
+
+      AssertElementInfoEquals(expected, actual);
+
+      std::cout << "Analyzed " << elements.size() << " files.\n";
+      std::cout << "Serial loop:            " << serial_elapsed << " ms\n";
+      std::cout << "SelectionAnalyzer (" << analyzer.GetThreadCount() << " threads): " << parallel_elapsed << " ms\n";
+      if (parallel_elapsed > 0)
+        std::cout << "Speedup: " << ra::strings::Format("%.2f", double(serial_elapsed) / double(parallel_elapsed)) << "x\n";
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
@@ -27,9 +27,11 @@
 #include "SelectionContext.h"
 #include "PropertyManager.h"
 #include "SaUtils.h"
+#include "Workspace.h"
 
 #include "rapidassist/process.h"
 #include "rapidassist/filesystem.h"
+#include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/testing.h"
 #include "rapidassist/errors.h"
 
@@ -96,6 +98,56 @@ namespace shellanything
       ASSERT_EQ(3, c.GetNumDirectories());
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionContext, testElementMetadata)
+    {
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      static const std::string content = "The quick brown fox jumps over the lazy dog.";
+      const std::string file_path = workspace.GetFullPathUtf8("file.bin");
+      const std::string directory_path = workspace.GetFullPathUtf8("directory");
+      const std::string missing_path = workspace.GetFullPathUtf8("missing.txt");
+      ASSERT_TRUE(ra::filesystem::WriteFileUtf8(file_path, content));
+      ASSERT_TRUE(ra::filesystem::CreateDirectoryUtf8(directory_path.c_str()));
+
+      SelectionContext c;
+      StringList elements;
+      elements.push_back(file_path);
+      elements.push_back(directory_path);
+      elements.push_back(missing_path);
+      c.SetElements(elements);
+
+      ASSERT_EQ(1, c.GetNumFiles());
+      ASSERT_EQ(1, c.GetNumDirectories());
+
+      ASSERT_EQ(SelectionContext::ELEMENT_TYPE_FILE, c.GetElementType(0));
+      ASSERT_TRUE(c.IsFile(0));
+      ASSERT_FALSE(c.IsDirectory(0));
+      ASSERT_EQ(content.size(), c.GetElementSize(0));
+      ASSERT_EQ(ra::filesystem::GetFileModifiedDateUtf8(file_path), c.GetElementModifiedDate(0));
+
+      ASSERT_EQ(SelectionContext::ELEMENT_TYPE_DIRECTORY, c.GetElementType(1));
+      ASSERT_FALSE(c.IsFile(1));
+      ASSERT_TRUE(c.IsDirectory(1));
+
+      ASSERT_EQ(SelectionContext::ELEMENT_TYPE_NONE, c.GetElementType(2));
+      ASSERT_FALSE(c.IsFile(2));
+      ASSERT_FALSE(c.IsDirectory(2));
+      ASSERT_EQ(0, c.GetElementSize(2));
+
+      //out of range
+      ASSERT_EQ(SelectionContext::ELEMENT_TYPE_NONE, c.GetElementType(3));
+
+      //assert metadata is copied
+      SelectionContext copy = c;
+      ASSERT_TRUE(copy.IsFile(0));
+      ASSERT_TRUE(copy.IsDirectory(1));
+      ASSERT_EQ(content.size(), copy.GetElementSize(0));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestSelectionContext, testCopy)
     {
       SelectionContext c;
@@ -410,6 +462,54 @@ namespace shellanything
       ASSERT_EQ("dll,exe,exe,msc", selection_filename_ext);
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSelectionContext, testRegisterPropertiesLazy)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.Clear();
+
+      pmgr.SetProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME, ",");
+
+      SelectionContext context;
+#ifdef _WIN32
+      {
+        StringList elements;
+        elements.push_back("C:\\Windows\\System32\\cmd.exe");
+        elements.push_back("C:\\Windows\\System32\\notepad.exe");
+        context.SetElements(elements);
+      }
+#else
+      //TODO: complete with known path to files
+#endif
+
+      //act
+      context.RegisterProperties();
+
+      //assert path and counts are computed immediately
+      ASSERT_TRUE(pmgr.HasProperty("selection.path"));
+      ASSERT_FALSE(pmgr.IsLazyProperty("selection.path"));
+      ASSERT_FALSE(pmgr.IsLazyProperty("selection.count"));
+
+      //assert other properties are computed on demand
+      ASSERT_TRUE(pmgr.HasProperty("selection.mimetype"));
+      ASSERT_TRUE(pmgr.IsLazyProperty("selection.mimetype"));
+      ASSERT_TRUE(pmgr.IsLazyProperty("selection.filename"));
+      ASSERT_TRUE(pmgr.IsLazyProperty("selection.dir.count"));
+
+      ASSERT_EQ("C:\\Windows\\System32\\cmd.exe,C:\\Windows\\System32\\notepad.exe", pmgr.Expand("${selection.path}"));
+      ASSERT_EQ("cmd.exe,notepad.exe", pmgr.Expand("${selection.filename}"));
+      ASSERT_EQ("cmd.exe,notepad.exe", pmgr.Expand("${selection.filename}"));
+
+      //assert the separator is read when the properties are registered
+      pmgr.SetProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME, ";");
+      ASSERT_EQ("exe,exe", pmgr.Expand("${selection.filename.extension}"));
+
+      //assert lazy properties are unregistered
+      context.UnregisterProperties();
+      ASSERT_FALSE(pmgr.HasProperty("selection.mimetype"));
+      ASSERT_FALSE(pmgr.IsLazyProperty("selection.mimetype"));
+      ASSERT_FALSE(pmgr.HasProperty("selection.dir.count"));
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestSelectionContext, testSelectionDrive)
     {
       PropertyManager& pmgr = PropertyManager::GetInstance();
@@ -31,6 +31,9 @@
 #include "rapidassist/testing.h"
 #include "rapidassist/process.h"
 
+#include <thread>
+#include <atomic>
+
 extern shellanything::TestKeyboardService* keyboard_service;
 
 namespace shellanything
@@ -602,6 +605,158 @@ namespace shellanything
       ASSERT_TRUE(v.IsInversed("bar"));
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testIsInversedKnownAttributes)
+    {
+      Validator v;
+
+      v.SetInserve("class" SA_INVERSE_ATTR_SEPARATOR_STR "foo");
+      ASSERT_TRUE(v.IsInversed("class"));
+      ASSERT_TRUE(v.IsInversed("foo"));
+      ASSERT_FALSE(v.IsInversed("pattern"));
+      ASSERT_FALSE(v.IsInversed("all"));
+
+      // Assert the inversed attributes are compiled again
+      v.SetInserve("pattern");
+      ASSERT_FALSE(v.IsInversed("class"));
+      ASSERT_FALSE(v.IsInversed("foo"));
+      ASSERT_TRUE(v.IsInversed("pattern"));
+
+      // Assert 'all' inverse known and custom attributes
+      v.SetInserve("all");
+      ASSERT_TRUE(v.IsInversed("all"));
+      ASSERT_TRUE(v.IsInversed("class"));
+      ASSERT_TRUE(v.IsInversed("foo"));
+
+      v.SetInserve("");
+      ASSERT_FALSE(v.IsInversed("all"));
+      ASSERT_FALSE(v.IsInversed("class"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testCompiledAttributesExpansion)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      SelectionContext c;
+      {
+        StringList elements;
+        elements.push_back("C:\\foo\\bar.txt");
+        elements.push_back("C:\\foo\\baz.txt");
+        c.SetElements(elements);
+      }
+
+      Validator v;
+      v.SetPattern("${test.pattern}");
+      v.SetClass(".${test.extension}");
+
+      pmgr.SetProperty("test.pattern", "*.txt");
+      pmgr.SetProperty("test.extension", "txt");
+      ASSERT_TRUE(v.Validate(c));
+      ASSERT_TRUE(v.Validate(c));
+
+      // Assert compiled attributes are updated when the expanded value changes
+      pmgr.SetProperty("test.pattern", "*.doc");
+      ASSERT_FALSE(v.Validate(c));
+
+      pmgr.SetProperty("test.pattern", "*.TXT" SA_PATTERN_ATTR_SEPARATOR_STR "*.doc");
+      ASSERT_TRUE(v.Validate(c));
+
+      pmgr.SetProperty("test.extension", "doc");
+      ASSERT_FALSE(v.Validate(c));
+
+      pmgr.SetProperty("test.extension", "TXT");
+      ASSERT_TRUE(v.Validate(c));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testCostOrderedValidation)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      SelectionContext c;
+      {
+        StringList elements;
+        elements.push_back("C:\\foo\\bar.txt");
+        c.SetElements(elements);
+      }
+
+      const bool previous = Validator::IsStatisticsEnabled();
+      Validator::SetStatisticsEnabled(true);
+
+      // Define an expensive check before a cheaper one in source order.
+      Validator v;
+      v.SetExprtk("${test.count} > 5");
+      v.SetIsTrue("${test.enabled}");
+
+      // Assert the cheaper check is evaluated first and the expensive check is skipped.
+      pmgr.SetProperty("test.count", "10");
+      pmgr.SetProperty("test.enabled", "false");
+      ASSERT_FALSE(v.Validate(c));
+
+      std::string str;
+      v.ToStatisticsString(str, 0);
+      ASSERT_NE(std::string::npos, str.find("1 validations, 1 failures")) << str;
+      ASSERT_NE(std::string::npos, str.find("istrue: evaluations=1, failures=1, skipped=0")) << str;
+      ASSERT_NE(std::string::npos, str.find("exprtk: evaluations=0, failures=0, skipped=1")) << str;
+
+      // Assert the result is the same as the evaluation in source order
+      pmgr.SetProperty("test.enabled", "true");
+      ASSERT_TRUE(v.Validate(c));
+      pmgr.SetProperty("test.count", "1");
+      ASSERT_FALSE(v.Validate(c));
+
+      str.clear();
+      v.ToStatisticsString(str, 0);
+      ASSERT_NE(std::string::npos, str.find("3 validations, 2 failures")) << str;
+      ASSERT_NE(std::string::npos, str.find("exprtk: evaluations=2, failures=1, skipped=1")) << str;
+      printf("%s\n", str.c_str());
+
+      v.ResetStatistics();
+      str.clear();
+      v.ToStatisticsString(str, 0);
+      ASSERT_NE(std::string::npos, str.find("0 validations, 0 failures")) << str;
+
+      Validator::SetStatisticsEnabled(previous);
+      pmgr.ClearProperty("test.count");
+      pmgr.ClearProperty("test.enabled");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testMultipleThreads)
+    {
+      SelectionContext c;
+      {
+        StringList elements;
+        elements.push_back("C:\\foo\\bar.txt");
+        elements.push_back("C:\\foo\\baz.ini");
+        c.SetElements(elements);
+      }
+
+      // Assert the cached and compiled attributes of a validator can be used by multiple threads.
+      Validator v;
+      v.SetPattern("*.txt" SA_PATTERN_ATTR_SEPARATOR_STR "*.ini");
+      v.SetFileExtensions("txt" SA_FILEEXTENSION_ATTR_SEPARATOR_STR "ini");
+
+      static const size_t NUM_THREADS = 4;
+      static const size_t NUM_VALIDATIONS = 1000;
+      std::atomic<size_t> failures(0);
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        threads.push_back(std::thread([&v, &c, &failures]()
+        {
+          for (size_t j = 0; j < NUM_VALIDATIONS; j++)
+          {
+            if (!v.Validate(c))
+              failures++;
+          }
+        }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+
+      ASSERT_EQ(0, failures.load());
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestValidator, testMaxFilesInversed)
     {
       SelectionContext c;
@@ -24,7 +24,10 @@
 
 #include "TestWildcard.h"
 #include "Wildcard.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
 #include <sstream>
+#include <iostream>
 
 namespace shellanything
 {
@@ -623,6 +626,165 @@ namespace shellanything
       }
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcard, testMatcherCompatibility)
+    {
+      struct TEST
+      {
+        const char* pattern;
+        const char* value;
+      };
+      static const TEST tests[] = {
+        {"abcd", "abcd"},
+        {"ab?d", "abcd"},
+        {"?bcd", "abcd"},
+        {"abc?", "abcd"},
+        {"ab*cde", "abcde"},
+        {"ab*de", "abcde"},
+        {"ab*e", "abcde"},
+        {"*abcde", "abcde"},
+        {"*bcde", "abcde"},
+        {"*cde", "abcde"},
+        {"abcde*", "abcde"},
+        {"abcd*", "abcde"},
+        {"abc*", "abcde"},
+        {"abc*f?h*z", "abcz"},
+        {"abc*d", "abcd"},
+        {"abcd*", "abcd"},
+        {"*abcd", "abcd"},
+        {"abc*?e", "abcde"},
+        {"abc*fg", "abcdefabcfg"},
+        {"abc*??h", "abcdefgh"},
+        {"abc*??", "abcdefg"},
+        {"*", ""},
+        {"******", ""},
+        {"", ""},
+        {"", "a"},
+        {"?", ""},
+        {"a?", "a"},
+        {"*.txt", "file.txt"},
+        {"*.txt", "file.txt.bak"},
+        {"*\\foo\\*.txt", "C:\\foo\\bar.txt"},
+        {"*\\foo\\*.txt", "C:\\foo\\bar.exe"},
+      };
+      static const size_t num_tests = sizeof(tests) / sizeof(tests[0]);
+
+      // Assert the matcher returns the same results as WildcardMatch().
+      for (size_t i = 0; i < num_tests; i++)
+      {
+        const TEST& test = tests[i];
+
+        StringList patterns;
+        patterns.push_back(test.pattern);
+
+        WildcardMatcher matcher;
+        matcher.Compile(patterns, true);
+
+        bool expected = WildcardMatch(test.pattern, test.value);
+        bool match = matcher.IsMatch(test.value);
+        ASSERT_EQ(expected, match) << "Unexpected assertion: pattern \"" << test.pattern << "\" and value \"" << test.value << "\".";
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcard, testMatcherPatternIndex)
+    {
+      StringList patterns;
+      patterns.push_back("*.txt");
+      patterns.push_back("*.exe");
+      patterns.push_back("C:\\*");
+      patterns.push_back("*.t?t");
+
+      WildcardMatcher matcher;
+      ASSERT_FALSE(matcher.IsMatch("foo.txt"));
+      matcher.Compile(patterns, true);
+      ASSERT_EQ(4, matcher.GetPatternCount());
+      ASSERT_TRUE(matcher.IsCaseSensitive());
+
+      // Assert the index of the first matching pattern is returned
+      ASSERT_EQ(0, matcher.Match("D:\\foo.txt"));
+      ASSERT_EQ(1, matcher.Match("D:\\foo.exe"));
+      ASSERT_EQ(2, matcher.Match("C:\\foo.dll"));
+      ASSERT_EQ(0, matcher.Match("C:\\foo.txt"));
+      ASSERT_EQ(3, matcher.Match("D:\\foo.tst"));
+      ASSERT_EQ(WildcardMatcher::INVALID_PATTERN_INDEX, matcher.Match("D:\\foo.dll"));
+      ASSERT_EQ(WildcardMatcher::INVALID_PATTERN_INDEX, matcher.Match(NULL));
+
+      // Assert a copy matches the same values
+      WildcardMatcher copy = matcher;
+      ASSERT_EQ(1, copy.Match("D:\\foo.exe"));
+
+      matcher.Clear();
+      ASSERT_EQ(0, matcher.GetPatternCount());
+      ASSERT_FALSE(matcher.IsMatch("D:\\foo.txt"));
+      ASSERT_EQ(1, copy.Match("D:\\foo.exe"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcard, testMatcherCaseInsensitive)
+    {
+      StringList patterns;
+      patterns.push_back("*\\Windows\\*.EXE");
+
+      WildcardMatcher matcher;
+      matcher.Compile(patterns, true);
+      ASSERT_TRUE(matcher.IsMatch("C:\\Windows\\notepad.EXE"));
+      ASSERT_FALSE(matcher.IsMatch("c:\\windows\\notepad.exe"));
+
+      matcher.Compile(patterns, false);
+      ASSERT_FALSE(matcher.IsCaseSensitive());
+      ASSERT_TRUE(matcher.IsMatch("C:\\Windows\\notepad.EXE"));
+      ASSERT_TRUE(matcher.IsMatch("c:\\windows\\notepad.exe"));
+      ASSERT_TRUE(matcher.IsMatch("C:\\WINDOWS\\NOTEPAD.EXE"));
+      ASSERT_FALSE(matcher.IsMatch("C:\\WINDOWS\\NOTEPAD.DLL"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcard, testMatcherBenchmark)
+    {
+      // Build many patterns and many paths like a large selection validated against many menus.
+      static const size_t NUM_PATTERNS = 50;
+      static const size_t NUM_PATHS = 2000;
+      StringList patterns;
+      for (size_t i = 0; i < NUM_PATTERNS; i++)
+        patterns.push_back("*\\FOLDER" + ra::strings::ToString(i) + "\\*.EXT" + ra::strings::ToString(i));
+      StringList paths;
+      for (size_t i = 0; i < NUM_PATHS; i++)
+        paths.push_back("C:\\Users\\Foo\\Documents\\folder" + ra::strings::ToString(i % (NUM_PATTERNS * 2)) + "\\file" + ra::strings::ToString(i) + ".ext" + ra::strings::ToString(i % NUM_PATTERNS));
+
+      // Match with WildcardMatch() like the Validator used to do.
+      uint64_t time_start = ra::timing::GetMillisecondsCounterU64();
+      size_t expected_matches = 0;
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        std::string path_uppercase = ra::strings::Uppercase(paths[i]);
+        for (size_t j = 0; j < patterns.size(); j++)
+        {
+          if (WildcardMatch(patterns[j].c_str(), path_uppercase.c_str()))
+          {
+            expected_matches++;
+            break;
+          }
+        }
+      }
+      uint64_t elapsed_recursive = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      // Match with the compiled automaton
+      time_start = ra::timing::GetMillisecondsCounterU64();
+      WildcardMatcher matcher;
+      matcher.Compile(patterns, false);
+      size_t matches = 0;
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        if (matcher.IsMatch(paths[i].c_str()))
+          matches++;
+      }
+      uint64_t elapsed_automaton = ra::timing::GetMillisecondsCounterU64() - time_start;
+
+      ASSERT_EQ(expected_matches, matches);
+      ASSERT_GT(matches, 0);
+
+      std::cout << "Matched " << NUM_PATHS << " paths against " << NUM_PATTERNS << " patterns.\n";
+      std::cout << "WildcardMatch():         " << elapsed_recursive << " ms\n";
+      std::cout << "WildcardMatcher::Match(): " << elapsed_automaton << " ms (" << matcher.GetStateCount() << " states)\n";
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
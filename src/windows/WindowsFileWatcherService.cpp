@@ -0,0 +1,139 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "WindowsFileWatcherService.h"
+#include "LoggerHelper.h"
+
+#include "rapidassist/unicode.h"
+#include "rapidassist/errors.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+
+#include <map>
+#include <mutex>
+
+namespace shellanything
+{
+  static const DWORD CHANGE_NOTIFICATION_FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+  typedef std::map<std::string, HANDLE> ChangeHandleMap;
+
+  struct WindowsFileWatcherService::STATE
+  {
+    std::mutex mutex;
+    ChangeHandleMap handles; // change notification handle of each watched directory.
+  };
+
+  WindowsFileWatcherService::WindowsFileWatcherService() :
+    mState(new STATE())
+  {
+  }
+
+  WindowsFileWatcherService::~WindowsFileWatcherService()
+  {
+    UnwatchAll();
+    delete mState;
+    mState = NULL;
+  }
+
+  bool WindowsFileWatcherService::Watch(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    if (mState->handles.find(path) != mState->handles.end())
+      return true; // already watching
+
+    std::wstring path_unicode = ra::unicode::Utf8ToUnicode(path);
+    HANDLE handle = FindFirstChangeNotificationW(path_unicode.c_str(), TRUE, CHANGE_NOTIFICATION_FILTER);
+    if (handle == INVALID_HANDLE_VALUE || handle == NULL)
+    {
+      ra::errors::errorcode_t code = ra::errors::GetLastErrorCode();
+      std::string desc = ra::errors::GetErrorCodeDescription(code);
+      SA_LOG(WARNING) << "Failed watching directory '" << path << "'. Error 0x" << std::hex << code << std::dec << ", " << desc;
+      return false;
+    }
+
+    mState->handles[path] = handle;
+    return true;
+  }
+
+  bool WindowsFileWatcherService::Unwatch(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    ChangeHandleMap::iterator it = mState->handles.find(path);
+    if (it == mState->handles.end())
+      return false;
+
+    FindCloseChangeNotification(it->second);
+    mState->handles.erase(it);
+    return true;
+  }
+
+  void WindowsFileWatcherService::UnwatchAll()
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    for (ChangeHandleMap::iterator it = mState->handles.begin(); it != mState->handles.end(); it++)
+    {
+      FindCloseChangeNotification(it->second);
+    }
+    mState->handles.clear();
+  }
+
+  bool WindowsFileWatcherService::IsWatching(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return (mState->handles.find(path) != mState->handles.end());
+  }
+
+  bool WindowsFileWatcherService::GetChanges(StringList& directories)
+  {
+    directories.clear();
+
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    for (ChangeHandleMap::iterator it = mState->handles.begin(); it != mState->handles.end(); it++)
+    {
+      const std::string& path = it->first;
+      HANDLE handle = it->second;
+
+      // Check the notification without waiting
+      DWORD status = WaitForSingleObject(handle, 0);
+      if (status == WAIT_TIMEOUT)
+        continue;
+
+      directories.push_back(path);
+
+      // Rearm the notification for the next changes.
+      // Once signaled, the handle stays signaled until FindNextChangeNotification() is called.
+      if (status != WAIT_OBJECT_0 || !FindNextChangeNotification(handle))
+      {
+        SA_LOG(WARNING) << "Failed waiting for changes in directory '" << path << "'. Changes will be reported on each call.";
+      }
+    }
+
+    return !directories.empty();
+  }
+
+} //namespace shellanything
@@ -0,0 +1,63 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_WINDOWS_FILE_WATCHER_SERVICE_H
+#define SA_WINDOWS_FILE_WATCHER_SERVICE_H
+
+#include "sa_windows_export.h"
+#include "IFileWatcherService.h"
+
+namespace shellanything
+{
+  /// <summary>
+  /// Win32 implementation class of IFileWatcherService.
+  /// Each watched directory is assigned a change notification handle that also monitors its subdirectories.
+  /// The handles are checked without blocking when GetChanges() is called.
+  /// </summary>
+  class SA_WINDOWS_EXPORT WindowsFileWatcherService : public virtual IFileWatcherService
+  {
+  public:
+    WindowsFileWatcherService();
+    virtual ~WindowsFileWatcherService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    WindowsFileWatcherService(const WindowsFileWatcherService&);
+    WindowsFileWatcherService& operator=(const WindowsFileWatcherService&);
+  public:
+
+    virtual bool Watch(const std::string& path);
+    virtual bool Unwatch(const std::string& path);
+    virtual void UnwatchAll();
+    virtual bool IsWatching(const std::string& path);
+    virtual bool GetChanges(StringList& directories);
+
+  private:
+    struct STATE;
+    STATE* mState;
+  };
+
+} //namespace shellanything
+
+#endif //SA_WINDOWS_FILE_WATCHER_SERVICE_H